@@ -38,14 +38,6 @@ RoutingPlugin::RoutingPlugin(const string& outputFile, EdgeFilter *edgFilter, bo
 RoutingPlugin::~RoutingPlugin() {
     ;
 }
-/**
- * @brief isRestricted
- * @param v1
- * @return
- */
-bool RoutingPlugin::isRestricted(const VertexId v1) {
-    return turns_.find(v1) != turns_.end();
-}
 /**
  * @brief isEndPoint
  * @param v
@@ -80,133 +72,6 @@ void RoutingPlugin::setTurnRestrictions(const EndPointPlugin::TurnRestrictions &
     turns_ = restrictions;
     hasTurnRestrictions_ = true;
 }
-/**
- * @brief RoutingPlugin::nextEndPoint
- * @param vpt
- * @return
- */
-Vertex::VertexId RoutingPlugin::nextEndPoint() {
-    // insert new id
-    Vertex::VertexId newId = freeVerId_++;
-    return newId;
-}
-/**
- * This function works only on endpoints!!!
- * @brief RoutingPlugin::createTurnEdges
- * @param v1
- * @param via
- * @param v2
- * @param dist
- * @param time
- * @param origId
- */
-void RoutingPlugin::createTurnEdges(VertexId v1, VertexId v2,
-                                    DistType dist, DistType time,
-                                    Edge::EdgeType type, Edge::EdgeId origId,
-                                    bool first) {
-    if(first) {
-        // v1 is an endpoint here as its restricted
-        EdgeForw from(v2, dist, time, Vertex::NullVertexId, type, origId);
-        if(edgesFromTurn_.find(v1) != edgesFromTurn_.end())
-            edgesFromTurn_[v1].push_back(from);
-        else
-            edgesFromTurn_[v1] = {from};
-
-        if(!(type & Edge::ONE_WAY)) {
-            EdgeBack to(v2, dist, time, Vertex::NullVertexId, type, origId);
-            if(edgesToTurn_.find(v1) != edgesToTurn_.end())
-                edgesToTurn_[v1].push_back(to);
-            else
-                edgesToTurn_[v1] = {to};
-        }
-    } else {
-        EdgeBack to(v1, dist, time, Vertex::NullVertexId, type, origId);
-        if(edgesToTurn_.find(v2) != edgesToTurn_.end())
-            edgesToTurn_[v2].push_back(to);
-        else
-            edgesToTurn_[v2] = {to};
-
-        // v2 is an endpoint here
-        if(!(type & Edge::ONE_WAY)) {
-            EdgeForw from(v1, dist, time, Vertex::NullVertexId, type, origId);
-            if(edgesFromTurn_.find(v2) != edgesFromTurn_.end())
-                edgesFromTurn_[v2].push_back(from);
-            else
-                edgesFromTurn_[v2] = {from};
-        }
-    }
-}
-
-/**
- * This function works only on endpoints!!!
- * The function throws out turns which create a turn restriction
- * @brief createTurnShortcuts
- */
-void RoutingPlugin::createTurnShortcuts() {
-    for(auto turn : turns_) {
-        // the via that we got from endpoint handler is not translated
-        // to endpoint id
-        int shortCuts = 0;
-        VertexId via = newId(turn.first);
-
-        // get all the turn restrictions at the node
-        // and divide them into permissive and restrictive types
-        map<Edge::EdgeId, Edge::EdgeId> only;
-        map<Edge::EdgeId, set<Edge::EdgeId> > no;
-        for(int i = 0; i < turn.second.size(); i++) {
-            TurnRestriction curr = turn.second[i];
-            if(edgeFilter_->isNoRestriction(curr.getType())) {
-                auto found = no.find(curr.getFrom());
-                if(found == no.end())
-                    no[curr.getFrom()] = {curr.getTo()};
-                else
-                    found->second.insert(curr.getTo());
-            }
-
-            if(edgeFilter_->isOnlyRestriction(curr.getType())) {
-                if(only.count(curr.getFrom()))
-                    LOGG(Logger::ERROR) << "Contradicting turn restriction for from:" <<
-                                           curr.getFrom() << " to:" << curr.getTo() << " via: " <<
-                                           curr.getVia() << " type:" << curr.getType() << Logger::FLUSH;
-                only[curr.getFrom()] = curr.getTo();
-            }
-        }
-
-        for(const EdgeForw &from : edgesFromTurn_[via]) {
-            for(const EdgeBack &to : edgesToTurn_[via]) {
-                // check that the edges do not create a turn restriction
-                Edge::EdgeId fId = to.getOrigId(), tId = from.getOrigId();
-
-                // there should be no "no" restriction at the turn
-                // if there is a "only" retriction at the turn, it has to be the
-                // destination edge
-                bool haveNo = no.count(fId) && no[fId].count(tId);
-                bool haveOnly = only.count(fId) == 0 || only[fId] == tId;
-                if(!haveNo && haveOnly) {
-                    // make sure the type of the new edge makes sense
-                    Edge::EdgeType type = from.getType() | to.getType() | Edge::TURN_RESTRICTED | Edge::FINAL;
-                    if(type & Edge::GEOMETRY_STORED) {
-                        // geometry will not be stored in the database
-                        type = type ^ Edge::GEOMETRY_STORED;
-                    }
-
-                    // create a new shortcut edge
-                    DistType time = from.getCost<Edge::TimeMetric>()+to.getCost<Edge::TimeMetric>();
-                    DistType dist = from.getCost<Edge::DistanceMetric>()+to.getCost<Edge::DistanceMetric>();
-                    Edge::EdgeId origId = from.getOrigId() == to.getOrigId() ? from.getOrigId() : Edge::NullEdgeId;
-
-                    // serialize new edge, no need to serialize geometry
-                    serializeEdge(to.getNextId(), from.getNextId(), dist, time, type, origId, via);
-                    shortCuts++;
-                }
-            }
-        }
-        if(shortCuts == 0) {
-            LOGG(Logger::WARNING) << "Vertex " << turn.first << " has 0 shortcuts created" << Logger::FLUSH;
-        }
-    }
-}
-
 /**
  * @brief RoutingPlugin::serializeEdge
  * @param ver1
@@ -240,15 +105,6 @@ void RoutingPlugin::serializeVertices() {
             die(pluginId_,"can't insert point to kdTree");
         totalEndpointsWritten_++;
     }
-
-    // these were created when resolving turn restrictions by splitting edges
-    for(auto &edge : dummyEndPoints_) {
-        VertexPoint vpt = edge.second;
-        vpt.serializeToFile(vertFileDescr_);
-        if(!kdTreeEndPt_.insertBulk(vpt, sep, noStartEnd))
-            die(pluginId_,"can't insert point to kdTree");
-        totalEndpointsWritten_++;
-    }
 }
 /**
  * @brief serializeTurnRestrictions
@@ -354,7 +210,6 @@ void RoutingPlugin::before_nodes() {
     fclose(endPointDescriptor);
 
     // from this point on noone should insert into endpoints
-    freeVerId_ = numEndPoints;
     freeEdgeId_ = osmValidator_->maxEdgeId()+1;
 
     // assign new id's to vertices
@@ -383,8 +238,6 @@ void RoutingPlugin::notifyRelation(OSMRelation* /*rel*/) {
  * @brief finalize
  */
 void RoutingPlugin::finalize() {
-    LOGG(Logger::INFO) << "[CREATE TURN SHORTCUTS]" << Logger::FLUSH;
-    createTurnShortcuts();
     LOGG(Logger::INFO) << "[SERIALIZE TURN RESTRICTIONS]" << Logger::FLUSH;
     serializeTurnRestrictions();
     LOGG(Logger::INFO) << "[SERIALIZE VERTICES START]" << Logger::FLUSH;
@@ -494,112 +347,33 @@ void RoutingPlugin::notifyWay(OSMWay* way) {
 
             EdgeType type = commonType;
 
-            // serialize only in case not both of the endpoints were turn
-            // restricted and there was no point in between curr and prevEnd
-            if(!(curr-prev == 1 && isRestricted(vers[curr]) && isRestricted(vers[prev]))) {
-                // type tells us if the geometry is stored in the database
-                if(curr-prev > 1)
-                    type |= Edge::GEOMETRY_STORED;
-
-                // extract geometry
-                vector<Point> geom;
-                vector<VertexId> ids;
-                for(int i = prev+1; i < curr; i++) {
-                    geom.push_back(pts[i]);
-                    ids.push_back(vers[i]);
-                }
+            // type tells us if the geometry is stored in the database
+            if(curr-prev > 1)
+                type |= Edge::GEOMETRY_STORED;
 
-                // prepare turn restrictions by inserting a split vertex
-                // in the middle of each edge that has at least one restricted
-                // endpoint.
-                int fix[] = {prev, curr};
-                bool changedEndPoint[] = {false, false};
-                VertexId newEndIds[] = {newId(vers[prev]), newId(vers[curr])};
-                for(int i = 0; i < 2; i++) {
-                    // insert a new point just after start of the edge
-                    // and before the end of the edge
-                    VertexId at = fix[i];
-                    if(isRestricted(vers[at])) {
-                        vector<Point> tmp = {pts[at-i], pts[at+1-i]};
-                        Point mid = centerOfMass(tmp);
-                        VertexId newEnd = nextEndPoint();
-                        VertexPoint vpt(newEnd, mid.lat(), mid.lon());
-                        if(dummyEndPoints_.count({(Edge::EdgeId)way->nID, edgeKey(vers[at-i], vers[at+1-i])})) {
-                            LOGG(Logger::ERROR) << "Couldn't resolve way: " << way->nID << Logger::FLUSH;
-                            for(int k = 0; k < way->nRefs; k++) {
-                                LOGG(Logger::ERROR) << vers[k] << Logger::FLUSH;
-                            }
-                            exit(EXIT_FAILURE);
-                        }
-                        dummyEndPoints_[{(Edge::EdgeId)way->nID, edgeKey(vers[at-i], vers[at+1-i])}] = vpt;
-                        changedEndPoint[i] = true;
-                        newEndIds[i] = newEnd;
-                    }
-                }
-
-                // update distance
-                if(changedEndPoint[0])
-                    dist -= pointDistance(pts[prev], pts[prev+1])/2.0;
-                if(changedEndPoint[1])
-                    dist -= pointDistance(pts[curr], pts[curr-1])/2.0;
-
-                // update edge metrics
-                Edge::EdgeDist speed = edgeFilter_->speedLimit(way);
-                time += dist/(speed*EdgeFilter::KMH_TO_MS);
-
-                // remember the edges that lead to a turn restriction and from turn restriction
-                // schema:
-                //    original edge with a turn restriction on both vertices
-                //      v1-------v2
-                //    new edges created v1->n1, n2->v2
-                //      v1--n1------n2-v2
-                if(changedEndPoint[0]) {
-                    DistType fromDist = pointDistance(pts[prev], pts[prev+1])/2.0;
-                    DistType fromTime = fromDist/speed;
-                    createTurnEdges(newId(vers[prev]), newEndIds[0], fromDist, fromTime, type, way->nID, true);
-                }
+            // extract geometry
+            vector<Point> geom;
+            vector<VertexId> ids;
+            for(int i = prev+1; i < curr; i++) {
+                geom.push_back(pts[i]);
+                ids.push_back(vers[i]);
+            }
 
-                if(changedEndPoint[1]) {
-                    DistType toDist = pointDistance(pts[curr], pts[curr-1])/2.0;
-                    DistType toTime = toDist/speed;
-                    createTurnEdges(newEndIds[1], newId(vers[curr]), toDist, toTime, type, way->nID, false);
-                }
+            // update edge metrics
+            Edge::EdgeDist speed = edgeFilter_->speedLimit(way);
+            time += dist/(speed*EdgeFilter::KMH_TO_MS);
 
-                if(edgeFilter_->onewayEdge(way)) {
-                    serializeEdge(newEndIds[0], newEndIds[1], dist, time, type, way->nID);
-                    serializeGeometry(newEndIds[0], newEndIds[1], true, ids, geom);
-                } else {
-                    // create and serialize edges
-                    serializeEdge(newEndIds[1], newEndIds[0], dist, time, type, way->nID);
-                    serializeEdge(newEndIds[0], newEndIds[1], dist, time, type, way->nID);
-                    serializeGeometry(newEndIds[0], newEndIds[1], false, ids, geom);
-                }
+            // turn restrictions are serialized separately, the routing
+            // model resolves them when it loads the graph
+            VertexId ver1 = newId(vers[prev]), ver2 = newId(vers[curr]);
+            if(edgeFilter_->onewayEdge(way)) {
+                serializeEdge(ver1, ver2, dist, time, type, way->nID);
+                serializeGeometry(ver1, ver2, true, ids, geom);
             } else {
-                // the case that both vertices are restricted and there
-                // is no vertex in between so that the edge could be split
-
-                // create new via vertex
-                vector<Point> tmp = {pts[prev], pts[curr]};
-                Point mid = centerOfMass(tmp);
-                VertexId newEnd = nextEndPoint();
-                VertexPoint vpt(newEnd, mid.lat(), mid.lon());
-                if(dummyEndPoints_.count({(Edge::EdgeId)way->nID, edgeKey(vers[prev], vers[curr])}) != 0) {
-                    LOGG(Logger::ERROR) << "Couldn't resolve way: " << way->nID << Logger::FLUSH;
-                    for(int k = 0; k < way->nRefs; k++) {
-                        LOGG(Logger::ERROR) << vers[k] << Logger::FLUSH;
-                    }
-                    exit(EXIT_FAILURE);
-                }
-                dummyEndPoints_[{(Edge::EdgeId)way->nID, edgeKey(vers[prev], vers[curr])}] = vpt;
-
-                // update edge metrics
-                DistType nDist = pointDistance(pts[prev], pts[curr])/2.0;
-                DistType speed = edgeFilter_->speedLimit(way);
-                DistType nTime = nDist/(speed*EdgeFilter::KMH_TO_MS);
-
-                // create turn edges
-                createTurnEdges(newId(vers[prev]), newEnd, nDist, nTime, type, way->nID, true);
-                createTurnEdges(newEnd, newId(vers[curr]), nDist, nTime, type, way->nID, false);
+                // create and serialize edges
+                serializeEdge(ver2, ver1, dist, time, type, way->nID);
+                serializeEdge(ver1, ver2, dist, time, type, way->nID);
+                serializeGeometry(ver1, ver2, false, ids, geom);
             }
             dist = time = 0;
             prev = curr;
@@ -16,16 +16,6 @@
 #include <vector>
 #include <string>
 
-namespace std {
-    template<>
-    class hash<pair<Edge::EdgeId, Edge::EdgeKey> > {
-    public:
-        size_t operator()(const pair<Edge::EdgeId, Edge::EdgeKey> &k) const {
-            return std::hash<Edge::EdgeId>()(k.first) ^ std::hash<Edge::EdgeKey>()(k.second);
-        }
-    };
-}
-
 /**
  * @brief The RoutingPlugin class
  */
@@ -56,12 +46,7 @@ public:
     // translate vertex ids to 0 based and contuguous
     typedef google::sparse_hash_map<VertexId, VertexId, std::hash<VertexId>, EqIds> VertexIdTranslator;
     typedef google::sparse_hash_map<VertexId, Point, std::hash<VertexId>, EqIds> VertexPointMap;
-    typedef google::sparse_hash_map<std::pair<Edge::EdgeId, Edge::EdgeKey>, 
-                                    VertexPoint, 
-                                    std::hash<std::pair<Edge::EdgeId, Edge::EdgeKey> > > DummyEndPointMap;
     typedef google::sparse_hash_set<VertexId, std::hash<Vertex> > VertexSet;
-    typedef google::sparse_hash_map<VertexId, vector<EdgeBack>, std::hash<VertexId> > ToTurnRestriction;
-    typedef google::sparse_hash_map<VertexId, vector<EdgeForw>, std::hash<VertexId> > FromTurnRestriction;
 private:
     // file for storing vertex and edge info
     std::string outputFileName_;
@@ -86,8 +71,6 @@ private:
     std::string endPointsFileName_;
     // nodes that are endpoints of some ways
     VertexSet endPoints_;
-    // nodes that were created by splitting edges
-    DummyEndPointMap dummyEndPoints_;
     // kdtree for routing stores endpoints
     KdTreeSql kdTreeEndPt_;
     // validation
@@ -100,24 +83,15 @@ private:
     GeometryIndexSql indexGeometry_;
     // turn restrictions
     EndPointPlugin::TurnRestrictions turns_;
-    // edges leading to turn restriction
-    ToTurnRestriction edgesToTurn_;
-    // edge leading from turn restriction
-    FromTurnRestriction edgesFromTurn_;
-    // current free endpoint index and way id
-    VertexId freeVerId_, freeEdgeId_;
+    // current free way id
+    VertexId freeEdgeId_;
     // for serializing turn restrictions
     std::string turnRestrictionsName_;
     FILE *turnRestrictionsFile_;
     bool hasTurnRestrictions_;
 private:
-    bool isRestricted(const VertexId v1);
     bool isEndPoint(const Vertex &v) ;
     VertexId newId(VertexId id);
-    void createTurnEdges(VertexId v1, VertexId v2,
-                         DistType dist, DistType time,
-                         Edge::EdgeType type, Edge::EdgeId origId,
-                         bool first);
     void serializeEdge(VertexId ver1, VertexId ver2, DistType dist,
                        DistType time, EdgeType type, Edge::EdgeId origId,
                        VertexId via = Vertex::NullVertexId);
@@ -126,12 +100,10 @@ private:
                            vector<Point> &pts);
     void serializeVertices();
     void serializeTurnRestrictions();
-    void createTurnShortcuts();
 public:
     RoutingPlugin(const std::string& outputFile, EdgeFilter *edgFilter, bool compress = true);
     virtual ~RoutingPlugin();
     void setTurnRestrictions(const EndPointPlugin::TurnRestrictions &restrictions);
-    VertexId nextEndPoint();
     virtual void init();
     virtual void notifyNode(OSMNode*);
     virtual void notifyWay(OSMWay*);
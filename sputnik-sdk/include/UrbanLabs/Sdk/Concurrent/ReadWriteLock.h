@@ -29,9 +29,14 @@
 // }
 //
 // no further synchronization is necessary
+//
+// writers are preferred: once a writer waits, new readers wait until it is
+// done. A thread which already holds a read lock can take it again without
+// waiting, the writer couldn't get in before the outer lock is released
 
 #include <mutex>
 #include <atomic>
+#include <functional>
 #include <thread>
 #include <cassert>
 #include <condition_variable>
@@ -49,6 +54,9 @@ private:
     mutable std::mutex requestLock_;
     std::atomic<int> numRequests_;
     std::condition_variable hasNoRequests_;
+    // writers waiting or writing, guarded by requestLock_
+    int numWriters_;
+    std::condition_variable hasNoWriters_;
 
     std::function<void()> startRead_;
     std::function<void()> finishRead_;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+
+/**
+ * @brief The WorkStealingPool class
+ * threads kept for the lifetime of the pool, every thread has its own
+ * queue of tasks. A thread takes the newest task of its own queue and when
+ * it runs out takes the oldest task of another queue, so the threads don't
+ * contend for a single queue and long tasks don't leave threads idle.
+ * Thread local state, like the search spaces, stays with the threads and
+ * is reused by the following tasks
+ */
+class WorkStealingPool {
+public:
+    // the argument is the index of the thread running the task
+    typedef std::function<void (size_t)> Task;
+    static const size_t NullWorker;
+private:
+    /**
+     * @brief The Queue struct
+     */
+    struct Queue {
+        std::mutex lock_;
+        std::deque<Task> tasks_;
+    };
+
+    /**
+     * @brief The Latch struct
+     * counts the tasks of a parallel loop which are not done yet
+     */
+    struct Latch {
+        std::mutex lock_;
+        std::condition_variable done_;
+        size_t remaining_;
+    };
+private:
+    std::vector<std::unique_ptr<Queue> > queues_;
+    std::vector<std::thread> threads_;
+    // sleeping threads wait for queued tasks
+    std::mutex sleepLock_;
+    std::condition_variable wakeUp_;
+    std::atomic<size_t> numQueued_;
+    std::atomic<size_t> nextQueue_;
+    bool stop_;
+private:
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator = (const WorkStealingPool &) = delete;
+    size_t getCurrentWorker() const;
+    bool popTask(size_t worker, Task &task);
+    void run(size_t worker);
+public:
+    WorkStealingPool(size_t numThreads = 0);
+    ~WorkStealingPool();
+    size_t getNumThreads() const;
+    void submit(const Task &task);
+
+    /**
+     * calls func(i, worker) for i in [0, count) on the threads of the pool
+     * and returns when all calls are done. A thread of the pool calling it
+     * runs the tasks while it waits
+     * @brief parallelFor
+     * @param count
+     * @param func
+     */
+    template<typename Function>
+    void parallelFor(size_t count, Function func) {
+        if(count == 0)
+            return;
+
+        std::shared_ptr<Latch> latch = std::make_shared<Latch>();
+        latch->remaining_ = count;
+        for(size_t i = 0; i < count; i++) {
+            submit([latch, i, &func](size_t worker) {
+                func(i, worker);
+                std::lock_guard<std::mutex> lock(latch->lock_);
+                if(--latch->remaining_ == 0)
+                    latch->done_.notify_all();
+            });
+        }
+
+        size_t worker = getCurrentWorker();
+        Task task;
+        while(worker != NullWorker && popTask(worker, task)) {
+            task(worker);
+            task = Task();
+        }
+
+        std::unique_lock<std::mutex> lock(latch->lock_);
+        latch->done_.wait(lock, [&latch]() { return latch->remaining_ == 0; });
+    }
+};
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Edges.h>
+#include <UrbanLabs/Sdk/GraphCore/GraphFile.h>
+
+/**
+ * @brief The CompactAdjacency class
+ * read only adjacency of one direction. Edges of vertex v are stored in the
+ * range [offsets[v], offsets[v+1]) of the edge array. Via vertices and
+ * original way ids are only needed to unpack paths, they live in separate
+ * arrays parallel to the edge array. The arrays are either owned or point
+ * directly into a mapped graph file.
+ *
+ * The costs of the packed edges are the customized weights. The weights the
+ * edges had before customization, the middle vertices of the shortcuts found
+ * by customization and the indices of their two child edges are kept per
+ * metric
+ */
+class CompactAdjacency {
+public:
+    typedef Vertex::VertexId VertexId;
+    typedef CompactEdge::CompactVertexId CompactVertexId;
+    typedef uint64_t EdgeOffset;
+    typedef int32_t Weight;
+    typedef uint32_t EdgeIndex;
+    static const EdgeIndex NullEdgeIndex;
+
+    /**
+     * @brief The ShortcutEdges struct
+     * the shortcut from -> to through via is made of the edge from -> via,
+     * stored in the backward adjacency at via, and the edge via -> to,
+     * stored in the forward adjacency at via
+     */
+    struct ShortcutEdges {
+        EdgeIndex in_;
+        EdgeIndex out_;
+    };
+    static const ShortcutEdges NullShortcutEdges;
+
+    /**
+     * @brief The Sections struct
+     * graph file sections holding the arrays of one direction
+     */
+    struct Sections {
+        GraphFile::Section offsets_;
+        GraphFile::Section edges_;
+        GraphFile::Section via_;
+        GraphFile::Section origIds_;
+        GraphFile::Section input_[Edge::NUM_METRICS];
+        GraphFile::Section shortcutVia_[Edge::NUM_METRICS];
+        GraphFile::Section shortcutEdges_[Edge::NUM_METRICS];
+    };
+    static const Sections FORWARD_SECTIONS;
+    static const Sections BACKWARD_SECTIONS;
+
+    /**
+     * @brief The Weights struct
+     * copies of the arrays the weights of one metric are stored in. A copy
+     * is changed while searches read the arrays in use, then swapped in
+     */
+    struct Weights {
+        std::vector<CompactEdge> edges_;
+        std::vector<Weight> input_;
+        std::vector<CompactVertexId> shortcutVia_;
+        std::vector<ShortcutEdges> shortcutEdges_;
+
+        /**
+         * @brief setInputCost
+         * @param index
+         * @param cost
+         */
+        template<typename Metric>
+        void setInputCost(EdgeOffset index, typename Metric::Metric cost) {
+            input_[index] = cost;
+        }
+
+        /**
+         * @brief setShortcut
+         * @param index
+         * @param cost
+         * @param via
+         * @param in
+         * @param out
+         */
+        template<typename Metric>
+        void setShortcut(EdgeOffset index, typename Metric::Metric cost, VertexId via, EdgeOffset in, EdgeOffset out) {
+            edges_[index].setCost<Metric>(cost);
+            shortcutVia_[index] = CompactEdge::toCompactVertexId(via);
+            shortcutEdges_[index].in_ = EdgeIndex(in);
+            shortcutEdges_[index].out_ = EdgeIndex(out);
+        }
+    };
+private:
+    // owned storage, empty if the arrays are mapped
+    std::vector<EdgeOffset> offsetsData_;
+    std::vector<CompactEdge> edgesData_;
+    std::vector<CompactVertexId> viaData_;
+    std::vector<Edge::EdgeId> origIdsData_;
+    std::vector<Weight> inputData_[Edge::NUM_METRICS];
+    std::vector<CompactVertexId> shortcutViaData_[Edge::NUM_METRICS];
+    std::vector<ShortcutEdges> shortcutEdgesData_[Edge::NUM_METRICS];
+    // arrays in use
+    EdgeOffset *offsets_;
+    CompactEdge *edges_;
+    CompactVertexId *via_;
+    Edge::EdgeId *origIds_;
+    Weight *input_[Edge::NUM_METRICS];
+    CompactVertexId *shortcutVia_[Edge::NUM_METRICS];
+    ShortcutEdges *shortcutEdges_[Edge::NUM_METRICS];
+    size_t numVertices_;
+    size_t numEdges_;
+private:
+    CompactAdjacency(const CompactAdjacency &) = delete;
+    CompactAdjacency &operator = (const CompactAdjacency &) = delete;
+    void useOwnedData();
+public:
+    CompactAdjacency();
+    void clear();
+    bool isMapped() const;
+    void copyMappedData();
+    size_t getNumVertices() const;
+    size_t getNumEdges() const;
+    size_t getMemoryUsage() const;
+    bool map(const GraphFileReader &file, const Sections &sections);
+    bool write(GraphFileWriter &file, const Sections &sections) const;
+    bool checkShortcutEdges(const CompactAdjacency &in, const CompactAdjacency &out) const;
+
+    /**
+     * @brief begin
+     * @param id
+     * @return
+     */
+    CompactEdge *begin(VertexId id) const {
+        return edges_+offsets_[id];
+    }
+
+    /**
+     * @brief end
+     * @param id
+     * @return
+     */
+    CompactEdge *end(VertexId id) const {
+        return edges_+offsets_[id+1];
+    }
+
+    /**
+     * index of the first edge of the vertex in the edge array
+     * @brief offset
+     * @param id
+     * @return
+     */
+    EdgeOffset offset(VertexId id) const {
+        return offsets_[id];
+    }
+
+    /**
+     * index of the edge in the edge array
+     * @brief index
+     * @param edge
+     * @return
+     */
+    EdgeOffset index(const CompactEdge *edge) const {
+        return edge-edges_;
+    }
+
+    /**
+     * @brief getEdge
+     * @param index
+     * @return
+     */
+    CompactEdge *getEdge(EdgeOffset index) const {
+        return edges_+index;
+    }
+
+    /**
+     * @brief degree
+     * @param id
+     * @return
+     */
+    size_t degree(VertexId id) const {
+        return offsets_[id+1]-offsets_[id];
+    }
+
+    /**
+     * via vertex the edge had in the input graph
+     * @brief getVia
+     * @param edge
+     * @return
+     */
+    VertexId getVia(const CompactEdge *edge) const {
+        return CompactEdge::fromCompactVertexId(via_[edge-edges_]);
+    }
+
+    /**
+     * @brief getOrigId
+     * @param edge
+     * @return
+     */
+    Edge::EdgeId getOrigId(const CompactEdge *edge) const {
+        return origIds_[edge-edges_];
+    }
+
+    /**
+     * weight of the edge before customization
+     * @brief getInputCost
+     * @param edge
+     * @return
+     */
+    template<typename Metric>
+    typename Metric::Metric getInputCost(const CompactEdge *edge) const {
+        return input_[Metric::Index][edge-edges_];
+    }
+
+    /**
+     * @brief setInputCost
+     * @param edge
+     * @param cost
+     */
+    template<typename Metric>
+    void setInputCost(const CompactEdge *edge, typename Metric::Metric cost) {
+        assert(!isMapped());
+        input_[Metric::Index][edge-edges_] = cost;
+    }
+
+    /**
+     * middle vertex if the customized weight is the one of a path through
+     * a lower vertex, null otherwise
+     * @brief getShortcutVia
+     * @param edge
+     * @return
+     */
+    template<typename Metric>
+    VertexId getShortcutVia(const CompactEdge *edge) const {
+        return CompactEdge::fromCompactVertexId(shortcutVia_[Metric::Index][edge-edges_]);
+    }
+
+    /**
+     * indices of the child edges of a shortcut, in_ is null if the edge is
+     * not a shortcut
+     * @brief getShortcutEdges
+     * @param edge
+     * @return
+     */
+    template<typename Metric>
+    const ShortcutEdges &getShortcutEdges(const CompactEdge *edge) const {
+        return shortcutEdges_[Metric::Index][edge-edges_];
+    }
+
+    /**
+     * @brief setShortcut
+     * @param edge
+     * @param cost
+     * @param via
+     * @param in index of the edge into via in the backward adjacency
+     * @param out index of the edge out of via in the forward adjacency
+     */
+    template<typename Metric>
+    void setShortcut(CompactEdge *edge, typename Metric::Metric cost, VertexId via, EdgeOffset in, EdgeOffset out) {
+        EdgeOffset i = edge-edges_;
+        edge->setCost<Metric>(cost);
+        shortcutVia_[Metric::Index][i] = CompactEdge::toCompactVertexId(via);
+        shortcutEdges_[Metric::Index][i].in_ = EdgeIndex(in);
+        shortcutEdges_[Metric::Index][i].out_ = EdgeIndex(out);
+    }
+
+    /**
+     * copies the arrays holding the weights of the metric, the edges hold
+     * the weights of all metrics
+     * @brief copyWeights
+     * @param weights
+     */
+    template<typename Metric>
+    void copyWeights(Weights &weights) const {
+        weights.edges_.assign(edges_, edges_+numEdges_);
+        weights.input_.assign(input_[Metric::Index], input_[Metric::Index]+numEdges_);
+        weights.shortcutVia_.assign(shortcutVia_[Metric::Index], shortcutVia_[Metric::Index]+numEdges_);
+        weights.shortcutEdges_.assign(shortcutEdges_[Metric::Index], shortcutEdges_[Metric::Index]+numEdges_);
+    }
+
+    /**
+     * uses the copied arrays, weights gets the ones used before. The other
+     * arrays stay where they are, mapped or owned
+     * @brief swapWeights
+     * @param weights
+     */
+    template<typename Metric>
+    void swapWeights(Weights &weights) {
+        assert(weights.edges_.size() == numEdges_ && weights.input_.size() == numEdges_);
+        edgesData_.swap(weights.edges_);
+        inputData_[Metric::Index].swap(weights.input_);
+        shortcutViaData_[Metric::Index].swap(weights.shortcutVia_);
+        shortcutEdgesData_[Metric::Index].swap(weights.shortcutEdges_);
+        edges_ = edgesData_.data();
+        input_[Metric::Index] = inputData_[Metric::Index].data();
+        shortcutVia_[Metric::Index] = shortcutViaData_[Metric::Index].data();
+        shortcutEdges_[Metric::Index] = shortcutEdgesData_[Metric::Index].data();
+    }
+
+    /**
+     * restores the input weights of a metric and drops its shortcuts
+     * @brief resetCosts
+     */
+    template<typename Metric>
+    void resetCosts() {
+        assert(!isMapped());
+        for(size_t i = 0; i < numEdges_; i++) {
+            edges_[i].setCost<Metric>(input_[Metric::Index][i]);
+            shortcutVia_[Metric::Index][i] = CompactEdge::NullCompactVertexId;
+            shortcutEdges_[Metric::Index][i] = NullShortcutEdges;
+        }
+    }
+
+    /**
+     * moves adjacency lists into the compact arrays, the lists are released.
+     * The costs of the edges become the input weights
+     * @brief build
+     * @param adjacency
+     * @param numVertices
+     */
+    template<class E>
+    void build(std::vector<std::vector<E> > &adjacency, size_t numVertices) {
+        // targets and the child edges of shortcuts are stored in 32 bits
+        assert(numVertices < CompactEdge::NullCompactVertexId);
+
+        size_t numEdges = 0;
+        for(size_t i = 0; i < adjacency.size(); i++)
+            numEdges += adjacency[i].size();
+        assert(numEdges < NullEdgeIndex);
+
+        clear();
+        offsetsData_.reserve(numVertices+1);
+        edgesData_.reserve(numEdges);
+        viaData_.reserve(numEdges);
+        origIdsData_.reserve(numEdges);
+        for(size_t m = 0; m < Edge::NUM_METRICS; m++)
+            inputData_[m].reserve(numEdges);
+
+        offsetsData_.push_back(0);
+        for(VertexId id = 0; id < (VertexId)numVertices; id++) {
+            if(id < (VertexId)adjacency.size()) {
+                for(const E &edge : adjacency[id]) {
+                    edgesData_.push_back(CompactEdge(edge));
+                    viaData_.push_back(CompactEdge::toCompactVertexId(edge.getVia()));
+                    origIdsData_.push_back(edge.getOrigId());
+                    inputData_[Edge::DistanceMetric::Index].push_back(edge.template getCost<Edge::DistanceMetric>());
+                    inputData_[Edge::TimeMetric::Index].push_back(edge.template getCost<Edge::TimeMetric>());
+                }
+                std::vector<E>().swap(adjacency[id]);
+            }
+            offsetsData_.push_back(edgesData_.size());
+        }
+        for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+            shortcutViaData_[m].assign(numEdges, CompactEdge::NullCompactVertexId);
+            shortcutEdgesData_[m].assign(numEdges, NullShortcutEdges);
+        }
+        std::vector<std::vector<E> >().swap(adjacency);
+        useOwnedData();
+    }
+
+    /**
+     * moves the compact arrays back to adjacency lists, the edges get
+     * their input weights back
+     * @brief expand
+     * @param adjacency
+     */
+    template<class E>
+    void expand(std::vector<std::vector<E> > &adjacency) {
+        adjacency.clear();
+        adjacency.resize(numVertices_);
+        for(VertexId id = 0; id < (VertexId)numVertices_; id++) {
+            adjacency[id].reserve(degree(id));
+            for(const CompactEdge *edge = begin(id); edge != end(id); ++edge) {
+                adjacency[id].push_back(E(edge->getNext(), getInputCost<Edge::DistanceMetric>(edge),
+                                          getInputCost<Edge::TimeMetric>(edge), getVia(edge),
+                                          edge->getType(), getOrigId(edge)));
+            }
+        }
+        clear();
+    }
+
+    /**
+     * keeps only edges for which keep(source, edge) holds, compacts in place.
+     * The edges move, so the customization is dropped, the edges get their
+     * input weights back
+     * @brief prune
+     * @param keep
+     */
+    template<class Predicate>
+    void prune(Predicate keep) {
+        if(isMapped())
+            copyMappedData();
+
+        EdgeOffset curr = 0;
+        for(VertexId id = 0; id < (VertexId)numVertices_; id++) {
+            EdgeOffset begin = offsetsData_[id], end = offsetsData_[id+1];
+            offsetsData_[id] = curr;
+            for(EdgeOffset j = begin; j < end; j++) {
+                if(keep(id, edgesData_[j])) {
+                    edgesData_[curr] = edgesData_[j];
+                    viaData_[curr] = viaData_[j];
+                    origIdsData_[curr] = origIdsData_[j];
+                    for(size_t m = 0; m < Edge::NUM_METRICS; m++)
+                        inputData_[m][curr] = inputData_[m][j];
+                    curr++;
+                }
+            }
+        }
+        offsetsData_[numVertices_] = curr;
+
+        edgesData_.resize(curr);
+        edgesData_.shrink_to_fit();
+        viaData_.resize(curr);
+        viaData_.shrink_to_fit();
+        origIdsData_.resize(curr);
+        origIdsData_.shrink_to_fit();
+        for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+            inputData_[m].resize(curr);
+            inputData_[m].shrink_to_fit();
+            shortcutViaData_[m].resize(curr);
+            shortcutViaData_[m].shrink_to_fit();
+            shortcutEdgesData_[m].resize(curr);
+            shortcutEdgesData_[m].shrink_to_fit();
+        }
+        useOwnedData();
+        resetCosts<Edge::DistanceMetric>();
+        resetCosts<Edge::TimeMetric>();
+    }
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+
+/**
+ * @brief The DaryHeap class
+ * indexed heap where every node has Arity children. The children of a node
+ * are adjacent, so a level of the heap needs one cache line instead of
+ * several and the heap is half as deep as a binary one
+ */
+template<typename Key, typename Val, typename KeyPosMap = std::vector<unsigned>, unsigned Arity = 4>
+class DaryHeap {
+private:
+    /**
+     * @brief The HeapEl class
+     */
+    class HeapEl {
+    public:
+        Key key;
+        Val val;
+    };
+public:
+    // key -> position map
+    KeyPosMap keyPosMap_;
+private:
+    size_t heapSize_;
+    // the root is at position 0
+    std::vector<HeapEl> heap_;
+private:
+    /**
+     * moves the element up while it is smaller than its parent
+     * @brief siftUp
+     * @param pos
+     */
+    inline void siftUp(size_t pos) {
+        HeapEl el = heap_[pos];
+        while(pos > 0) {
+            size_t parent = (pos-1)/Arity;
+            if(heap_[parent].val <= el.val)
+                break;
+            heap_[pos] = heap_[parent];
+            keyPosMap_[heap_[pos].key] = pos;
+            pos = parent;
+        }
+        heap_[pos] = el;
+        keyPosMap_[el.key] = pos;
+    }
+
+    /**
+     * @brief findSmallestChild
+     * @param first the first child
+     * @return
+     */
+    inline size_t findSmallestChild(size_t first) const {
+        size_t smallest = first;
+        if(first+Arity <= heapSize_) {
+            // all children exist, the loop is unrolled
+            for(size_t child = first+1; child < first+Arity; child++) {
+                if(heap_[child].val < heap_[smallest].val)
+                    smallest = child;
+            }
+        } else {
+            for(size_t child = first+1; child < heapSize_; child++) {
+                if(heap_[child].val < heap_[smallest].val)
+                    smallest = child;
+            }
+        }
+        return smallest;
+    }
+
+    /**
+     * moves the hole at the root down to a leaf along the smallest children
+     * and fills it with the last element. The last element is large, so this
+     * needs fewer comparisons than moving it down from the root
+     * @brief popRoot
+     */
+    inline void popRoot() {
+        size_t pos = 0;
+        while(true) {
+            size_t first = pos*Arity+1;
+            if(first >= heapSize_)
+                break;
+
+            size_t smallest = findSmallestChild(first);
+            heap_[pos] = heap_[smallest];
+            keyPosMap_[heap_[pos].key] = pos;
+            pos = smallest;
+        }
+        if(pos != heapSize_) {
+            heap_[pos] = heap_[heapSize_];
+            siftUp(pos);
+        }
+    }
+public:
+    DaryHeap() : heapSize_(0) {;}
+
+    size_t size() const {
+        return heapSize_;
+    }
+
+    bool empty() const {
+        return heapSize_ == 0;
+    }
+
+    /**
+     * sets the size to 0
+     */
+    void setEmpty() {
+        heapSize_ = 0;
+    }
+
+    /**
+     * @brief topHeap
+     * @return
+     */
+    std::pair<Key, Val> topHeap() const {
+        return std::make_pair(heap_[0].key, heap_[0].val);
+    }
+
+    /**
+     * insert a new element into the heap
+     */
+    void pushHeap(const Key &key, const Val &val) {
+        if(heapSize_ == heap_.size())
+            heap_.resize(2*heapSize_+16);
+
+        heap_[heapSize_].key = key;
+        heap_[heapSize_].val = val;
+        siftUp(heapSize_++);
+    }
+
+    /**
+     * remove the top of the heap
+     */
+    void popHeap() {
+        if(--heapSize_ > 0)
+            popRoot();
+    }
+
+    /**
+     * decrease the value of an existing key in the heap
+     * @brief decreaseKey
+     * @param key
+     * @param val
+     */
+    void decreaseKey(const Key &key, const Val &val) {
+        size_t pos = keyPosMap_[key];
+        if(val < heap_[pos].val) {
+            heap_[pos].val = val;
+            siftUp(pos);
+        }
+    }
+};
+
+/**
+ * @brief The QuaternaryHeapPolicy struct
+ */
+struct QuaternaryHeapPolicy {
+    template<typename Key, typename Val, typename KeyPosMap>
+    using HeapType = DaryHeap<Key, Val, KeyPosMap, 4>;
+};
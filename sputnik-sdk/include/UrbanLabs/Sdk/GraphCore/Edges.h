@@ -18,15 +18,18 @@ public:
 public:
     static const EdgeId NullEdgeId;
 public:
-    // types of metrics used
+    // types of metrics used, the index selects per metric arrays
     class TimeMetric {
     public:
         typedef EdgeTime Metric;
+        enum { Index = 1 };
     };
     class DistanceMetric {
     public:
         typedef EdgeDist Metric;
+        enum { Index = 0 };
     };
+    enum { NUM_METRICS = 2 };
 public:
     /**
      * @brief The EdgeTypeEnum enum
@@ -197,6 +200,10 @@ public:
     }
 };
 
+// time cost is defined in the source file
+template<>
+Edge::TimeMetric::Metric Edge::getCost<Edge::TimeMetric>() const;
+
 // forward edges
 class EdgeForw : public Edge {
 public:
@@ -245,6 +252,127 @@ public:
     }
 };
 
+/**
+ * @brief The CompactEdge class
+ * packed edge used by the read only graph, holds only what is needed to
+ * relax the edge. Via vertices and original way ids are kept aside in
+ * arrays parallel to the edges, see CompactAdjacency
+ */
+class CompactEdge {
+public:
+    typedef uint32_t CompactVertexId;
+    typedef Edge::EdgeDist EdgeDist;
+    typedef Edge::EdgeTime EdgeTime;
+    typedef Edge::EdgeType EdgeType;
+    typedef Vertex::VertexId VertexId;
+    static const CompactVertexId NullCompactVertexId;
+protected:
+    CompactVertexId next_;
+    EdgeDist dist_;
+    EdgeTime time_;
+    EdgeType type_;
+    // explicit padding, edges are written to the graph file as raw bytes
+    unsigned char reserved_[3];
+public:
+    /**
+     * @brief CompactEdge
+     */
+    CompactEdge() : next_(NullCompactVertexId), dist_(0), time_(0), type_(0), reserved_() {
+        ;
+    }
+    /**
+     * @brief CompactEdge
+     * @param edge
+     */
+    explicit CompactEdge(const Edge &edge)
+        : next_(edge.getNextId()), dist_(edge.getCost<Edge::DistanceMetric>()),
+          time_(edge.getCost<Edge::TimeMetric>()), type_(edge.getType()), reserved_() {
+        ;
+    }
+
+    /**
+     * @brief getNext
+     * @return
+     */
+    Vertex getNext() const {
+        return Vertex(next_);
+    }
+
+    /**
+     * @brief getNextId
+     * @return
+     */
+    VertexId getNextId() const {
+        return next_;
+    }
+
+    /**
+     * @brief getType
+     * @return
+     */
+    EdgeType getType() const {
+        return type_;
+    }
+
+    /**
+     * @brief getCost
+     * @return
+     */
+    template<typename Metric = Edge::DistanceMetric>
+    typename Metric::Metric getCost() const {
+        return dist_;
+    }
+
+    /**
+     * @brief setCost
+     * @param cost
+     */
+    template<typename Metric = Edge::DistanceMetric>
+    void setCost(typename Metric::Metric cost) {
+        dist_ = cost;
+    }
+
+    /**
+     * @brief setTime
+     * @param time
+     */
+    void setTime(EdgeTime time) {
+        time_ = time;
+    }
+
+    /**
+     * @brief setDist
+     * @param dist
+     */
+    void setDist(EdgeDist dist) {
+        dist_ = dist;
+    }
+
+    /**
+     * @brief toCompactVertexId
+     * @param id
+     * @return
+     */
+    static CompactVertexId toCompactVertexId(VertexId id) {
+        return id == Vertex::NullVertexId ? NullCompactVertexId : (CompactVertexId)id;
+    }
+
+    /**
+     * @brief fromCompactVertexId
+     * @param id
+     * @return
+     */
+    static VertexId fromCompactVertexId(CompactVertexId id) {
+        return id == NullCompactVertexId ? Vertex::NullVertexId : (VertexId)id;
+    }
+};
+
+// time cost is defined in the source file
+template<>
+Edge::TimeMetric::Metric CompactEdge::getCost<Edge::TimeMetric>() const;
+template<>
+void CompactEdge::setCost<Edge::TimeMetric>(Edge::TimeMetric::Metric cost);
+
 namespace std {
     // specialize hashing function for edge keys
     template<>
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Point.h>
+#include <UrbanLabs/Sdk/GraphCore/Edges.h>
+#include <UrbanLabs/Sdk/GraphCore/Vertices.h>
+#include <UrbanLabs/Sdk/GraphCore/GraphFile.h>
+
+/**
+ * @brief The GeometryStore class
+ * in memory copy of the geometry index. The geometries are sorted by the
+ * keys of their edges and stored one after another, every point as the
+ * difference to the previous one in zigzag varints of fixed point
+ * coordinates. Finding a geometry is a binary search over the keys and a
+ * decode of a few bytes, the arrays are used directly from the mapped file
+ */
+class GeometryStore {
+public:
+    typedef Vertex::VertexId VertexId;
+    typedef uint64_t Offset;
+    // coordinates are stored as integers in units of 1/SCALE_FACTOR degrees
+    static const double SCALE_FACTOR;
+
+    /**
+     * @brief The Key struct
+     * the edge key of a geometry, see edgeKey and edgeKeyFixed
+     */
+    struct Key {
+        VertexId first_;
+        VertexId second_;
+
+        bool operator < (const Key &key) const {
+            return first_ < key.first_ || (first_ == key.first_ && second_ < key.second_);
+        }
+    };
+private:
+    // geometry i is in [offsets_[i], offsets_[i+1]) of the points, the
+    // arrays point to the stored vectors after building and into the file
+    // after loading
+    size_t numGeometries_;
+    const Key *keys_;
+    const Offset *offsets_;
+    const uint8_t *points_;
+    std::vector<Key> keyStore_;
+    std::vector<Offset> offsetStore_;
+    std::vector<uint8_t> pointStore_;
+    GraphFileReader file_;
+private:
+    GeometryStore(const GeometryStore &) = delete;
+    GeometryStore &operator = (const GeometryStore &) = delete;
+    void setStored();
+    void decode(size_t geometry, std::vector<Point> &points) const;
+public:
+    GeometryStore();
+    void clear();
+    bool empty() const;
+    size_t getNumGeometries() const;
+    bool add(VertexId id1, VertexId id2, const std::vector<Point> &points);
+    bool findGeometry(VertexId id1, VertexId id2, const Point &target, bool fixed, std::vector<Point> &geometry) const;
+    bool save(const std::string &path) const;
+    bool load(const std::string &path);
+};
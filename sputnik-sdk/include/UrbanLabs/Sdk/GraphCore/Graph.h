@@ -2,6 +2,9 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <utility>
+#include <thread>
 #include <unordered_set>
 #include <UrbanLabs/Sdk/Platform/Stdafx.h>
 #include <UrbanLabs/Sdk/GraphCore/Heap.h>
@@ -9,9 +12,10 @@
 #include <UrbanLabs/Sdk/Utils/Timer.h>
 #include <UrbanLabs/Sdk/Utils/Logger.h>
 #include <UrbanLabs/Sdk/Utils/FileSystemUtil.h>
+#include <UrbanLabs/Sdk/Concurrent/ReadWriteLock.h>
 
 //#define GRAPH_DEBUG
-template<class GraphModel>
+template<class GraphModel, class HeapPolicy = BinaryHeapPolicy>
 class BaseGraph {
 public:
     typedef typename GraphModel::EdgeType EdgeType;
@@ -23,7 +27,7 @@ public:
     typedef typename GraphModel::NearestPointResult NearestPointResult;
     typedef typename GraphModel::SearchResult SearchResult;
     typedef typename GraphModel::AlgorithmInit DijkstraInit;
-    typedef typename GraphModel::AlgorithmState DijkstraState;
+    typedef typename GraphModel::template BasicAlgorithmState<HeapPolicy> DijkstraState;
 protected:
     // object representing edges, vertices, geometry storage of the graph
     GraphModel *gModel_;
@@ -53,9 +57,9 @@ public:
      * parse the graph from file
      * @brief parseGraph
      * @param filename
-     * @param edgeFilter
+     * @param engine how the graph is searched, empty for the default of the model
      */
-    bool parseGraph(const std::string &filename) {
+    bool parseGraph(const std::string &filename, const std::string &engine = "") {
         // cleanup previous storage
         if(gModel_ == 0)
             gModel_ = new GraphModel();
@@ -63,7 +67,7 @@ public:
             gModel_->unload();
 
         // parse new data
-        if(!gModel_->parse(filename)) {
+        if(!gModel_->setEngine(engine) || !gModel_->parse(filename)) {
             gModel_->unload();
             return false;
         }
@@ -105,11 +109,12 @@ public:
      * @param prevMap
      * @return
      */
+    template<typename Metric=Edge::DistanceMetric>
     std::vector<VertexId> unrollPathBiDir(VertexId s, VertexId c, VertexId d,
                                      DijkstraState &stateB, DijkstraState &stateF) {
         // unroll before and after the common vertex
-        std::vector<VertexId> pathForw = stateF.unrollPath(s, c);
-        std::vector<VertexId> pathBack = stateB.unrollPath(d, c, true);
+        std::vector<VertexId> pathForw = stateF.template unrollPath<Metric>(s, c);
+        std::vector<VertexId> pathBack = stateB.template unrollPath<Metric>(d, c, true);
 
         // pop the common point and the end
         pathForw.pop_back();
@@ -130,18 +135,53 @@ public:
         // when both are endpoints the points have to have same id
         if(start.isEndPoint() && end.isEndPoint()) {
             return start.getSrc().getId() == end.getDst().getId();
+        } else if(start.isEndPoint()) {
+            // the endpoint has to be an end of the other edge
+            sameWay = start.getSrc().getId() == end.getSrc().getId() || start.getSrc().getId() == end.getDst().getId();
+        } else if(end.isEndPoint()) {
+            sameWay = end.getSrc().getId() == start.getSrc().getId() || end.getSrc().getId() == start.getDst().getId();
         } else {
-            if((start.getSrc().getId() == end.getSrc().getId() || start.isEndPoint()) &&
-               (start.getDst().getId() == end.getDst().getId() || end.isEndPoint())) {
+            if(start.getSrc().getId() == end.getSrc().getId() && start.getDst().getId() == end.getDst().getId()) {
                 sameWay = true;
-            } else if((start.getSrc().getId() == end.getDst().getId() || start.isEndPoint()) &&
-                      (start.getDst().getId() == end.getSrc().getId() || end.isEndPoint())) {
+            } else if(start.getSrc().getId() == end.getDst().getId() && start.getDst().getId() == end.getSrc().getId()) {
                 sameWay = true;
             }
         }
         return sameWay;
     }
 
+    /**
+     * @brief addLinePoint
+     * @param line
+     * @param pt appended unless it is the last point already
+     */
+    static void addLinePoint(std::vector<Point> &line, const Point &pt) {
+        if(line.empty() || !(line.back() == pt))
+            line.push_back(pt);
+    }
+
+    /**
+     * splits the geometry of an edge at the projection of the point on it
+     * @brief splitLine
+     * @param line
+     * @param pt
+     * @param toFirst from the projection back to the first point
+     * @param toLast from the projection to the last point
+     */
+    static void splitLine(const std::vector<Point> &line, const Point &pt,
+                          std::vector<Point> &toFirst, std::vector<Point> &toLast) {
+        Point projection;
+        double fraction = 0;
+        size_t index = closestSegment(pt, line, projection, fraction);
+
+        addLinePoint(toFirst, projection);
+        for(size_t i = index+1; i-- > 0;)
+            addLinePoint(toFirst, line[i]);
+        addLinePoint(toLast, projection);
+        for(size_t i = index+1; i < line.size(); i++)
+            addLinePoint(toLast, line[i]);
+    }
+
     /**
      * returns a vector of points on path given by vertex id's
      * @brief findMultiLinesFromPath
@@ -150,7 +190,6 @@ public:
      */
     void findMultiLinesFromPath(const NearestPointResult &start, const NearestPointResult &end,
                                 const std::vector<VertexId> &path, std::vector<std::vector<Point> > &multiLines) {
-
         // no path was found
         if(path.size() == 0) {
             return;
@@ -169,23 +208,23 @@ public:
                     else
                         gModel_->findGeometryForEdge(end.getSrc().getId(), end.getDst().getId(),
                                                      end.getTarget().getPoint(), segment);
-                    // find id of start and end in the segment
-                    int endIndex = closestPoint(end.getTarget().getPoint(), segment);
-                    int startIndex = closestPoint(start.getTarget().getPoint(), segment);
-
-                    int initSize = segment.size();
-                    if(endIndex < startIndex) {
-                        reverse(segment.begin(), segment.end());
-                        startIndex = initSize-startIndex-1;
-                        endIndex = initSize-endIndex-1;
+                    // the part of the geometry between the projections of the points
+                    Point startPoint, endPoint;
+                    double startFraction = 0, endFraction = 0;
+                    size_t startIndex = closestSegment(start.getTarget().getPoint(), segment, startPoint, startFraction);
+                    size_t endIndex = closestSegment(end.getTarget().getPoint(), segment, endPoint, endFraction);
+
+                    std::vector<Point> line;
+                    addLinePoint(line, startPoint);
+                    if(startIndex+startFraction <= endIndex+endFraction) {
+                        for(size_t i = startIndex+1; i <= endIndex; i++)
+                            addLinePoint(line, segment[i]);
+                    } else {
+                        for(size_t i = startIndex; i > endIndex; i--)
+                            addLinePoint(line, segment[i]);
                     }
-
-                    for(int i = 0; i < endIndex-startIndex+1; i++)
-                        segment[i] = segment[i+startIndex];
-
-                    for(int i = 0; i < initSize-endIndex+startIndex-1; i++)
-                        segment.pop_back();
-                    multiLines.push_back(segment);
+                    addLinePoint(line, endPoint);
+                    multiLines.push_back(line);
                 } else {
                     // if its the same vertex, out only one point to the geometry
                     multiLines.push_back({start.getTarget().getPoint()});
@@ -203,19 +242,16 @@ public:
             gModel_->findGeometryForEdge(start.getSrc().getId(), start.getDst().getId(),
                                         start.getTarget().getPoint(),startSegment);
 
-            //find id of target point in startSegment
-            int pointIndex = closestPoint(start.getTarget().getPoint(),startSegment);
+            std::vector<Point> toSrc, toDst;
+            splitLine(startSegment, start.getTarget().getPoint(), toSrc, toDst);
 
             //path begins from start edge
             if (path[0] == start.getSrc().getId()) {
                 //print all points from target to start
-                std::vector<Point> firstSegment(startSegment.begin(), startSegment.begin()+pointIndex+1);
-                reverse(firstSegment.begin(), firstSegment.end());
-                multiLines.push_back(firstSegment);
+                multiLines.push_back(toSrc);
             } else {
                 //print all points from target to end
-                std::vector<Point> firstSegment(startSegment.begin()+pointIndex, startSegment.end());
-                multiLines.push_back(firstSegment);
+                multiLines.push_back(toDst);
             }
         }
         // the middle segment
@@ -230,17 +266,16 @@ public:
             gModel_->findGeometryForEdge(end.getSrc().getId(), end.getDst().getId(),
                                         end.getTarget().getPoint(), endSegment);
 
-            //find id of target point in startSegment
-            int pointIndex = closestPoint(end.getTarget().getPoint(),endSegment);
+            std::vector<Point> toSrc, toDst;
+            splitLine(endSegment, end.getTarget().getPoint(), toSrc, toDst);
 
             //path ends on start point
             if (path[path.size()-1] == end.getSrc().getId()) {
-                std::vector<Point> lastSegment(endSegment.begin(), endSegment.begin()+pointIndex+1);
-                multiLines.push_back(lastSegment);
+                reverse(toSrc.begin(), toSrc.end());
+                multiLines.push_back(toSrc);
             } else if(path[path.size()-1] == end.getDst().getId()){
-                std::vector<Point> lastSegment(endSegment.begin()+pointIndex, endSegment.end());
-                reverse(lastSegment.begin(), lastSegment.end());
-                multiLines.push_back(lastSegment);
+                reverse(toDst.begin(), toDst.end());
+                multiLines.push_back(toDst);
             } else {
                 LOGG(Logger::ERROR) << "Something is wrong!" << Logger::FLUSH;
                 assert(false);
@@ -311,128 +346,12 @@ public:
     }
 };
 
-template<class GraphModel>
-class LocalGraph : public BaseGraph<GraphModel> {
-public:
-    typedef typename GraphModel::VertexType VertexType;
-    typedef typename VertexType::VertexId VertexId;
-    typedef typename GraphModel::EdgeType EdgeType;
-    typedef typename EdgeType::EdgeId EdgeId;
-    typedef typename GraphModel::DistType DistType;
-
-    typedef typename GraphModel::NearestPointResult NearestPointResult;
-    typedef typename GraphModel::SearchResultLocal SearchResultLocal;
-    typedef typename GraphModel::AlgorithmInitLocal DijkstraInit;
-    typedef typename GraphModel::AlgorithmState DijkstraState;
-public:
-    /**
-     * @brief LocalGraph
-     */
-    LocalGraph() : BaseGraph<GraphModel>() {;}
-
-    /**
-     * shortest path using local Dijkstra step used for constructing contraction hierarchies
-     * @brief shortestPathDijkstraLocal
-     * @param s
-     * @param d
-     * @param path
-     * @return
-     */
-    DistType shortestPathDijkstraLocal(DijkstraInit &initConfig, SearchResultLocal &result) const {
-#ifdef GRAPH_DEBUG
-        size_t vertices = 0;
-#endif
-        typedef typename GraphModel::AlgorithmStateLocal DijkstraStateLocal;
-
-        DijkstraStateLocal state(this->gModel_);
-        state.init(initConfig);
-
-        // the list of targets to be visited
-        std::unordered_set<VertexId> targetsToVisit(initConfig.targetVertices_.begin(),
-                                                    initConfig.targetVertices_.end());
-
-#ifdef GRAPH_DEBUG
-        DistType oldDistance = 0;
-#endif
-
-        size_t currSearchSpace = 0;
-        while(!state.isDone()) {
-#ifdef GRAPH_DEBUG
-            vertices++;
-#endif
-
-            // find the current closest vertex
-            auto currMin = state.getNextVertex();
-
-            // do not visit the ignored vertex
-            if(currMin.first == initConfig.ignoredVertex_) {
-                continue;
-            }
-
-            // check if the stopping distance is reached
-            if(currMin.second > initConfig.stopDistance_) {
-                break;
-            }
-
-            // limit the number of hops a path can have
-            if(state.numHops(currMin.first) > initConfig.hopNumber_) {
-                continue;
-            }
-
-            // check the search space size
-            if(currSearchSpace > initConfig.searchSpace_) {
-                break;
-            }
-
-            targetsToVisit.erase(currMin.first);
-            currSearchSpace++;
-
-            // finally if all the targets are reached
-            if(targetsToVisit.empty()){
-#ifdef GRAPH_DEBUG
-                LOGG(Logger::INFO) << "[DIJKSTRA NODE] " << currMin.first << Logger::FLUSH;
-                LOGG(Logger::INFO) << "[DIJKSTRA] path length " << currMin.second << Logger::FLUSH;
-                LOGG(Logger::INFO) << "[DIJKSTRA] vertices visited: " << vertices << Logger::FLUSH;
-                LOGG(Logger::INFO) << "[DIJKSTRA]: path" << Logger::FLUSH;
-#endif
-                // fill in the distances to targets in the init config
-                std::unordered_map<VertexId, DistType> targetDistances;
-                for(VertexId id : initConfig.targetVertices_) {
-                    targetDistances[id] = state.distTo(id);
-                }
-                result.setDistToTargets(targetDistances);
-                result.setSearchSpace(currSearchSpace);
-#ifdef GRAPH_DEBUG
-                printPath(result.getPath());
-#endif
-                return currMin.second;
-            }
-
-            // get the outgoing edges
-            auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
-            auto outGoingCur = this->gModel_->getOutgoingIterBegin(currMin.first);
-
-            size_t prevHops = state.numHops(currMin.first);
-            for(; outGoingCur != outGoingEnd; ++outGoingCur) {
-                if(!state.relaxEdge(currMin, prevHops, outGoingCur))
-                    break;
-            }
-        }
-
-        // fill in the distances anyway
-        std::unordered_map<VertexId, DistType> targetDistances;
-        for(VertexId id : initConfig.targetVertices_) {
-            targetDistances[id] = state.distTo(id);
-        }
-        result.setDistToTargets(targetDistances);
-        result.setSearchSpace(currSearchSpace);
-
-        return std::numeric_limits<DistType>::max();
-    }
-};
-
-template<class GraphModel>
-class Graph : public BaseGraph<GraphModel> {
+/**
+ * searches of a graph model, the heap policy chooses the priority queue
+ * of the models which support it
+ */
+template<class GraphModel, class HeapPolicy = BinaryHeapPolicy>
+class Graph : public BaseGraph<GraphModel, HeapPolicy> {
 public:
     typedef typename GraphModel::VertexType VertexType;
     typedef typename VertexType::VertexId VertexId;
@@ -443,24 +362,25 @@ public:
     typedef typename GraphModel::NearestPointResult NearestPointResult;
     typedef typename GraphModel::SearchResult SearchResult;
     typedef typename GraphModel::AlgorithmInit DijkstraInit;
-    typedef typename GraphModel::AlgorithmState DijkstraState;
+    typedef typename GraphModel::template BasicAlgorithmState<HeapPolicy> DijkstraState;
 public:
     // Object pool initializer and destuctor
     class Initializer {
     private:
         std::string filename_;
+        std::string engine_;
     public:
-        Initializer(const std::string &filename)
-            : filename_(filename) {;}
+        Initializer(const std::string &filename, const std::string &engine = "")
+            : filename_(filename), engine_(engine) {;}
 
-        bool init(Graph<GraphModel> &graph) const {
-            return graph.parseGraph(filename_);
+        bool init(Graph<GraphModel, HeapPolicy> &graph) const {
+            return graph.parseGraph(filename_, engine_);
         }
     };
 
     class Destructor {
     public:
-        static bool release(Graph<GraphModel> &graph) {
+        static bool release(Graph<GraphModel, HeapPolicy> &graph) {
             graph.unloadGraph();
             return true;
         }
@@ -469,7 +389,7 @@ public:
     /**
      * @brief Graph
      */
-    Graph() : BaseGraph<GraphModel>() {;}
+    Graph() : BaseGraph<GraphModel, HeapPolicy>() {;}
 
     /**
      * shortest path using Dijkstras algorithm
@@ -564,7 +484,7 @@ public:
 #ifdef GRAPH_DEBUG
         size_t vertices = 0;
 #endif
-        typedef typename GraphModel::AlgorithmStateAStar AStarState;
+        typedef typename GraphModel::template BasicAlgorithmStateAStar<HeapPolicy> AStarState;
 
         DijkstraInit initConfig;
         if(!this->gModel_->getInitConfig(src, dst, initConfig)) {
@@ -573,7 +493,7 @@ public:
         result = SearchResult(initConfig.getSrcSearchResult(), initConfig.getDstSearchResult());
 
         AStarState state(this->gModel_);
-        state.init(initConfig);
+        state.template init<Metric>(initConfig);
 
 #ifdef GRAPH_DEBUG
         DistType oldDistance = 0;
@@ -608,7 +528,7 @@ public:
                 result.setLength(currMin.second);
 
                 std::vector<Edge::EdgeId> wayIds;
-                if(this->findOrigWayIds(result.getPath(), wayIds)) {
+                if(this->findOrigWayIds(result, wayIds)) {
                     result.setOrigIds(wayIds);
                 } else {
                     LOGG(Logger::INFO) << "[ASTAR]: couldn't get all original way ids" << Logger::FLUSH;
@@ -623,12 +543,9 @@ public:
             auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
             auto outGoingCur = this->gModel_->getOutgoingIterBegin(currMin.first);
 
-            // point of the current min distance vertex
-            DistType heuristicOld = state.getHeuristic(currMin.first);
-
             // update the shortest distances
             for(; outGoingCur != outGoingEnd; ++outGoingCur) {
-                state.relaxEdge(currMin, heuristicOld, outGoingCur);
+                state.template relaxEdge<decltype(outGoingCur), Metric>(currMin, outGoingCur);
             }
         }
 
@@ -636,149 +553,110 @@ public:
     }
 
     /**
-     * shortest path using bidirectional A* algorithm
+     * shortest path using bidirectional A* algorithm. The keys of both
+     * searches are doubled distances plus the same bound with opposite signs,
+     * so the shortest path is found once the smallest keys add up to twice
+     * its length
      * @brief shortestPathBidirectionalAStar
      * @param s
      * @param d
      * @param path
      * @return
      */
+    template<typename Metric=Edge::DistanceMetric>
     DistType shortestPathBidirectionalAStar(const Point &src, const Point &dst, SearchResult &result) {
-        typedef typename GraphModel::AlgorithmStateAStar AStarState;
+        DijkstraInit initConfig;
+        if(!this->gModel_->getInitConfig(src, dst, initConfig))
+            return -1;
+        return shortestPathBidirectionalAStar<Metric>(initConfig, result);
+    }
+
+    /**
+     * shortest path using bidirectional A* algorithm between points which
+     * were already snapped to the graph
+     * @brief shortestPathBidirectionalAStar
+     * @param initConfig
+     * @param result
+     * @return
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    DistType shortestPathBidirectionalAStar(const DijkstraInit &initConfig, SearchResult &result) {
+        typedef typename GraphModel::template BasicAlgorithmStateAStar<HeapPolicy> AStarState;
 
         // time inner Dijkstra
         Timer timer;
 
-        DijkstraInit initConfig;
-        if(!this->gModel_->getInitConfig(src, dst))
-            return -1;
-
         result = SearchResult(initConfig.getSrcSearchResult(), initConfig.getDstSearchResult());
 
-        AStarState stateF(this->gModel_), stateB(this->gModel_);
-        stateF.init(initConfig);
+        AStarState stateF(this->gModel_), stateB(this->gModel_, true);
+        stateF.template init<Metric>(initConfig, true);
 
         DijkstraInit revConf = initConfig.reverseConfig();
-        stateB.init(revConf, true);
+        stateB.template init<Metric>(revConf, true);
 
         // a common meeting point
         VertexId commonVertex = VertexType::NullVertexId;
+        DistType shortestSoFar = std::numeric_limits<DistType>::max();
 
-        // last seen shortest paths
-        DistType lastSeenForward = std::numeric_limits<DistType>::max(),
-                lastSeenBackward = lastSeenForward, shortestSoFar = lastSeenBackward;
+        // updates the shortest path with the vertex if both searches have seen it
+        auto meet = [&](VertexId v) {
+            if(stateF.wasSeen(v) && stateB.wasSeen(v) && stateF.distTo(v)+stateB.distTo(v) < shortestSoFar) {
+                shortestSoFar = stateF.distTo(v)+stateB.distTo(v);
+                commonVertex = v;
+            }
+        };
 
-#ifdef GRAPH_DEBUG
-        LOGG(Logger::INFO) << "[BIDIJKSTRA] Bidirectional vertices: " << s << d << Logger::FLUSH;
-#endif
+        while(!stateF.isDone() && !stateB.isDone()) {
+            // stopping criterion
+            if(shortestSoFar != std::numeric_limits<DistType>::max() &&
+               (int64_t)stateF.getMinKey()+stateB.getMinKey() >= 2*(int64_t)shortestSoFar)
+                break;
 
-        bool forewardDone = false, backwardDone = false;
-        while(!forewardDone || !backwardDone) {
-            // forward Dijkstra step
-            if(!stateF.isDone()) {
-                // current point on the frontier
+            // expand the search with the smaller key
+            if(stateF.getMinKey() <= stateB.getMinKey()) {
                 auto currMin = stateF.getNextVertex();
-                lastSeenForward = currMin.second;
-
-                if(lastSeenForward <= shortestSoFar) {
-                    // check if vertex is seen from both ends
-                    if(stateB.wasSeen(currMin.first)) {
-                        DistType shortestCurrent = stateB.distTo(currMin.first)+currMin.second;
-                        if(shortestCurrent < shortestSoFar) {
-                            shortestSoFar = shortestCurrent;
-                            commonVertex = currMin.first;
-                        }
-                    }
+                meet(currMin.first);
 
-                    DistType heuristicOld = stateF.getHeuristic(currMin.first);
-
-                    // get the outgoing edges
-                    auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
-                    auto outGoingCur = this->gModel_->getOutgoingIterBegin(currMin.first);
-
-                    // update the shortest distances
-                    for(; outGoingCur != outGoingEnd; ++outGoingCur) {
-                        stateF.relaxEdge(currMin, dst, heuristicOld, outGoingCur);
-                    }
-                } else {
-                    forewardDone = true;
+                auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
+                auto outGoingCur = this->gModel_->getOutgoingIterBegin(currMin.first);
+                for(; outGoingCur != outGoingEnd; ++outGoingCur) {
+                    stateF.template relaxEdge<decltype(outGoingCur), Metric>(currMin, outGoingCur);
+                    meet(outGoingCur->getNextId());
                 }
             } else {
-                forewardDone = true;
-            }
-
-            // backward Dijkstra step
-            if(!stateB.isDone()) {
-                // current point on the frontier
                 auto currMin = stateB.getNextVertex();
-                lastSeenBackward = currMin.second;
-
-                if(lastSeenBackward <= shortestSoFar) {
-                    // check if vertex is seen from both ends
-                    if(stateF.wasSeen(currMin.first)) {
-                        DistType shortestCurrent = stateF.distTo(currMin.first)+currMin.second;
-                        if(shortestCurrent < shortestSoFar) {
-                            shortestSoFar = shortestCurrent;
-                            commonVertex = currMin.first;
-                        }
-                    }
-
-                    DistType heuristicOld = stateB.getHeuristic(currMin.first);
+                meet(currMin.first);
 
-                    // get the outgoing edges
-                    auto inComingEnd = this->gModel_->getIncomingIterEnd(currMin.first);
-                    auto inComingCur = this->gModel_->getIncomingIterBegin(currMin.first);
-
-                    // update the shortest distances
-                    for(; inComingCur != inComingEnd; ++inComingCur) {
-                        stateB.relaxEdge(currMin, src, heuristicOld, inComingCur);
-                    }
-                } else {
-                    backwardDone = true;
+                auto inComingEnd = this->gModel_->getIncomingIterEnd(currMin.first);
+                auto inComingCur = this->gModel_->getIncomingIterBegin(currMin.first);
+                for(; inComingCur != inComingEnd; ++inComingCur) {
+                    stateB.template relaxEdge<decltype(inComingCur), Metric>(currMin, inComingCur);
+                    meet(inComingCur->getNextId());
                 }
-            } else {
-                backwardDone = true;
             }
         }
 
-        // stopping criterion
-        if(shortestSoFar != std::numeric_limits<DistType>::max()) {
-#ifdef GRAPH_DEBUG
-            LOGG(Logger::INFO) << "[BIDIJKSTRA] common vertex: " << commonVertex.getId() << Logger::FLUSH;
-            LOGG(Logger::INFO) << "[BIDIJKSTRA] common vertices visited: " << vertices << Logger::FLUSH;
-            LOGG(Logger::INFO) << "[BIDIJKSTRA] shortest path: " << shortestSoFar << Logger::FLUSH;
-            LOGG(Logger::INFO) << "[BIDIJKSTRA PATH]: " << Logger::FLUSH;
-#endif
-            timer.stop();
-            LOGG(Logger::INFO) << "[INNER BIASTAR] " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        timer.stop();
+        LOGG(Logger::INFO) << "[INNER BIASTAR] " << timer.getElapsedTimeSec() << Logger::FLUSH;
 
-            VertexId start = stateF.getStartPoint(initConfig, commonVertex, true);
-            VertexId target = stateB.getStartPoint(revConf, commonVertex, true);
+        if(setDirectPath<Metric>(initConfig, shortestSoFar, result))
+            return result.getLength();
+        if(shortestSoFar == std::numeric_limits<DistType>::max())
+            return -1;
 
-            result.setPath(this->unrollPathBiDir(start, commonVertex, target, stateB, stateF));
-            result.setLength(shortestSoFar);
+        VertexId start = stateF.getStartPoint(initConfig, commonVertex);
+        VertexId target = stateB.getStartPoint(revConf, commonVertex);
 
-            std::vector<Edge::EdgeId> wayIds;
-            if(this->findOrigWayIds(result.getPath(), wayIds)) {
-                result.setOrigIds(wayIds);
-            } else {
-                LOGG(Logger::INFO) << "[BIASTAR]: couldn't get all original way ids" << Logger::FLUSH;
-            }
+        result.setPath(this->template unrollPathBiDir<Metric>(start, commonVertex, target, stateB, stateF));
+        result.setLength(shortestSoFar);
 
-#ifdef GRAPH_DEBUG
-            printPath(path);
-#endif
-            return shortestSoFar;
+        std::vector<Edge::EdgeId> wayIds;
+        if(this->findOrigWayIds(result, wayIds)) {
+            result.setOrigIds(wayIds);
         } else {
-#ifdef GRAPH_DEBUG
-            LOGG(Logger::INFO) << "[BIDIJKSTRA] path not found" << Logger::FLUSH;
-#endif
+            LOGG(Logger::INFO) << "[BIASTAR]: couldn't get all original way ids" << Logger::FLUSH;
         }
-
-        timer.stop();
-        LOGG(Logger::INFO) << "[INNER BIASTAR] " << timer.getElapsedTimeSec() << Logger::FLUSH;
-
-        return -1;
+        return shortestSoFar;
     }
 
 
@@ -792,19 +670,32 @@ public:
      */
     template<typename Metric=Edge::DistanceMetric>
     DistType shortestPathBidirectionalDijkstra(const Point &src, const Point &dst, SearchResult &result) {
-        // time inner Dijkstra
-        Timer timer;
-
         DijkstraInit initConfig;
         if(!this->gModel_->getInitConfig(src, dst, initConfig))
             return -1;
+        return shortestPathBidirectionalDijkstra<Metric>(initConfig, result);
+    }
+
+    /**
+     * shortest path using bidirectional Dijkstra algorithm between points
+     * which were already snapped to the graph
+     * @brief shortestPathBidirectionalDijkstra
+     * @param initConfig
+     * @param result
+     * @return
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    DistType shortestPathBidirectionalDijkstra(const DijkstraInit &initConfig, SearchResult &result) {
+        // time inner Dijkstra
+        Timer timer;
+
         result = SearchResult(initConfig.getSrcSearchResult(), initConfig.getDstSearchResult());
 
         DijkstraState stateF(this->gModel_), stateB(this->gModel_, true);
-        stateF.init(initConfig);
+        stateF.template init<Metric>(initConfig);
 
         DijkstraInit revConf = initConfig.reverseConfig();
-        stateB.init(revConf);
+        stateB.template init<Metric>(revConf);
 
         // a common meeting point
         VertexId commonVertex = VertexType::NullVertexId;
@@ -841,7 +732,7 @@ public:
 
                     // update the shortest distances
                     for(; outGoingCur != outGoingEnd; ++outGoingCur) {
-                        stateF.relaxEdge(currMin, outGoingCur);
+                        stateF.template relaxEdge<decltype(outGoingCur), Metric>(currMin, outGoingCur);
                     }
                 } else {
                     forewardDone = true;
@@ -872,7 +763,7 @@ public:
 
                     // update the shortest distances
                     for(; inComingCur != inComingEnd; ++inComingCur) {
-                        stateB.relaxEdge(currMin, inComingCur);
+                        stateB.template relaxEdge<decltype(inComingCur), Metric>(currMin, inComingCur);
                     }
                 } else {
                     backwardDone = true;
@@ -882,6 +773,9 @@ public:
             }
         }
 
+        if(setDirectPath<Metric>(initConfig, shortestSoFar, result))
+            return result.getLength();
+
         // stopping criterion
         if(shortestSoFar != std::numeric_limits<DistType>::max()) {
     #ifdef GRAPH_DEBUG
@@ -896,7 +790,7 @@ public:
             VertexId start = stateF.getStartPoint(initConfig, commonVertex);
             VertexId target = stateB.getStartPoint(revConf, commonVertex);
 
-            result.setPath(this->unrollPathBiDir(start, commonVertex, target, stateB, stateF));
+            result.setPath(this->template unrollPathBiDir<Metric>(start, commonVertex, target, stateB, stateF));
             result.setLength(shortestSoFar);
 
             std::vector<Edge::EdgeId> wayIds;
@@ -922,4 +816,673 @@ public:
 
         return -1;
     }
+
+    /**
+     * shortest path on the contraction hierarchy. Both searches only go up,
+     * a vertex is stalled if a higher vertex reaches it on a shorter path,
+     * and a search stops once its smallest distance is not shorter than the
+     * best path found. With parallel set both searches run to the end on
+     * their own threads and meet afterwards. Maps without a hierarchy are
+     * searched on the overlay if they have one, else by bidirectional Dijkstra
+     * @brief shortestPathCH
+     * @param src
+     * @param dst
+     * @param result
+     * @param parallel
+     * @return the length, -1 if there is no path
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    DistType shortestPathCH(const Point &src, const Point &dst, SearchResult &result, bool parallel = false) {
+        DijkstraInit initConfig;
+        if(!this->gModel_->getInitConfig(src, dst, initConfig))
+            return -1;
+        return shortestPathCH<Metric>(initConfig, result, parallel);
+    }
+
+    /**
+     * shortest path on the contraction hierarchy between points which were
+     * already snapped to the graph, see setInitConfig
+     * @brief shortestPathCH
+     * @param initConfig
+     * @param result
+     * @param parallel
+     * @return the length, -1 if there is no path
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    DistType shortestPathCH(const DijkstraInit &initConfig, SearchResult &result, bool parallel = false) {
+        if(!this->gModel_->hasHierarchy()) {
+            if(this->gModel_->hasOverlay())
+                return shortestPathOverlay<Metric>(initConfig, result);
+            return shortestPathBidirectionalDijkstra<Metric>(initConfig, result);
+        }
+
+        Timer timer;
+
+        result = SearchResult(initConfig.getSrcSearchResult(), initConfig.getDstSearchResult());
+
+        DijkstraInit revConf = initConfig.reverseConfig();
+        DijkstraState stateF(this->gModel_), stateB(this->gModel_, true);
+        stateF.template init<Metric>(initConfig);
+        stateB.template init<Metric>(revConf);
+
+        VertexId commonVertex = VertexType::NullVertexId;
+        DistType shortestSoFar = std::numeric_limits<DistType>::max();
+        size_t settled = 0;
+        if(parallel) {
+            std::vector<std::pair<VertexId, DistType> > settledF, settledB;
+            auto search = [this](DijkstraState &state, bool backward, std::vector<std::pair<VertexId, DistType> > &settled) {
+                std::pair<VertexId, DistType> currMin;
+                while(!state.isDone()) {
+                    if(settleVertexCH<Metric>(state, backward, currMin))
+                        settled.push_back(currMin);
+                }
+            };
+            std::thread backward(search, std::ref(stateB), true, std::ref(settledB));
+            search(stateF, false, settledF);
+            backward.join();
+
+            for(const std::pair<VertexId, DistType> &vertex : settledF) {
+                if(stateB.wasSeen(vertex.first) && vertex.second+stateB.distTo(vertex.first) < shortestSoFar) {
+                    shortestSoFar = vertex.second+stateB.distTo(vertex.first);
+                    commonVertex = vertex.first;
+                }
+            }
+            settled = settledF.size()+settledB.size();
+        } else {
+            bool forwardDone = false, backwardDone = false;
+            std::pair<VertexId, DistType> currMin;
+            while(true) {
+                forwardDone = forwardDone || stateF.isDone() || stateF.getMinKey() >= shortestSoFar;
+                backwardDone = backwardDone || stateB.isDone() || stateB.getMinKey() >= shortestSoFar;
+                if(forwardDone && backwardDone)
+                    break;
+
+                // the side with the smaller distance goes next
+                bool forward = backwardDone || (!forwardDone && stateF.getMinKey() <= stateB.getMinKey());
+                DijkstraState &state = forward ? stateF : stateB, &other = forward ? stateB : stateF;
+                if(!settleVertexCH<Metric>(state, !forward, currMin))
+                    continue;
+
+                settled++;
+                if(other.wasSeen(currMin.first) && currMin.second+other.distTo(currMin.first) < shortestSoFar) {
+                    shortestSoFar = currMin.second+other.distTo(currMin.first);
+                    commonVertex = currMin.first;
+                }
+            }
+        }
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[CH] settled " << settled << " vertices in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        if(setDirectPath<Metric>(initConfig, shortestSoFar, result))
+            return result.getLength();
+        if(shortestSoFar == std::numeric_limits<DistType>::max())
+            return -1;
+
+        VertexId start = stateF.getStartPoint(initConfig, commonVertex);
+        VertexId target = stateB.getStartPoint(revConf, commonVertex);
+        result.setPath(this->template unrollPathBiDir<Metric>(start, commonVertex, target, stateB, stateF));
+        result.setLength(shortestSoFar);
+
+        std::vector<Edge::EdgeId> wayIds;
+        if(this->findOrigWayIds(result, wayIds)) {
+            result.setOrigIds(wayIds);
+        } else {
+            LOGG(Logger::INFO) << "[CH]: couldn't get all original way ids" << Logger::FLUSH;
+        }
+        return shortestSoFar;
+    }
+
+    /**
+     * shortest path on the multi level overlay by bidirectional Dijkstra.
+     * The searches relax the edges in the cells of the ends of the query
+     * and the clique arcs of the highest levels elsewhere, see
+     * settleVertexOverlay. A search stops once the smallest distances of
+     * both add up to the best path found
+     * @brief shortestPathOverlay
+     * @param initConfig
+     * @param result
+     * @return the length, -1 if there is no path
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    DistType shortestPathOverlay(const DijkstraInit &initConfig, SearchResult &result) {
+        Timer timer;
+
+        result = SearchResult(initConfig.getSrcSearchResult(), initConfig.getDstSearchResult());
+
+        DijkstraInit revConf = initConfig.reverseConfig();
+        DijkstraState stateF(this->gModel_), stateB(this->gModel_, true);
+        stateF.template init<Metric>(initConfig);
+        stateB.template init<Metric>(revConf);
+
+        typename GraphModel::OverlayQuery query;
+        this->gModel_->initOverlayQuery(initConfig, query);
+
+        VertexId commonVertex = VertexType::NullVertexId;
+        DistType shortestSoFar = std::numeric_limits<DistType>::max();
+        size_t settled = 0;
+        std::pair<VertexId, DistType> currMin;
+        while(!stateF.isDone() && !stateB.isDone()) {
+            DistType minF = stateF.getMinKey(), minB = stateB.getMinKey();
+            if(shortestSoFar != std::numeric_limits<DistType>::max() && minF+minB >= shortestSoFar)
+                break;
+
+            // the side with the smaller distance goes next
+            bool forward = minF <= minB;
+            DijkstraState &state = forward ? stateF : stateB, &other = forward ? stateB : stateF;
+            settleVertexOverlay<Metric>(state, !forward, query, currMin);
+
+            settled++;
+            if(other.wasSeen(currMin.first) && currMin.second+other.distTo(currMin.first) < shortestSoFar) {
+                shortestSoFar = currMin.second+other.distTo(currMin.first);
+                commonVertex = currMin.first;
+            }
+        }
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[OVERLAY] settled " << settled << " vertices in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        if(setDirectPath<Metric>(initConfig, shortestSoFar, result))
+            return result.getLength();
+        if(shortestSoFar == std::numeric_limits<DistType>::max())
+            return -1;
+
+        // vertices of both search trees, they are joined by edges or clique arcs
+        VertexId start = stateF.getStartPoint(initConfig, commonVertex);
+        VertexId target = stateB.getStartPoint(revConf, commonVertex);
+        std::vector<VertexId> tree;
+        for(VertexId curr = commonVertex; curr != start; curr = stateF.getPrevVertex(curr))
+            tree.push_back(curr);
+        tree.push_back(start);
+        std::reverse(tree.begin(), tree.end());
+        size_t meeting = tree.size()-1;
+        for(VertexId curr = commonVertex; curr != target; ) {
+            curr = stateB.getPrevVertex(curr);
+            tree.push_back(curr);
+        }
+
+        std::vector<VertexId> path;
+        this->gModel_->template unpackOverlayPath<Metric>(query, tree, meeting, path);
+        result.setPath(path);
+        result.setLength(shortestSoFar);
+
+        std::vector<Edge::EdgeId> wayIds;
+        if(this->findOrigWayIds(result, wayIds)) {
+            result.setOrigIds(wayIds);
+        } else {
+            LOGG(Logger::INFO) << "[OVERLAY]: couldn't get all original way ids" << Logger::FLUSH;
+        }
+        return shortestSoFar;
+    }
+
+    /**
+     * lengths of the shortest paths from the point to all vertices. An upward
+     * search settles the vertices above the source, a linear sweep over the
+     * vertices in decreasing rank finds the rest (PHAST)
+     * @brief shortestPathsOneToAll
+     * @param src
+     * @param dist lengths indexed by the vertex id, -1 if unreachable
+     * @return false if the point couldn't be snapped to the graph
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    bool shortestPathsOneToAll(const Point &src, std::vector<DistType> &dist) {
+        Timer timer;
+
+        DijkstraInit initConfig;
+        if(!this->gModel_->getInitConfig(src, initConfig))
+            return false;
+
+        std::vector<std::pair<VertexId, DistType> > upward;
+        DijkstraState state(this->gModel_);
+        state.template init<Metric>(initConfig);
+        settleAll<Metric>(state, false, upward);
+        this->gModel_->template sweepDownward<Metric>(upward, dist);
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[ONE TO ALL] " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return true;
+    }
+
+    /**
+     * many to many shortest path lengths on the hierarchy. A backward search
+     * from every target leaves its distances in the buckets of the vertices
+     * it settles, the forward search from a source then only scans the buckets
+     * of the vertices it settles. The searches are not pruned, on the
+     * preprocessed graph they only go up in the hierarchy. Without a
+     * hierarchy the searches would settle every vertex, so each pair is
+     * searched on its own like shortestPathCH does
+     * @brief distanceMatrix
+     * @param sources
+     * @param targets
+     * @param matrix lengths indexed by the source and the target, -1 if
+     * there is no path
+     * @return false if some of the points couldn't be snapped to the graph
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    bool distanceMatrix(const std::vector<Point> &sources, const std::vector<Point> &targets,
+                        std::vector<std::vector<DistType> > &matrix) {
+        Timer timer;
+        matrix.assign(sources.size(), std::vector<DistType>(targets.size(), -1));
+        // all searches see the same weights
+        ReadWriteLock::ReadLock weightsLock(this->gModel_->getWeightsLock());
+
+        // points which can't be snapped keep -1
+        std::vector<bool> snappedSource(sources.size()), snappedTarget(targets.size());
+        std::vector<NearestPointResult> nearestSources(sources.size()), nearestTargets(targets.size());
+        for(size_t i = 0; i < sources.size(); i++)
+            snappedSource[i] = this->gModel_->findNearestPointKdTree(sources[i], nearestSources[i]);
+        for(size_t j = 0; j < targets.size(); j++)
+            snappedTarget[j] = this->gModel_->findNearestPointKdTree(targets[j], nearestTargets[j]);
+        bool snapped = std::count(snappedSource.begin(), snappedSource.end(), false) == 0 &&
+                       std::count(snappedTarget.begin(), snappedTarget.end(), false) == 0;
+
+        if(!this->gModel_->hasHierarchy()) {
+            for(size_t i = 0; i < sources.size(); i++) {
+                for(size_t j = 0; j < targets.size() && snappedSource[i]; j++) {
+                    if(!snappedTarget[j])
+                        continue;
+                    DijkstraInit initConfig;
+                    SearchResult result;
+                    this->gModel_->setInitConfig(nearestSources[i], nearestTargets[j], initConfig);
+                    matrix[i][j] = shortestPathCH<Metric>(initConfig, result);
+                }
+            }
+
+            timer.stop();
+            LOGG(Logger::INFO) << "[DISTANCE MATRIX] " << sources.size() << "x" << targets.size()
+                               << " by pairs " << timer.getElapsedTimeSec() << Logger::FLUSH;
+            return snapped;
+        }
+
+        // distance from the vertex to the target
+        struct BucketEntry {
+            VertexId vertex_;
+            size_t target_;
+            DistType dist_;
+            bool operator < (const BucketEntry &entry) const {
+                return vertex_ < entry.vertex_;
+            }
+        };
+
+        // backward searches
+        std::vector<BucketEntry> buckets;
+        for(size_t j = 0; j < targets.size(); j++) {
+            if(!snappedTarget[j])
+                continue;
+
+            DijkstraInit initConfig;
+            this->gModel_->setInitConfig(nearestTargets[j], nearestTargets[j], initConfig);
+            DijkstraInit revConf = initConfig.reverseConfig();
+            DijkstraState stateB(this->gModel_, true);
+            stateB.template init<Metric>(revConf);
+            while(!stateB.isDone()) {
+                auto currMin = stateB.getNextVertex();
+                buckets.push_back({currMin.first, j, currMin.second});
+
+                auto inComingEnd = this->gModel_->getIncomingIterEnd(currMin.first);
+                auto inComingCur = this->gModel_->getIncomingIterBegin(currMin.first);
+                for(; inComingCur != inComingEnd; ++inComingCur) {
+                    stateB.template relaxEdge<decltype(inComingCur), Metric>(currMin, inComingCur);
+                }
+            }
+        }
+        std::stable_sort(buckets.begin(), buckets.end());
+
+        // forward searches
+        for(size_t i = 0; i < sources.size(); i++) {
+            if(!snappedSource[i])
+                continue;
+
+            DijkstraInit initConfig;
+            this->gModel_->setInitConfig(nearestSources[i], nearestSources[i], initConfig);
+            std::vector<DistType> &row = matrix[i];
+            DijkstraState stateF(this->gModel_);
+            stateF.template init<Metric>(initConfig);
+            while(!stateF.isDone()) {
+                auto currMin = stateF.getNextVertex();
+
+                BucketEntry key = {currMin.first, 0, 0};
+                auto entry = std::lower_bound(buckets.begin(), buckets.end(), key);
+                for(; entry != buckets.end() && entry->vertex_ == currMin.first; ++entry) {
+                    DistType dist = currMin.second+entry->dist_;
+                    if(row[entry->target_] == -1 || dist < row[entry->target_])
+                        row[entry->target_] = dist;
+                }
+
+                auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
+                auto outGoingCur = this->gModel_->getOutgoingIterBegin(currMin.first);
+                for(; outGoingCur != outGoingEnd; ++outGoingCur) {
+                    stateF.template relaxEdge<decltype(outGoingCur), Metric>(currMin, outGoingCur);
+                }
+            }
+
+            // the searches only find the paths through the ends of the edge
+            // a source and a target lie on, see setDirectPath
+            for(size_t j = 0; j < targets.size(); j++) {
+                if(!snappedTarget[j])
+                    continue;
+                DijkstraInit pairConfig;
+                this->gModel_->setInitConfig(nearestSources[i], nearestTargets[j], pairConfig);
+                DistType direct = this->gModel_->template findDirectCost<Metric>(pairConfig);
+                if(direct != std::numeric_limits<DistType>::max() && (row[j] == -1 || direct < row[j]))
+                    row[j] = direct;
+            }
+        }
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[DISTANCE MATRIX] " << sources.size() << "x" << targets.size() << " "
+                           << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return snapped;
+    }
+
+    /**
+     * shortest path and up to maxAlternatives alternatives to it. Every
+     * vertex settled by both upward searches is the via vertex of a path
+     * through the two search trees, the via paths are tried from the shortest.
+     * A path is accepted if it is not much longer than the shortest one, has
+     * no loops, shares little with the paths accepted so far and is locally
+     * optimal: the part of it around the via vertex is a shortest path
+     * @brief shortestPathAlternatives
+     * @param src
+     * @param dst
+     * @param maxAlternatives
+     * @param results the shortest path followed by the alternatives
+     * @return length of the shortest path, -1 if there is no path
+     */
+    template<typename Metric=Edge::DistanceMetric>
+    DistType shortestPathAlternatives(const Point &src, const Point &dst, size_t maxAlternatives,
+                                      std::vector<SearchResult> &results) {
+        typedef typename Metric::Metric Cost;
+        typedef std::pair<VertexId, VertexId> Arc;
+        // bounds relative to the length of the shortest path
+        const double maxStretch = 1.25, maxSharing = 0.8, localOptimality = 0.25;
+        // via vertices tried at most, bounds the time spent on a query
+        const size_t maxCandidates = 64;
+
+        Timer timer;
+        results.clear();
+
+        DijkstraInit initConfig;
+        if(!this->gModel_->getInitConfig(src, dst, initConfig))
+            return -1;
+        DijkstraInit revConf = initConfig.reverseConfig();
+
+        std::vector<std::pair<VertexId, DistType> > settledF, settledB;
+        DijkstraState stateF(this->gModel_), stateB(this->gModel_, true);
+        stateF.template init<Metric>(initConfig);
+        stateB.template init<Metric>(revConf);
+        settleAll<Metric>(stateF, false, settledF);
+        settleAll<Metric>(stateB, true, settledB);
+
+        // lengths of the via paths
+        std::vector<std::pair<DistType, VertexId> > candidates;
+        for(const std::pair<VertexId, DistType> &settled : settledF) {
+            if(stateB.wasSeen(settled.first))
+                candidates.push_back({settled.second+stateB.distTo(settled.first), settled.first});
+        }
+        if(candidates.empty())
+            return -1;
+        std::sort(candidates.begin(), candidates.end());
+        DistType shortest = candidates[0].first;
+
+        // vertices of the search trees on the shortest path, sorted. The
+        // parts of a via path which lead to them in the trees are shared
+        // with the shortest path, so most candidates are rejected before
+        // they are unpacked
+        std::vector<VertexId> treeF, treeB;
+        for(VertexId v = candidates[0].second; v != VertexType::NullVertexId; v = stateF.getPrevVertex(v))
+            treeF.push_back(v);
+        for(VertexId v = candidates[0].second; v != VertexType::NullVertexId; v = stateB.getPrevVertex(v))
+            treeB.push_back(v);
+        std::sort(treeF.begin(), treeF.end());
+        std::sort(treeB.begin(), treeB.end());
+        auto sharedInTree = [](const DijkstraState &state, const std::vector<VertexId> &tree, VertexId v) {
+            for(; v != VertexType::NullVertexId; v = state.getPrevVertex(v)) {
+                if(std::binary_search(tree.begin(), tree.end(), v))
+                    return state.distTo(v);
+            }
+            return (DistType)0;
+        };
+
+        // arcs of the accepted paths, sorted
+        std::vector<Arc> accepted;
+        for(size_t i = 0, tried = 0; i < candidates.size() && tried < maxCandidates && results.size() <= maxAlternatives; i++) {
+            DistType length = candidates[i].first;
+            VertexId via = candidates[i].second;
+            if(length > maxStretch*shortest)
+                break;
+            if(i > 0 && sharedInTree(stateF, treeF, via)+sharedInTree(stateB, treeB, via) > maxSharing*shortest)
+                continue;
+            tried++;
+
+            VertexId start = stateF.getStartPoint(initConfig, via);
+            VertexId target = stateB.getStartPoint(revConf, via);
+            std::vector<VertexId> path = this->template unrollPathBiDir<Metric>(start, via, target, stateB, stateF);
+
+            // lengths of the path prefixes and the length shared with the accepted paths
+            bool valid = true;
+            DistType shared = 0;
+            std::vector<DistType> prefix(1, 0);
+            for(size_t j = 0; j+1 < path.size() && valid; j++) {
+                Cost cost = this->gModel_->template findArcCost<Metric>(path[j], path[j+1]);
+                valid = cost != std::numeric_limits<Cost>::max();
+                prefix.push_back(prefix.back()+cost);
+                if(std::binary_search(accepted.begin(), accepted.end(), Arc(path[j], path[j+1])))
+                    shared += cost;
+            }
+
+            if(!results.empty()) {
+                std::vector<VertexId> sorted(path);
+                std::sort(sorted.begin(), sorted.end());
+                if(!valid || std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+                    continue;
+                if(shared > maxSharing*shortest)
+                    continue;
+
+                // the via vertex is on a shortest path between the vertices
+                // half of the tested length before and after it
+                size_t viaPos = std::find(path.begin(), path.end(), this->gModel_->getOriginalVertex(via))-path.begin();
+                if(viaPos == path.size())
+                    continue;
+                size_t first = viaPos, last = viaPos;
+                DistType half = localOptimality*shortest/2;
+                while(first > 0 && prefix[viaPos]-prefix[first] < half)
+                    first--;
+                while(last+1 < path.size() && prefix[last]-prefix[viaPos] < half)
+                    last++;
+                DistType subpath = prefix[last]-prefix[first];
+                if(first < last && findVertexDistance<Metric>(path[first], path[last], subpath) < subpath)
+                    continue;
+            }
+
+            for(size_t j = 0; j+1 < path.size(); j++)
+                accepted.push_back(Arc(path[j], path[j+1]));
+            std::sort(accepted.begin(), accepted.end());
+
+            SearchResult result(initConfig.getSrcSearchResult(), initConfig.getDstSearchResult());
+            result.setPath(path);
+            result.setLength(length);
+            std::vector<Edge::EdgeId> wayIds;
+            if(this->findOrigWayIds(result, wayIds)) {
+                result.setOrigIds(wayIds);
+            }
+            results.push_back(result);
+        }
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[ALTERNATIVES] " << results.size()-1 << " alternatives in "
+                           << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return shortest;
+    }
+private:
+    /**
+     * the path along the edge both ends of the search lie on, the searches
+     * only find the paths through the ends of the edge
+     * @brief setDirectPath
+     * @param initConfig
+     * @param length of the path found by the search
+     * @param result
+     * @return true if the path along the edge is shorter
+     */
+    template<typename Metric>
+    bool setDirectPath(const DijkstraInit &initConfig, DistType length, SearchResult &result) {
+        DistType direct = this->gModel_->template findDirectCost<Metric>(initConfig);
+        if(direct >= length)
+            return false;
+
+        result = SearchResult(initConfig.getSrcSearchResult(), initConfig.getDstSearchResult());
+        result.setPath({initConfig.getSrcEdgeSrc()});
+        result.setLength(direct);
+        std::vector<Edge::EdgeId> wayIds;
+        if(this->findOrigWayIds(result, wayIds))
+            result.setOrigIds(wayIds);
+        return true;
+    }
+
+    /**
+     * runs the search until every reachable vertex is settled
+     * @brief settleAll
+     * @param state
+     * @param backward
+     * @param settled vertices in the order they were settled with their distances
+     * @param bound vertices this far or farther are not settled
+     */
+    template<typename Metric>
+    void settleAll(DijkstraState &state, bool backward, std::vector<std::pair<VertexId, DistType> > &settled,
+                   DistType bound = std::numeric_limits<DistType>::max()) {
+        while(!state.isDone()) {
+            auto currMin = state.getNextVertex();
+            if(currMin.second >= bound)
+                break;
+            settled.push_back(currMin);
+
+            if(backward) {
+                auto inComingEnd = this->gModel_->getIncomingIterEnd(currMin.first);
+                auto inComingCur = this->gModel_->getIncomingIterBegin(currMin.first);
+                for(; inComingCur != inComingEnd; ++inComingCur) {
+                    state.template relaxEdge<decltype(inComingCur), Metric>(currMin, inComingCur);
+                }
+            } else {
+                auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
+                auto outGoingCur = this->gModel_->getOutgoingIterBegin(currMin.first);
+                for(; outGoingCur != outGoingEnd; ++outGoingCur) {
+                    state.template relaxEdge<decltype(outGoingCur), Metric>(currMin, outGoingCur);
+                }
+            }
+        }
+    }
+
+    /**
+     * settles the next vertex of an upward search unless it is stalled: a
+     * higher vertex the search has seen reaches it on a shorter path, so its
+     * distance is not the shortest and the paths through it aren't either
+     * @brief settleVertexCH
+     * @param state
+     * @param backward
+     * @param currMin the vertex and its distance
+     * @return false if the vertex was stalled
+     */
+    template<typename Metric>
+    bool settleVertexCH(DijkstraState &state, bool backward, std::pair<VertexId, DistType> &currMin) {
+        currMin = state.getNextVertex();
+        if(!backward) {
+            auto inComingEnd = this->gModel_->getIncomingIterEnd(currMin.first);
+            for(auto in = this->gModel_->getIncomingIterBegin(currMin.first); in != inComingEnd; ++in) {
+                VertexId higher = in->getNext().getId();
+                if(state.wasSeen(higher) && in->template getCost<Metric>() < currMin.second-state.distTo(higher))
+                    return false;
+            }
+
+            auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
+            for(auto out = this->gModel_->getOutgoingIterBegin(currMin.first); out != outGoingEnd; ++out)
+                state.template relaxEdge<decltype(out), Metric>(currMin, out);
+        } else {
+            auto outGoingEnd = this->gModel_->getOutgoingIterEnd(currMin.first);
+            for(auto out = this->gModel_->getOutgoingIterBegin(currMin.first); out != outGoingEnd; ++out) {
+                VertexId higher = out->getNext().getId();
+                if(state.wasSeen(higher) && out->template getCost<Metric>() < currMin.second-state.distTo(higher))
+                    return false;
+            }
+
+            auto inComingEnd = this->gModel_->getIncomingIterEnd(currMin.first);
+            for(auto in = this->gModel_->getIncomingIterBegin(currMin.first); in != inComingEnd; ++in)
+                state.template relaxEdge<decltype(in), Metric>(currMin, in);
+        }
+        return true;
+    }
+
+    /**
+     * settles the next vertex of a search on the overlay. On the level the
+     * query searches the vertex on it relaxes the clique arcs of its cell
+     * and the edges leaving the cell, the backward search the ones entering
+     * it. On level 0 all edges are relaxed
+     * @brief settleVertexOverlay
+     * @param state
+     * @param backward
+     * @param query
+     * @param currMin the vertex and its distance
+     */
+    template<typename Metric, typename OverlayQuery>
+    void settleVertexOverlay(DijkstraState &state, bool backward, const OverlayQuery &query,
+                             std::pair<VertexId, DistType> &currMin) {
+        currMin = state.getNextVertex();
+        VertexId vert = currMin.first;
+
+        const auto &overlay = this->gModel_->getOverlay();
+        size_t level = overlay.getQueryLevel(vert, query);
+        if(level > 0) {
+            overlay.forEachCliqueArc(level, vert, backward, Metric::Index, [&](VertexId next, DistType cost) {
+                state.relaxVertex(currMin, next, cost);
+            });
+        }
+
+        if(!backward) {
+            auto outGoingEnd = this->gModel_->getOutgoingIterEnd(vert);
+            for(auto out = this->gModel_->getOutgoingIterBegin(vert); out != outGoingEnd; ++out) {
+                if(level == 0 || overlay.getCell(level, out->getNextId()) != overlay.getCell(level, vert))
+                    state.template relaxEdge<decltype(out), Metric>(currMin, out);
+            }
+        } else {
+            auto inComingEnd = this->gModel_->getIncomingIterEnd(vert);
+            for(auto in = this->gModel_->getIncomingIterBegin(vert); in != inComingEnd; ++in) {
+                if(level == 0 || overlay.getCell(level, in->getNextId()) != overlay.getCell(level, vert))
+                    state.template relaxEdge<decltype(in), Metric>(currMin, in);
+            }
+        }
+    }
+
+    /**
+     * length of the shortest path between two vertices, paths which are
+     * not shorter than the bound are not searched for
+     * @brief findVertexDistance
+     * @param s
+     * @param d
+     * @param bound
+     * @return the length, max if there is no path shorter than the bound
+     */
+    template<typename Metric>
+    DistType findVertexDistance(VertexId s, VertexId d, DistType bound) {
+        NearestPointResult src, dst;
+        src.setStartId(s);
+        src.setEndId(s);
+        dst.setStartId(d);
+        dst.setEndId(d);
+
+        DijkstraInit initConfig;
+        initConfig.setSearchResults(src, dst);
+        DijkstraInit revConf = initConfig.reverseConfig();
+
+        std::vector<std::pair<VertexId, DistType> > settledF, settledB;
+        DijkstraState stateF(this->gModel_), stateB(this->gModel_, true);
+        stateF.template init<Metric>(initConfig);
+        stateB.template init<Metric>(revConf);
+        settleAll<Metric>(stateF, false, settledF, bound);
+        settleAll<Metric>(stateB, true, settledB, bound);
+
+        // vertices seen but not settled by the backward search are farther than the bound
+        DistType best = std::numeric_limits<DistType>::max();
+        for(const std::pair<VertexId, DistType> &settled : settledF) {
+            if(stateB.wasSeen(settled.first))
+                best = std::min(best, settled.second+stateB.distTo(settled.first));
+        }
+        return best;
+    }
 };
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/Utils/MemoryMappedFile.h>
+
+/**
+ * @brief The GraphFile class
+ * binary container for the preprocessed graph. The file starts with a fixed
+ * size header followed by raw arrays (sections), every section starts at an
+ * offset aligned to 8 bytes so that it can be used directly from the mapping
+ */
+class GraphFile {
+public:
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 5;
+    static const size_t ALIGNMENT = 8;
+public:
+    enum Section {
+        // vertex coordinates
+        POINTS = 0,
+        // contraction hierarchy ranks
+        RANKS,
+        // forward adjacency, numVertices+1 offsets and the edges
+        FORW_OFFSETS,
+        FORW_EDGES,
+        // backward adjacency, numVertices+1 offsets and the edges
+        BACK_OFFSETS,
+        BACK_EDGES,
+        // via vertices and original way ids parallel to the edges
+        FORW_VIA,
+        FORW_ORIG_IDS,
+        BACK_VIA,
+        BACK_ORIG_IDS,
+        // edge weights before customization, one array per metric
+        FORW_DIST_INPUT,
+        FORW_TIME_INPUT,
+        BACK_DIST_INPUT,
+        BACK_TIME_INPUT,
+        // middle vertices of shortcuts found by customization, per metric
+        FORW_DIST_SHORTCUT_VIA,
+        FORW_TIME_SHORTCUT_VIA,
+        BACK_DIST_SHORTCUT_VIA,
+        BACK_TIME_SHORTCUT_VIA,
+        // child edges of the shortcuts, per metric
+        FORW_DIST_SHORTCUT_EDGES,
+        FORW_TIME_SHORTCUT_EDGES,
+        BACK_DIST_SHORTCUT_EDGES,
+        BACK_TIME_SHORTCUT_EDGES,
+        // original vertices of the copies added for turn restrictions
+        TURN_COPIES,
+        // landmarks and their distances to and from every vertex, per metric
+        LANDMARKS,
+        LANDMARK_DIST_FROM,
+        LANDMARK_DIST_TO,
+        LANDMARK_TIME_FROM,
+        LANDMARK_TIME_TO,
+        // ids the vertices had in the input before they were renumbered
+        INPUT_IDS,
+        // edge geometries, keys, offsets into the points and the points
+        GEOMETRY_KEYS,
+        GEOMETRY_OFFSETS,
+        GEOMETRY_POINTS,
+        // keep this last
+        NUM_SECTIONS = 32
+    };
+
+    /**
+     * @brief The Header struct
+     */
+    struct Header {
+        char magic_[8];
+        uint32_t version_;
+        uint32_t reserved_;
+        uint64_t numVertices_;
+        uint64_t offset_[NUM_SECTIONS];
+        uint64_t size_[NUM_SECTIONS];
+    };
+public:
+    static bool isGraphFile(const std::string &path);
+};
+
+/**
+ * @brief The GraphFileWriter class
+ */
+class GraphFileWriter {
+private:
+    std::ofstream oss_;
+    GraphFile::Header header_;
+public:
+    GraphFileWriter();
+    bool open(const std::string &path, uint64_t numVertices);
+    bool writeSection(GraphFile::Section section, const void *data, size_t size);
+    bool close();
+
+    /**
+     * @brief writeSection
+     * @param section
+     * @param data
+     * @return
+     */
+    template<typename T>
+    bool writeSection(GraphFile::Section section, const std::vector<T> &data) {
+        return writeSection(section, data.data(), data.size()*sizeof(T));
+    }
+};
+
+/**
+ * @brief The GraphFileReader class
+ */
+class GraphFileReader {
+private:
+    MemoryMappedFile file_;
+    const GraphFile::Header *header_;
+public:
+    GraphFileReader();
+    bool open(const std::string &path);
+    bool close();
+    bool isOpen() const;
+    uint64_t getNumVertices() const;
+    const char *getSection(GraphFile::Section section, size_t &size) const;
+
+    /**
+     * @brief getSection returns a pointer to the array stored in the section
+     * @param section
+     * @param count the number of elements in the array
+     * @return
+     */
+    template<typename T>
+    T *getSection(GraphFile::Section section, size_t &count) const {
+        size_t size = 0;
+        const char *data = getSection(section, size);
+        if(data == 0 || size % sizeof(T) != 0) {
+            count = 0;
+            return 0;
+        }
+        count = size/sizeof(T);
+        return reinterpret_cast<T *>(const_cast<char *>(data));
+    }
+};
@@ -572,3 +572,12 @@ size_t Heap<Key, Value>::maxElems_ = 0;
 template<typename Key, typename Value, typename KeyPosMap = vector<unsigned> >
 size_t Heap<Key, Value>::totalElements_ = 0;
 #endif
+
+/**
+ * heap policies choose the priority queue used by the searches
+ * @brief The BinaryHeapPolicy struct
+ */
+struct BinaryHeapPolicy {
+    template<typename Key, typename Val, typename KeyPosMap>
+    using HeapType = Heap<Key, Val, KeyPosMap>;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Point.h>
+
+/**
+ * @brief The Isochrone class
+ * outline of the points reachable from a center. The plane around the
+ * center is split into sectors of equal angle and the farthest point of
+ * every sector becomes a corner of the polygon. The polygon is star shaped
+ * around the center, so unlike the convex hull it follows the dents of the
+ * reachable area
+ */
+class Isochrone {
+private:
+    Point center_;
+    // number of sectors, the polygon has at most this many corners
+    size_t numSectors_;
+public:
+    Isochrone(const Point &center, size_t numSectors = 72);
+    void findPolygon(const std::vector<Point> &points, std::vector<Point> &polygon) const;
+};
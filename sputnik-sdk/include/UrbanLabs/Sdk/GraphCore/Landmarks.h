@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Edges.h>
+#include <UrbanLabs/Sdk/GraphCore/Vertices.h>
+#include <UrbanLabs/Sdk/GraphCore/GraphFile.h>
+
+/**
+ * @brief The Landmarks class
+ * distances between a few landmark vertices and every other vertex, used as
+ * lower bounds by A* (ALT). By the triangle inequality the distance from v
+ * to t is at least d(v, L)-d(t, L) and d(L, t)-d(L, v) for every landmark
+ * L. The landmarks are picked far from each other, so most targets lie
+ * behind one of them as seen from the vertices of a search
+ */
+class Landmarks {
+public:
+    typedef Vertex::VertexId VertexId;
+    typedef Edge::EdgeDist Dist;
+    typedef uint64_t EdgeOffset;
+    static const Dist Unreachable;
+
+    /**
+     * @brief The Arc struct
+     * arc of the input graph with its cost in every metric
+     */
+    struct Arc {
+        VertexId target_;
+        Dist cost_[Edge::NUM_METRICS];
+    };
+
+    /**
+     * @brief The Adjacency struct
+     * arcs of vertex v are in [offsets_[v], offsets_[v+1])
+     */
+    struct Adjacency {
+        std::vector<EdgeOffset> offsets_;
+        std::vector<Arc> arcs_;
+    };
+
+    /**
+     * @brief The Target class
+     * landmark distances of a set of vertices, a search reaching any of them
+     * is done. The bounds of a backward search are bounds of the distance
+     * from the set
+     */
+    class Target {
+        friend class Landmarks;
+    private:
+        size_t metric_;
+        bool backward_;
+        // per landmark the largest distance of the set towards the landmark
+        // and the smallest distance of the set away from it
+        std::vector<Dist> reach_;
+        std::vector<Dist> leave_;
+    };
+private:
+    size_t numVertices_;
+    std::vector<VertexId> landmarks_;
+    // distances from and to the landmarks per metric, the distances of a
+    // vertex are adjacent. They point to the stored vectors after the
+    // landmarks are computed and into the file after they are loaded
+    const Dist *from_[Edge::NUM_METRICS];
+    const Dist *to_[Edge::NUM_METRICS];
+    std::vector<Dist> fromStore_[Edge::NUM_METRICS];
+    std::vector<Dist> toStore_[Edge::NUM_METRICS];
+    GraphFileReader file_;
+private:
+    Landmarks(const Landmarks &) = delete;
+    Landmarks &operator = (const Landmarks &) = delete;
+    void search(const Adjacency &graph, VertexId source, size_t metric, std::vector<Dist> &dist) const;
+public:
+    Landmarks();
+    void clear();
+    bool empty() const;
+    size_t getNumLandmarks() const;
+    const std::vector<VertexId> &getLandmarks() const;
+    Dist getDistanceFrom(size_t landmark, VertexId v, size_t metric) const;
+    Dist getDistanceTo(size_t landmark, VertexId v, size_t metric) const;
+    void selectLandmarks(const Adjacency &forw, size_t numCandidates, size_t numLandmarks);
+    void computeDistances(size_t landmark, size_t metric, bool backward, const Adjacency &graph);
+    bool save(const std::string &path) const;
+    bool load(const std::string &path, size_t numVertices);
+
+    /**
+     * @brief initTarget
+     * @param vertices the set of vertices
+     * @param backward the bounds are bounds of the distance from the set
+     * @param target
+     */
+    template<typename Metric>
+    void initTarget(const std::vector<VertexId> &vertices, bool backward, Target &target) const {
+        size_t numLandmarks = landmarks_.size();
+        const Dist *reach = backward ? from_[Metric::Index] : to_[Metric::Index];
+        const Dist *leave = backward ? to_[Metric::Index] : from_[Metric::Index];
+
+        target.metric_ = Metric::Index;
+        target.backward_ = backward;
+        target.reach_.assign(numLandmarks, 0);
+        target.leave_.assign(numLandmarks, Unreachable);
+        for(VertexId v : vertices) {
+            for(size_t l = 0; l < numLandmarks; l++) {
+                Dist r = reach[v*numLandmarks+l], e = leave[v*numLandmarks+l];
+                if(r > target.reach_[l])
+                    target.reach_[l] = r;
+                if(e < target.leave_[l])
+                    target.leave_[l] = e;
+            }
+        }
+    }
+
+    /**
+     * lower bound of the distance from the vertex to the target, for
+     * backward targets of the distance from the target to the vertex
+     * @brief lowerBound
+     * @param v
+     * @param target
+     * @return the bound, Unreachable if the target can't be reached
+     */
+    inline Dist lowerBound(VertexId v, const Target &target) const {
+        size_t numLandmarks = landmarks_.size();
+        const Dist *reach = (target.backward_ ? from_[target.metric_] : to_[target.metric_])+v*numLandmarks;
+        const Dist *leave = (target.backward_ ? to_[target.metric_] : from_[target.metric_])+v*numLandmarks;
+
+        Dist bound = 0;
+        for(size_t l = 0; l < numLandmarks; l++) {
+            // the target reaches the landmark and the vertex doesn't,
+            // so the vertex doesn't reach the target
+            if(target.reach_[l] != Unreachable) {
+                if(reach[l] == Unreachable)
+                    return Unreachable;
+                if(reach[l]-target.reach_[l] > bound)
+                    bound = reach[l]-target.reach_[l];
+            }
+            if(target.leave_[l] != Unreachable && leave[l] != Unreachable && target.leave_[l]-leave[l] > bound)
+                bound = target.leave_[l]-leave[l];
+        }
+        return bound;
+    }
+};
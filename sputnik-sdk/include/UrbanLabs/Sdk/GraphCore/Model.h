@@ -1,10 +1,13 @@
 #pragma once
 
 #include <mutex>
+#include <queue>
 #include <stack>
+#include <atomic>
 #include <thread>
-#include <google/dense_hash_map>
-#include <google/dense_hash_set>
+#include <unordered_map>
+#include <unordered_set>
+#include <initializer_list>
 
 #include <UrbanLabs/Sdk/Platform/Stdafx.h>
 #include <UrbanLabs/Sdk/GraphCore/Edges.h>
@@ -13,10 +16,21 @@
 #include <UrbanLabs/Sdk/GraphCore/ModelInterface.h>
 #include <UrbanLabs/Sdk/GraphCore/SearchResult.h>
 #include <UrbanLabs/Sdk/GraphCore/Graph.h>
+#include <UrbanLabs/Sdk/GraphCore/GraphFile.h>
+#include <UrbanLabs/Sdk/GraphCore/CompactAdjacency.h>
+#include <UrbanLabs/Sdk/GraphCore/NestedDissection.h>
+#include <UrbanLabs/Sdk/GraphCore/Landmarks.h>
+#include <UrbanLabs/Sdk/GraphCore/MultiLevelOverlay.h>
+#include <UrbanLabs/Sdk/GraphCore/GeometryStore.h>
+#include <UrbanLabs/Sdk/GraphCore/SearchSpace.h>
 #include <UrbanLabs/Sdk/Storage/Storage.h>
 #include <UrbanLabs/Sdk/Storage/KdTreeSql.h>
+#include <UrbanLabs/Sdk/GraphCore/SnapIndex.h>
+#include <UrbanLabs/Sdk/GraphCore/SegmentIndex.h>
 #include <UrbanLabs/Sdk/Storage/SqlConsts.h>
+#include <UrbanLabs/Sdk/Concurrent/ReadWriteLock.h>
 #include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/Utils/MathUtils.h>
 
 //#define DEBUG_MODEL
 class AdjacencyList;
@@ -32,21 +46,23 @@ public:
     typedef Edge::EdgeDist DistType;
     typedef OsmGraphCore::NearestPointResult NearestPointResult;
     typedef OsmGraphCore::SearchResultBasic SearchResult;
-    typedef OsmGraphCore::SearchResultLocal SearchResultLocal;
     // iterator types for edges
-    typedef typename std::vector<EdgeForw>::iterator OutgoingEdgeIter;
-    typedef typename std::vector<EdgeBack>::iterator IncomingEdgeIter;
+    typedef CompactEdge* OutgoingEdgeIter;
+    typedef CompactEdge* IncomingEdgeIter;
+    typedef const CompactEdge* ConstOutgoingEdgeIter;
+    typedef const CompactEdge* ConstIncomingEdgeIter;
+    // iterator types for edges while the graph is modified
+    typedef EdgeForw* MutableOutgoingEdgeIter;
+    typedef EdgeBack* MutableIncomingEdgeIter;
+    // ends of a query on the overlay
+    typedef MultiLevelOverlay::Query OverlayQuery;
 public:
     typedef std::vector<Point> VertexPointVector;
-private:
-    typedef long long HeuristicVal;
 private:
     typedef std::vector<Vertex> VertexVector;
     typedef std::vector<std::vector<EdgeForw> > VertexEdgeForwVector;
     typedef std::vector<std::vector<EdgeBack> > VertexEdgeBackVector;
     typedef std::vector<VertexId> VertexRankMap;
-    typedef unordered_set<VertexId> UnrankedVertexSet;
-    typedef std::vector<unordered_map<VertexId, DistType> > WitnessMap;
     typedef std::vector<TurnRestriction> TurnRestrictions;
 public:
     class AlgorithmInit {
@@ -56,6 +72,9 @@ public:
         // types of edges
         Edge::EdgeType srcEdgeType_;
         Edge::EdgeType dstEdgeType_;
+        // copies of the destination vertices made for turn restrictions
+        // and the vertices they were copied from
+        std::vector<std::pair<VertexId, VertexId> > dstCopies_;
     public:
         AlgorithmInit() : srcResult_(), dstResult_(), srcEdgeType_(0), dstEdgeType_(0) {;}
 
@@ -65,6 +84,10 @@ public:
          * @return
          */
         bool isEndReached(VertexId v) const {
+            for(const std::pair<VertexId, VertexId> &copy : dstCopies_) {
+                if(copy.first == v)
+                    v = copy.second;
+            }
             if(!isDstEndPoint()) {
                 Edge::EdgeType type = getDstEdgeType();
                 if(type & Edge::ONE_WAY) {
@@ -122,10 +145,18 @@ public:
             return dstEdgeType_;
         }
 
+        /**
+         * @brief setDstCopies
+         * @param copies pairs of a copy and the destination vertex it was made from
+         */
+        void setDstCopies(const std::vector<std::pair<VertexId, VertexId> > &copies) {
+            dstCopies_ = copies;
+        }
+
         /**
          * returns reversed init config
          */
-        AlgorithmInit reverseConfig() {
+        AlgorithmInit reverseConfig() const {
             AlgorithmInit revConf;
             revConf.srcEdgeType_ = dstEdgeType_;
             revConf.dstEdgeType_ = srcEdgeType_;
@@ -186,154 +217,66 @@ public:
         }
     };
 
-    class AlgorithmInitLocal {
-    public:
-        // used by local dijkstra searches during preprocessing
-        Vertex src_, dst_;
-        size_t hopNumber_;
-        size_t searchSpace_;
-        DistType stopDistance_;
-        VertexId ignoredVertex_;
-        unordered_set<VertexId> targetVertices_;
-    public:
-        /**
-         * @brief AlgorithmInitLocal
-         */
-        AlgorithmInitLocal() : hopNumber_(0), searchSpace_(0), stopDistance_(0),
-            ignoredVertex_(VertexType::NullVertexId) {;}
-
-        /**
-         * @brief getSrc
-         * @return
-         */
-        Vertex getSrc() const {
-            return src_;
-        }
-
-        /**
-         * @brief getDst
-         * @return
-         */
-        Vertex getDst() const {
-            return dst_;
-        }
-
-        /**
-         * @brief setSrc
-         * @param vertex
-         */
-        void setSrc(const Vertex &vertex) {
-            src_ = vertex;
-        }
-
-        /**
-         * @brief setDst
-         * @param vertex
-         */
-        void setDst(const Vertex &vertex) {
-            dst_ = vertex;
-        }
-
-        /**
-         * stop once this distance is reached
-         */
-        void setStoppingDistance(DistType stopDist) {
-            stopDistance_ = stopDist;
-        }
-
-        /**
-         * do not visit the ignored vertex
-         */
-        void setIgnoredVertex(VertexId ignoredVertex) {
-            ignoredVertex_ = ignoredVertex;
-        }
-
-        /**
-         * @brief setSearchSpace
-         */
-        void setSearchSpace(size_t searchSpace) {
-            searchSpace_ = searchSpace;
-        }
-
-        /**
-         * @brief setHopNumber
-         * @param hops
-         */
-        void setHopNumber(size_t hops) {
-            hopNumber_ = hops;
-        }
-
-        /**
-         * @brief setTargetvertices
-         * @param targetVertices
-         */
-        void setTargetVertices(const unordered_set<VertexId> &targetVertices) {
-            targetVertices_ = targetVertices;
-        }
-    };
-
-    class AlgorithmState {
+    /**
+     * the state of one search. The distances and previous vertices are kept
+     * in a search space of the calling thread, which is borrowed for the
+     * lifetime of the state. The heap policy chooses the priority queue.
+     * The weights of the model can't change while a state is alive
+     */
+    template<typename HeapPolicy>
+    class BasicAlgorithmState {
     protected:
         AdjacencyList *gModel_;
+        ReadWriteLock::ReadLock weightsLock_;
     public:
-        typedef typename google::dense_hash_map<VertexId, size_t, hash<VertexId> > VertexPosMap;
-        typedef typename google::dense_hash_map<VertexId, DistType, hash<VertexId> > VertexDistanceMap;
-        typedef typename google::dense_hash_map<VertexId, VertexId, hash<VertexId> > VertexVertexMap;
-        typedef typename google::dense_hash_set<VertexId, hash<VertexId> > VisitedSet;
-    public:
-        // distance map
-        typedef VertexDistanceMap DistanceMap;
-        // previous vertex map for dijkstra
-        typedef VertexVertexMap PrevMap;
-        // used for caching heuristic values by A* or similar
-        typedef VertexDistanceMap HeuristicMap;
+        // per vertex state of a search
+        typedef SearchSpace<VertexId, DistType, HeapPolicy> SearchSpaceType;
         // heap type
-        typedef Heap<VertexId, DistType, VertexPosMap> HeapType;
+        typedef typename SearchSpaceType::HeapType HeapType;
     protected:
         bool rev_;
-        HeapType heap_;
-        PrevMap prevMap_;
-        VisitedSet visSet_;
-        DistanceMap oldDist_;
+        SearchSpaceType *space_;
+        HeapType &heap_;
+    private:
+        BasicAlgorithmState(const BasicAlgorithmState &) = delete;
+        BasicAlgorithmState &operator = (const BasicAlgorithmState &) = delete;
     public:
-        AlgorithmState(AdjacencyList *model, bool rev = false) : gModel_(model), rev_(rev) {;}
+        BasicAlgorithmState(AdjacencyList *model, bool rev = false)
+            : gModel_(model), weightsLock_(model->getWeightsLock()), rev_(rev),
+              space_(SearchSpaceType::acquire()), heap_(space_->getHeap()) {;}
 
-        template<typename T, typename K>
-        inline void initMap(T &map) {
-            map.set_empty_key((K)(-1));
-            map.set_deleted_key((K)(-2));
+        ~BasicAlgorithmState() {
+            SearchSpaceType::release(space_);
         }
 
-        inline void init(const AlgorithmInit &initConfig) {
-            initMap<VisitedSet, VertexId>(visSet_);
-            initMap<DistanceMap, VertexId>(oldDist_);
-            initMap<PrevMap, VertexId>(prevMap_);
+        /**
+         * starts the search at the point, a point inside of an edge starts
+         * it at the ends of the edge with the parts of the edge left to them
+         * @brief init
+         * @param initConfig
+         * @param bounds
+         */
+        template<typename Metric=Edge::DistanceMetric>
+        inline void init(const AlgorithmInit &initConfig, bool bounds = false) {
+            space_->reset(gModel_->getNumVertices(), bounds);
 
             Edge::EdgeType type = initConfig.getSrcEdgeType();
 
             // initialize the heap
-            heap_.initGoogle();
             if(initConfig.isSrcEndPoint()) {
-                heap_.pushHeap(initConfig.getSrcEdgeSrc(), 0);
-                oldDist_[initConfig.getSrcEdgeSrc()] = 0;
-                visSet_.insert(initConfig.getSrcEdgeSrc());
+                pushStart(initConfig.getSrcEdgeSrc(), 0);
             } else {
                 // src1 is the source of the edge and src2 is the target
+                VertexId src1 = initConfig.getSrcEdgeSrc(), src2 = initConfig.getSrcEdgeDst();
+                double offset = initConfig.getSrcSearchResult().getOffset();
+                double rest = offset < 0 ? offset : 1-offset;
                 if((type & Edge::ONE_WAY) == 0) {
-                    heap_.pushHeap(initConfig.getSrcEdgeSrc(), 1);
-                    heap_.pushHeap(initConfig.getSrcEdgeDst(), 1);
-
-                    oldDist_[initConfig.getSrcEdgeSrc()] = 1;
-                    oldDist_[initConfig.getSrcEdgeDst()] = 1;
-
-                    visSet_.insert(initConfig.getSrcEdgeSrc());
-                    visSet_.insert(initConfig.getSrcEdgeDst());
+                    pushStart(src1, partialCost<Metric>(src2, src1, offset, 1));
+                    pushStart(src2, partialCost<Metric>(src1, src2, rest, 1));
                 } else {
                     // in case of one way edge we can only traverse forward
                     // starting from the destination of the edge
-                    heap_.pushHeap(initConfig.getSrcEdgeDst(), 0);
-                    oldDist_[initConfig.getSrcEdgeDst()] = 0;
-                    visSet_.insert(initConfig.getSrcEdgeDst());
+                    pushStart(src2, partialCost<Metric>(src1, src2, rest, 0));
                 }
             }
         }
@@ -342,12 +285,26 @@ public:
             return heap_.empty();
         }
 
+        /**
+         * the smallest key of the heap, the distance of the next vertex
+         * unless the keys include bounds. Used by bidirectional searches
+         * @brief getMinKey
+         * @return
+         */
+        inline DistType getMinKey() const {
+            return heap_.topHeap().second;
+        }
+
         inline bool wasSeen(VertexId v) const {
-            return visSet_.find(v) != visSet_.end();
+            return space_->wasSeen(v);
         }
 
         inline DistType distTo(VertexId v) const {
-            return oldDist_.find(v)->second;
+            return space_->getDist(v);
+        }
+
+        inline VertexId getPrevVertex(VertexId v) const {
+            return space_->wasSeen(v) ? space_->getPrev(v) : Vertex::NullVertexId;
         }
 
         inline pair<VertexId, DistType> getNextVertex() {
@@ -364,276 +321,339 @@ public:
                 if(!state.isDstEndPoint() && d == Vertex::NullVertexId) {
                     Edge::EdgeType type = state.getDstEdgeType();
                     if(type & Edge::ONE_WAY)
-                        d = state.getDstEdgeSrc();
+                        d = findReachedEnd({state.getDstEdgeSrc()});
                     else
-                        d = prevMap_.find(state.getDstEdgeSrc()) != prevMap_.end() ? state.getDstEdgeSrc() : state.getDstEdgeDst();
-                    return unrollPrevMap(d, state, prevMap_);
+                        d = findReachedEnd({state.getDstEdgeSrc(), state.getDstEdgeDst()});
+                    return unrollPrevMap(d, state);
                 } else {
                     if(d == Vertex::NullVertexId) {
-                        d = state.getDstEdgeSrc();
+                        d = findReachedEnd({state.getDstEdgeSrc()});
                         assert(state.getDstEdgeSrc() == state.getDstEdgeDst());
                     }
-                    return unrollPrevMap(d, state, prevMap_);
+                    return unrollPrevMap(d, state);
                 }
+            } else if(rev_ && d != Vertex::NullVertexId) {
+                // the backward search may have started at a copy of the vertex
+                return unrollPrevMap(d, state);
             } else
                 return state.getSrcEdgeSrc();
         }
 
+        /**
+         * unrolls path found by dijkstra algorithm, shortcuts are expanded
+         * using the child edges found by customization of the metric
+         * @brief unrollPath
+         */
+        template<typename Metric=Edge::DistanceMetric>
         inline std::vector<VertexId> unrollPath(VertexId s, VertexId d, bool rev = false) {
-            return unrollPath(s, d, prevMap_, rev);
+            // vertices of the search tree in the direction of the edges,
+            // the backward search follows the edges from d to s
+            std::vector<VertexId> tree;
+            for(VertexId curr = d; curr != s; curr = space_->getPrev(curr))
+                tree.push_back(curr);
+            tree.push_back(s);
+            if(!rev) {
+                reverse(tree.begin(), tree.end());
+            }
+
+            std::vector<VertexId> path;
+            gModel_->template unpackPath<Metric>(tree, path);
+            return path;
         }
 
         template<typename EdgeIter, typename Metric=Edge::DistanceMetric>
         inline void relaxEdge(const pair<VertexId, DistType> &currMin, const EdgeIter &outGoingCur) {
-            VertexType currVert = outGoingCur->getNext();
+            relaxVertex(currMin, outGoingCur->getNextId(), outGoingCur->template getCost<Metric>());
+        }
 
+        /**
+         * relaxes an arc which is not an edge of the model, like the clique
+         * arcs of the overlay
+         * @brief relaxVertex
+         * @param currMin
+         * @param currVertId
+         * @param cost
+         */
+        inline void relaxVertex(const pair<VertexId, DistType> &currMin, VertexId currVertId, DistType cost) {
             // find out the new distance
-            DistType newDist = currMin.second+outGoingCur->template getCost<Metric>();
+            DistType newDist = currMin.second+cost;
 
             // if the vertex has not been visited yet
-            VertexId currVertId = currVert.getId();
-            if(!wasSeen(currVertId)) {
-                visSet_.insert(currVertId);
-                prevMap_[currVertId] = currMin.first;
-                oldDist_[currVertId] = newDist;
-
+            if(!space_->wasSeen(currVertId)) {
+                space_->visit(currVertId, newDist, currMin.first);
                 heap_.pushHeap(currVertId, newDist);
             }
             // if the vertex has been visited before
             else {
-                if(oldDist_[currVertId] > newDist) {
-                    prevMap_[currVertId] = currMin.first;
-                    oldDist_[currVertId] = newDist;
+                if(space_->getDist(currVertId) > newDist) {
+                    space_->visit(currVertId, newDist, currMin.first);
                     heap_.decreaseKey(currVertId, newDist);
                 }
             }
         }
     protected:
+        /**
+         * cost of the part of the edge which is followed from the vertex
+         * from to the vertex to, the backward search follows the edge from
+         * to to from
+         * @brief partialCost
+         * @param from
+         * @param to
+         * @param part relative to the whole edge, negative if it isn't known
+         * @param unknown cost of a part which isn't known
+         * @return
+         */
+        template<typename Metric>
+        inline DistType partialCost(VertexId from, VertexId to, double part, DistType unknown) const {
+            typedef typename Metric::Metric Cost;
+            if(part < 0)
+                return unknown;
+            Cost cost = rev_ ? gModel_->template findArcCost<Metric>(to, from) : gModel_->template findArcCost<Metric>(from, to);
+            if(cost == std::numeric_limits<Cost>::max())
+                return unknown;
+            return DistType(llround(part*cost));
+        }
+
+        /**
+         * pushes a vertex the search starts from. Arriving at a copy made for
+         * turn restrictions is arriving at the vertex, so the backward search
+         * starts from the copies as well
+         * @brief pushStart
+         * @param id
+         * @param dist
+         */
+        inline void pushStart(VertexId id, DistType dist) {
+            // the start may be pushed twice if the search starts at a vertex
+            if(space_->wasSeen(id))
+                return;
+            heap_.pushHeap(id, dist);
+            space_->visit(id, dist, Vertex::NullVertexId);
+
+            if(rev_) {
+                std::pair<VertexId, VertexId> copies = gModel_->getTurnCopies(id);
+                for(VertexId copy = copies.first; copy < copies.second; copy++) {
+                    heap_.pushHeap(copy, dist);
+                    space_->visit(copy, dist, Vertex::NullVertexId);
+                }
+            }
+        }
+
+        /**
+         * the end vertex or the copy of it which was reached first
+         * @brief findReachedEnd
+         * @param ends
+         * @return
+         */
+        inline VertexId findReachedEnd(std::initializer_list<VertexId> ends) const {
+            VertexId reached = *ends.begin();
+            DistType reachedDist = std::numeric_limits<DistType>::max();
+            auto check = [&](VertexId id) {
+                if(space_->wasSeen(id) && space_->getDist(id) < reachedDist) {
+                    reached = id;
+                    reachedDist = space_->getDist(id);
+                }
+            };
+
+            for(VertexId end : ends) {
+                check(end);
+                std::pair<VertexId, VertexId> copies = gModel_->getTurnCopies(end);
+                for(VertexId copy = copies.first; copy < copies.second; copy++)
+                    check(copy);
+            }
+            return reached;
+        }
+
         /**
          * @brief getStartingPoint
          * @param dest
-         * @param prevMap
          * @return
          */
-        inline VertexId unrollPrevMap(const VertexId dest, const AlgorithmInit &state, const PrevMap &prevMap) const {
+        inline VertexId unrollPrevMap(const VertexId dest, const AlgorithmInit &state) const {
             VertexId curr = dest, src1 = state.getSrcEdgeSrc(), src2 = state.getSrcEdgeDst();
             Edge::EdgeType type = state.getSrcEdgeType();
             bool isOneWay = type & Edge::ONE_WAY;
 
+            // the search may have started at copies of the source vertices
             if(isOneWay) {
                 // if the source edge is one way we can only go through the destination of the edge
-                while(curr != src2) {
-                    curr = prevMap.find(curr)->second;
+                while(gModel_->getOriginalVertex(curr) != src2) {
+                    curr = space_->getPrev(curr);
                 }
             } else {
-                while(curr != src1 && curr != src2) {
-                    curr = prevMap.find(curr)->second;
+                while(gModel_->getOriginalVertex(curr) != src1 && gModel_->getOriginalVertex(curr) != src2) {
+                    curr = space_->getPrev(curr);
                 }
             }
 
             return curr;
         }
-
-        /**
-         * unrolls path found by dijkstra algorithm
-         * @brief unrollPath
-         */
-        template<class NextVertexMap>
-        inline std::vector<VertexId> unrollPath(VertexId s, VertexId d, NextVertexMap &nextVertex, bool rev = false) {
-            std::vector<VertexId> path;
-            for(VertexId curr = d; curr != s; ) {
-                std::stack<pair<VertexId, VertexId> > unrollEdges;
-                if(rev) {
-                    unrollEdges.push({curr, nextVertex[curr]});
-                } else {
-                    unrollEdges.push({nextVertex[curr], curr});
-                }
-
-                while(!unrollEdges.empty()) {
-                    pair<VertexId, VertexId> currEdg = unrollEdges.top();
-                    unrollEdges.pop();
-
-                    // determine edge type and the via vertex
-                    Edge::EdgeType type = 0;
-                    VertexId via = Vertex::NullVertexId;
-                    {
-                        EdgeForw *edgeForw = gModel_->findEdgeForw(currEdg.first, currEdg.second);
-                        if(edgeForw == 0) {
-                            EdgeBack *edgeBack = gModel_->findEdgeBack(currEdg.first, currEdg.second);
-                            type = edgeBack->getType();
-                            via = edgeBack->getVia();
-                        } else {
-                            type = edgeForw->getType();
-                            via = edgeForw->getVia();
-                        }
-                    }
-
-                    // final edges might be created by turn restrictions
-                    // we should not expand them further
-                    if(via == VertexType::NullVertexId || (type & Edge::FINAL)) {
-                        if(rev)
-                            path.push_back(currEdg.first);
-                        else
-                            path.push_back(currEdg.second);
-                    }
-                    else {
-                        if(rev) {
-                            unrollEdges.push({via, currEdg.second});
-                            unrollEdges.push({currEdg.first, via});
-                        } else {
-                            unrollEdges.push({currEdg.first, via});
-                            unrollEdges.push({via, currEdg.second});
-                        }
-                    }
-                }
-
-                curr = nextVertex[curr];
-            }
-
-            path.push_back(s);
-            if(!rev) {
-                reverse(path.begin(), path.end());
-            }
-
-            return path;
-        }
     };
 
-    class AlgorithmStateLocal : public AlgorithmState {
+    /**
+     * A* keys the heap by the distance plus a lower bound of the distance
+     * left. The bounds come from the landmarks if the map has them, else
+     * from the straight line distance, which only bounds the distance metric.
+     * Bidirectional searches use the difference of the bounds towards both
+     * ends so that the keys of both searches agree, the keys are doubled
+     * to keep them integral
+     */
+    template<typename HeapPolicy>
+    class BasicAlgorithmStateAStar : public BasicAlgorithmState<HeapPolicy> {
+    protected:
+        typedef BasicAlgorithmState<HeapPolicy> Base;
+        using Base::gModel_;
+        using Base::rev_;
+        using Base::space_;
+        using Base::heap_;
     public:
-        typedef google::dense_hash_map<Vertex::VertexId, size_t, hash<Vertex::VertexId> > HeapKeyPosMap;
-        typedef google::dense_hash_map<VertexId, size_t, hash<VertexId> > HopsMap;
+        using Base::wasSeen;
+        using Base::distTo;
     private:
-        HopsMap hopsMap_;
+        // bounds towards the end of the search and from its start
+        Landmarks::Target end_, start_;
+        std::vector<Point> endPoints_, startPoints_;
+        bool bidirectional_;
+        // the straight line distance is a bound of the metric
+        bool geometric_;
     public:
-        AlgorithmStateLocal(AdjacencyList *model) : AlgorithmState(model) {;}
-
-        void init(const AlgorithmInitLocal &state) {
-            Vertex s = state.getSrc();
-            initMap<HopsMap, VertexId>(hopsMap_);
-            hopsMap_[s.getId()] = 0;
-            // initialize the heap
-            heap_.initGoogle();
-            heap_.pushHeap(s.getId(), 0);
-
-            // initialize distance
-            initMap<DistanceMap, VertexId>(oldDist_);
-            oldDist_[s.getId()] = 0;
-
-            // initializ visited map
-            initMap<VisitedSet, VertexId>(visSet_);
-            visSet_.insert(s.getId());
-        }
-
-        size_t numHops(VertexId v) {
-            return hopsMap_[v];
+        BasicAlgorithmStateAStar(AdjacencyList *model, bool rev = false)
+            : Base(model, rev), bidirectional_(false), geometric_(false) {;}
+
+        template<typename Metric=Edge::DistanceMetric>
+        void init(const AlgorithmInit &initConfig, bool bidirectional = false) {
+            bidirectional_ = bidirectional;
+            geometric_ = size_t(Metric::Index) == size_t(Edge::DistanceMetric::Index);
+
+            // the ends are reached at the copies of their vertices as well, the
+            // sets have to be the same for both searches to keep the keys in step
+            std::vector<VertexId> end, start = {initConfig.getSrcEdgeSrc(), initConfig.getSrcEdgeDst()};
+            end.push_back(initConfig.getDstEdgeSrc());
+            if(!initConfig.isDstEndPoint())
+                end.push_back(initConfig.getDstEdgeDst());
+            addTurnCopies(end);
+            addTurnCopies(start);
+
+            const Landmarks &landmarks = gModel_->getLandmarks();
+            if(!landmarks.empty()) {
+                landmarks.template initTarget<Metric>(end, rev_, end_);
+                landmarks.template initTarget<Metric>(start, !rev_, start_);
+            }
+            endPoints_.clear();
+            startPoints_.clear();
+            for(VertexId v : end)
+                endPoints_.push_back(gModel_->getPoint(v));
+            for(VertexId v : start)
+                startPoints_.push_back(gModel_->getPoint(v));
+
+            // the start vertices are pushed again keyed by their bounds
+            Base::template init<Metric>(initConfig, true);
+            heap_.setEmpty();
+            std::sort(start.begin(), start.end());
+            start.erase(std::unique(start.begin(), start.end()), start.end());
+            for(VertexId v : start) {
+                if(!wasSeen(v))
+                    continue;
+                DistType potential = findPotential(v);
+                if(potential != Landmarks::Unreachable)
+                    heap_.pushHeap(v, 2*distTo(v)+potential);
+            }
         }
 
-        inline DistType distTo(VertexId id) const {
-            auto it = oldDist_.find(id);
-            if(it != oldDist_.end())
-                return it->second;
-            return numeric_limits<DistType>::max();
+        /**
+         * @brief getNextVertex
+         * @return the vertex with the smallest key and its distance
+         */
+        inline pair<VertexId, DistType> getNextVertex() {
+            VertexId v = heap_.topHeap().first;
+            heap_.popHeap();
+            space_->settle(v);
+            return {v, distTo(v)};
         }
 
         template<typename EdgeIter, typename Metric=Edge::DistanceMetric>
-        bool relaxEdge(const pair<VertexId, DistType> &currMin, size_t prevHops, const EdgeIter &outGoingCur) {
-            VertexType currVert = outGoingCur->getNext();
-            if(gModel_->isRanked(currVert.getId()))
-                return false;
-
-            // find out the new distance
+        inline void relaxEdge(const pair<VertexId, DistType> &currMin, const EdgeIter &outGoingCur) {
+            VertexId currVertId = outGoingCur->getNext().getId();
             DistType newDist = currMin.second+outGoingCur->template getCost<Metric>();
 
-            // if the vertex has not been visited yet
-            VertexId currVertId = currVert.getId();
-            if(!wasSeen(currVertId)) {
-                visSet_.insert(currVertId);
-                oldDist_[currVertId] = newDist;
+            // the vertex doesn't lead to the end
+            DistType potential = findPotential(currVertId);
+            if(potential == Landmarks::Unreachable)
+                return;
 
-                heap_.pushHeap(currVertId, newDist);
-                hopsMap_[currVert.getId()] = prevHops+1;
+            // if the vertex has not been visited yet
+            if(!space_->wasSeen(currVertId)) {
+                space_->visit(currVertId, newDist, currMin.first);
+                heap_.pushHeap(currVertId, 2*newDist+potential);
             }
-            // if the vertex has been visited before
-            else {
-                if(oldDist_[currVertId] > newDist) {
-                    oldDist_[currVertId] = newDist;
-                    heap_.decreaseKey(currVertId, newDist);
-                    hopsMap_[currVert.getId()] = min(hopsMap_[currVert.getId()], prevHops+1);
-                }
+            // straight line bounds may be inconsistent by rounding, settled vertices stay
+            else if(space_->getDist(currVertId) > newDist && !space_->wasSettled(currVertId)) {
+                space_->visit(currVertId, newDist, currMin.first);
+                heap_.decreaseKey(currVertId, 2*newDist+potential);
             }
-            return true;
         }
-    };
-
-    class AlgorithmStateAStar : public AlgorithmState {
     private:
-        DistanceMap distToDest_;
-    public:
-        AlgorithmStateAStar(AdjacencyList *model) : AlgorithmState(model) {;}
-
-        void init(const AlgorithmInit &state) {
-            Vertex s = state.getSrcEdgeSrc(), t = state.getDstEdgeSrc();
-            initMap<DistanceMap, VertexId>(distToDest_);
-            // points
-            Point srcPoint = gModel_->getPoint(s);
-            Point destPoint = gModel_->getPoint(t);
-
-            // keep precomputed distance to the destination
-            if(state.isSrcEndPoint()) {
-                distToDest_[s.getId()] = pointDistance(srcPoint, destPoint);
-            } else {
-                Point srcPt1 = gModel_->getPoint(state.getSrcEdgeSrc());
-                Point srcPt2 = gModel_->getPoint(state.getSrcEdgeDst());
-                distToDest_[state.getSrcEdgeSrc()] = pointDistance(srcPt1, destPoint);
-                distToDest_[state.getSrcEdgeDst()] = pointDistance(srcPt2, destPoint);
+        /**
+         * @brief addTurnCopies
+         * @param vertices
+         */
+        inline void addTurnCopies(std::vector<VertexId> &vertices) const {
+            for(size_t i = 0, size = vertices.size(); i < size; i++) {
+                std::pair<VertexId, VertexId> copies = gModel_->getTurnCopies(vertices[i]);
+                for(VertexId copy = copies.first; copy < copies.second; copy++)
+                    vertices.push_back(copy);
             }
-            static_cast<AlgorithmState*>(this)->init(state);
-        }
-
-        DistType getHeuristic(VertexId v) {
-            return distToDest_[v];
         }
 
-        template<typename EdgeIter, typename Metric=Edge::DistanceMetric>
-        void relaxEdge(const pair<VertexId, DistType> &currMin,
-                       const Point &destPoint, const DistType heuristicOld,
-                       const EdgeIter &outGoingCur) {
-            VertexType currVert = outGoingCur->getNext();
-
-            // find out the new distance
-            DistType newDist = currMin.second;
-
-            // if the vertex has not been visited yet
-            VertexId currVertId = currVert.getId();
-            if(!wasSeen(currVertId)) {
-                visSet_.insert(currVertId);
-
-                // compute the distance to destination and save it
-                Point currPoint = gModel_->getPoint(currVert);
-                DistType heuristicNew = pointDistance(currPoint, destPoint);
-                distToDest_[currVertId] = heuristicNew;
-
-                // reweight the curent edge
-                newDist += max(heuristicNew-heuristicOld+outGoingCur->template getCost<Metric>(), 0);
-
-                prevMap_[currVertId] = currMin.first;
-                oldDist_[currVertId] = newDist;
-                heap_.pushHeap(currVertId, newDist);
+        /**
+         * @brief findPotential
+         * @param v
+         * @return the doubled bound, Unreachable if the vertex isn't on a path between the ends
+         */
+        inline DistType findPotential(VertexId v) {
+            if(space_->hasBound(v))
+                return space_->getBound(v);
+
+            DistType potential = 0;
+            DistType toEnd = lowerBound(v, end_, endPoints_);
+            if(!bidirectional_) {
+                if(toEnd != Landmarks::Unreachable)
+                    potential = 2*toEnd;
+                else
+                    potential = Landmarks::Unreachable;
+            } else {
+                DistType fromStart = lowerBound(v, start_, startPoints_);
+                if(toEnd != Landmarks::Unreachable && fromStart != Landmarks::Unreachable)
+                    potential = toEnd-fromStart;
+                else
+                    potential = Landmarks::Unreachable;
             }
-            // if the vertex has been visited before
-            else {
-                newDist += max(distToDest_[currVertId]-heuristicOld+outGoingCur->template getCost<Metric>(), 0);
+            space_->setBound(v, potential);
+            return potential;
+        }
 
-                if(oldDist_[currVertId] > newDist) {
-                    prevMap_[currVertId] = currMin.first;
-                    oldDist_[currVertId] = newDist;
-                    heap_.decreaseKey(currVertId, newDist);
-                }
-            }
+        /**
+         * @brief lowerBound
+         * @return bound of the distance between the vertex and the set of vertices
+         */
+        inline DistType lowerBound(VertexId v, const Landmarks::Target &target, const std::vector<Point> &points) const {
+            const Landmarks &landmarks = gModel_->getLandmarks();
+            if(!landmarks.empty())
+                return landmarks.lowerBound(v, target);
+            if(!geometric_)
+                return 0;
+
+            Point pt = gModel_->getPoint(v);
+            DistType bound = Landmarks::Unreachable;
+            for(const Point &end : points)
+                bound = min(bound, (DistType)pointDistance(pt, end));
+            return bound;
         }
     };
 
+    // the states of the searches with the default heap
+    typedef BasicAlgorithmState<BinaryHeapPolicy> AlgorithmState;
+    typedef BasicAlgorithmStateAStar<BinaryHeapPolicy> AlgorithmStateAStar;
+
 private:
 
     /**
@@ -670,26 +690,6 @@ private:
         }
     };
 
-    /**
-     *
-     */
-    template<class E>
-    class CompareEdgeUnranked {
-    public:
-        const AdjacencyList* gModel_;
-        CompareEdgeUnranked(const AdjacencyList *model) : gModel_(model) {;}
-    public:
-        bool operator () (const E &e1, const E &e2) {
-            if(gModel_->isRanked(e1.getNextId()) != gModel_->isRanked(e2.getNextId())) {
-                if(gModel_->isRanked(e1.getNextId()))
-                    return false;
-                else
-                    return true;
-            }
-            return e1.getNextId() < e2.getNextId();
-        }
-    };
-
     /**
      *
      */
@@ -713,46 +713,73 @@ private:
     };
 
     /**
-     *
+     * edge of the compact adjacency waiting to be unpacked
      */
-    template<class E>
-    class CompareVertexEdgeUnranked {
-    public:
-        const AdjacencyList *gModel_;
-        CompareVertexEdgeUnranked(const AdjacencyList *model) : gModel_(model) {;}
-    public:
-        bool operator () (const E &e1, const Vertex &v) {
-            if(gModel_->isRanked(e1.getNextId()))
-                return false;
-            return e1.getNextId() < v.getId();
-        }
+    struct PackedEdge {
+        bool back_;
+        CompactAdjacency::EdgeOffset index_;
+        VertexId target_;
     };
 
     /**
-     * @brief The VertexProcResult class
+     * input edge of a way, the traffic on the way sets its time
      */
-    class VertexProcResult {
-    public:
-        size_t totalSearchSpace_;
-        size_t totalShortcuts_;
+    struct WayEdge {
+        Edge::EdgeId way_;
+        bool back_;
+        CompactAdjacency::EdgeOffset index_;
+        // vertex the edge is stored at
+        VertexId source_;
 
-        VertexProcResult() : totalSearchSpace_(0), totalShortcuts_(0) {
-            ;
+        bool operator < (const WayEdge &edge) const {
+            return way_ < edge.way_;
         }
     };
 
+    /**
+     * time weights an edge gets from a traffic update
+     */
+    struct TrafficWeights {
+        Edge::EdgeTime input_;
+        Edge::EdgeTime cost_;
+        VertexId via_;
+        CompactAdjacency::EdgeOffset in_;
+        CompactAdjacency::EdgeOffset out_;
+    };
+
+    /**
+     * new input time of an edge with the vertex it is stored at
+     */
+    struct TrafficInput {
+        VertexId source_;
+        Edge::EdgeTime time_;
+    };
+
+    // edge of the compact adjacency, its index with the direction in the lowest bit
+    typedef uint64_t TrafficKey;
+
 private:
     //--------------------------------------------------------------------------
     // number of vertices
     size_t numVertices_;
     //--------------------------------------------------------------------------
-    // backward edges
+    // backward edges, used while the graph is modified
     VertexEdgeBackVector edgesTo_;
-    // forward edges
+    // forward edges, used while the graph is modified
     VertexEdgeForwVector edgesFrom_;
+    // compact read only adjacency used for queries
+    CompactAdjacency forw_;
+    CompactAdjacency back_;
+    // set when the compact adjacency is in use
+    bool frozen_;
+    // preprocessed graph file, compact adjacency may point into it
+    GraphFileReader graphFile_;
     //--------------------------------------------------------------------------
     // turn restrictions
     TurnRestrictions restrictions_;
+    // vertex each copy made for turn restrictions was made from, the copies
+    // have the ids after the vertices of the input and are sorted by it
+    std::vector<VertexId> turnCopyOf_;
     //--------------------------------------------------------------------------
     // number of marked verticed
     size_t numMarkedVert_;
@@ -760,17 +787,38 @@ private:
     VertexRankMap rank_;
     // bool vector marking that the vertex was marked
     std::vector<bool> ranked_;
-    // set of unranked nodes
-    UnrankedVertexSet unrankedNodes_;
+    // vertices by decreasing rank, the order of the downward sweep
+    std::vector<VertexId> sweepOrder_;
+    // sweep position of the higher end of every backward edge
+    std::vector<VertexId> sweepSource_;
+    //--------------------------------------------------------------------------
+    // lower bounds for A*, stored next to the input file
+    Landmarks landmarks_;
+    // partition and cliques of the overlay engine, built when the graph is
+    // loaded, empty for the hierarchy
+    MultiLevelOverlay overlay_;
     //--------------------------------------------------------------------------
     // sql based kd tree for endpoint indexing
     KdTreeSql kdTreeEndPt_;
     // sql based kdtree for non endpoints
     KdTreeSql kdTreeNonEndPt_;
+    // in memory copy of both kd trees, the sql trees are searched without it
+    SnapIndex snapIndex_;
+    // segments of the edge geometries, used for snapping instead of the
+    // kd trees if it could be built
+    SegmentIndex segmentIndex_;
     //geometry index in sqlite
     GeometryIndexSql indexGeometry_;
+    // copy of the geometry index stored next to the input file, optional
+    GeometryStore geometryStore_;
     // vertex to point vector
     VertexPointVector vertexToPoint_;
+    // ids the vertices of the input have in the input file, the kd trees
+    // and the geometry index use them. Empty if the vertices were not
+    // renumbered by preprocessing
+    std::vector<VertexId> inputIdOf_;
+    // vertex of every id of the input file
+    std::vector<VertexId> vertexOfInputId_;
     //--------------------------------------------------------------------------
     // the input filename
     std::string inputFilename_;
@@ -779,28 +827,44 @@ private:
     // a flag set if we read from
     // already preprocessed input
     bool readPreprocessed_;
+    // the graph is searched on the overlay instead of the hierarchy
+    bool useOverlay_;
     // edges added during preprocessing
     size_t edgesAdded_;
-    // static field hop number
-    size_t hopsAllowed_;
-    // the total degree for vertices
-    size_t totalDegree_;
-    // the search space limit
-    size_t searchSpaceLimit_;
-    // the set of witness found distances
-    WitnessMap oneHopWitness_;
-    // lock
+    // number of threads used by preprocessing
+    size_t numThreads_;
+    // the sqlite indices share their prepared statements, queries running
+    // on several threads take turns
     std::mutex kdTreeMutex_;
+    std::mutex geometryMutex_;
+    //--------------------------------------------------------------------------
+    // live traffic
+    // searches read the weights under the lock, traffic updates are written
+    // under it
+    ReadWriteLock weightsLock_;
+    // traffic updates are computed one at a time
+    std::mutex trafficMutex_;
+    // input edges sorted by their ways, built by the first traffic update
+    std::vector<WayEdge> wayEdges_;
+    // times the edges changed by traffic had before the first update
+    std::unordered_map<TrafficKey, Edge::EdgeTime> loadedTimes_;
+    // vertices by rank and for every vertex the forward and the backward
+    // edges of the lower vertices it is the next vertex of, ordered by the
+    // rank of the lower vertex. The lower vertices two vertices share are
+    // the lower triangles of the edge between them
+    std::vector<VertexId> rankOrder_;
+    std::vector<CompactAdjacency::EdgeOffset> lowerOffsets_[2];
+    std::vector<std::pair<VertexRank, CompactAdjacency::EdgeOffset> > lowerEdges_[2];
     //--------------------------------------------------------------------------
 public:
     AdjacencyList() {
         // initialize the preprocessing parameters
         numVertices_ = 0;
         edgesAdded_ = 0;
-        totalDegree_ = 0;
-        hopsAllowed_ = 0;
-        searchSpaceLimit_ = 0;
+        numThreads_ = 1;
         readPreprocessed_ = false;
+        useOverlay_ = false;
+        frozen_ = false;
     }
     //--------------------------------------------------------------------------
     // memory and data statistics functions
@@ -836,6 +900,35 @@ public:
             return false;
         }
 
+        setInitConfig(nearestSrc, nearestDst, initConfig);
+        return true;
+    }
+    /**
+     * the point is both the source and the destination of the config, used
+     * by searches which snap every point once and combine the configs
+     * @brief getInitConfig
+     * @param pt
+     * @param initConfig
+     * @return
+     */
+    bool getInitConfig(const Point &pt, AlgorithmInit &initConfig) {
+        NearestPointResult nearest;
+        if(!findNearestPointKdTree(pt, nearest)) {
+            LOGG(Logger::ERROR) << "couldn't find " << pt << " in kdtree" << Logger::FLUSH;
+            return false;
+        }
+
+        setInitConfig(nearest, nearest, initConfig);
+        return true;
+    }
+    /**
+     * @brief setInitConfig
+     * @param nearestSrc
+     * @param nearestDst
+     * @param initConfig
+     */
+    void setInitConfig(const NearestPointResult &nearestSrc, const NearestPointResult &nearestDst,
+                       AlgorithmInit &initConfig) {
         initConfig.setSearchResults(nearestSrc, nearestDst);
 
         // change destinations in case not end point
@@ -852,7 +945,17 @@ public:
             initConfig.setDstEdgeType(dstType);
         }
 
-        return true;
+        // the destination is also reached when arriving at one of its copies
+        std::vector<std::pair<VertexId, VertexId> > dstCopies;
+        std::vector<VertexId> dstVertices = {nearestDst.getSrc().getId()};
+        if(nearestDst.getDst().getId() != nearestDst.getSrc().getId())
+            dstVertices.push_back(nearestDst.getDst().getId());
+        for(VertexId id : dstVertices) {
+            std::pair<VertexId, VertexId> copies = getTurnCopies(id);
+            for(VertexId copy = copies.first; copy < copies.second; copy++)
+                dstCopies.push_back({copy, id});
+        }
+        initConfig.setDstCopies(dstCopies);
     }
 
     /**
@@ -867,12 +970,10 @@ public:
      * @brief checkForEmptyEdges
      */
     void checkEdgesValidity() const {
-        LOGG(Logger::INFO) << "[MEMORY] edges vector size: " << edgesTo_.size() << Logger::FLUSH;
-
-        assert(edgesTo_.size() == edgesFrom_.size());
+        LOGG(Logger::INFO) << "[MEMORY] edges vector size: " << getNumVertices() << Logger::FLUSH;
 
-        for(size_t i = 0; i < edgesTo_.size(); i++)
-            if(edgesTo_[i].size() == 0 && edgesFrom_[i].size() == 0) {
+        for(size_t i = 0; i < getNumVertices(); i++)
+            if(numIncomingEdges(i) == 0 && numOutGoingEdges(i) == 0) {
                 LOGG(Logger::INFO) << "[PARSE WARNING]: no edge for " << i << Logger::FLUSH;
             }
     }
@@ -882,7 +983,9 @@ public:
      * @return
      */
     size_t getEdgeMemoryInfo() const {
-        assert(edgesFrom_.size() == edgesFrom_.capacity());
+        if(frozen_) {
+            return forw_.getMemoryUsage()+back_.getMemoryUsage();
+        }
 
         size_t totalMemory = 0;
         for(size_t i = 0; i < edgesFrom_.size(); i++) {
@@ -905,25 +1008,10 @@ public:
      * @return
      */
     size_t numPointsOnGeometryRecursive(VertexId src, VertexId dst) {
-        size_t pointsToStore = 2;
-        std::stack<pair<VertexId, VertexId> > unrollEdges;
-        unrollEdges.push({src, dst});
-
-        while(!unrollEdges.empty()) {
-            pair<VertexId, VertexId> currEdg = unrollEdges.top();
-            unrollEdges.pop();
-
-            VertexId via = getViaForEdge(currEdg.first, currEdg.second);
-            if(via == Vertex::NullVertexId) {
-                pointsToStore++;
-            }
-            else {
-                unrollEdges.push({currEdg.first, via});
-                unrollEdges.push({via, currEdg.second});
-            }
-        }
-
-        return pointsToStore;
+        // the first vertex and one vertex per unpacked edge
+        std::vector<VertexId> path;
+        unpackPath<Edge::DistanceMetric>({src, dst}, path);
+        return path.size()+1;
     }
 
     /**
@@ -935,9 +1023,7 @@ public:
     size_t getNumPointsToStoreNonRecursive() const {
         size_t pointsToStore = 0;
         for(VertexId id = 0; id < getNumVertices(); id++) {
-            for(size_t i = 0; i < edgesFrom_[id].size(); i++) {
-                pointsToStore += 2;
-            }
+            pointsToStore += 2*numOutGoingEdges(id);
         }
         return pointsToStore;
     }
@@ -949,8 +1035,8 @@ public:
     size_t getNumPointsToStoreRecursive() {
         size_t pointsToStore = 0;
         for(VertexId id = 0; id < getNumVertices(); id++) {
-            for(size_t i = 0; i < edgesFrom_[id].size(); i++) {
-                pointsToStore += numPointsOnGeometryRecursive(id, edgesFrom_[id][i].getNextId());
+            for(auto it = getOutgoingIterBegin(id); it != getOutgoingIterEnd(id); ++it) {
+                pointsToStore += numPointsOnGeometryRecursive(id, it->getNextId());
             }
         }
 
@@ -964,8 +1050,8 @@ public:
         // find out the edge with a maximal distance
         DistType maxDist = 0;
         for(VertexId id = 0; id < getNumVertices(); id++) {
-            for(size_t i = 0; id < edgesTo_.size() && i < edgesTo_[id].size(); i++) {
-                maxDist = max(maxDist, edgesTo_[id][i].getCost<Edge::DistanceMetric>());
+            for(auto it = getIncomingIterBegin(id); it != getIncomingIterEnd(id); ++it) {
+                maxDist = max(maxDist, it->getCost<Edge::DistanceMetric>());
             }
         }
 
@@ -982,32 +1068,36 @@ public:
         SqlStream sqliteStr;
         inputFilename_ = filename;
 
-        {
-            // deserialize vertices
-            URL url(filename);
-            Properties props = {{"type", "sqlite"}, {"create", "0"}, {"table", SqlConsts::VERTICES_TABLE}};
-            if(!sqliteStr.open(url, props)) {
-                LOGG(Logger::ERROR) << "cant prepare table stream " << SqlConsts::VERTICES_TABLE << Logger::FLUSH;
+        // check if there exists a preprocessed version, the overlay is
+        // built on the original graph
+        if(!useOverlay_ && graphFile_.open(filename+".preprocessed")) {
+            LOGG(Logger::INFO) << "reading from preprocessed graph file" << Logger::FLUSH;
+            readPreprocessed_ = true;
+            if(!deserializeGraphFile(graphFile_)) {
+                LOGG(Logger::ERROR) << "can't read preprocessed graph file " << filename << Logger::FLUSH;
                 return false;
-            } else {
-                if(!deserializeVertices(sqliteStr, sqliteStr.getNumRows())) {
+            }
+        } else {
+            {
+                // deserialize vertices
+                URL url(filename);
+                Properties props = {{"type", "sqlite"}, {"create", "0"}, {"table", SqlConsts::VERTICES_TABLE}};
+                if(!sqliteStr.open(url, props)) {
+                    LOGG(Logger::ERROR) << "cant prepare table stream " << SqlConsts::VERTICES_TABLE << Logger::FLUSH;
                     return false;
+                } else {
+                    if(!deserializeVertices(sqliteStr, sqliteStr.getNumRows())) {
+                        return false;
+                    }
                 }
             }
-        }
 
-        // check if there exists a preprocessed version
-        fstream fstrPreprocessed(filename+".preprocessed");
-        if(fstrPreprocessed.is_open()) {
-            LOGG(Logger::INFO) << "reading from preprocessed file" << Logger::FLUSH;
-            readPreprocessed_ = true;
-            deserializeRanks(fstrPreprocessed);
-            size_t numEdges = 0;
-            fstrPreprocessed >> numEdges;
-            deserializeEdges(fstrPreprocessed,numEdges);
-        }
-        else {
-            // reading from preprocessed
+            // preprocessed files written by older versions hold hierarchies
+            // valid for a single metric, they are ignored and the graph is rebuilt
+            if(!useOverlay_ && ifstream(filename+".preprocessed").good()) {
+                LOGG(Logger::WARNING) << "ignoring outdated preprocessed file, the graph should be preprocessed again" << Logger::FLUSH;
+            }
+
             LOGG(Logger::INFO) << "reading from the original file" << Logger::FLUSH;
             URL url(filename);
             Properties props = {{"type", "sqlite"}, {"create", "0"}, {"table", SqlConsts::EDGES_TABLE}};
@@ -1016,19 +1106,30 @@ public:
                 return false;
             }
             deserializeEdges(sqliteStr, sqliteStr.getNumRows());
-        }
 
-        {
-            // deserialize turn restrictions
-            URL url(filename);
-            Properties props = {{"type", "sqlite"}, {"create", "0"}, {"table", SqlConsts::TURN_RESTRICTIONS}};
-            if(!sqliteStr.open(url, props)) {
-                LOGG(Logger::ERROR) << "can't prepare table stream " << SqlConsts::TURN_RESTRICTIONS << Logger::FLUSH;
-            } else {
-                deserializeTurnRestrictions(sqliteStr, sqliteStr.getNumRows());
+            {
+                // deserialize turn restrictions, the preprocessed file
+                // already has the vertices split for them
+                Properties props = {{"type", "sqlite"}, {"create", "0"}, {"table", SqlConsts::TURN_RESTRICTIONS}};
+                if(!sqliteStr.open(url, props)) {
+                    LOGG(Logger::ERROR) << "can't prepare table stream " << SqlConsts::TURN_RESTRICTIONS << Logger::FLUSH;
+                } else {
+                    deserializeTurnRestrictions(sqliteStr, sqliteStr.getNumRows());
+                    splitRestrictedVertices();
+                }
             }
+            freezeEdges();
         }
 
+        // landmarks are optional, A* uses straight line bounds without them.
+        // They are computed on the input graph and don't match the vertex
+        // ids of a hierarchy
+        if(!hasHierarchy())
+            landmarks_.load(filename+".landmarks", getNumVertices());
+        geometryStore_.load(filename+".geometry");
+        if(useOverlay_)
+            buildOverlay();
+
         {
             // initialize kd tree sqlite
             URL url(filename);
@@ -1052,8 +1153,11 @@ public:
                 return false;
             }
         }
+        // the points of the kd trees are snapped to if the edges can't be,
+        // the segment index needs the geometry store
+        if(!buildSegmentIndex())
+            snapIndex_.build(kdTreeEndPt_, kdTreeNonEndPt_);
         checkMemoryInfo();
-        fstrPreprocessed.close();
         return true;
     }
 
@@ -1074,13 +1178,34 @@ public:
         inputFilename_ = "";
         releaseMemory(edgesTo_);
         releaseMemory(edgesFrom_);
+        forw_.clear();
+        back_.clear();
+        frozen_ = false;
+        graphFile_.close();
         releaseMemory(rank_);
         releaseMemory(ranked_);
-        releaseMemory(unrankedNodes_);
+        releaseMemory(sweepOrder_);
+        releaseMemory(sweepSource_);
+        landmarks_.clear();
+        overlay_.clear();
+        releaseMemory(restrictions_);
+        releaseMemory(turnCopyOf_);
         releaseMemory(vertexToPoint_);
+        releaseMemory(inputIdOf_);
+        releaseMemory(vertexOfInputId_);
         kdTreeEndPt_.close();
         kdTreeNonEndPt_.close();
+        snapIndex_.clear();
+        segmentIndex_.clear();
         indexGeometry_.close();
+        geometryStore_.clear();
+        releaseMemory(wayEdges_);
+        loadedTimes_.clear();
+        releaseMemory(rankOrder_);
+        for(int back = 0; back < 2; back++) {
+            releaseMemory(lowerOffsets_[back]);
+            releaseMemory(lowerEdges_[back]);
+        }
         checkMemoryInfo();
     }
 private:
@@ -1147,17 +1272,6 @@ private:
         }
 
         sortEdges();
-
-        // ensure that the size is the capacity
-        for(VertexId i = 0; i < numVertices_; i++) {
-            std::vector<EdgeForw> tmpForw;
-            swap(tmpForw, edgesFrom_[i]);
-            edgesFrom_[i] = tmpForw;
-
-            std::vector<EdgeBack> tmpBack;
-            swap(tmpBack, edgesTo_[i]);
-            edgesTo_[i] = tmpBack;
-        }
     }
 
     /**
@@ -1174,67 +1288,185 @@ private:
             VertexId via;
             Edge::EdgeId from, to;
             iss >> from >> to >> via >> type;
+            restrictions_.push_back(TurnRestriction(from, to, via, type));
         }
     }
 
     /**
-     * @brief deserializeRanks
+     * makes the turn restrictions part of the graph. Every way entering a
+     * restricted vertex gets its own copy of the vertex, the copy only has
+     * the edges of the turns allowed from that way. The arcs of the way are
+     * moved to the copy, so any search, contraction included, can only take
+     * the allowed turns. The copies share the point of the vertex and are
+     * mapped back to it in paths
+     * @brief splitRestrictedVertices
      */
-    istream &deserializeRanks(istream &fstrPreprocessed) {
-        rank_.resize(getNumVertices());
-        ranked_.resize(getNumVertices(), false);
+    void splitRestrictedVertices() {
+        sort(restrictions_.begin(), restrictions_.end(), [](const TurnRestriction &r1, const TurnRestriction &r2) {
+            return make_pair(r1.getVia(), r1.getFrom()) < make_pair(r2.getVia(), r2.getFrom());
+        });
+
+        size_t numInput = getNumVertices();
+        for(size_t i = 0, j = 0; i < restrictions_.size(); i = j) {
+            VertexId via = restrictions_[i].getVia();
+            Edge::EdgeId from = restrictions_[i].getFrom();
+
+            // restrictions of one way at the vertex
+            std::vector<Edge::EdgeId> prohibited, mandatory;
+            for(j = i; j < restrictions_.size() && restrictions_[j].getVia() == via &&
+                       restrictions_[j].getFrom() == from; j++) {
+                if(restrictions_[j].isProhibitive())
+                    prohibited.push_back(restrictions_[j].getTo());
+                else if(restrictions_[j].isMandatory())
+                    mandatory.push_back(restrictions_[j].getTo());
+            }
 
-        size_t numRanked = 0;
-        fstrPreprocessed >> numRanked;
-        for(size_t i = 0; i < numRanked; i++) {
-            VertexId id;
-            VertexRank rank;
+            if(via < 0 || size_t(via) >= numInput) {
+                LOGG(Logger::WARNING) << "[TURN RESTRICTIONS] via vertex " << via << " doesn't exist" << Logger::FLUSH;
+                continue;
+            }
+            auto isFrom = [from](const EdgeBack &edge) {
+                return edge.getOrigId() == from;
+            };
+            if(none_of(edgesTo_[via].begin(), edgesTo_[via].end(), isFrom))
+                continue;
+
+            VertexId copy = numVertices_++;
+            vertexToPoint_.push_back(vertexToPoint_[via]);
+            turnCopyOf_.push_back(via);
+            edgesFrom_.push_back(std::vector<EdgeForw>());
+            edgesTo_.push_back(std::vector<EdgeBack>());
+
+            // the arcs of the way enter the copy instead of the vertex
+            for(const EdgeBack &edge : edgesTo_[via]) {
+                if(!isFrom(edge))
+                    continue;
+                for(EdgeForw &edgeForw : edgesFrom_[edge.getNextId()]) {
+                    if(edgeForw.getNextId() == via)
+                        edgeForw.setNextId(copy);
+                }
+                edgesTo_[copy].push_back(edge);
+            }
+            edgesTo_[via].erase(remove_if(edgesTo_[via].begin(), edgesTo_[via].end(), isFrom), edgesTo_[via].end());
 
-            fstrPreprocessed >> id >> rank;
-            ranked_[id] = true;
-            rank_[id] = rank;
+            // the copy leaves by the allowed turns
+            for(const EdgeForw &edge : edgesFrom_[via]) {
+                Edge::EdgeId to = edge.getOrigId();
+                if(count(prohibited.begin(), prohibited.end(), to) != 0 ||
+                   (!mandatory.empty() && count(mandatory.begin(), mandatory.end(), to) == 0))
+                    continue;
+                edgesFrom_[copy].push_back(edge);
+                edgesTo_[edge.getNextId()].push_back(EdgeBack(copy, edge.getCost<Edge::DistanceMetric>(),
+                                                              edge.getCost<Edge::TimeMetric>(), edge.getVia(),
+                                                              edge.getType(), edge.getOrigId()));
+            }
         }
 
-        return fstrPreprocessed;
+        sortEdges();
+        LOGG(Logger::INFO) << "[TURN RESTRICTIONS] " << restrictions_.size() << " restrictions, "
+                           << turnCopyOf_.size() << " vertices added" << Logger::FLUSH;
     }
 
+    /**
+     * @brief deserializeGraphFile
+     * reads vertices, ranks and edges from the binary graph file
+     */
+    bool deserializeGraphFile(const GraphFileReader &graphFile) {
+        size_t numPoints = 0, numRanks = 0;
+        const Point *points = graphFile.getSection<Point>(GraphFile::POINTS, numPoints);
+        const VertexRank *ranks = graphFile.getSection<VertexRank>(GraphFile::RANKS, numRanks);
+        if(points == 0 || numPoints != graphFile.getNumVertices() || (ranks != 0 && numRanks != numPoints)) {
+            LOGG(Logger::ERROR) << "[PARSE ERROR] wrong number of vertices" << Logger::FLUSH;
+            return false;
+        }
+
+        size_t numCopies = 0;
+        const VertexId *copies = graphFile.getSection<VertexId>(GraphFile::TURN_COPIES, numCopies);
+        if(numCopies > numPoints || (numCopies > 0 && copies == 0)) {
+            LOGG(Logger::ERROR) << "[PARSE ERROR] wrong number of turn restriction copies" << Logger::FLUSH;
+            return false;
+        }
+        for(size_t i = 0; i < numCopies; i++) {
+            if(copies[i] < 0 || size_t(copies[i]) >= numPoints-numCopies || (i > 0 && copies[i] < copies[i-1])) {
+                LOGG(Logger::ERROR) << "[PARSE ERROR] corrupted turn restriction copies" << Logger::FLUSH;
+                return false;
+            }
+        }
+
+        size_t numInputIds = 0;
+        const VertexId *inputIds = graphFile.getSection<VertexId>(GraphFile::INPUT_IDS, numInputIds);
+        if(numInputIds != 0 && numInputIds != numPoints-numCopies) {
+            LOGG(Logger::ERROR) << "[PARSE ERROR] wrong number of input ids" << Logger::FLUSH;
+            return false;
+        }
+        vertexOfInputId_.assign(numInputIds, Vertex::NullVertexId);
+        for(size_t i = 0; i < numInputIds; i++) {
+            if(inputIds[i] < 0 || size_t(inputIds[i]) >= numInputIds || vertexOfInputId_[inputIds[i]] != Vertex::NullVertexId) {
+                LOGG(Logger::ERROR) << "[PARSE ERROR] corrupted input ids" << Logger::FLUSH;
+                return false;
+            }
+            vertexOfInputId_[inputIds[i]] = i;
+        }
+
+        numVertices_ = numPoints;
+        vertexToPoint_.assign(points, points+numPoints);
+        turnCopyOf_.assign(copies, copies+numCopies);
+        inputIdOf_.assign(inputIds, inputIds+numInputIds);
+
+        rank_.resize(getNumVertices());
+        ranked_.resize(getNumVertices(), false);
+        for(size_t id = 0; ranks != 0 && id < getNumVertices(); id++) {
+            if(ranks[id] != numeric_limits<VertexRank>::max()) {
+                ranked_[id] = true;
+                rank_[id] = ranks[id];
+            }
+        }
+
+        // edges are used directly from the mapping
+        if(!forw_.map(graphFile, CompactAdjacency::FORWARD_SECTIONS) ||
+           !back_.map(graphFile, CompactAdjacency::BACKWARD_SECTIONS)) {
+            LOGG(Logger::ERROR) << "[PARSE ERROR] corrupted adjacency arrays" << Logger::FLUSH;
+            return false;
+        }
+        if(!forw_.checkShortcutEdges(back_, forw_) || !back_.checkShortcutEdges(back_, forw_)) {
+            LOGG(Logger::ERROR) << "[PARSE ERROR] corrupted shortcuts" << Logger::FLUSH;
+            return false;
+        }
+        frozen_ = true;
+        buildSweepOrder();
+        return true;
+    }
 
     /**
-     * serialize edges and ranks after preprocessing with CH
+     * serialize vertices, edges and ranks after preprocessing with CH
      */
     void serializeEdgesAfterProcessing() const {
         LOGG(Logger::INFO) << "[NOTIFICATION] serialize edges after preprocessing" << Logger::FLUSH;
         std::string preprocessedFile = inputFilename_+".preprocessed";
-        fstream oss(preprocessedFile, fstream::out);
-
-        // figure out how many are ranked
-        size_t numRanked = 0;
-        for(VertexId id = 0; id < getNumVertices(); id++) {
-            if(ranked_[id])
-                numRanked++;
-        }
 
-        oss << numRanked << endl;
+        GraphFileWriter writer;
+        if(!writer.open(preprocessedFile, getNumVertices()))
+            return;
 
-        // serialize ranks
+        // serialize points and ranks
+        std::vector<VertexRank> ranks(getNumVertices());
         for(VertexId id = 0; id < getNumVertices(); id++) {
-            if(ranked_[id])
-                oss << id << " " << rank_[id] << endl;
+            ranks[id] = getVertexRank(id);
         }
+        bool good = writer.writeSection(GraphFile::POINTS, vertexToPoint_) &&
+                    writer.writeSection(GraphFile::RANKS, ranks) &&
+                    writer.writeSection(GraphFile::TURN_COPIES, turnCopyOf_) &&
+                    writer.writeSection(GraphFile::INPUT_IDS, inputIdOf_);
 
-        // serialize edges
-        size_t numEdges = 0;
-        for(VertexId id = 0; id < getNumVertices(); id++) {
-            numEdges += edgesFrom_[id].size();
-        }
-        oss << numEdges << endl;
-        for(VertexId id = 0; id < getNumVertices(); id++) {
-            for(const EdgeForw &edge : edgesFrom_[id]) {
-                oss << id << " ";
-                edge.serialize(oss);
-            }
+        // serialize edges, the arrays are written as they are in memory
+        assert(frozen_);
+        good = good && forw_.write(writer, CompactAdjacency::FORWARD_SECTIONS);
+        good = good && back_.write(writer, CompactAdjacency::BACKWARD_SECTIONS);
+
+        if(!writer.close() || !good) {
+            LOGG(Logger::ERROR) << "[NOTIFICATION] couldn't write " << preprocessedFile << Logger::FLUSH;
+            remove(preprocessedFile.c_str());
         }
-        oss.close();
     }
 
     /**
@@ -1248,43 +1480,6 @@ private:
             indexGeometry_.insertGeometry(v1, v2, false, geometry);
         }
     }
-    /**
-     * @brief getNewMetricRecursive
-     * @param src
-     * @param dst
-     * @return
-     */
-    DistType getNewMetricRecursive(VertexId src, VertexId dst) {
-        DistType metric = 0;
-        std::stack<pair<VertexId, VertexId> > unrollEdges;
-        unrollEdges.push({src, dst});
-
-        while(!unrollEdges.empty()) {
-            pair<VertexId, VertexId> currEdg = unrollEdges.top();
-            unrollEdges.pop();
-
-            VertexId via = getViaForEdge(currEdg.first, currEdg.second);
-            if(via == Vertex::NullVertexId) {
-                metric += findEdgeForw(currEdg.first, currEdg.second)->getCost<Edge::TimeMetric>();
-            }
-            else {
-                Edge *edge1 = findEdgeForw(currEdg.first, via);
-                if(edge1->getCost<Edge::TimeMetric>() != Edge::MaxTime)
-                    metric += edge1->getCost<Edge::TimeMetric>();
-                else
-                    unrollEdges.push({currEdg.first, via});
-
-                Edge *edge2 = findEdgeForw(via, currEdg.second);
-                if(edge2->getCost<Edge::TimeMetric>() != Edge::MaxTime)
-                    metric += edge2->getCost<Edge::TimeMetric>();
-                else
-                    unrollEdges.push({via, currEdg.second});
-            }
-        }
-
-        return metric;
-    }
-
     /**
      * @brief serializeGeometryAfterPreprocessing
      * iterate over all edges and find all created during
@@ -1303,17 +1498,17 @@ private:
         sort(rankedVertices.begin(), rankedVertices.end(), CompareRanks());
 
         for(VertexId id = 0; id < getNumVertices(); id++) {
-            for(size_t i = 0; i < edgesFrom_[id].size(); i++) {
-                if(edgesFrom_[id][i].getType() & Edge::CREATED_ON_PREPROCESSING ||
-                   edgesFrom_[id][i].getVia() != Vertex::NullVertexId) {
+            for(auto it = getOutgoingIterBegin(id); it != getOutgoingIterEnd(id); ++it) {
+                if(it->getType() & Edge::CREATED_ON_PREPROCESSING ||
+                   forw_.getShortcutVia<Edge::DistanceMetric>(it) != Vertex::NullVertexId) {
                     std::vector<Point> first, second;
-                    findGeometryForEdge(id, edgesFrom_[id][i].getNextId(), getPoint(id), first);
-                    findGeometryForEdge(id, edgesFrom_[id][i].getNextId(), getPoint(id), second);
+                    findGeometryForEdge(id, it->getNextId(), getPoint(id), first);
+                    findGeometryForEdge(id, it->getNextId(), getPoint(id), second);
 
                     first.pop_back();
                     first.insert(first.end(), second.begin(), second.end());
 
-                    serializePreprocessedGeometry(id, edgesFrom_[id][i].getNextId(), first);
+                    serializePreprocessedGeometry(id, it->getNextId(), first);
                 }
             }
         }
@@ -1326,12 +1521,12 @@ private:
      * @param dst
      * @return
      */
-    EdgeForw* findEdgeForw(Vertex src, Vertex dst) {
+    OutgoingEdgeIter findEdgeForw(Vertex src, Vertex dst) {
         auto it = lower_bound(getOutgoingIterBegin(src), getOutgoingIterEnd(src),
-                              dst, CompareVertexEdge<EdgeForw>());
+                              dst, CompareVertexEdge<CompactEdge>());
 
         if(it != getOutgoingIterEnd(src) && it->getNextId() == dst.getId())
-            return &(*it);
+            return it;
         else
             return 0;
     }
@@ -1342,16 +1537,50 @@ private:
      * @param dst
      * @return
      */
-    EdgeBack* findEdgeBack(Vertex src, Vertex dst) {
+    IncomingEdgeIter findEdgeBack(Vertex src, Vertex dst) {
         auto it = lower_bound(getIncomingIterBegin(dst), getIncomingIterEnd(dst),
-                              src, CompareVertexEdge<EdgeBack>());
+                              src, CompareVertexEdge<CompactEdge>());
 
         if(it != getIncomingIterEnd(dst) && it->getNextId() == src.getId())
-            return &(*it);
+            return it;
         else
             return 0;
     }
 
+    /**
+     * @brief hasInputEdge
+     * @param src
+     * @param dst
+     * @return true if there is an edge from src to dst not added by contraction
+     */
+    bool hasInputEdge(VertexId src, VertexId dst) {
+        OutgoingEdgeIter edgeForw = findEdgeForw(src, dst);
+        if(edgeForw != 0 && (edgeForw->getType() & Edge::CREATED_ON_PREPROCESSING) == 0)
+            return true;
+        IncomingEdgeIter edgeBack = findEdgeBack(src, dst);
+        return edgeBack != 0 && (edgeBack->getType() & Edge::CREATED_ON_PREPROCESSING) == 0;
+    }
+
+    /**
+     * arcs entering a restricted vertex may have been moved to one of its
+     * copies, returns the vertex the arc from src to dst ends at
+     * @brief findArcTarget
+     * @param src
+     * @param dst
+     * @return
+     */
+    VertexId findArcTarget(VertexId src, VertexId dst) {
+        if(hasInputEdge(src, dst))
+            return dst;
+
+        std::pair<VertexId, VertexId> copies = getTurnCopies(dst);
+        for(VertexId copy = copies.first; copy < copies.second; copy++) {
+            if(hasInputEdge(src, copy))
+                return copy;
+        }
+        return dst;
+    }
+
     /**
      * @brief findEdgeType
      * @param src
@@ -1359,10 +1588,12 @@ private:
      * @return
      */
     Edge::EdgeType findEdgeType(Vertex src, Vertex dst) {
-        EdgeForw *edgeForw = findEdgeForw(src, dst);
+        ReadWriteLock::ReadLock lock(&weightsLock_);
+        dst = findArcTarget(src.getId(), dst.getId());
+        OutgoingEdgeIter edgeForw = findEdgeForw(src, dst);
 
         if(edgeForw == 0) {
-            EdgeBack *edgeBack = findEdgeBack(src, dst);
+            IncomingEdgeIter edgeBack = findEdgeBack(src, dst);
 
             assert(edgeBack != 0);
             return edgeBack->getType();
@@ -1372,21 +1603,50 @@ private:
     }
 
     /**
-     * get the number of unranked neighbors
+     * expands the edges between consecutive vertices of the path into edges
+     * of the input graph. Every edge is looked up once, the edges of the
+     * shortcuts are taken from the indices stored by customization, so the
+     * expansion takes time linear in the length of the result. Copies made
+     * for turn restrictions are not visible outside
+     * @brief unpackPath
+     * @param tree vertices in the direction of the edges
+     * @param path the first vertex and the ends of the unpacked edges
      */
-    size_t numUnrankedNeighbors(Vertex id) const {
-        size_t neighbors = 0;
-        for(size_t i = 0; i < edgesTo_[id.getId()].size(); i++) {
-            if(ranked_[edgesTo_[id.getId()][i].getNextId()])
-                neighbors++;
-        }
+    template<typename Metric>
+    void unpackPath(const std::vector<VertexId> &tree, std::vector<VertexId> &path) {
+        if(tree.empty())
+            return;
 
-        for(size_t i = 0; i < edgesFrom_[id.getId()].size(); i++) {
-            if(ranked_[edgesFrom_[id.getId()][i].getNextId()])
-                neighbors++;
-        }
+        path.push_back(getOriginalVertex(tree[0]));
+        std::vector<PackedEdge> unpack;
+        for(size_t i = 0; i+1 < tree.size(); i++) {
+            OutgoingEdgeIter edgeForw = findEdgeForw(tree[i], tree[i+1]);
+            if(edgeForw != 0) {
+                unpack.push_back({false, forw_.index(edgeForw), tree[i+1]});
+            } else {
+                IncomingEdgeIter edgeBack = findEdgeBack(tree[i], tree[i+1]);
+                assert(edgeBack != 0);
+                unpack.push_back({true, back_.index(edgeBack), tree[i+1]});
+            }
 
-        return neighbors;
+            while(!unpack.empty()) {
+                PackedEdge curr = unpack.back();
+                unpack.pop_back();
+
+                // the via vertices of final edges created by turn restrictions
+                // are only used for geometry, they are not shortcuts
+                const CompactAdjacency &adj = curr.back_ ? back_ : forw_;
+                const CompactEdge *edge = adj.getEdge(curr.index_);
+                const CompactAdjacency::ShortcutEdges &children = adj.getShortcutEdges<Metric>(edge);
+                if(children.in_ == CompactAdjacency::NullEdgeIndex) {
+                    path.push_back(getOriginalVertex(curr.target_));
+                } else {
+                    // the edge into the middle vertex is unpacked first
+                    unpack.push_back({false, children.out_, curr.target_});
+                    unpack.push_back({true, children.in_, adj.getShortcutVia<Metric>(edge)});
+                }
+            }
+        }
     }
 
 public:
@@ -1401,30 +1661,372 @@ public:
     void importMetricsStream(T &iss) {
         LOGG(Logger::INFO) << "[NOTIFICATION] importing different metrics" << Logger::FLUSH;
 
+        // the imported times replace the ones traffic falls back to
+        std::lock_guard<std::mutex> traffic(trafficMutex_);
+        loadedTimes_.clear();
+
+        std::unordered_map<TrafficKey, TrafficInput> inputs;
         while(!iss.eof()) {
             VertexId src, dst;
             iss >> src >> dst;
             DistType meters, seconds, kmh;
             iss >> meters >> seconds >> kmh;
+            src = findInputVertex(src);
+            dst = findInputVertex(dst);
 
             if(src != dst) {
-                if(findEdgeForw(src, dst))
-                    findEdgeForw(src, dst)->setTime(seconds);
+                // the arcs of copies made for turn restrictions have the same times
+                std::pair<VertexId, VertexId> srcCopies = getTurnCopies(src), dstCopies = getTurnCopies(dst);
+                std::vector<VertexId> sources = {src}, targets = {dst};
+                for(VertexId copy = srcCopies.first; copy < srcCopies.second; copy++)
+                    sources.push_back(copy);
+                for(VertexId copy = dstCopies.first; copy < dstCopies.second; copy++)
+                    targets.push_back(copy);
+
+                for(VertexId s : sources) {
+                    for(VertexId d : targets) {
+                        OutgoingEdgeIter edgeForw = findEdgeForw(s, d);
+                        if(edgeForw)
+                            inputs[getTrafficKey(false, forw_.index(edgeForw))] = {s, Edge::EdgeTime(seconds)};
+
+                        IncomingEdgeIter edgeBack = findEdgeBack(s, d);
+                        if(edgeBack)
+                            inputs[getTrafficKey(true, back_.index(edgeBack))] = {d, Edge::EdgeTime(seconds)};
+                    }
+                }
+            }
+        }
+
+        // only the times depending on the imported ones are computed again
+        customizeTimes(inputs);
+    }
+
+    /**
+     * @brief getWeightsLock
+     * @return lock held for reading while the weights are used
+     */
+    ReadWriteLock *getWeightsLock() {
+        return &weightsLock_;
+    }
+
+    /**
+     * sets the times of the edges of the ways from their current speeds and
+     * customizes the times again. Only the weights depending on the changed
+     * edges are computed, bottom up like customize, the overlay computes all
+     * of its cliques again. Meanwhile the searches keep using the current
+     * weights
+     * @brief updateTraffic
+     * @param speeds way ids with their speeds in km/h, a speed which is not
+     * positive restores the times the edges of the way had when loaded
+     * @return number of edges whose weights changed
+     */
+    size_t updateTraffic(const std::vector<std::pair<Edge::EdgeId, double> > &speeds) {
+        typedef Edge::TimeMetric Metric;
+        typedef Metric::Metric Cost;
+        const Cost maxCost = numeric_limits<Cost>::max();
 
-                if(findEdgeBack(src, dst))
-                    findEdgeBack(src, dst)->setTime(seconds);
+        std::lock_guard<std::mutex> traffic(trafficMutex_);
+        if(!frozen_)
+            return 0;
+        if(wayEdges_.empty())
+            buildWayEdges();
+
+        // input times of the edges of the ways, the last speed of a way counts
+        std::unordered_map<TrafficKey, TrafficInput> inputs;
+        for(const std::pair<Edge::EdgeId, double> &speed : speeds) {
+            WayEdge way;
+            way.way_ = speed.first;
+            auto range = std::equal_range(wayEdges_.begin(), wayEdges_.end(), way);
+            for(auto it = range.first; it != range.second; ++it) {
+                const CompactAdjacency &adjacency = it->back_ ? back_ : forw_;
+                const CompactEdge *edge = adjacency.getEdge(it->index_);
+                TrafficKey key = getTrafficKey(it->back_, it->index_);
+                auto loaded = loadedTimes_.find(key);
+
+                Cost time = loaded != loadedTimes_.end() ? loaded->second : adjacency.getInputCost<Metric>(edge);
+                if(speed.second > 0) {
+                    double seconds = adjacency.getInputCost<Edge::DistanceMetric>(edge)*3.6/speed.second;
+                    time = Cost(std::max(1.0, std::min(std::round(seconds), double(maxCost-1))));
+                }
+                if(time != adjacency.getInputCost<Metric>(edge) && loaded == loadedTimes_.end())
+                    loadedTimes_[key] = adjacency.getInputCost<Metric>(edge);
+                inputs[key] = {it->source_, time};
             }
         }
+        return customizeTimes(inputs);
+    }
+private:
+    /**
+     * sets the input times of the edges and customizes the times depending
+     * on them again, the caller holds the traffic mutex. A search sees
+     * either all of the new weights or none
+     * @brief customizeTimes
+     * @param inputs new input times by edge
+     * @return number of edges whose weights changed
+     */
+    size_t customizeTimes(const std::unordered_map<TrafficKey, TrafficInput> &inputs) {
+        typedef Edge::TimeMetric Metric;
+        typedef Metric::Metric Cost;
+        typedef CompactAdjacency::EdgeOffset EdgeOffset;
+        const Cost maxCost = numeric_limits<Cost>::max();
 
-        for(VertexId id = 0; id < getNumVertices(); id++) {
-            for(size_t i = 0; i < edgesFrom_[id].size(); i++) {
-                DistType metric = getNewMetricRecursive(id, edgesFrom_[id][i].getNextId());
-                edgesFrom_[id][i].setTime(metric);
+        Timer timer;
+        if(hasHierarchy() && rankOrder_.empty())
+            buildLowerEdges();
+
+        // edges to compute by the rank of the vertex they are stored at,
+        // the edges they depend on are stored at lower vertices
+        typedef std::pair<VertexRank, TrafficKey> QueueEntry;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+        std::unordered_set<TrafficKey> queued;
+        std::unordered_map<TrafficKey, TrafficWeights> weights;
+
+        for(const std::pair<const TrafficKey, TrafficInput> &input : inputs) {
+            bool back = input.first & 1;
+            const CompactAdjacency &adjacency = back ? back_ : forw_;
+            if(input.second.time_ == adjacency.getInputCost<Metric>(adjacency.getEdge(input.first >> 1)))
+                continue;
+            weights[input.first].input_ = input.second.time_;
+            queued.insert(input.first);
+            queue.push(QueueEntry(hasHierarchy() ? rank_[input.second.source_] : 0, input.first));
+        }
+        size_t numInputs = weights.size();
+
+        while(!queue.empty()) {
+            VertexRank rank = queue.top().first;
+            TrafficKey key = queue.top().second;
+            queue.pop();
+
+            bool back = key & 1;
+            CompactAdjacency &adjacency = back ? back_ : forw_;
+            CompactEdge *edge = adjacency.getEdge(key >> 1);
+            auto found = weights.find(key);
+
+            TrafficWeights curr;
+            curr.input_ = found != weights.end() ? found->second.input_ : adjacency.getInputCost<Metric>(edge);
+            curr.cost_ = curr.input_;
+            curr.via_ = Vertex::NullVertexId;
+            curr.in_ = curr.out_ = CompactAdjacency::NullEdgeIndex;
+
+            // the best path through the lower triangles, the lower vertices
+            // of both ends are merged by rank, the order customize tries them
+            VertexId vert = hasHierarchy() ? rankOrder_[rank] : Vertex::NullVertexId, next = edge->getNextId();
+            VertexId from = back ? next : vert, to = back ? vert : next;
+            if(hasHierarchy()) {
+                EdgeOffset i = lowerOffsets_[1][from], j = lowerOffsets_[0][to];
+                while(i < lowerOffsets_[1][from+1] && j < lowerOffsets_[0][to+1]) {
+                    const std::pair<VertexRank, EdgeOffset> &in = lowerEdges_[1][i], &out = lowerEdges_[0][j];
+                    if(in.first != out.first) {
+                        in.first < out.first ? i++ : j++;
+                        continue;
+                    }
+                    i++, j++;
+
+                    Cost inCost = getTrafficTime(weights, true, in.second);
+                    Cost outCost = getTrafficTime(weights, false, out.second);
+                    if(inCost == maxCost || outCost == maxCost)
+                        continue;
+                    if(inCost+outCost < curr.cost_) {
+                        curr.cost_ = inCost+outCost;
+                        curr.via_ = rankOrder_[in.first];
+                        curr.in_ = in.second;
+                        curr.out_ = out.second;
+                    }
+                }
+            }
+
+            const CompactAdjacency::ShortcutEdges &children = adjacency.getShortcutEdges<Metric>(edge);
+            bool changed = curr.cost_ != edge->getCost<Metric>();
+            if(changed || curr.input_ != adjacency.getInputCost<Metric>(edge) ||
+               curr.via_ != adjacency.getShortcutVia<Metric>(edge) ||
+               curr.in_ != children.in_ || curr.out_ != children.out_) {
+                weights[key] = curr;
+            } else if(found != weights.end()) {
+                weights.erase(found);
+            }
+            if(!changed || !hasHierarchy())
+                continue;
+
+            // edges between the next vertex and the other higher neighbors
+            // go through the edge
+            CompactAdjacency &other = back ? forw_ : back_;
+            for(const CompactEdge *e = other.begin(vert); e != other.end(vert); ++e) {
+                VertexId upperFrom = back ? next : e->getNextId(), upperTo = back ? e->getNextId() : next;
+                if(upperFrom == upperTo)
+                    continue;
+
+                TrafficKey upper;
+                VertexRank upperRank;
+                if(rank_[upperFrom] < rank_[upperTo]) {
+                    upper = getTrafficKey(false, forw_.index(findEdgeForw(upperFrom, upperTo)));
+                    upperRank = rank_[upperFrom];
+                } else {
+                    upper = getTrafficKey(true, back_.index(findEdgeBack(upperFrom, upperTo)));
+                    upperRank = rank_[upperTo];
+                }
+                if(queued.insert(upper).second)
+                    queue.push(QueueEntry(upperRank, upper));
+            }
+        }
+        // the cliques of the overlay are computed from the new times
+        MultiLevelOverlay::Weights overlayWeights;
+        bool customized = hasOverlay() && !weights.empty();
+        if(customized) {
+            getForwardCosts<Metric>(overlayWeights.arcs_);
+            for(const std::pair<const TrafficKey, TrafficWeights> &entry : weights) {
+                if((entry.first & 1) == 0)
+                    overlayWeights.arcs_[entry.first >> 1] = entry.second.cost_;
             }
-            for(size_t i = 0; i < edgesTo_[id].size(); i++) {
-                DistType metric = getNewMetricRecursive(edgesTo_[id][i].getNextId(), id);
-                edgesTo_[id][i].setTime(metric);
+            customizeOverlay(overlayWeights);
+        }
+        timer.stop();
+        double computed = timer.getElapsedTimeSec();
+
+        // the new weights go to copies of the arrays while the searches
+        // read the current ones, the lock is only held to swap them. The
+        // arrays used before are released after the lock
+        CompactAdjacency::Weights forwWeights, backWeights;
+        if(!weights.empty()) {
+            forw_.copyWeights<Metric>(forwWeights);
+            back_.copyWeights<Metric>(backWeights);
+            for(const std::pair<const TrafficKey, TrafficWeights> &entry : weights) {
+                CompactAdjacency::Weights &copy = (entry.first & 1) ? backWeights : forwWeights;
+                const TrafficWeights &curr = entry.second;
+                copy.setInputCost<Metric>(entry.first >> 1, curr.input_);
+                copy.setShortcut<Metric>(entry.first >> 1, curr.cost_, curr.via_, curr.in_, curr.out_);
             }
+
+            ReadWriteLock::WriteLock lock(&weightsLock_);
+            if(customized)
+                overlay_.setWeights(Metric::Index, overlayWeights);
+            forw_.swapWeights<Metric>(forwWeights);
+            back_.swapWeights<Metric>(backWeights);
+        }
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[TRAFFIC] " << numInputs << " edges, "
+                           << weights.size() << " weights changed, computed in " << computed
+                           << " total " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return weights.size();
+    }
+    /**
+     * @brief getTrafficKey
+     * @param back
+     * @param index
+     * @return
+     */
+    static TrafficKey getTrafficKey(bool back, CompactAdjacency::EdgeOffset index) {
+        return (TrafficKey(index) << 1) | TrafficKey(back);
+    }
+
+    /**
+     * time of the edge, the weights computed by the update come first
+     * @brief getTrafficTime
+     * @param weights
+     * @param back
+     * @param index
+     * @return
+     */
+    Edge::EdgeTime getTrafficTime(const std::unordered_map<TrafficKey, TrafficWeights> &weights,
+                                  bool back, CompactAdjacency::EdgeOffset index) const {
+        auto found = weights.find(getTrafficKey(back, index));
+        if(found != weights.end())
+            return found->second.cost_;
+        return (back ? back_ : forw_).getEdge(index)->getCost<Edge::TimeMetric>();
+    }
+
+    /**
+     * indexes the edges of the input by their ways, the shortcuts added
+     * by preprocessing don't belong to a way
+     * @brief buildWayEdges
+     */
+    void buildWayEdges() {
+        wayEdges_.clear();
+        for(VertexId id = 0; id < (VertexId)forw_.getNumVertices(); id++) {
+            for(int back = 0; back < 2; back++) {
+                const CompactAdjacency &adjacency = back ? back_ : forw_;
+                for(const CompactEdge *edge = adjacency.begin(id); edge != adjacency.end(id); ++edge) {
+                    if((edge->getType() & Edge::CREATED_ON_PREPROCESSING) == 0 &&
+                       adjacency.getOrigId(edge) != Edge::NullEdgeId) {
+                        WayEdge way = {adjacency.getOrigId(edge), back != 0, adjacency.index(edge), id};
+                        wayEdges_.push_back(way);
+                    }
+                }
+            }
+        }
+        std::stable_sort(wayEdges_.begin(), wayEdges_.end());
+        wayEdges_.shrink_to_fit();
+    }
+
+    /**
+     * @brief buildLowerEdges
+     */
+    void buildLowerEdges() {
+        rankOrder_ = getRankOrder();
+        for(int back = 0; back < 2; back++) {
+            const CompactAdjacency &adjacency = back ? back_ : forw_;
+            std::vector<CompactAdjacency::EdgeOffset> &offsets = lowerOffsets_[back];
+            offsets.assign(adjacency.getNumVertices()+1, 0);
+            for(VertexId id = 0; id < (VertexId)adjacency.getNumVertices(); id++) {
+                for(const CompactEdge *edge = adjacency.begin(id); edge != adjacency.end(id); ++edge)
+                    offsets[edge->getNextId()+1]++;
+            }
+            for(size_t i = 1; i < offsets.size(); i++)
+                offsets[i] += offsets[i-1];
+
+            std::vector<CompactAdjacency::EdgeOffset> pos(offsets.begin(), offsets.end()-1);
+            lowerEdges_[back].resize(offsets.back());
+            for(VertexRank rank = 0; rank < (VertexRank)rankOrder_.size(); rank++) {
+                VertexId id = rankOrder_[rank];
+                for(const CompactEdge *edge = adjacency.begin(id); edge != adjacency.end(id); ++edge)
+                    lowerEdges_[back][pos[edge->getNextId()]++] = std::make_pair(rank, adjacency.index(edge));
+            }
+        }
+    }
+public:
+    /**
+     * second phase of a one to all search (PHAST). The distances found by
+     * the upward search are final for the highest vertex, going down in rank
+     * every vertex takes the best of the edges coming from higher vertices.
+     * The vertices are swept by their position in the rank order, so the
+     * distances of the higher vertices are read from the front of the array.
+     * Without a hierarchy the upward search is a complete Dijkstra search
+     * and there is nothing to sweep
+     * @brief sweepDownward
+     * @param upward vertices settled by the upward search with their distances
+     * @param dist distances to the vertices of the input, -1 if unreachable
+     */
+    template<typename Metric>
+    void sweepDownward(const std::vector<pair<VertexId, DistType> > &upward, std::vector<DistType> &dist) const {
+        const DistType maxDist = numeric_limits<DistType>::max();
+        size_t numVertices = getNumVertices();
+        bool sweep = !sweepOrder_.empty();
+
+        std::vector<DistType> sweepDist(numVertices, maxDist);
+        for(const pair<VertexId, DistType> &settled : upward) {
+            VertexId pos = sweep ? numVertices-1-rank_[settled.first] : settled.first;
+            sweepDist[pos] = settled.second;
+        }
+
+        for(size_t pos = 0; sweep && pos < numVertices; pos++) {
+            VertexId id = sweepOrder_[pos];
+            DistType best = sweepDist[pos];
+            const VertexId *source = sweepSource_.data()+back_.offset(id);
+            for(IncomingEdgeIter it = back_.begin(id); it != back_.end(id); ++it, ++source) {
+                DistType sourceDist = sweepDist[*source];
+                if(sourceDist != maxDist && sourceDist+it->getCost<Metric>() < best)
+                    best = sourceDist+it->getCost<Metric>();
+            }
+            sweepDist[pos] = best;
+        }
+
+        // copies made for turn restrictions are reported as their vertices
+        dist.assign(numVertices-turnCopyOf_.size(), -1);
+        for(size_t id = 0; id < numVertices; id++) {
+            DistType d = sweepDist[sweep ? numVertices-1-rank_[id] : id];
+            VertexId orig = getOriginalVertex(id);
+            if(d != maxDist && (dist[orig] == -1 || d < dist[orig]))
+                dist[orig] = d;
         }
     }
     //--------------------------------------------------------------------------
@@ -1459,6 +2061,56 @@ public:
         return numVertices_;
     }
 
+    /**
+     * the vertex a copy made for turn restrictions was made from, other
+     * vertices are returned as they are
+     * @brief getOriginalVertex
+     * @param id
+     * @return
+     */
+    VertexId getOriginalVertex(VertexId id) const {
+        VertexId numInput = numVertices_-turnCopyOf_.size();
+        if(id == Vertex::NullVertexId || id < numInput)
+            return id;
+        return turnCopyOf_[id-numInput];
+    }
+
+    /**
+     * the id a vertex of the input has in the input file, other vertices
+     * are returned as they are
+     * @brief getInputId
+     * @param id
+     * @return
+     */
+    VertexId getInputId(VertexId id) const {
+        if(id < 0 || size_t(id) >= inputIdOf_.size())
+            return id;
+        return inputIdOf_[id];
+    }
+
+    /**
+     * @brief findInputVertex
+     * @param inputId id of a vertex in the input file
+     * @return the vertex with the id
+     */
+    VertexId findInputVertex(VertexId inputId) const {
+        if(inputId < 0 || size_t(inputId) >= vertexOfInputId_.size())
+            return inputId;
+        return vertexOfInputId_[inputId];
+    }
+
+    /**
+     * copies of the vertex made for turn restrictions
+     * @brief getTurnCopies
+     * @param id
+     * @return the range of the ids of the copies
+     */
+    std::pair<VertexId, VertexId> getTurnCopies(VertexId id) const {
+        VertexId numInput = numVertices_-turnCopyOf_.size();
+        auto range = equal_range(turnCopyOf_.begin(), turnCopyOf_.end(), id);
+        return {numInput+(range.first-turnCopyOf_.begin()), numInput+(range.second-turnCopyOf_.begin())};
+    }
+
     /**
      * @brief getVertexRank
      * @param v
@@ -1484,7 +2136,7 @@ public:
      * @return
      */
     size_t getVertexDegree(VertexId id) const {
-        return edgesTo_[id].size()+edgesFrom_[id].size();
+        return numIncomingEdges(id)+numOutGoingEdges(id);
     }
 
     /**
@@ -1493,8 +2145,8 @@ public:
      * @param v
      * @return
      */
-    OutgoingEdgeIter getOutgoingIterBegin(const Vertex &v) {
-        return edgesFrom_[v.getId()].begin();
+    OutgoingEdgeIter getOutgoingIterBegin(const Vertex &v) const {
+        return forw_.begin(v.getId());
     }
 
     /**
@@ -1502,8 +2154,8 @@ public:
      * @param v
      * @return
      */
-    OutgoingEdgeIter getOutgoingIterEnd(const Vertex &v) {
-        return edgesFrom_[v.getId()].end();
+    OutgoingEdgeIter getOutgoingIterEnd(const Vertex &v) const {
+        return forw_.end(v.getId());
     }
 
     /**
@@ -1512,8 +2164,8 @@ public:
      * @param v
      * @return
      */
-    IncomingEdgeIter getIncomingIterBegin(const Vertex &v) {
-        return edgesTo_[v.getId()].begin();
+    IncomingEdgeIter getIncomingIterBegin(const Vertex &v) const {
+        return back_.begin(v.getId());
     }
 
     /**
@@ -1521,8 +2173,46 @@ public:
      * @param v
      * @return
      */
-    IncomingEdgeIter getIncomingIterEnd(const Vertex &v) {
-        return edgesTo_[v.getId()].end();
+    IncomingEdgeIter getIncomingIterEnd(const Vertex &v) const {
+        return back_.end(v.getId());
+    }
+
+    /**
+     * get outgoing edges while the graph is modified
+     * @brief getOutgoingMutableIterBegin
+     * @param v
+     * @return
+     */
+    MutableOutgoingEdgeIter getOutgoingMutableIterBegin(const Vertex &v) {
+        return edgesFrom_[v.getId()].data();
+    }
+
+    /**
+     * @brief getOutgoingMutableIterEnd
+     * @param v
+     * @return
+     */
+    MutableOutgoingEdgeIter getOutgoingMutableIterEnd(const Vertex &v) {
+        return edgesFrom_[v.getId()].data()+edgesFrom_[v.getId()].size();
+    }
+
+    /**
+     * get incoming edges while the graph is modified
+     * @brief getIncomingMutableIterBegin
+     * @param v
+     * @return
+     */
+    MutableIncomingEdgeIter getIncomingMutableIterBegin(const Vertex &v) {
+        return edgesTo_[v.getId()].data();
+    }
+
+    /**
+     * @brief getIncomingMutableIterEnd
+     * @param v
+     * @return
+     */
+    MutableIncomingEdgeIter getIncomingMutableIterEnd(const Vertex &v) {
+        return edgesTo_[v.getId()].data()+edgesTo_[v.getId()].size();
     }
 
     /**
@@ -1531,6 +2221,8 @@ public:
      * @return
      */
     size_t numOutGoingEdges(VertexId id) const {
+        if(frozen_)
+            return forw_.degree(id);
         return edgesFrom_[id].size();
     }
 
@@ -1540,6 +2232,8 @@ public:
      * @return
      */
     size_t numIncomingEdges(VertexId id) const {
+        if(frozen_)
+            return back_.degree(id);
         return edgesTo_[id].size();
     }
 
@@ -1551,34 +2245,69 @@ public:
      * @return
      */
     VertexId getViaForEdge(const Vertex &from, const Vertex &to) {
-        EdgeForw *edgeForw = findEdgeForw(from.getId(), to.getId());
+        ReadWriteLock::ReadLock lock(&weightsLock_);
+        VertexId target = findArcTarget(from.getId(), to.getId());
+        OutgoingEdgeIter edgeForw = findEdgeForw(from.getId(), target);
         if(edgeForw == 0) {
-            EdgeBack *edgeBack = findEdgeBack(from.getId(), to.getId());
+            IncomingEdgeIter edgeBack = findEdgeBack(from.getId(), target);
             assert(edgeBack != 0);
-            return edgeBack->getVia();
+            return back_.getVia(edgeBack);
         } else {
-            return edgeForw->getVia();
+            return forw_.getVia(edgeForw);
         }
     }
 
     /**
-     * find nearest point using kd-tree datastructure
+     * find nearest point on the edges if the segment index was built. The
+     * point is then the projection on the closest edge and the result has
+     * its offset, the target id is the input id of the end of the edge
+     * closer to it. Otherwise the nearest point of the kd trees is found,
+     * in the in memory index if it was built and the sql trees otherwise
      * @brief findNearestPointKdTree
      * @param pt
      * @return
      */
     bool findNearestPointKdTree(const Point &pt, NearestPointResult &result) {
-        // search in endpoints kdTree
-        std::string endPtData;
-        NearestPointResult rEndPt;
-        if(!kdTreeEndPt_.findNearestVertex(pt, rEndPt, endPtData)) {
-            return false;
+        if(!segmentIndex_.empty()) {
+            SegmentIndex::Snap snap;
+            if(!segmentIndex_.findNearest(pt, snap))
+                return false;
+
+            // a projection on an end of the edge is at the vertex
+            VertexId start = snap.start_, end = snap.end_;
+            if(snap.offset_ <= 0)
+                end = start;
+            else if(snap.offset_ >= 1)
+                start = end;
+            VertexId closer = snap.offset_ < 0.5 ? start : end;
+            result.setTarget(VertexPoint(getInputId(closer), snap.point_.lat(), snap.point_.lon()));
+            result.setStartId(start);
+            result.setEndId(end);
+            result.setOffset(start == end ? -1 : snap.offset_);
+            return true;
         }
-        // search in non endpoints
-        std::string nonEndPtData;
-        NearestPointResult rNonEndPt;
-        if(!kdTreeNonEndPt_.findNearestVertex(pt, rNonEndPt, nonEndPtData)) {
-            return false;
+        if(!snapIndex_.empty()) {
+            SnapIndex::Target target;
+            if(!snapIndex_.findNearest(pt, target))
+                return false;
+            result.setTarget(VertexPoint(target.id_, target.getPoint().lat(), target.getPoint().lon()));
+            result.setStartId(findInputVertex(target.start_));
+            result.setEndId(findInputVertex(target.end_));
+            return true;
+        }
+
+        std::string endPtData, nonEndPtData;
+        NearestPointResult rEndPt, rNonEndPt;
+        {
+            std::lock_guard<std::mutex> lock(kdTreeMutex_);
+            // search in endpoints kdTree
+            if(!kdTreeEndPt_.findNearestVertex(pt, rEndPt, endPtData)) {
+                return false;
+            }
+            // search in non endpoints
+            if(!kdTreeNonEndPt_.findNearestVertex(pt, rNonEndPt, nonEndPtData)) {
+                return false;
+            }
         }
         std::vector<Point> pts = {rEndPt.getTarget().getPoint(), rNonEndPt.getTarget().getPoint()};
         std::vector<std::string> ptData = {endPtData, nonEndPtData};
@@ -1587,13 +2316,14 @@ public:
 
         result.setTarget(res[cId].getTarget());
 
+        // the kd trees have the ids of the input
         if (ptData[cId] != "") {
             SimpleTokenator st(ptData[cId], ' ', '\"', true);
-            result.setStartId(lexical_cast<Vertex::VertexId>(st.nextToken()));
-            result.setEndId(lexical_cast<Vertex::VertexId>(st.nextToken()));
+            result.setStartId(findInputVertex(lexical_cast<Vertex::VertexId>(st.nextToken())));
+            result.setEndId(findInputVertex(lexical_cast<Vertex::VertexId>(st.nextToken())));
         } else {
-            result.setStartId(result.getTarget().getId());
-            result.setEndId(result.getTarget().getId());
+            result.setStartId(findInputVertex(result.getTarget().getId()));
+            result.setEndId(findInputVertex(result.getTarget().getId()));
         }
         return true;
     }
@@ -1610,6 +2340,19 @@ public:
      */
     bool findGeometryForEdge(const VertexId source, const VertexId dest,
                              Point target, std::vector<Point> &geometry) {
+        // a traffic update copies the edges it changes
+        ReadWriteLock::ReadLock lock(&weightsLock_);
+        return findEdgeGeometry(source, dest, target, true, geometry);
+    }
+
+    /**
+     * the geometry of the edge from the geometry store, from the sqlite
+     * index if the store doesn't have it and useIndex is set. Without
+     * either an edge is a straight line. The caller holds the weights lock
+     * @brief findEdgeGeometry
+     */
+    bool findEdgeGeometry(const VertexId source, const VertexId dest, const Point &target,
+                          bool useIndex, std::vector<Point> &geometry) {
         bool ret = true;
         Vertex ver1 = findVertex(source), ver2 = findVertex(dest);
         if(ver1.getId() != Vertex::NullVertexId && ver2.getId() != Vertex::NullVertexId) {
@@ -1622,10 +2365,14 @@ public:
             } else {
                 geometry = {getPoint(ver1)};
 
-                // use sqlite index to index find edge geometry
+                // use the geometry store if there is one, the sqlite index otherwise
                 bool oneWay = type & Edge::ONE_WAY;
-                if(!indexGeometry_.findGeometry(ver1.getId(), ver2.getId(), target, oneWay, geometry))
-                    ret = false;
+                VertexId id1 = getInputId(getOriginalVertex(ver1.getId()));
+                VertexId id2 = getInputId(getOriginalVertex(ver2.getId()));
+                if(!geometryStore_.findGeometry(id1, id2, target, oneWay, geometry) && useIndex) {
+                    std::lock_guard<std::mutex> lock(geometryMutex_);
+                    ret = indexGeometry_.findGeometry(id1, id2, target, oneWay, geometry);
+                }
                 geometry.push_back(getPoint(ver2));
             }
         }
@@ -1640,37 +2387,74 @@ public:
      */
     bool findOrigWayId(VertexId s, VertexId d, Edge::EdgeId &origId) {
         // after preprocessing edges in low to high rank direction are removed
-        // so we try every possible option
-        bool good = false;
-        {
-            EdgeForw *edge = findEdgeForw(s, d);
-            if(edge != 0) {
-                origId = edge->getOrigId();
-                good = true;
+        // so we try every possible option, the edge from s to d first. Edges
+        // added by contraction don't belong to a way
+        ReadWriteLock::ReadLock lock(&weightsLock_);
+        VertexId sd = findArcTarget(s, d), ds = findArcTarget(d, s);
+        std::pair<const CompactAdjacency *, const CompactEdge *> edges[] = {
+            {&forw_, findEdgeForw(s, sd)}, {&back_, findEdgeBack(s, sd)},
+            {&forw_, findEdgeForw(d, ds)}, {&back_, findEdgeBack(d, ds)}
+        };
+        for(const auto &edge : edges) {
+            if(edge.second != 0 && (edge.second->getType() & Edge::CREATED_ON_PREPROCESSING) == 0) {
+                origId = edge.first->getOrigId(edge.second);
+                return true;
             }
         }
-        {
-            EdgeForw *edge = findEdgeForw(d, s);
-            if(edge != 0) {
-                origId = edge->getOrigId();
-                good = true;
-            }
-        }
-        {
-            EdgeBack *edge = findEdgeBack(s, d);
-            if(edge != 0) {
-                origId = edge->getOrigId();
-                good = true;
-            }
-        }
-        {
-            EdgeBack *edge = findEdgeBack(d, s);
-            if(edge != 0) {
-                origId = edge->getOrigId();
-                good = true;
-            }
-        }
-        return good;
+        return false;
+    }
+
+    /**
+     * weight the arc from s to d of a path had in the input
+     * @brief findArcCost
+     * @param s
+     * @param d
+     * @return the weight, max if there is no such arc
+     */
+    template<typename Metric>
+    typename Metric::Metric findArcCost(VertexId s, VertexId d) {
+        ReadWriteLock::ReadLock lock(&weightsLock_);
+        VertexId sd = findArcTarget(s, d);
+        OutgoingEdgeIter edgeForw = findEdgeForw(s, sd);
+        if(edgeForw != 0 && (edgeForw->getType() & Edge::CREATED_ON_PREPROCESSING) == 0)
+            return forw_.getInputCost<Metric>(edgeForw);
+        IncomingEdgeIter edgeBack = findEdgeBack(s, sd);
+        if(edgeBack != 0 && (edgeBack->getType() & Edge::CREATED_ON_PREPROCESSING) == 0)
+            return back_.getInputCost<Metric>(edgeBack);
+        return numeric_limits<typename Metric::Metric>::max();
+    }
+
+    /**
+     * length of the path along the edge both ends of the search lie on
+     * @brief findDirectCost
+     * @param initConfig
+     * @return the length, max if the ends are on different edges, their
+     * offsets aren't known or the edge can't be followed between them
+     */
+    template<typename Metric>
+    DistType findDirectCost(const AlgorithmInit &initConfig) {
+        NearestPointResult src = initConfig.getSrcSearchResult(), dst = initConfig.getDstSearchResult();
+        if(src.isEndPoint() || dst.isEndPoint() || src.getOffset() < 0 || dst.getOffset() < 0)
+            return numeric_limits<DistType>::max();
+        if(src.getSrc().getId() != dst.getSrc().getId() || src.getDst().getId() != dst.getDst().getId()) {
+            dst = dst.reverse();
+            if(src.getSrc().getId() != dst.getSrc().getId() || src.getDst().getId() != dst.getDst().getId())
+                return numeric_limits<DistType>::max();
+        }
+
+        // one way edges are followed from their source
+        VertexId s = src.getSrc().getId(), d = src.getDst().getId();
+        double part = dst.getOffset()-src.getOffset();
+        if(part < 0) {
+            if(initConfig.getSrcEdgeType() & Edge::ONE_WAY)
+                return numeric_limits<DistType>::max();
+            std::swap(s, d);
+            part = -part;
+        }
+        typename Metric::Metric cost = findArcCost<Metric>(s, d);
+        if(cost == numeric_limits<typename Metric::Metric>::max())
+            return numeric_limits<DistType>::max();
+        return DistType(llround(part*cost));
     }
 
     /**
@@ -1721,35 +2505,44 @@ public:
      * @brief pruneEdgesRank
      */
     void pruneEdgesRank() {
-        LOGG(Logger::INFO) << "[NOTIFICATION] pruning edges and ranks" << Logger::FLUSH;
+        LOGG(Logger::INFO) << "[NOTIFICATION] pruning edges" << Logger::FLUSH;
+        assert(frozen_);
+
+        size_t edgesCounter = forw_.getNumEdges()+back_.getNumEdges();
+        auto keep = [this](VertexId id, const CompactEdge &edge) {
+            return getVertexRank(id) <= getVertexRank(edge.getNextId());
+        };
+        forw_.prune(keep);
+        back_.prune(keep);
+        size_t prunedEdgesCounter = edgesCounter-forw_.getNumEdges()-back_.getNumEdges();
+
+        // ranks are kept, customization processes vertices in their order
+        LOGG(Logger::INFO) << "[NOTIFICATION] pruned " << 100.0*(double)prunedEdgesCounter/(double)edgesCounter << "% edges" << Logger::FLUSH;
+    }
 
-        size_t prunedEdgesCounter = 0, edgesCounter = 0;
-        for(VertexId id = 0; id < getNumVertices(); id++) {
-            std::vector<EdgeForw> tmpForwEdges;
-            for(size_t j = 0; j < edgesFrom_[id].size(); j++) {
-                if(getVertexRank(id) <= getVertexRank(edgesFrom_[id][j].getNextId())) {
-                    tmpForwEdges.push_back(edgesFrom_[id][j]);
-                }
-            }
-            edgesCounter += edgesFrom_[id].size();
-            prunedEdgesCounter += edgesFrom_[id].size()-tmpForwEdges.size();
-            edgesFrom_[id].swap(tmpForwEdges);
-
-            std::vector<EdgeBack> tmpBackEdges;
-            for(size_t j = 0; j < edgesTo_[id].size(); j++) {
-                if(getVertexRank(id) <= getVertexRank(edgesTo_[id][j].getNextId())) {
-                    tmpBackEdges.push_back(edgesTo_[id][j]);
-                }
-            }
-            edgesCounter += edgesTo_[id].size();
-            prunedEdgesCounter += edgesTo_[id].size()-tmpBackEdges.size();
-            edgesTo_[id].swap(tmpBackEdges);
-        }
+    /**
+     * moves per vertex edge vectors into the compact read only adjacency
+     * @brief freezeEdges
+     */
+    void freezeEdges() {
+        if(frozen_)
+            return;
+        forw_.build(edgesFrom_, getNumVertices());
+        back_.build(edgesTo_, getNumVertices());
+        frozen_ = true;
+    }
 
-        // destroy rank information
-        releaseMemory(ranked_);
-        releaseMemory(rank_);
-        LOGG(Logger::INFO) << "[NOTIFICATION] pruned " << 100.0*(double)prunedEdgesCounter/(double)edgesCounter << "% edges" << Logger::FLUSH;
+    /**
+     * moves compact adjacency back to per vertex edge vectors, so that edges can be added
+     * @brief thawEdges
+     */
+    void thawEdges() {
+        if(!frozen_)
+            return;
+        forw_.expand(edgesFrom_);
+        back_.expand(edgesTo_);
+        graphFile_.close();
+        frozen_ = false;
     }
 
     /**
@@ -1773,492 +2566,769 @@ public:
     }
 
     /**
-     * see if we already processed this pair
-     * @brief findWitness
-     * @param from
-     * @return
+     * number of threads used by preprocessing, 0 uses all available cores
+     * @brief setNumThreads
+     * @param numThreads
      */
-    DistType findWitness(VertexId from, VertexId to) {
-        auto it = oneHopWitness_[from].find(to);
-        if(it != oneHopWitness_[from].end())
-            return it->second;
-        return numeric_limits<DistType>::max();
+    void setNumThreads(size_t numThreads) {
+        if(numThreads == 0)
+            numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        numThreads_ = numThreads;
     }
 
-    typedef std::vector<SearchResultLocal> LocalDijkstraSearchResult;
-    typedef std::vector<std::vector<bool> > DijstraStarted;
-    typedef std::vector<std::vector<DistType> > NewDistanceMap;
+    /**
+     * @brief getNumThreads
+     * @return
+     */
+    size_t getNumThreads() const {
+        return numThreads_;
+    }
 
     /**
-     * @brief recalculateParameters
+     * picks the landmarks and computes their distances in every metric,
+     * the result is stored next to the input file and used by A*. The
+     * landmarks are computed on the input graph, not on the hierarchy
+     * @brief preprocessLandmarks
+     * @param numLandmarks
+     * @return
      */
-    void recalculateParameters(const Vertex &currVert,
-                               const DijstraStarted &wasDijkstaStarted,
-                               const LocalDijkstraSearchResult &searchResult,
-                               const NewDistanceMap &newDistances,
-                               size_t &shortcutsCreated, size_t &totalSearchSpace) {
-        auto itInBegin = getIncomingIterBegin(currVert);
-        auto itInEnd = getIncomingIterEnd(currVert);
+    bool preprocessLandmarks(size_t numLandmarks = 16) {
+        if(hasHierarchy()) {
+            LOGG(Logger::ERROR) << "[PREPROCESSING ALT] landmarks are computed before the graph is contracted" << Logger::FLUSH;
+            return false;
+        }
 
-        for(int i = 0; itInBegin != itInEnd; ++itInBegin, i++) {
-            if(ranked_[itInBegin->getNextId()]) break;
+        Timer timer;
+        Landmarks::Adjacency forw, back;
+        for(size_t id = 0; id < getNumVertices(); id++) {
+            forw.offsets_.push_back(forw.arcs_.size());
+            back.offsets_.push_back(back.arcs_.size());
+            for(OutgoingEdgeIter it = getOutgoingIterBegin(id); it != getOutgoingIterEnd(id); ++it)
+                forw.arcs_.push_back({it->getNextId(), {it->getCost<Edge::DistanceMetric>(), it->getCost<Edge::TimeMetric>()}});
+            for(IncomingEdgeIter it = getIncomingIterBegin(id); it != getIncomingIterEnd(id); ++it)
+                back.arcs_.push_back({it->getNextId(), {it->getCost<Edge::DistanceMetric>(), it->getCost<Edge::TimeMetric>()}});
+        }
+        forw.offsets_.push_back(forw.arcs_.size());
+        back.offsets_.push_back(back.arcs_.size());
+
+        // copies made for turn restrictions are not picked
+        landmarks_.selectLandmarks(forw, getNumVertices()-turnCopyOf_.size(), numLandmarks);
+
+        // one search per landmark, metric and direction
+        size_t numSearches = 2*Edge::NUM_METRICS;
+        runParallel(landmarks_.getNumLandmarks()*numSearches, [&](size_t i, size_t) {
+            size_t landmark = i/numSearches, metric = i%numSearches/2;
+            bool backward = i%2 == 1;
+            landmarks_.computeDistances(landmark, metric, backward, backward ? back : forw);
+        });
 
-            totalSearchSpace += searchResult[i].getSearchSpace();
+        timer.stop();
+        LOGG(Logger::INFO) << "[PREPROCESSING ALT] landmarks done in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return landmarks_.save(inputFilename_+".landmarks");
+    }
 
-            auto itOutBegin = getOutgoingIterBegin(currVert);
-            auto itOutEnd = getOutgoingIterEnd(currVert);
+    /**
+     * partitions the graph for the overlay and customizes every metric. The
+     * copies made for turn restrictions are placed at the vertex they were
+     * copied from
+     * @brief buildOverlay
+     * @param cellSize most vertices a cell of the first level has
+     * @param levelBits every level has 2^levelBits times fewer cells than the one below
+     * @param maxLevels
+     * @return false if the graph fits into one cell, it is searched by Dijkstra then
+     */
+    bool buildOverlay(size_t cellSize = 256, size_t levelBits = 3, size_t maxLevels = 4) {
+        Timer timer;
+        std::vector<Point> points(getNumVertices());
+        std::vector<MultiLevelOverlay::EdgeOffset> offsets(1, 0);
+        std::vector<VertexId> targets;
+        targets.reserve(forw_.getNumEdges());
+        for(size_t id = 0; id < getNumVertices(); id++) {
+            points[id] = getPoint(Vertex(getOriginalVertex(id)));
+            for(OutgoingEdgeIter it = getOutgoingIterBegin(id); it != getOutgoingIterEnd(id); ++it)
+                targets.push_back(it->getNextId());
+            offsets.push_back(targets.size());
+        }
+
+        overlay_.build(points, offsets, targets, cellSize, levelBits, maxLevels);
+        if(overlay_.empty()) {
+            LOGG(Logger::WARNING) << "[OVERLAY] the graph fits into one cell, it is searched without the overlay" << Logger::FLUSH;
+            return false;
+        }
 
-            for(int j = 0; itOutBegin != itOutEnd; ++itOutBegin, j++) {
-                // check if dest vertex is not ranked
-                if(ranked_[itOutBegin->getNextId()]) break;
+        MultiLevelOverlay::Weights weights;
+        getForwardCosts<Edge::DistanceMetric>(weights.arcs_);
+        customizeOverlay(weights);
+        overlay_.setWeights(Edge::DistanceMetric::Index, weights);
+        getForwardCosts<Edge::TimeMetric>(weights.arcs_);
+        customizeOverlay(weights);
+        overlay_.setWeights(Edge::TimeMetric::Index, weights);
 
-                // dijkstra was started
-                if(wasDijkstaStarted[i][j]) {
-                    if(searchResult[i].getTargetDistFor(itOutBegin->getNextId()) > newDistances[i][j]) {
-                        shortcutsCreated++;
-                    }
-                }
-                // dijkstra wasn't started only because we saw this edge already or
-                // edge was already there and it wasn't updated
-                else {
-                    if(findWitness(itInBegin->getNextId(), itOutBegin->getNextId()) == newDistances[i][j]) {
-                        shortcutsCreated++;
-                    }
-                }
-            }
-        }
+        timer.stop();
+        LOGG(Logger::INFO) << "[OVERLAY] built in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return true;
     }
 
     /**
-     * @brief createForwardEdges
+     * indexes the geometries of the edges of the input for snapping. A pair
+     * of vertices is added once, in the direction of its edge if it is one
+     * way. The copies made for turn restrictions are snapped to as the
+     * vertex they were copied from. Geometries are only read from the
+     * geometry store, querying the sqlite index for every edge would make
+     * loading slower than the searches it saves
+     * @brief buildSegmentIndex
+     * @return false if there is no geometry store or no edges
      */
-    void createForwardEdges(const Vertex &currVert,
-                            const DijstraStarted &wasDijkstaStarted,
-                            const LocalDijkstraSearchResult &searchResult,
-                            const NewDistanceMap &newDistances) {
-        std::vector<std::thread> threads;
+    bool buildSegmentIndex() {
+        Timer timer;
+        segmentIndex_.clear();
+        if(geometryStore_.empty())
+            return false;
 
-        // merge forward edges
-        std::vector<std::vector<EdgeForw> > newForwEdges(edgesTo_[currVert.getId()].size(),
-                                              std::vector<EdgeForw>());
-
-        auto itInBegin = getIncomingIterBegin(currVert);
-        auto itInEnd = getIncomingIterEnd(currVert);
-
-        for(int i = 0; itInBegin != itInEnd; ++itInBegin, i++) {
-            VertexId toId = itInBegin->getNextId();
-            if(ranked_[toId]) break;
-
-            auto itOutBegin = getOutgoingIterBegin(currVert);
-            auto itOutEnd = getOutgoingIterEnd(currVert);
-
-            for(int j = 0; itOutBegin != itOutEnd; ++itOutBegin, j++) {
-                VertexId fromId = itOutBegin->getNextId();
-                if(isRanked(fromId)) break;
-
-                //check if dest vertex is not ranked
-                if(fromId != toId) {
-                    // dijkstra was started, hence we
-                    if(wasDijkstaStarted[i][j]) {
-                        if (searchResult[i].getTargetDistFor(fromId) > newDistances[i][j]) {
-                            Vertex to = itOutBegin->getNext();
-                            EdgeForw edgFrom(to, newDistances[i][j], newDistances[i][j], currVert.getId(),
-                                             Edge::CREATED_ON_PREPROCESSING);
-                            newForwEdges[i].push_back(edgFrom);
-                            edgesAdded_++;
-
-                            // update witness
-                            oneHopWitness_[toId][fromId] = newDistances[i][j];
-                        }
-                    } else {
-                        // saw this edge already
-                        DistType witness = findWitness(itInBegin->getNextId(), itOutBegin->getNextId());
-                        if(witness == newDistances[i][j]) {
-                            Vertex to = itOutBegin->getNext();
-                            EdgeForw edgFrom(to, witness, witness, currVert.getId(), Edge::CREATED_ON_PREPROCESSING);
-                            newForwEdges[i].push_back(edgFrom);
-                            edgesAdded_++;
-                        }
-                    }
-                }
+        std::vector<std::pair<VertexId, VertexId> > arcs;
+        for(size_t id = 0; id < getNumVertices(); id++) {
+            for(OutgoingEdgeIter it = getOutgoingIterBegin(id); it != getOutgoingIterEnd(id); ++it) {
+                if((it->getType() & Edge::CREATED_ON_PREPROCESSING) == 0)
+                    arcs.push_back({getOriginalVertex(id), getOriginalVertex(it->getNextId())});
             }
-            Vertex from = itInBegin->getNext();
-            threads.push_back(std::thread(std::bind(&AdjacencyList::mergeEdgeForwSequences, this,
-                                                    from.getId(), std::ref(newForwEdges[i]))));
+            for(IncomingEdgeIter it = getIncomingIterBegin(id); it != getIncomingIterEnd(id); ++it) {
+                if((it->getType() & Edge::CREATED_ON_PREPROCESSING) == 0)
+                    arcs.push_back({getOriginalVertex(it->getNextId()), getOriginalVertex(id)});
+            }
+        }
+        sort(arcs.begin(), arcs.end());
+        arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
+
+        // arcs which leave a copy can't be found from the vertex
+        auto valid = [this](const std::pair<VertexId, VertexId> &arc) {
+            return arc.first != arc.second && hasInputEdge(arc.first, findArcTarget(arc.first, arc.second));
+        };
+        ReadWriteLock::ReadLock lock(&weightsLock_);
+        std::vector<Point> geometry;
+        for(const std::pair<VertexId, VertexId> &arc : arcs) {
+            if(!valid(arc))
+                continue;
+            std::pair<VertexId, VertexId> back(arc.second, arc.first);
+            if(arc.first > arc.second && binary_search(arcs.begin(), arcs.end(), back) && valid(back))
+                continue;
+
+            geometry.clear();
+            findEdgeGeometry(arc.first, arc.second, getPoint(arc.first), false, geometry);
+            segmentIndex_.add(arc.first, arc.second, geometry);
         }
-        for(int j=0;j<(int)threads.size();++j)
-            threads[j].join();
+        segmentIndex_.build();
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[SEGMENT INDEX] " << segmentIndex_.getNumSegments() << " segments in "
+                           << timer.getElapsedTimeSec() << " sec, " << segmentIndex_.getMemoryInfo()/1048576.0
+                           << " MB" << Logger::FLUSH;
+        return !segmentIndex_.empty();
     }
 
     /**
-     * @brief createBackwardEdges
+     * copies the geometry index into a geometry store stored next to the
+     * input file, route geometries are then read from memory
+     * @brief preprocessGeometry
+     * @return
      */
-    void createBackwardEdges(const Vertex &currVert,
-                             const DijstraStarted &wasDijkstaStarted,
-                             const LocalDijkstraSearchResult &searchResult,
-                             const NewDistanceMap &newDistances) {
-        std::vector<std::thread> threads;
-
-        // merge backward edges
-        std::vector<std::vector<EdgeBack> > newBackEdges(edgesFrom_[currVert.getId()].size(),
-                                               std::vector<EdgeBack>());
-
-        auto itOutBegin = getOutgoingIterBegin(currVert);
-        auto itOutEnd = getOutgoingIterEnd(currVert);
-
-        for(int j = 0; itOutBegin != itOutEnd; ++itOutBegin, j++) {
-            // check if src vertex is not ranked
-            VertexId fromId = itOutBegin->getNextId();
-            if(ranked_[fromId]) break;
-
-            auto itInBegin = getIncomingIterBegin(currVert);
-            auto itInEnd = getIncomingIterEnd(currVert);
-
-            for(int i = 0; itInBegin != itInEnd; ++itInBegin, i++) {
-                VertexId toId = itInBegin->getNextId();
-                if(isRanked(toId)) break;
-                // check if src vertex is not ranked
-                if(fromId != toId) {
-                    if(wasDijkstaStarted[i][j]) {
-                        if(searchResult[i].getTargetDistFor(fromId) > newDistances[i][j]) {
-                            Vertex from = itInBegin->getNext();
-                            EdgeBack edgTo(from, newDistances[i][j], newDistances[i][j], currVert.getId(),
-                                           Edge::CREATED_ON_PREPROCESSING);
-                            newBackEdges[j].push_back(edgTo);
-                            edgesAdded_++;
-
-                            // update witness
-                            oneHopWitness_[fromId][toId] = newDistances[i][j];
-                        }
-                    } else {
-                        // saw this optimal path before
-                        DistType witness = findWitness(itOutBegin->getNextId(), itInBegin->getNextId());
-                        if(witness == newDistances[i][j]) {
-                            Vertex from = itInBegin->getNext();
-                            EdgeBack edgTo(from, witness, witness, currVert.getId(), Edge::CREATED_ON_PREPROCESSING);
-                            newBackEdges[j].push_back(edgTo);
-                            edgesAdded_++;
-                        }
-                    }
-                }
-            }
-
-            Vertex to = itOutBegin->getNext();
-            threads.push_back(std::thread(std::bind(&AdjacencyList::mergeEdgeBackSequences, this,
-                                                    to.getId(), std::ref(newBackEdges[j]))));
+    bool preprocessGeometry() {
+        Timer timer;
+        geometryStore_.clear();
+        bool ordered = true;
+        bool read = indexGeometry_.forEachGeometry([&](VertexId id1, VertexId id2, const std::vector<Point> &points) {
+            ordered = geometryStore_.add(id1, id2, points);
+            return ordered;
+        });
+        if(!read || !ordered) {
+            LOGG(Logger::ERROR) << "[PREPROCESSING GEOMETRY] can't read the geometry index" << Logger::FLUSH;
+            geometryStore_.clear();
+            return false;
         }
 
-        for(int j=0;j<(int)threads.size();++j)
-            threads[j].join();
+        timer.stop();
+        LOGG(Logger::INFO) << "[PREPROCESSING GEOMETRY] " << geometryStore_.getNumGeometries()
+                           << " geometries done in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return geometryStore_.save(inputFilename_+".geometry");
     }
 
     /**
-     * either simulates the contraction of the node or actually contracts it
-     * depending on addEdges value
+     * @brief getLandmarks
+     * @return
      */
-    template<typename Metric = Edge::DistanceMetric>
-    void processNode(Vertex currVert, const LocalGraph<AdjacencyList> &graph,
-                     VertexProcResult &procResult, bool addEdges = false) {
-
-        std::vector<std::thread> threads;
+    const Landmarks &getLandmarks() const {
+        return landmarks_;
+    }
 
-        // accumulating parameters in case we want to create edges later
-        size_t numIn = numIncomingEdges(currVert.getId()),
-               numOut = numOutGoingEdges(currVert.getId());
-        LocalDijkstraSearchResult searchResult(numIn);
-        DijstraStarted wasDijkstaStarted(numIn, std::vector<bool>(numOut, 0));
-        NewDistanceMap newDistances(numIn, std::vector<DistType>(numOut, 0));
+    /**
+     * @brief hasHierarchy
+     * @return true if the edges are the edges of the contraction hierarchy
+     */
+    bool hasHierarchy() const {
+        return !rank_.empty();
+    }
 
-        // iterate over all possible pairs of incoming and outgoing vertices
-        //check if dest vertex is not ranked
+    /**
+     * chooses how the graph is searched, called before it is parsed. The
+     * hierarchy ("ch", the default) is read from the preprocessed file if
+     * there is one. The overlay ("overlay") is built from the original
+     * graph when it is loaded, its metrics are customized in seconds, which
+     * suits maps whose weights change often
+     * @brief setEngine
+     * @param engine
+     * @return false if the engine is not known
+     */
+    bool setEngine(const std::string &engine) {
+        if(engine.empty() || engine == "ch") {
+            useOverlay_ = false;
+        } else if(engine == "overlay") {
+            useOverlay_ = true;
+        } else {
+            LOGG(Logger::ERROR) << "unknown engine " << engine << Logger::FLUSH;
+            return false;
+        }
+        return true;
+    }
 
-        auto itInBegin = getIncomingIterBegin(currVert);
-        auto itInEnd = getIncomingIterEnd(currVert);
+    /**
+     * @brief hasOverlay
+     * @return true if the graph is searched on the overlay
+     */
+    bool hasOverlay() const {
+        return !overlay_.empty();
+    }
 
-        for(int i = 0; itInBegin != itInEnd; ++itInBegin, i++) {
-            if(ranked_[itInBegin->getNextId()]) break;
+    /**
+     * @brief getOverlay
+     * @return
+     */
+    const MultiLevelOverlay &getOverlay() const {
+        return overlay_;
+    }
 
-            DistType maxDistance = 0;
+    /**
+     * the cells of the ends of the searches of the query, the copies made
+     * for turn restrictions are ends as well
+     * @brief initOverlayQuery
+     * @param initConfig
+     * @param query
+     */
+    void initOverlayQuery(const AlgorithmInit &initConfig, OverlayQuery &query) const {
+        std::vector<VertexId> ends;
+        for(VertexId end : {initConfig.getSrcEdgeSrc(), initConfig.getSrcEdgeDst(),
+                            initConfig.getDstEdgeSrc(), initConfig.getDstEdgeDst()}) {
+            ends.push_back(end);
+            std::pair<VertexId, VertexId> copies = getTurnCopies(end);
+            for(VertexId copy = copies.first; copy < copies.second; copy++)
+                ends.push_back(copy);
+        }
+        overlay_.initQuery(ends, query);
+    }
 
-            // accumulate target vertices and do a one time pass
-            // and try to reach all at once
-            unordered_set<VertexId> targetVertices(numOutGoingEdges(currVert.getId()));
-            searchResult[i] = SearchResultLocal();
+    /**
+     * unpacks the clique arcs of a path found on the overlay, then the path
+     * is unpacked like the ones of the other searches
+     * @brief unpackOverlayPath
+     * @param query
+     * @param tree vertices of both search trees from the start to the end
+     * @param meeting index of the vertex the searches met at, the arcs
+     * before it were relaxed by the forward search
+     * @param path
+     */
+    template<typename Metric>
+    void unpackOverlayPath(const OverlayQuery &query, const std::vector<VertexId> &tree, size_t meeting,
+                           std::vector<VertexId> &path) {
+        if(tree.empty())
+            return;
 
-            // for all pairs of outgoing and incoming edges
-            auto itOutBegin = getOutgoingIterBegin(currVert);
-            auto itOutEnd = getOutgoingIterEnd(currVert);
+        std::vector<VertexId> edges(1, tree[0]);
+        for(size_t i = 0; i+1 < tree.size(); i++) {
+            size_t level = overlay_.getArcLevel(tree[i], tree[i+1], i >= meeting, query);
+            if(level == 0)
+                edges.push_back(tree[i+1]);
+            else
+                overlay_.unpackArc(level, tree[i], tree[i+1], Metric::Index, edges);
+        }
+        unpackPath<Metric>(edges, path);
+    }
 
-            for(int j = 0; itOutBegin != itOutEnd; ++itOutBegin, j++) {
-                if(ranked_[itOutBegin->getNextId()]) break;
+    /**
+     * preprocess with customizable contraction hierarchies. The contraction
+     * order and the edges added by contraction only depend on the structure
+     * of the graph, so one hierarchy serves all metrics. The weights of each
+     * metric are computed afterwards by customization
+     * @brief preprocess
+     */
+    void preprocess() {
+        // we have found a preprocessed file
+        if(readPreprocessed_)
+            return;
 
-                if(itInBegin->getNextId() == itOutBegin->getNextId())
-                    continue;
+        Timer timer;
 
-                // find out if there was already an edge between the pair of vertices
-                // forward edge
-                auto edgeOut = lower_bound(getOutgoingIterBegin(itInBegin->getNext()),
-                                           getOutgoingIterEnd(itInBegin->getNext()),
-                                           itOutBegin->getNext(), CompareVertexEdgeUnranked<EdgeForw>(this));
-
-                // if the edge is not found
-                if(edgeOut->getNextId() != itOutBegin->getNextId())
-                    edgeOut = getOutgoingIterEnd(itInBegin->getNext());
-
-                // find out if there was already an edge between the pair of vertices
-                // backward edge
-                auto edgeIn = lower_bound(getIncomingIterBegin(itOutBegin->getNext()),
-                                          getIncomingIterEnd(itOutBegin->getNext()),
-                                          itInBegin->getNext(), CompareVertexEdgeUnranked<EdgeBack>(this));
-
-                // if the edge is not found
-                if(edgeIn->getNextId() != itInBegin->getNextId())
-                    edgeIn = getIncomingIterEnd(itOutBegin->getNext());
-
-                // cost of the new edge
-                DistType newCost = itOutBegin->template getCost<Metric>()+itInBegin->template getCost<Metric>();
-                maxDistance = max(maxDistance, newCost);
-
-                if(edgeOut != getOutgoingIterEnd(itInBegin->getNext())) {
-                    assert(edgeIn != getIncomingIterEnd(itOutBegin->getNext()));
-
-                    if(addEdges && edgeOut->template getCost<Metric>() >= newCost) {
-                        // update forward edge
-                        edgeOut->setVia(currVert.getId());
-                        edgeOut->setDist(newCost);
-
-                        // update backward edge
-                        edgeIn->setVia(currVert.getId());
-                        edgeIn->setDist(newCost);
-                    }
-                }
-                // if there wasn't any edge, create new one
-                else {
-                    // if the distance is shorter than new cost, don't execute dijkstra on
-                    // this target vertex
-                    if(findWitness(itInBegin->getNextId(), itOutBegin->getNextId()) > newCost) {
-                        wasDijkstaStarted[i][j] = true;
-                        targetVertices.insert(itOutBegin->getNextId());
-                    }
-                    newDistances[i][j] = newCost;
-                }
-            }
+        // edges are added during contraction
+        thawEdges();
+        renumberVertices();
+        std::vector<std::pair<VertexId, VertexId> > cells;
+        computeContractionOrder(cells);
+        timer.stop();
+        LOGG(Logger::INFO) << "[PREPROCESSING CH] contraction order done in " << timer.getElapsedTimeSec() << Logger::FLUSH;
 
-            if(targetVertices.size() > 0) {
-                Vertex from = itInBegin->getNext();
-
-                // prepare Dijkstra configuration
-                LocalGraph<AdjacencyList>::DijkstraInit initConfig;
-                initConfig.setStoppingDistance(maxDistance);
-                initConfig.setIgnoredVertex(currVert.getId());
-                initConfig.setTargetVertices(targetVertices);
-                initConfig.setSearchSpace(searchSpaceLimit_);
-                initConfig.setHopNumber(hopsAllowed_);
-                initConfig.setSrc(from);
-
-                // dispatch Dijkstra
-                threads.push_back(std::thread(std::bind(&LocalGraph<AdjacencyList>::shortestPathDijkstraLocal,
-                                                        std::ref(graph), initConfig, std::ref(searchResult[i]))));
-            }
-        }
+        timer.start();
+        contractVertices(cells);
+        timer.stop();
+        LOGG(Logger::INFO) << "[PREPROCESSING CH] contraction done in " << timer.getElapsedTimeSec()
+                           << " using " << numThreads_ << " threads and " << cells.size() << " cells" << Logger::FLUSH;
+        LOGG(Logger::INFO) << "[PREPROCESSING CH] total edges added: " << edgesAdded_ << Logger::FLUSH;
 
-        for(int j=0;j<(int)threads.size();++j)
-            threads[j].join();
+        freezeEdges();
+        pruneEdgesRank();
+        buildSweepOrder();
 
-        recalculateParameters(currVert, wasDijkstaStarted, searchResult, newDistances,
-                              procResult.totalShortcuts_, procResult.totalSearchSpace_);
+        timer.start();
+        customizeMetrics();
+        timer.stop();
+        LOGG(Logger::INFO) << "[PREPROCESSING CH] customization done in " << timer.getElapsedTimeSec() << Logger::FLUSH;
 
-        if(addEdges) {
-            createForwardEdges(currVert, wasDijkstaStarted, searchResult, newDistances);
-            createBackwardEdges(currVert, wasDijkstaStarted, searchResult, newDistances);
-        }
+        serializeEdgesAfterProcessing();
+        rebuildVertexIndexes();
     }
 
-
+private:
     /**
-     * @brief getHeuristic
-     * @param id
-     * @return
+     * renumbers the vertices of the input along a space filling curve, so
+     * vertices close to each other have close ids and their points, ranks
+     * and edges share cache lines. The copies made for turn restrictions
+     * stay after the input vertices, ordered by the vertex they copy
+     * @brief renumberVertices
      */
-    HeuristicVal getHeuristic(Vertex id, size_t shortcutsAdded, size_t searchSpace) {
-        size_t neighborsContracted = 0;
-        for(size_t i = 0; i < edgesTo_[id.getId()].size(); i++) {
-            if(ranked_[edgesTo_[id.getId()][i].getNextId()])
-                neighborsContracted++;
-        }
+    void renumberVertices() {
+        size_t numVertices = getNumVertices(), numInput = numVertices-turnCopyOf_.size();
+
+        BalancedPeanoCurve curve;
+        std::vector<pair<int64_t, VertexId> > curvePos(numInput);
+        for(size_t id = 0; id < numInput; id++)
+            curvePos[id] = {curve.convert(vertexToPoint_[id].lat(), vertexToPoint_[id].lon()), id};
+        sort(curvePos.begin(), curvePos.end());
+
+        std::vector<VertexId> newId(numVertices);
+        for(size_t id = 0; id < numInput; id++)
+            newId[curvePos[id].second] = id;
+
+        std::vector<VertexId> copies(turnCopyOf_.size());
+        for(size_t copy = 0; copy < copies.size(); copy++)
+            copies[copy] = copy;
+        stable_sort(copies.begin(), copies.end(), [&](VertexId c1, VertexId c2) {
+            return newId[turnCopyOf_[c1]] < newId[turnCopyOf_[c2]];
+        });
+        std::vector<VertexId> copyOf(copies.size());
+        for(size_t copy = 0; copy < copies.size(); copy++) {
+            newId[numInput+copies[copy]] = numInput+copy;
+            copyOf[copy] = newId[turnCopyOf_[copies[copy]]];
+        }
+
+        // move the vertices and their edges to the new ids
+        VertexPointVector points(numVertices);
+        VertexEdgeForwVector edgesFrom(numVertices);
+        VertexEdgeBackVector edgesTo(numVertices);
+        for(size_t id = 0; id < numVertices; id++) {
+            points[newId[id]] = vertexToPoint_[id];
+            edgesFrom[newId[id]].swap(edgesFrom_[id]);
+            edgesTo[newId[id]].swap(edgesTo_[id]);
+        }
+        auto renumberEdge = [&](Edge &edge) {
+            edge.setNextId(newId[edge.getNextId()]);
+            if(edge.getVia() >= 0 && size_t(edge.getVia()) < numVertices)
+                edge.setVia(newId[edge.getVia()]);
+        };
+        for(size_t id = 0; id < numVertices; id++) {
+            for_each(edgesFrom[id].begin(), edgesFrom[id].end(), renumberEdge);
+            for_each(edgesTo[id].begin(), edgesTo[id].end(), renumberEdge);
+        }
+        vertexToPoint_.swap(points);
+        edgesFrom_.swap(edgesFrom);
+        edgesTo_.swap(edgesTo);
+        turnCopyOf_.swap(copyOf);
+
+        // vertices renumbered before keep the ids of the input
+        std::vector<VertexId> inputIdOf(numInput);
+        for(size_t id = 0; id < numInput; id++)
+            inputIdOf[newId[id]] = getInputId(id);
+        inputIdOf_.swap(inputIdOf);
+        vertexOfInputId_.assign(numInput, 0);
+        for(size_t id = 0; id < numInput; id++)
+            vertexOfInputId_[inputIdOf_[id]] = id;
 
-        for(size_t i = 0; i < edgesFrom_[id.getId()].size(); i++) {
-            if(ranked_[edgesFrom_[id.getId()][i].getNextId()])
-                neighborsContracted++;
-        }
+        sortEdges();
+    }
 
-        return 190*(8*shortcutsAdded-(getVertexDegree(id.getId())))+120*(neighborsContracted) + searchSpace;
+    /**
+     * the indexes built when the graph was loaded hold the vertex ids from
+     * before renumbering. They end up like after reading the preprocessed
+     * file: landmarks and the overlay don't match the ids of a hierarchy
+     * and are dropped, the segment index is built again and traffic maps
+     * its ways to the edges of the hierarchy when it is updated next
+     * @brief rebuildVertexIndexes
+     */
+    void rebuildVertexIndexes() {
+        landmarks_.clear();
+        overlay_.clear();
+        releaseMemory(wayEdges_);
+        loadedTimes_.clear();
+        releaseMemory(rankOrder_);
+        for(int back = 0; back < 2; back++) {
+            releaseMemory(lowerOffsets_[back]);
+            releaseMemory(lowerEdges_[back]);
+        }
+        if(!segmentIndex_.empty())
+            buildSegmentIndex();
     }
+
     /**
-     * modify the number of hops allowed according to the average degree
-     * in the graph
+     * ranks the vertices by nested dissection of the undirected graph. The
+     * dissection is split into a few cells per thread, which are contracted
+     * in parallel
+     * @brief computeContractionOrder
+     * @param cells rank ranges of the cells, their vertices aren't neighbors
      */
-    void modifyNumberOfHops() {
-        double avgDegree = (double)totalDegree_/(double)getNumVertices();
-        hopsAllowed_ = 1;
-        if(avgDegree >= 3.3) {
-            hopsAllowed_ = 2;
-        }
-        if(avgDegree >= 8.0) {
-            hopsAllowed_ = 3;
-        }
-        if(avgDegree >= 10.0) {
-            hopsAllowed_ = 5;
-        }
+    void computeContractionOrder(std::vector<std::pair<VertexId, VertexId> > &cells) {
+        std::vector<NestedDissection::EdgeOffset> offsets(1, 0);
+        std::vector<VertexId> neighbors;
+        for(size_t id = 0; id < getNumVertices(); id++) {
+            size_t first = neighbors.size();
+            for(const EdgeForw &edge : edgesFrom_[id])
+                neighbors.push_back(edge.getNextId());
+            for(const EdgeBack &edge : edgesTo_[id])
+                neighbors.push_back(edge.getNextId());
+
+            sort(neighbors.begin()+first, neighbors.end());
+            neighbors.erase(unique(neighbors.begin()+first, neighbors.end()), neighbors.end());
+            offsets.push_back(neighbors.size());
+        }
+
+        size_t depth = 0;
+        while(numThreads_ > 1 && (size_t(1) << depth) < 4*numThreads_)
+            depth++;
+        NestedDissection dissection(vertexToPoint_, offsets, neighbors);
+        dissection.computeRanks(rank_, depth, cells);
+        ranked_.assign(getNumVertices(), true);
     }
 
     /**
-     * @brief updateNeighborEdges
-     * @param currVert
+     * @brief getRankOrder
+     * @return vertices sorted by their rank
      */
-    void updateNeighborEdges(VertexId currVert) {
-        auto itInBegin = getIncomingIterBegin(currVert);
-        auto itInEnd = getIncomingIterEnd(currVert);
+    std::vector<VertexId> getRankOrder() const {
+        std::vector<VertexId> order(getNumVertices());
+        for(size_t id = 0; id < getNumVertices(); id++)
+            order[rank_[id]] = id;
+        return order;
+    }
 
-        for(;itInBegin != itInEnd; ++itInBegin) {
-            Vertex neighbor = itInBegin->getNextId();
-            std::sort(getOutgoingIterBegin(neighbor), getOutgoingIterEnd(neighbor),
-                      CompareEdgeUnranked<EdgeForw>(this));
-        }
+    /**
+     * orders the vertices for the downward sweep of one to all searches,
+     * the sweep reads the distances of the higher ends of the backward edges
+     * by their position, so the positions are stored next to the edges
+     * @brief buildSweepOrder
+     */
+    void buildSweepOrder() {
+        releaseMemory(sweepOrder_);
+        releaseMemory(sweepSource_);
+        size_t numVertices = getNumVertices();
+        if(!frozen_ || rank_.size() != numVertices || count(ranked_.begin(), ranked_.end(), false) > 0)
+            return;
 
-        auto itOutBegin = getOutgoingIterBegin(currVert);
-        auto itOutEnd = getOutgoingIterEnd(currVert);
+        sweepOrder_.resize(numVertices);
+        for(size_t id = 0; id < numVertices; id++)
+            sweepOrder_[numVertices-1-rank_[id]] = id;
 
-        for(;itOutBegin != itOutEnd; ++itOutBegin) {
-            Vertex neighbor = itOutBegin->getNextId();
-            std::sort(getIncomingIterBegin(neighbor), getIncomingIterEnd(neighbor),
-                      CompareEdgeUnranked<EdgeBack>(this));
+        sweepSource_.resize(back_.getNumEdges());
+        for(size_t id = 0; id < numVertices; id++) {
+            size_t offset = back_.offset(id);
+            for(IncomingEdgeIter it = back_.begin(id); it != back_.end(id); ++it, ++offset)
+                sweepSource_[offset] = numVertices-1-rank_[it->getNextId()];
         }
     }
+
     /**
-     * preprocess with constraction hierarchies
-     * @brief preprocessCH
+     * @brief The SharedEdges struct
+     * halves of the edges added while contracting a cell which are stored
+     * at separator vertices, other cells may add the same edges at once.
+     * forw_ holds (from, to) of edgesFrom_, back_ (to, from) of edgesTo_
      */
-    void preprocess() {
-        // we have found a preprocessed file
-        if(readPreprocessed_)
-            return;
-
-        Timer timer;
+    struct SharedEdges {
+        std::vector<std::pair<VertexId, VertexId> > forw_, back_;
+    };
 
-        // create a temporary graph for computations
-        LocalGraph<AdjacencyList> graph;
-        graph.setModel(this);
+    /**
+     * contracts the vertices in the order of their ranks. For every path
+     * u -> v -> w over higher neighbors of v an edge u -> w is added, there
+     * are no witness searches so the edges are needed by every metric. The
+     * new edges get their weights from customization.
+     *
+     * A vertex only gets edges from contracting lower neighbors, so the
+     * vertices of the cells, which aren't neighbors, are contracted by the
+     * cell in parallel and the separators above them afterwards. The edges
+     * are the same as contracting one vertex after another
+     * @brief contractVertices
+     * @param cells rank ranges of the cells
+     */
+    void contractVertices(const std::vector<std::pair<VertexId, VertexId> > &cells) {
+        const uint32_t NoCell = numeric_limits<uint32_t>::max();
+        size_t numEdges = 0;
+        for(VertexId id = 0; id < VertexId(getNumVertices()); id++)
+            numEdges += edgesFrom_[id].size();
 
-        // prepate the rank datastructure
-        rank_.resize(getNumVertices());
-        ranked_.resize(getNumVertices(), false);
+        std::vector<VertexId> order = getRankOrder();
+        std::vector<uint32_t> cellOf(getNumVertices(), NoCell);
+        for(size_t cell = 0; cell < cells.size(); cell++) {
+            for(VertexId rank = cells[cell].first; rank < cells[cell].second; rank++)
+                cellOf[order[rank]] = uint32_t(cell);
+        }
 
-        // statistics
-        size_t edgesUpdated = 0, maxIn = 0, maxOut = 0, reinsertedNodes = 0, currRank = 0;
-        totalDegree_ = 0;
+        // the edge lists of the separators are only read while the cells
+        // are contracted, their new edges are added afterwards
+        std::vector<SharedEdges> shared(std::max<size_t>(1, numThreads_));
+        runParallel(cells.size(), [&](size_t cell, size_t thread) {
+            for(VertexId rank = cells[cell].first; rank < cells[cell].second; rank++)
+                contractVertex(order[rank], uint32_t(cell), cellOf, shared[thread]);
+        });
+        addSharedEdges(shared);
 
-        // initialize the total degree of vertices
-        for(VertexId currVert = 0; currVert < vertexToPoint_.size(); ++currVert) {
-            totalDegree_ += getVertexDegree(currVert);
+        for(VertexId currVert : order) {
+            if(cellOf[currVert] == NoCell)
+                contractVertex(currVert, NoCell, cellOf, shared[0]);
         }
 
-        // the node contraction priority
-        Heap<VertexId, HeuristicVal> contractOrder;
-        contractOrder.initResizeHeap(getNumVertices());
+        edgesAdded_ = 0;
+        for(VertexId id = 0; id < VertexId(getNumVertices()); id++)
+            edgesAdded_ += edgesFrom_[id].size();
+        edgesAdded_ -= numEdges;
+    }
 
-        // the set of uranked nodes
-        unrankedNodes_ = UnrankedVertexSet();
+    /**
+     * adds the edges between the higher neighbors of the vertex. Contracting
+     * a cell only changes the edge lists of its vertices, the halves stored
+     * at other vertices are collected, no cell changes all of them
+     * @brief contractVertex
+     * @param currVert
+     * @param cell the cell of the vertex, no cell changes all edge lists
+     * @param cellOf
+     * @param shared
+     */
+    void contractVertex(VertexId currVert, uint32_t cell, const std::vector<uint32_t> &cellOf, SharedEdges &shared) {
+        const uint32_t NoCell = numeric_limits<uint32_t>::max();
+        auto owns = [&](VertexId id) {
+            return cell == NoCell || cellOf[id] == cell;
+        };
+
+        // higher neighbors, sorted by id like the edges
+        std::vector<VertexId> in, out;
+        for(const EdgeBack &edge : edgesTo_[currVert]) {
+            if(rank_[edge.getNextId()] > rank_[currVert])
+                in.push_back(edge.getNextId());
+        }
+        for(const EdgeForw &edge : edgesFrom_[currVert]) {
+            if(rank_[edge.getNextId()] > rank_[currVert])
+                out.push_back(edge.getNextId());
+        }
+
+        std::vector<EdgeForw> newForwEdges;
+        std::vector<std::vector<EdgeBack> > newBackEdges(out.size());
+        for(VertexId from : in) {
+            newForwEdges.clear();
+            for(size_t j = 0; j < out.size(); j++) {
+                VertexId to = out[j];
+                if(from == to)
+                    continue;
 
-        // initialize witness
-        oneHopWitness_ = WitnessMap(getNumVertices());
+                // a list of a vertex of the cell has all of its edges
+                bool exists = owns(from) || !owns(to) ?
+                    binary_search(edgesFrom_[from].begin(), edgesFrom_[from].end(),
+                                  EdgeForw(to, 0, 0, Vertex::NullVertexId, 0), CompareEdge<EdgeForw>()) :
+                    binary_search(edgesTo_[to].begin(), edgesTo_[to].end(),
+                                  EdgeBack(from, 0, 0, Vertex::NullVertexId, 0), CompareEdge<EdgeBack>());
+                if(exists)
+                    continue;
 
-        // assign ranks to vertices
-        modifyNumberOfHops();
-        searchSpaceLimit_ = 200;
-        for(VertexId currVert = 0; currVert < vertexToPoint_.size(); ++currVert) {
-            VertexProcResult vertProc;
-            unrankedNodes_.insert(currVert);
-            processNode(currVert, graph, vertProc);
-            HeuristicVal heuristic = getHeuristic(currVert, vertProc.totalShortcuts_,
-                                               vertProc.totalSearchSpace_);
-            contractOrder.pushHeap(currVert, heuristic);
+                if(owns(from))
+                    newForwEdges.push_back(EdgeForw(to, Edge::MaxDist, Edge::MaxTime, Vertex::NullVertexId,
+                                                    Edge::CREATED_ON_PREPROCESSING));
+                else
+                    shared.forw_.push_back(make_pair(from, to));
+                if(owns(to))
+                    newBackEdges[j].push_back(EdgeBack(from, Edge::MaxDist, Edge::MaxTime, Vertex::NullVertexId,
+                                                       Edge::CREATED_ON_PREPROCESSING));
+                else
+                    shared.back_.push_back(make_pair(to, from));
+            }
+            if(!newForwEdges.empty())
+                mergeEdgeForwSequences(from, newForwEdges);
         }
-        timer.stop();
-        LOGG(Logger::INFO) << "[PREPROCESSING CH]: ranking done in" << timer.getElapsedTimeSec() << Logger::FLUSH;
+        for(size_t j = 0; j < out.size(); j++) {
+            if(!newBackEdges[j].empty())
+                mergeEdgeBackSequences(out[j], newBackEdges[j]);
+        }
+    }
 
-        timer.start();
-        while(!contractOrder.empty()) {
-            auto currMinOrder = contractOrder.topHeap();
-            contractOrder.popHeapFloyd();
-
-            Vertex currVert = currMinOrder.first;
-
-            // maximum degrees of a node
-            maxIn = max(maxIn, numIncomingEdges(currVert.getId()));
-            maxOut = max(maxOut, numOutGoingEdges(currVert.getId()));
-
-            if(currRank % 10000 == 0) {
-                LOGG(Logger::INFO) << "[PREPROCESSING CH] current vertex: " << currRank << "out of"<<getNumVertices()<< Logger::FLUSH;
-                LOGG(Logger::INFO) << "[PREPROCESSING CH] max indegree: " << maxIn << "max outdegree:" << maxOut << Logger::FLUSH;
-                LOGG(Logger::INFO) << "[PREPROCESSING CH] edges added: " << edgesAdded_ << Logger::FLUSH;
-                LOGG(Logger::INFO) << "[PREPROCESSING CH] nodes reinserted: " << reinsertedNodes << Logger::FLUSH;
-                LOGG(Logger::INFO) << "[PREPROCESSING CH] avg degree: " << (double)totalDegree_/(double)getNumVertices() << Logger::FLUSH;
+    /**
+     * adds the collected halves of the edges which aren't there yet
+     * @brief addSharedEdges
+     * @param shared
+     */
+    void addSharedEdges(std::vector<SharedEdges> &shared) {
+        std::vector<std::pair<VertexId, VertexId> > forw, back;
+        for(SharedEdges &edges : shared) {
+            forw.insert(forw.end(), edges.forw_.begin(), edges.forw_.end());
+            back.insert(back.end(), edges.back_.begin(), edges.back_.end());
+            releaseMemory(edges.forw_);
+            releaseMemory(edges.back_);
+        }
+        sort(forw.begin(), forw.end());
+        forw.erase(unique(forw.begin(), forw.end()), forw.end());
+        sort(back.begin(), back.end());
+        back.erase(unique(back.begin(), back.end()), back.end());
+
+        std::vector<EdgeForw> newForwEdges;
+        for(size_t i = 0, j = 0; i < forw.size(); i = j) {
+            newForwEdges.clear();
+            for(j = i; j < forw.size() && forw[j].first == forw[i].first; j++) {
+                EdgeForw edge(forw[j].second, Edge::MaxDist, Edge::MaxTime, Vertex::NullVertexId,
+                              Edge::CREATED_ON_PREPROCESSING);
+                if(!binary_search(edgesFrom_[forw[i].first].begin(), edgesFrom_[forw[i].first].end(),
+                                  edge, CompareEdge<EdgeForw>()))
+                    newForwEdges.push_back(edge);
             }
+            mergeEdgeForwSequences(forw[i].first, newForwEdges);
+        }
+        std::vector<EdgeBack> newBackEdges;
+        for(size_t i = 0, j = 0; i < back.size(); i = j) {
+            newBackEdges.clear();
+            for(j = i; j < back.size() && back[j].first == back[i].first; j++) {
+                EdgeBack edge(back[j].second, Edge::MaxDist, Edge::MaxTime, Vertex::NullVertexId,
+                              Edge::CREATED_ON_PREPROCESSING);
+                if(!binary_search(edgesTo_[back[i].first].begin(), edgesTo_[back[i].first].end(),
+                                  edge, CompareEdge<EdgeBack>()))
+                    newBackEdges.push_back(edge);
+            }
+            mergeEdgeBackSequences(back[i].first, newBackEdges);
+        }
+    }
 
-            // modify the number of hops allowed and the search space
-            modifyNumberOfHops();
-
-
-            VertexProcResult vertProc;
-            processNode(currVert, graph, vertProc, true);
-
-
-            // update the structures
-            rank_[currVert.getId()] = currRank;
-            ranked_[currVert.getId()] = true;
-            unrankedNodes_.erase(currVert.getId());
-            updateNeighborEdges(currVert.getId());
-
-            // update statistics
-            totalDegree_ += 2*vertProc.totalShortcuts_;
-            currRank++;
+    /**
+     * computes the weights of the metric bottom up. The edge between two
+     * higher neighbors of a vertex is relaxed by the path through it, edges
+     * of a vertex have their final weights once the lower vertices are done
+     * @brief customize
+     */
+    template<typename Metric>
+    void customize() {
+        typedef typename Metric::Metric Cost;
+        const Cost maxCost = numeric_limits<Cost>::max();
+
+        for(VertexId currVert : getRankOrder()) {
+            for(IncomingEdgeIter in = back_.begin(currVert); in != back_.end(currVert); ++in) {
+                VertexId from = in->getNextId();
+                Cost inCost = in->getCost<Metric>();
+                if(inCost == maxCost)
+                    continue;
 
-            // update the orders of the neighbors
-            unordered_set<Vertex> neighbors;
-            auto itOutBegin = getOutgoingIterBegin(currVert);
-            auto itOutEnd = getOutgoingIterEnd(currVert);
-            for(; itOutBegin != itOutEnd; ++itOutBegin) {
-                if(!isRanked(itOutBegin->getNextId()))
-                    neighbors.insert(itOutBegin->getNext());
+                for(OutgoingEdgeIter out = forw_.begin(currVert); out != forw_.end(currVert); ++out) {
+                    VertexId to = out->getNextId();
+                    Cost outCost = out->getCost<Metric>();
+                    if(from == to || outCost == maxCost)
+                        continue;
+
+                    // the edge is stored at its lower end
+                    Cost cost = inCost+outCost;
+                    if(rank_[from] < rank_[to]) {
+                        OutgoingEdgeIter edge = findEdgeForw(from, to);
+                        if(cost < edge->getCost<Metric>())
+                            forw_.setShortcut<Metric>(edge, cost, currVert, back_.index(in), forw_.index(out));
+                    } else {
+                        IncomingEdgeIter edge = findEdgeBack(from, to);
+                        if(cost < edge->getCost<Metric>())
+                            back_.setShortcut<Metric>(edge, cost, currVert, back_.index(in), forw_.index(out));
+                    }
+                }
             }
+        }
+    }
 
-            auto itInBegin = getIncomingIterBegin(currVert);
-            auto itInEnd = getIncomingIterEnd(currVert);
-            for(; itInBegin != itInEnd; ++itInBegin) {
-                if(!isRanked(itInBegin->getNextId()))
-                    neighbors.insert(itInBegin->getNext());
+    /**
+     * customizes all metrics, each metric in its own thread
+     * @brief customizeMetrics
+     */
+    void customizeMetrics() {
+        forw_.copyMappedData();
+        back_.copyMappedData();
+        runParallel(Edge::NUM_METRICS, [this](size_t metric, size_t) {
+            if(metric == Edge::DistanceMetric::Index) {
+                forw_.resetCosts<Edge::DistanceMetric>();
+                back_.resetCosts<Edge::DistanceMetric>();
+                customize<Edge::DistanceMetric>();
+            } else {
+                forw_.resetCosts<Edge::TimeMetric>();
+                back_.resetCosts<Edge::TimeMetric>();
+                customize<Edge::TimeMetric>();
             }
+        });
+    }
 
-            // simulate the contraction for all neighbors
-            for(const Vertex &neighbor: neighbors) {
-                VertexProcResult vertProcLocal;
-                processNode(neighbor, graph, vertProcLocal);
-                HeuristicVal heuristic = getHeuristic(neighbor.getId(), vertProcLocal.totalShortcuts_,
-                                                      vertProcLocal.totalSearchSpace_);
-                contractOrder.changeKey(neighbor.getId(), heuristic);
-            }
-            releaseMemory(oneHopWitness_[currVert.getId()]);
+    /**
+     * @brief getForwardCosts
+     * @param costs costs of the forward edges in the order they are stored
+     */
+    template<typename Metric>
+    void getForwardCosts(std::vector<DistType> &costs) {
+        costs.clear();
+        costs.reserve(forw_.getNumEdges());
+        for(size_t id = 0; id < getNumVertices(); id++) {
+            for(OutgoingEdgeIter it = getOutgoingIterBegin(id); it != getOutgoingIterEnd(id); ++it)
+                costs.push_back(it->getCost<Metric>());
         }
+    }
 
+    /**
+     * computes the cliques of the overlay level by level, the cells of a
+     * level in parallel. The costs of the arcs are set
+     * @brief customizeOverlay
+     * @param weights
+     */
+    void customizeOverlay(MultiLevelOverlay::Weights &weights) const {
+        Timer timer;
+        overlay_.initWeights(weights);
+        for(size_t level = 1; level <= overlay_.getNumLevels(); level++) {
+            runParallel(overlay_.getNumCells(level), [&](size_t cell, size_t) {
+                overlay_.customizeCell(level, MultiLevelOverlay::CellId(cell), weights);
+            });
+        }
         timer.stop();
-        LOGG(Logger::INFO) << "[PREPROCESSING CH] Done in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        LOGG(Logger::INFO) << "[OVERLAY] customized in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+    }
 
-        sortEdges();
-        LOGG(Logger::INFO) << "[PREPROCESSING CH] total edges added: " << edgesAdded_ << Logger::FLUSH;
-        LOGG(Logger::INFO) << "[PREPROCESSING CH] total edges updated: " << edgesUpdated << Logger::FLUSH;
+    /**
+     * calls func(i, thread) for i in [0, count) using the preprocessing
+     * threads, thread is the index of the calling thread in [0, numThreads_)
+     * @brief runParallel
+     */
+    template<typename Function>
+    void runParallel(size_t count, Function func) const {
+        size_t numThreads = std::min(numThreads_, count);
+        if(numThreads <= 1) {
+            for(size_t i = 0; i < count; i++)
+                func(i, 0);
+            return;
+        }
 
-        serializeEdgesAfterProcessing();
-        pruneEdgesRank();
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> threads;
+        for(size_t t = 0; t < numThreads; t++) {
+            threads.push_back(std::thread([&, t]() {
+                for(size_t i = next++; i < count; i = next++)
+                    func(i, t);
+            }));
+        }
+        for(size_t t = 0; t < threads.size(); t++)
+            threads[t].join();
     }
 };
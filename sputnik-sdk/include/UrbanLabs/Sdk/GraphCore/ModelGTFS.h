@@ -9,6 +9,7 @@
 #include <UrbanLabs/Sdk/GraphCore/VerticesGTFS.h>
 #include <UrbanLabs/Sdk/GraphCore/SearchResultGtfs.h>
 #include <UrbanLabs/Sdk/GraphCore/Graph.h>
+#include <UrbanLabs/Sdk/GraphCore/Landmarks.h>
 #include <UrbanLabs/Sdk/Storage/Storage.h>
 #include <UrbanLabs/Sdk/Storage/KdTreeSql.h>
 #include <UrbanLabs/Sdk/Utils/Logger.h>
@@ -69,8 +70,12 @@ private:
     // Disk based kd tree for vertex indexing
     KdTreeSql kdTreeDisk_;
     //--------------------------------------------------------------------------
+    // landmark distances on the lower bound costs, used by A*
+    Landmarks landmarks_;
+    //--------------------------------------------------------------------------
     size_t numVertices_;
     VertexPointVector vertexToPoint_;
+    std::string inputFilename_;
 public:
     class AlgorithmInit {
     public:
@@ -246,9 +251,86 @@ public:
         }
     };
 
-    //class AlgorithmStateLocal {};
+    /**
+     * A* keys the heap by the time plus a lower bound of the time left to
+     * the destination. The bounds come from the landmarks, which are
+     * computed on the fastest rides between the stops, so they hold at
+     * any time of the day. Without landmarks the bound is 0
+     */
+    class AlgorithmStateAStar : public AlgorithmState {
+    private:
+        Landmarks::Target end_;
+        HeuristicMap bounds_;
+    public:
+        AlgorithmStateAStar(const AdjacencyListGTFS *model) : AlgorithmState(model) {;}
+
+        template<typename Metric=EdgeGTFS::DistanceMetric>
+        inline void init(const AlgorithmInit &initConfig) {
+            const Landmarks &landmarks = gModel_->getLandmarks();
+            if(!landmarks.empty())
+                landmarks.template initTarget<Edge::TimeMetric>({initConfig.getDst()}, false, end_);
+            initMap<HeuristicMap, VertexId>(bounds_);
+            AlgorithmState::init(initConfig);
+        }
+
+        /**
+         * @brief getNextVertex
+         * @return the vertex with the smallest key and its time
+         */
+        inline pair<VertexId, DistType> getNextVertex() {
+            VertexId v = heap_.topHeap().first;
+            heap_.popHeap();
+            return {v, oldDist_[v]};
+        }
+
+        template<typename EdgeIter, typename Metric=EdgeGTFS::DistanceMetric>
+        inline void relaxEdge(const pair<VertexId, DistType> &currMin, const EdgeIter &outGoingCur) {
+            VertexId currVertId = outGoingCur->getNext().getId();
+            DistType newDist = currMin.second+outGoingCur->template getCost<Metric>();
+
+            // the destination can't be reached from the vertex
+            Landmarks::Dist bound = findBound(currVertId);
+            if(bound == Landmarks::Unreachable)
+                return;
+
+            if(!visMap_[currVertId]) {
+                visMap_[currVertId] = true;
+                prevMap_[currVertId] = currMin.first;
+                oldDist_[currVertId] = newDist;
+                heap_.pushHeap(currVertId, newDist+bound);
+            } else if(oldDist_[currVertId] > newDist) {
+                prevMap_[currVertId] = currMin.first;
+                oldDist_[currVertId] = newDist;
+                heap_.decreaseKey(currVertId, newDist+bound);
+            }
+        }
+    private:
+        /**
+         * @brief findBound
+         * @param v
+         * @return bound of the time from the vertex to the destination
+         */
+        inline Landmarks::Dist findBound(VertexId v) {
+            const Landmarks &landmarks = gModel_->getLandmarks();
+            if(landmarks.empty())
+                return 0;
+
+            auto found = bounds_.find(v);
+            if(found != bounds_.end())
+                return found->second;
+            Landmarks::Dist bound = landmarks.lowerBound(v, end_);
+            bounds_[v] = bound;
+            return bound;
+        }
+    };
+
+    // the time dependent searches keep their own heap
+    template<typename HeapPolicy>
+    using BasicAlgorithmState = AlgorithmState;
+    template<typename HeapPolicy>
+    using BasicAlgorithmStateAStar = AlgorithmStateAStar;
 
-    //class AlgorithmStateAStar {};
+    //class AlgorithmStateLocal {};
 
 private:
     /**
@@ -381,8 +463,9 @@ public:
      * @brief parse
      * @param filename
      */
-    bool parse(const string &/*filename*/) {
+    bool parse(const string &filename) {
         string folder = "example/example/";
+        inputFilename_ = filename;
 
         // do not change the order
         vector<Agency> agencies = readObjects<Agency>(folder+"agency.txt");
@@ -414,6 +497,9 @@ public:
         initKdTreeSpatial(folder+"stops", stops);
 
         numVertices_ = stops.size();
+
+        // landmarks are optional, A* uses no bounds without them
+        landmarks_.load(filename+".landmarks", numVertices_);
         return true;
     }
 
@@ -440,6 +526,7 @@ public:
         releaseMemory(serviceIdToCalendar_);
         releaseMemory(tripIdStopTimeToStopTime_);
         kdTreeDisk_.close();
+        landmarks_.clear();
         releaseMemory(vertexToPoint_);
     }
 
@@ -520,7 +607,7 @@ public:
                         edge.setTime(edge.getCost<EdgeGTFS::DistanceMetric>());
                         edgesToDebug[stops[j]].push_back(edge);
                     }
-                    if(i+1 < stops.size()) {
+                    if(j+1 < stops.size()) {
                         edgesFromTmp[stops[j]].push_back({stops[j+1], currId});
                         EdgeGTFS edge = {currId, stops[j+1], timeArrive[j+1].getDiff(timeDepart[j])};
                         edge.setTime(edge.getCost<EdgeGTFS::DistanceMetric>());
@@ -626,6 +713,79 @@ public:
         ;
     }
 
+    /**
+     * the fastest ride between consecutive stops of all trips. A ride takes
+     * at least as long at any time of the day, waiting at the stop only
+     * adds to it, so the distances by these costs are lower bounds
+     * @brief getLowerBoundCosts
+     * @param forw arcs leaving every stop
+     * @param back arcs entering every stop
+     */
+    void getLowerBoundCosts(Landmarks::Adjacency &forw, Landmarks::Adjacency &back) const {
+        vector<vector<Landmarks::Arc> > arcsTo(numVertices_);
+        forw.offsets_.assign(1, 0);
+        forw.arcs_.clear();
+        for(size_t stop = 0; stop < numVertices_; stop++) {
+            for(size_t i = 0; stop < edgesFrom_.size() && i < edgesFrom_[stop].size(); i++) {
+                Stop::StopId next = edgesFrom_[stop][i];
+                Landmarks::Dist cost = Landmarks::Unreachable;
+                for(Trip::TripId tripId : edgesFromTrip_[stop][i]) {
+                    const map<Stop::StopId, StopTime> &stopTimes = tripIdStopTimeToStopTime_[tripId];
+                    auto from = stopTimes.find(stop), to = stopTimes.find(next);
+                    if(from == stopTimes.end() || to == stopTimes.end())
+                        continue;
+                    int ride = to->second.getArrival().getDiff(from->second.getDeparture());
+                    cost = min(cost, Landmarks::Dist(max(ride, 0)));
+                }
+                if(cost == Landmarks::Unreachable)
+                    continue;
+                forw.arcs_.push_back({VertexId(next), {cost, cost}});
+                arcsTo[next].push_back({VertexId(stop), {cost, cost}});
+            }
+            forw.offsets_.push_back(forw.arcs_.size());
+        }
+
+        back.offsets_.assign(1, 0);
+        back.arcs_.clear();
+        for(size_t stop = 0; stop < numVertices_; stop++) {
+            back.arcs_.insert(back.arcs_.end(), arcsTo[stop].begin(), arcsTo[stop].end());
+            back.offsets_.push_back(back.arcs_.size());
+        }
+    }
+
+    /**
+     * picks the landmarks and computes their distances on the lower bound
+     * costs, the result is stored next to the input file and used by A*.
+     * The costs are times, both metrics get the same distances
+     * @brief preprocessLandmarks
+     * @param numLandmarks
+     * @return
+     */
+    bool preprocessLandmarks(size_t numLandmarks = 16) {
+        Timer timer;
+        Landmarks::Adjacency forw, back;
+        getLowerBoundCosts(forw, back);
+        landmarks_.selectLandmarks(forw, numVertices_, numLandmarks);
+        for(size_t landmark = 0; landmark < landmarks_.getNumLandmarks(); landmark++) {
+            for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+                landmarks_.computeDistances(landmark, metric, false, forw);
+                landmarks_.computeDistances(landmark, metric, true, back);
+            }
+        }
+
+        timer.stop();
+        LOGG(Logger::INFO) << "[PREPROCESSING ALT] landmarks done in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+        return landmarks_.save(inputFilename_+".landmarks");
+    }
+
+    /**
+     * @brief getLandmarks
+     * @return
+     */
+    const Landmarks &getLandmarks() const {
+        return landmarks_;
+    }
+
     /**
      * get an intermediate vertex
      */
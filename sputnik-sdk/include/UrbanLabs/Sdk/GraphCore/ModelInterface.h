@@ -15,6 +15,17 @@ public:
      */
     bool parse(const std::string &filename);
 
+    /**
+     * chooses how the graph is searched, called before parse. Models with a
+     * single engine only accept the default
+     * @brief setEngine
+     * @param engine
+     * @return false if the model has no such engine
+     */
+    bool setEngine(const std::string &engine) {
+        return engine.empty();
+    }
+
     /**
      * @brief unload
      */
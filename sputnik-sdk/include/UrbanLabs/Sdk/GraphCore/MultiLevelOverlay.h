@@ -0,0 +1,162 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Edges.h>
+#include <UrbanLabs/Sdk/GraphCore/Vertices.h>
+#include <UrbanLabs/Sdk/GraphCore/Point.h>
+
+/**
+ * @brief The MultiLevelOverlay class
+ * customizable route planning (CRP). The vertices are split recursively at
+ * the median coordinate and a few levels of the splits are kept as nested
+ * cells. The vertices with an arc leaving a cell are its boundary, the
+ * clique of a cell holds the distances between all pairs of its boundary
+ * vertices inside of the cell. The partition only depends on the structure
+ * of the graph, a metric is customized by computing the cliques bottom up,
+ * each level from the cliques of the level below, in seconds.
+ *
+ * A query searches the arcs of the graph in the cells of its ends only.
+ * Elsewhere a vertex uses the cliques of the highest level whose cell has
+ * none of the ends and the arcs leaving that cell
+ */
+class MultiLevelOverlay {
+public:
+    typedef Vertex::VertexId VertexId;
+    typedef Edge::EdgeDist Dist;
+    typedef uint64_t EdgeOffset;
+    typedef uint32_t CellId;
+    static const Dist Unreachable;
+
+    /**
+     * @brief The Weights struct
+     * one metric, the costs of the arcs of the graph and the cliques of all
+     * levels
+     */
+    struct Weights {
+        std::vector<Dist> arcs_;
+        std::vector<Dist> cliques_;
+    };
+
+    /**
+     * @brief The Query class
+     * leaf cells of the ends of a query
+     */
+    class Query {
+        friend class MultiLevelOverlay;
+    private:
+        std::vector<CellId> ends_;
+    };
+private:
+    size_t numLevels_;
+    size_t levelBits_;
+    // arcs of vertex v are in [offsets_[v], offsets_[v+1])
+    std::vector<EdgeOffset> offsets_;
+    std::vector<VertexId> targets_;
+    // leaf cell of every vertex, the cell of level l drops the last
+    // (l-1)*levelBits_ bits of it
+    std::vector<CellId> cell_;
+    // highest level the vertex is a boundary vertex of, 0 if none
+    std::vector<uint8_t> boundaryLevel_;
+    // per level the boundary vertices sorted by cell and the position of
+    // each in the list, level 0 holds all vertices
+    std::vector<std::vector<VertexId> > vertices_;
+    std::vector<std::vector<uint32_t> > position_;
+    // per level and cell where its boundary vertices start in vertices_ of
+    // the level, where the vertices it is searched on start in vertices_ of
+    // the level below and where its clique starts
+    std::vector<std::vector<uint32_t> > boundaryStart_;
+    std::vector<std::vector<uint32_t> > nodeStart_;
+    std::vector<std::vector<EdgeOffset> > cliqueStart_;
+    Weights weights_[Edge::NUM_METRICS];
+private:
+    MultiLevelOverlay(const MultiLevelOverlay &) = delete;
+    MultiLevelOverlay &operator = (const MultiLevelOverlay &) = delete;
+    void partition(const std::vector<Point> &points, size_t leafBits);
+    void search(size_t level, CellId cell, VertexId source, VertexId target, const Weights &weights,
+                std::vector<Dist> &dist, std::vector<uint32_t> &prev) const;
+
+    /**
+     * @brief forEachCliqueArc
+     * @see forEachCliqueArc
+     */
+    template<typename Function>
+    void forEachCliqueArc(size_t level, VertexId v, bool backward, const Weights &weights, Function func) const {
+        CellId cell = getCell(level, v);
+        uint32_t begin = boundaryStart_[level][cell], size = boundaryStart_[level][cell+1]-begin;
+        uint32_t slot = position_[level][v]-begin;
+        const Dist *clique = weights.cliques_.data()+cliqueStart_[level][cell];
+        for(uint32_t i = 0; i < size; i++) {
+            Dist cost = backward ? clique[size_t(i)*size+slot] : clique[size_t(slot)*size+i];
+            if(i != slot && cost != Unreachable)
+                func(vertices_[level][begin+i], cost);
+        }
+    }
+public:
+    MultiLevelOverlay();
+    void clear();
+    bool empty() const;
+    size_t getNumLevels() const;
+    size_t getNumCells(size_t level) const;
+    size_t getNumBoundaryVertices(size_t level) const;
+    void build(const std::vector<Point> &points, const std::vector<EdgeOffset> &offsets,
+               const std::vector<VertexId> &targets, size_t cellSize, size_t levelBits, size_t maxLevels);
+    void initWeights(Weights &weights) const;
+    void customizeCell(size_t level, CellId cell, Weights &weights) const;
+    void setWeights(size_t metric, Weights &weights);
+    Dist getCliqueCost(size_t level, VertexId from, VertexId to, size_t metric) const;
+    void initQuery(const std::vector<VertexId> &ends, Query &query) const;
+    size_t getArcLevel(VertexId from, VertexId to, bool backward, const Query &query) const;
+    void unpackArc(size_t level, VertexId from, VertexId to, size_t metric, std::vector<VertexId> &path) const;
+
+    /**
+     * @brief getCell
+     * @param level
+     * @param v
+     * @return the cell of the vertex on the level, levels start at 1
+     */
+    inline CellId getCell(size_t level, VertexId v) const {
+        return cell_[v] >> ((level-1)*levelBits_);
+    }
+
+    /**
+     * level a query searches the vertex on, the highest level whose cell of
+     * the vertex has none of the ends of the query. Only the boundary of the
+     * cell can be reached from outside of it, so a vertex is searched on
+     * levels it is a boundary vertex of
+     * @brief getQueryLevel
+     * @param v
+     * @param query
+     * @return the level, 0 if the arcs of the vertex are searched
+     */
+    inline size_t getQueryLevel(VertexId v, const Query &query) const {
+        size_t level = boundaryLevel_[v];
+        for(; level > 0; level--) {
+            size_t shift = (level-1)*levelBits_;
+            bool hasEnd = false;
+            for(CellId end : query.ends_)
+                hasEnd = hasEnd || (end >> shift) == (cell_[v] >> shift);
+            if(!hasEnd)
+                break;
+        }
+        return level;
+    }
+
+    /**
+     * calls func(next, cost) for the arcs of the clique of the cell of the
+     * vertex, backward calls it for the arcs into the vertex
+     * @brief forEachCliqueArc
+     * @param level
+     * @param v a boundary vertex of the level
+     * @param backward
+     * @param metric
+     * @param func
+     */
+    template<typename Function>
+    void forEachCliqueArc(size_t level, VertexId v, bool backward, size_t metric, Function func) const {
+        forEachCliqueArc(level, v, backward, weights_[metric], func);
+    }
+};
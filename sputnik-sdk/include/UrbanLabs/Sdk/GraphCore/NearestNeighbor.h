@@ -7,16 +7,19 @@ namespace OsmGraphCore {
 class NearestPointResult {
 private:
     VertexPoint src_, dst_, target_;
+    // part of the edge from src to dst which lies before the target,
+    // negative if it isn't known
+    double offset_;
 public:
     /**
      * @brief NearestPointResult
      */
-    NearestPointResult() : src_(), dst_(), target_() {;}
+    NearestPointResult() : src_(), dst_(), target_(), offset_(-1) {;}
     /**
      * @brief NearestPointResult
      */
-    NearestPointResult(const VertexPoint &src, const VertexPoint &dst, const VertexPoint &target)
-        : src_(src), dst_(dst), target_(target) {;}
+    NearestPointResult(const VertexPoint &src, const VertexPoint &dst, const VertexPoint &target, double offset = -1)
+        : src_(src), dst_(dst), target_(target), offset_(offset) {;}
     /**
      * @brief isEndPoint
      * @return
@@ -66,12 +69,26 @@ public:
     void setTarget(const VertexPoint &vp) {
         target_ = vp;
     }
+    /**
+     * @brief setOffset
+     * @param offset between 0 at src and 1 at dst
+     */
+    void setOffset(double offset) {
+        offset_ = offset;
+    }
+    /**
+     * @brief getOffset
+     * @return the offset, negative if it isn't known
+     */
+    double getOffset() const {
+        return offset_;
+    }
     /**
      * @brief reverse
      * @return
      */
     NearestPointResult reverse() const {
-        return NearestPointResult(dst_, src_, target_);
+        return NearestPointResult(dst_, src_, target_, offset_ < 0 ? offset_ : 1-offset_);
     }
 };
 } 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Vertices.h>
+#include <UrbanLabs/Sdk/GraphCore/Point.h>
+
+/**
+ * @brief The NestedDissection class
+ * computes a contraction order which doesn't depend on edge weights. The
+ * vertices are split recursively at the median coordinate, the vertices on
+ * the boundary between the two halves form the separator and get the highest
+ * ranks of the cell. Road networks have small separators, so contracting in
+ * this order adds few edges
+ */
+class NestedDissection {
+public:
+    typedef Vertex::VertexId VertexId;
+    typedef uint64_t EdgeOffset;
+private:
+    /**
+     * @brief The Cell struct
+     * vertices which get the ranks [firstRank_, firstRank_+vertices_.size()),
+     * the depth is the number of splits above the cell
+     */
+    struct Cell {
+        std::vector<VertexId> vertices_;
+        VertexId firstRank_;
+        size_t depth_;
+    };
+private:
+    const std::vector<Point> &points_;
+    // undirected adjacency, neighbors of v are in [offsets[v], offsets[v+1])
+    const std::vector<EdgeOffset> &offsets_;
+    const std::vector<VertexId> &neighbors_;
+    // cells with at most this many vertices are not split
+    size_t leafSize_;
+    // side of the split a vertex is on, valid for the current generation
+    std::vector<uint32_t> side_;
+    uint32_t generation_;
+private:
+    NestedDissection(const NestedDissection &) = delete;
+    NestedDissection &operator = (const NestedDissection &) = delete;
+    uint32_t nextGeneration();
+    size_t splitAxis(const std::vector<VertexId> &cell, int axis, std::vector<VertexId> &low,
+                     std::vector<VertexId> &high, std::vector<VertexId> &separator);
+    void split(const std::vector<VertexId> &cell, std::vector<VertexId> &low,
+               std::vector<VertexId> &high, std::vector<VertexId> &separator);
+public:
+    NestedDissection(const std::vector<Point> &points, const std::vector<EdgeOffset> &offsets,
+                     const std::vector<VertexId> &neighbors);
+    void setLeafSize(size_t leafSize);
+    void computeRanks(std::vector<VertexId> &rank);
+    void computeRanks(std::vector<VertexId> &rank, size_t depth, std::vector<std::pair<VertexId, VertexId> > &independent);
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <queue>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Point.h>
+
+/**
+ * @brief The PackedRTree class
+ * static R-tree over the bounding boxes of items. The items are sorted
+ * along a Hilbert curve through the centers of their boxes and packed into
+ * full nodes, every level is stored after the one below it in a single
+ * array, so the tree needs no pointers and is built in one pass. Distances
+ * are manhattan distances in degrees like in closestPoint
+ */
+class PackedRTree {
+public:
+    // coordinates in units of 1/SCALE_FACTOR degrees, the precision of the kd trees
+    typedef int32_t Coord;
+    static const double SCALE_FACTOR;
+    // children of a node
+    static const size_t NODE_SIZE;
+
+    /**
+     * @brief The Box struct
+     */
+    struct Box {
+        Coord minLat_;
+        Coord minLon_;
+        Coord maxLat_;
+        Coord maxLon_;
+
+        Box();
+        Box(const Point &pt);
+        Box(const Point &pt1, const Point &pt2);
+        void extend(const Box &box);
+        Point::PointDistType distanceTo(const Point &pt) const;
+    };
+private:
+    size_t numItems_;
+    // the leaves, one box per item, followed by the levels of the inner nodes
+    std::vector<Box> boxes_;
+    // item of every leaf
+    std::vector<uint32_t> items_;
+    // end of every level in the boxes, the root is the last box
+    std::vector<size_t> levelEnds_;
+private:
+    static uint32_t hilbertIndex(uint32_t x, uint32_t y);
+public:
+    PackedRTree();
+    void clear();
+    bool empty() const;
+    size_t getNumItems() const;
+    size_t getMemoryInfo() const;
+    void build(const std::vector<Box> &boxes);
+
+    /**
+     * the item closest to the point, nodes are visited in the order of the
+     * distance to their boxes, so the search stops at the first item which
+     * is closer than all boxes not visited yet. Of items at the same
+     * distance the one with the smallest index is found
+     * @brief findNearest
+     * @param pt
+     * @param distance exact distance of the point to an item, not less
+     * than the distance to its box
+     * @param item
+     * @return false if the tree is empty
+     */
+    template<typename Distance>
+    bool findNearest(const Point &pt, Distance distance, size_t &item) const {
+        auto boxDistance = [&pt](const Box &box) {
+            return box.distanceTo(pt);
+        };
+        return findNearest(boxDistance, distance, item);
+    }
+
+    /**
+     * the item closest by another distance than the manhattan distance
+     * @brief findNearest
+     * @param boxDistance distance to a box, not more than the distance to
+     * any item inside of it
+     * @param distance exact distance to an item
+     * @param item
+     * @return false if the tree is empty
+     */
+    template<typename BoxDistance, typename Distance>
+    bool findNearest(BoxDistance boxDistance, Distance distance, size_t &item) const {
+        if(numItems_ == 0)
+            return false;
+
+        // the distance, then boxes before items and items by index
+        typedef std::pair<Point::PointDistType, std::pair<bool, size_t> > Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+        queue.push({boxDistance(boxes_.back()), {false, boxes_.size()-1}});
+
+        while(!queue.empty()) {
+            Entry top = queue.top();
+            queue.pop();
+            if(top.second.first) {
+                item = top.second.second;
+                return true;
+            }
+
+            size_t box = top.second.second;
+            if(box < numItems_) {
+                queue.push({distance(items_[box]), {true, items_[box]}});
+                continue;
+            }
+
+            // the children are the boxes of the level below at the same offset
+            size_t level = std::upper_bound(levelEnds_.begin(), levelEnds_.end(), box)-levelEnds_.begin();
+            size_t levelBegin = levelEnds_[level-1], childBegin = level > 1 ? levelEnds_[level-2] : 0;
+            size_t first = childBegin+(box-levelBegin)*NODE_SIZE;
+            size_t last = std::min(first+NODE_SIZE, levelEnds_[level-1]);
+            for(size_t child = first; child < last; child++)
+                queue.push({boxDistance(boxes_[child]), {false, child}});
+        }
+        return false;
+    }
+};
@@ -58,6 +58,9 @@ public:
     friend Point::PointDistType manhattanDistance(const Point &from, const Point &to);
     friend std::vector<Point> computeBoundingBox(const Point &p1, const Point &p2);
     friend size_t closestPoint(const Point &ref, const std::vector<Point> &points);
+    friend Point::PointDistType planarDistance(const Point &ref, const Point &pt);
+    friend Point projectOnSegment(const Point &ref, const Point &from, const Point &to, double &fraction);
+    friend size_t closestSegment(const Point &ref, const std::vector<Point> &line, Point &projection, double &fraction);
     std::vector<Point> getBoundingBox(bool inMercator = false) const;
     friend Point::PointDistType getLength(const std::vector <Point> &line);
     friend Point centerOfMass(const std::vector<Point> &pts);
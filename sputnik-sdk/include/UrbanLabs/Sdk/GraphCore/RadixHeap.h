@@ -0,0 +1,220 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <cassert>
+#include <type_traits>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+
+/**
+ * @brief The RadixHeap class
+ * monotone heap for integer values. Bucket b holds the values whose highest
+ * bit differing from the last popped value is bit b-1, bucket 0 the values
+ * equal to it. A pop empties the first nonempty bucket into the lower ones,
+ * so an element moves at most once per bit of the values.
+ *
+ * Values smaller than the last popped one are popped before all others,
+ * which is their order anyway. Searches with inconsistent bounds keep
+ * working, only the key they see may go down
+ */
+template<typename Key, typename Val, typename KeyPosMap = std::vector<unsigned> >
+class RadixHeap {
+private:
+    typedef typename std::make_unsigned<Val>::type Bits;
+    static const unsigned NUM_BITS = std::numeric_limits<Bits>::digits;
+    static const unsigned NUM_BUCKETS = NUM_BITS+1;
+    // positions are the bucket and the index in it
+    static const unsigned INDEX_BITS = 25;
+    static const unsigned INDEX_MASK = (1u << INDEX_BITS)-1;
+
+    /**
+     * @brief The HeapEl class
+     */
+    class HeapEl {
+    public:
+        Key key;
+        Val val;
+    };
+public:
+    // key -> position map
+    KeyPosMap keyPosMap_;
+private:
+    size_t heapSize_;
+    Val last_;
+    // bucket 0 holds values below the last popped one
+    bool clamped_;
+    std::vector<HeapEl> buckets_[NUM_BUCKETS];
+private:
+    /**
+     * maps the values to unsigned integers of the same order
+     * @brief toBits
+     * @param val
+     * @return
+     */
+    static inline Bits toBits(Val val) {
+        if(std::numeric_limits<Val>::is_signed)
+            return Bits(val)^(Bits(1) << (NUM_BITS-1));
+        return Bits(val);
+    }
+
+    /**
+     * @brief findBucket
+     * @param val
+     * @return
+     */
+    inline unsigned findBucket(Val val) const {
+        Bits bits = toBits(val), last = toBits(last_);
+        if(bits <= last)
+            return 0;
+
+        Bits diff = bits^last;
+#if defined(__GNUC__) || defined(__clang__)
+        if(NUM_BITS <= std::numeric_limits<unsigned>::digits)
+            return std::numeric_limits<unsigned>::digits-__builtin_clz((unsigned)diff);
+        return std::numeric_limits<unsigned long long>::digits-__builtin_clzll((unsigned long long)diff);
+#else
+        unsigned bucket = 0;
+        for(; diff != 0; diff >>= 1)
+            bucket++;
+        return bucket;
+#endif
+    }
+
+    /**
+     * @brief insert
+     * @param el
+     */
+    inline void insert(const HeapEl &el) {
+        unsigned bucket = findBucket(el.val);
+        if(bucket == 0 && el.val < last_)
+            clamped_ = true;
+
+        assert(buckets_[bucket].size() <= INDEX_MASK);
+        keyPosMap_[el.key] = (bucket << INDEX_BITS) | buckets_[bucket].size();
+        buckets_[bucket].push_back(el);
+    }
+
+    /**
+     * @brief remove
+     * @param bucket
+     * @param index
+     */
+    inline void remove(unsigned bucket, size_t index) {
+        std::vector<HeapEl> &elems = buckets_[bucket];
+        if(index+1 != elems.size()) {
+            elems[index] = elems.back();
+            keyPosMap_[elems[index].key] = (bucket << INDEX_BITS) | index;
+        }
+        elems.pop_back();
+    }
+
+    /**
+     * the index of the smallest value in bucket 0, refills the bucket
+     * if it is empty
+     * @brief findTop
+     * @return
+     */
+    inline size_t findTop() {
+        std::vector<HeapEl> &first = buckets_[0];
+        if(first.empty()) {
+            unsigned bucket = 1;
+            while(buckets_[bucket].empty())
+                bucket++;
+
+            std::vector<HeapEl> &elems = buckets_[bucket];
+            last_ = elems[0].val;
+            for(const HeapEl &el : elems) {
+                if(el.val < last_)
+                    last_ = el.val;
+            }
+            clamped_ = false;
+            for(const HeapEl &el : elems)
+                insert(el);
+            elems.clear();
+        }
+
+        if(!clamped_)
+            return first.size()-1;
+
+        size_t top = 0;
+        for(size_t i = 1; i < first.size(); i++) {
+            if(first[i].val < first[top].val)
+                top = i;
+        }
+        return top;
+    }
+public:
+    RadixHeap() : heapSize_(0), last_(std::numeric_limits<Val>::min()), clamped_(false) {;}
+
+    size_t size() const {
+        return heapSize_;
+    }
+
+    bool empty() const {
+        return heapSize_ == 0;
+    }
+
+    /**
+     * removes all elements, the values may start from 0 again
+     */
+    void setEmpty() {
+        for(unsigned bucket = 0; bucket < NUM_BUCKETS; bucket++)
+            buckets_[bucket].clear();
+        heapSize_ = 0;
+        last_ = std::numeric_limits<Val>::min();
+        clamped_ = false;
+    }
+
+    /**
+     * @brief topHeap
+     * @return
+     */
+    std::pair<Key, Val> topHeap() {
+        const HeapEl &el = buckets_[0][findTop()];
+        return std::make_pair(el.key, el.val);
+    }
+
+    /**
+     * insert a new element into the heap
+     */
+    void pushHeap(const Key &key, const Val &val) {
+        insert({key, val});
+        heapSize_++;
+    }
+
+    /**
+     * remove the top of the heap
+     */
+    void popHeap() {
+        remove(0, findTop());
+        heapSize_--;
+        if(buckets_[0].empty())
+            clamped_ = false;
+    }
+
+    /**
+     * decrease the value of an existing key in the heap
+     * @brief decreaseKey
+     * @param key
+     * @param val
+     */
+    void decreaseKey(const Key &key, const Val &val) {
+        unsigned pos = keyPosMap_[key];
+        unsigned bucket = pos >> INDEX_BITS;
+        size_t index = pos & INDEX_MASK;
+        if(val < buckets_[bucket][index].val) {
+            remove(bucket, index);
+            insert({key, val});
+        }
+    }
+};
+
+/**
+ * @brief The RadixHeapPolicy struct
+ */
+struct RadixHeapPolicy {
+    template<typename Key, typename Val, typename KeyPosMap>
+    using HeapType = RadixHeap<Key, Val, KeyPosMap>;
+};
@@ -34,24 +34,5 @@ public:
     const std::vector<Edge::EdgeId> &getOrigWayIds() const;
     const std::vector<Vertex::VertexId> &getPath() const;
 };
-
-/**
- * @brief The SearchResultLocal class
- */
-class SearchResultLocal : public SearchResultBasic {
-public:
-    typedef Vertex::VertexId VertexId;
-    typedef Edge::EdgeDist DistType;
-private:
-    size_t searchSpace_;
-    std::unordered_map<VertexId, DistType> distToTargets_;
-public:
-    SearchResultLocal();
-    SearchResultLocal(const NearestPointResult &src, const NearestPointResult &dest);
-    void setDistToTargets(const std::unordered_map<VertexId, DistType> &dists);
-    void setSearchSpace(size_t searchSpace);
-    size_t getSearchSpace() const;
-    DistType getTargetDistFor(const VertexId id) const;
-};
 } // OsmGraphCore
 
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Heap.h>
+#include <UrbanLabs/Sdk/GraphCore/DaryHeap.h>
+#include <UrbanLabs/Sdk/GraphCore/RadixHeap.h>
+
+/**
+ * @brief The SearchSpace class
+ * the per vertex state of one search kept in flat arrays indexed by the
+ * vertex id. An entry belongs to the current search if its stamp equals the
+ * generation of the search, so a new search only increments the generation.
+ * Spaces are reused by the searches of a thread through acquire and release,
+ * the heap is chosen by the heap policy
+ */
+template<typename VertexId, typename DistType, typename HeapPolicy = BinaryHeapPolicy>
+class SearchSpace {
+public:
+    typedef uint32_t Generation;
+
+    /**
+     * @brief The PositionMap class
+     * positions of the vertices in the heap, only read for vertices which
+     * were pushed in the current search
+     */
+    class PositionMap {
+    private:
+        unsigned *pos_;
+    public:
+        PositionMap(unsigned *pos = 0) : pos_(pos) {;}
+
+        inline unsigned &operator[](VertexId v) {
+            return pos_[v];
+        }
+    };
+
+    typedef typename HeapPolicy::template HeapType<VertexId, DistType, PositionMap> HeapType;
+private:
+    Generation generation_;
+    // stamps of the vertices seen, settled and with a cached bound
+    std::vector<Generation> seen_;
+    std::vector<Generation> settled_;
+    std::vector<Generation> bounded_;
+    std::vector<DistType> dist_;
+    std::vector<VertexId> prev_;
+    std::vector<DistType> bound_;
+    std::vector<unsigned> heapPos_;
+    HeapType heap_;
+private:
+    SearchSpace(const SearchSpace &) = delete;
+    SearchSpace &operator = (const SearchSpace &) = delete;
+
+    /**
+     * spaces free for reuse by the calling thread
+     * @brief getFreeSpaces
+     * @return
+     */
+    static std::vector<std::unique_ptr<SearchSpace> > &getFreeSpaces() {
+        static thread_local std::vector<std::unique_ptr<SearchSpace> > spaces;
+        return spaces;
+    }
+public:
+    SearchSpace() : generation_(0) {;}
+
+    /**
+     * @brief acquire
+     * @return a space of the calling thread, it has to be released by the same thread
+     */
+    static SearchSpace *acquire() {
+        std::vector<std::unique_ptr<SearchSpace> > &spaces = getFreeSpaces();
+        if(spaces.empty())
+            return new SearchSpace();
+
+        SearchSpace *space = spaces.back().release();
+        spaces.pop_back();
+        return space;
+    }
+
+    /**
+     * @brief release
+     * @param space
+     */
+    static void release(SearchSpace *space) {
+        getFreeSpaces().emplace_back(space);
+    }
+
+    /**
+     * starts a new search, the arrays only grow so a space can be shared
+     * by graphs of different sizes
+     * @brief reset
+     * @param numVertices
+     * @param bounds the search caches bounds of the vertices
+     */
+    void reset(size_t numVertices, bool bounds = false) {
+        if(seen_.size() < numVertices) {
+            seen_.resize(numVertices, 0);
+            settled_.resize(numVertices, 0);
+            dist_.resize(numVertices);
+            prev_.resize(numVertices);
+            heapPos_.resize(numVertices);
+        }
+        if(bounds && bounded_.size() < numVertices) {
+            bounded_.resize(numVertices, 0);
+            bound_.resize(numVertices);
+        }
+
+        // the stamps of old searches could be taken for the new one
+        if(generation_ == std::numeric_limits<Generation>::max()) {
+            std::fill(seen_.begin(), seen_.end(), 0);
+            std::fill(settled_.begin(), settled_.end(), 0);
+            std::fill(bounded_.begin(), bounded_.end(), 0);
+            generation_ = 0;
+        }
+        generation_++;
+
+        heap_.setEmpty();
+        heap_.keyPosMap_ = PositionMap(heapPos_.data());
+    }
+
+    inline HeapType &getHeap() {
+        return heap_;
+    }
+
+    inline bool wasSeen(VertexId v) const {
+        return seen_[v] == generation_;
+    }
+
+    /**
+     * @brief visit
+     * @param v
+     * @param dist
+     * @param prev
+     */
+    inline void visit(VertexId v, DistType dist, VertexId prev) {
+        seen_[v] = generation_;
+        dist_[v] = dist;
+        prev_[v] = prev;
+    }
+
+    inline DistType getDist(VertexId v) const {
+        return dist_[v];
+    }
+
+    inline VertexId getPrev(VertexId v) const {
+        return prev_[v];
+    }
+
+    inline bool wasSettled(VertexId v) const {
+        return settled_[v] == generation_;
+    }
+
+    inline void settle(VertexId v) {
+        settled_[v] = generation_;
+    }
+
+    inline bool hasBound(VertexId v) const {
+        return bounded_[v] == generation_;
+    }
+
+    inline DistType getBound(VertexId v) const {
+        return bound_[v];
+    }
+
+    inline void setBound(VertexId v, DistType bound) {
+        bounded_[v] = generation_;
+        bound_[v] = bound;
+    }
+};
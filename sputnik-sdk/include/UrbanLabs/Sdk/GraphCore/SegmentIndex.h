@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Point.h>
+#include <UrbanLabs/Sdk/GraphCore/Vertices.h>
+#include <UrbanLabs/Sdk/GraphCore/PackedRTree.h>
+
+/**
+ * @brief The SegmentIndex class
+ * in memory index of the straight segments of the edge geometries. A
+ * location is snapped to the segment closest to it, the result is the
+ * perpendicular projection on the segment, the edge and how far along the
+ * edge the projection lies, so searches can start with the parts of the
+ * edge costs left to its ends. Distances are measured on the plane
+ * touching the earth at the location, see planarDistance. The index is
+ * only read after it is built and can be searched on several threads
+ */
+class SegmentIndex {
+public:
+    typedef Vertex::VertexId VertexId;
+
+    /**
+     * @brief The Snap struct
+     */
+    struct Snap {
+        // ends of the edge in the direction of its geometry
+        VertexId start_;
+        VertexId end_;
+        // projection of the location on the edge
+        Point point_;
+        // length of the edge before the projection, between 0 and 1
+        double offset_;
+    };
+private:
+    /**
+     * @brief The Line struct
+     * edge a geometry was added for
+     */
+    struct Line {
+        VertexId start_;
+        VertexId end_;
+    };
+
+    /**
+     * @brief The Segment struct
+     * the points first_ and first_+1 of a line
+     */
+    struct Segment {
+        uint32_t first_;
+        uint32_t line_;
+    };
+private:
+    PackedRTree tree_;
+    std::vector<Line> lines_;
+    std::vector<Segment> segments_;
+    // points of all lines one after another, with the length of their
+    // line up to them relative to the whole line
+    std::vector<PackedRTree::Coord> lats_;
+    std::vector<PackedRTree::Coord> lons_;
+    std::vector<float> offsets_;
+private:
+    SegmentIndex(const SegmentIndex &) = delete;
+    SegmentIndex &operator = (const SegmentIndex &) = delete;
+    Point getPoint(size_t point) const;
+public:
+    SegmentIndex();
+    void clear();
+    bool empty() const;
+    size_t getNumSegments() const;
+    size_t getMemoryInfo() const;
+    void add(VertexId start, VertexId end, const std::vector<Point> &geometry);
+    void build();
+    bool findNearest(const Point &pt, Snap &snap) const;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Point.h>
+#include <UrbanLabs/Sdk/GraphCore/Vertices.h>
+#include <UrbanLabs/Sdk/GraphCore/PackedRTree.h>
+#include <UrbanLabs/Sdk/Storage/KdTreeSql.h>
+
+/**
+ * @brief The SnapIndex class
+ * in memory copy of the endpoint and non endpoint kd trees. Every point
+ * keeps the edge it lies on, which the non endpoint tree stores as text,
+ * so finding the point closest to a location is a search in a packed
+ * R-tree without queries to sqlite. The index is only read after it is
+ * built and can be searched on several threads at once
+ */
+class SnapIndex {
+public:
+    typedef Vertex::VertexId VertexId;
+
+    /**
+     * @brief The Target struct
+     * a point of the kd trees, with the ids of the input
+     */
+    struct Target {
+        // id of the point in its kd tree
+        VertexId id_;
+        // ends of the edge the point is on, both are the point for endpoints
+        VertexId start_;
+        VertexId end_;
+        PackedRTree::Coord lat_;
+        PackedRTree::Coord lon_;
+
+        Point getPoint() const;
+    };
+private:
+    PackedRTree tree_;
+    // the endpoints come first, they are preferred at equal distances
+    std::vector<Target> targets_;
+private:
+    SnapIndex(const SnapIndex &) = delete;
+    SnapIndex &operator = (const SnapIndex &) = delete;
+    bool addPoints(KdTreeSql &kdTree, bool endPoints);
+public:
+    SnapIndex();
+    void clear();
+    bool empty() const;
+    size_t getMemoryInfo() const;
+    bool build(KdTreeSql &endPoints, KdTreeSql &nonEndPoints);
+    bool findNearest(const Point &pt, Target &target) const;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+#include <UrbanLabs/Sdk/GraphCore/Edges.h>
+
+/**
+ * @brief The TourOptimizer class
+ * orders stops by the lengths of the paths between them. The tour starts
+ * at the first stop and ends either at any stop or back at the first one.
+ * A nearest neighbour tour is improved by 2-opt moves, which reverse a
+ * part of the tour, and Or-opt moves, which move up to three consecutive
+ * stops elsewhere, until no move helps. The local optimum is then kicked
+ * by swapping two parts of the tour and improved again, the better tour
+ * is kept, until kicks stop helping or the time runs out. The lengths
+ * don't have to be symmetric, one way streets make them differ
+ */
+class TourOptimizer {
+public:
+    typedef Edge::EdgeDist Cost;
+    // lengths indexed by the source and the target, -1 if there is no path
+    typedef std::vector<std::vector<Cost> > Matrix;
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef int64_t TourCost;
+    // cost of a missing path, larger than any tour using only real paths
+    static const TourCost UNREACHABLE;
+    // kicks in a row which don't improve the tour before giving up
+    static const size_t MAX_FAILED_KICKS;
+private:
+    const Matrix &costs_;
+    bool roundTrip_;
+    double timeLimit_;
+    Clock::time_point deadline_;
+    // lengths along the tour and against it up to every position
+    std::vector<TourCost> forward_;
+    std::vector<TourCost> backward_;
+    // the same stops always give the same order
+    std::mt19937 random_;
+private:
+    TourOptimizer(const TourOptimizer &) = delete;
+    TourOptimizer &operator = (const TourOptimizer &) = delete;
+    TourCost cost(size_t from, size_t to) const;
+    TourCost tourCost(const std::vector<size_t> &tour) const;
+    void nearestNeighbor(std::vector<size_t> &tour) const;
+    void updatePrefix(const std::vector<size_t> &tour);
+    bool twoOpt(std::vector<size_t> &tour);
+    bool orOpt(std::vector<size_t> &tour);
+    size_t localSearch(std::vector<size_t> &tour);
+    void kick(std::vector<size_t> &tour);
+    bool timeIsUp() const;
+public:
+    TourOptimizer(const Matrix &costs);
+    void setRoundTrip(bool roundTrip);
+    void setTimeLimit(double seconds);
+    bool optimize(std::vector<size_t> &order);
+};
@@ -20,6 +20,8 @@ public:
     Vertex::VertexId getVia() const;
     Edge::EdgeId getFrom() const;
     Edge::EdgeId getTo() const;
+    bool isProhibitive() const;
+    bool isMandatory() const;
 };
 
 namespace std {
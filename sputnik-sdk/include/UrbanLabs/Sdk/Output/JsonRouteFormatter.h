@@ -21,6 +21,8 @@ public:
     Nodes textAndValue(T text, V value);
     void addRoot(const Point &startPoint, const Point &endPoint);
     void addRoute(const Point &startPoint, const Point &endPoint, JsonRouteFormatter::Nodes &legs, const Edge::EdgeDist length);
+    void addRoutes(const JsonRouteFormatter::Nodes &routes);
+    Node getRoute(const Point &startPoint, const Point &endPoint, JsonRouteFormatter::Nodes &legs, const Edge::EdgeDist length);
     Node getLeg(const std::vector <std::vector<Point> > &multiLines, const std::vector<Edge::EdgeId> &origWayIds,
                 const Point &startPoint, const Point &endPoint,
                 const Edge::EdgeDist length, const Edge::EdgeDist duration);
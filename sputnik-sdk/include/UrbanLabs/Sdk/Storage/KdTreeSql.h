@@ -39,15 +39,25 @@ protected:
     // database connection
     std::string idCol_;
     std::string table_;
+    std::string dataField_;
     bool fetchData_;
     std::unique_ptr<DbConn> conn_;
     std::unique_ptr<PrepStmt> stmt_;
+    // nodes of the sqlite r-tree and the data of a single point, for the
+    // nearest neighbour search, empty when the nodes can't be read
+    std::unique_ptr<PrepStmt> nodeStmt_;
+    std::unique_ptr<PrepStmt> dataStmt_;
 protected:
     KdTreeSql &operator = (const KdTreeSql &kd);
     KdTreeSql(const KdTreeSql &kd);
 private:
     bool queryRtree(const Point &hiLeft, const Point &lowRight,
                     std::vector<VertexPoint> &results, std::vector<string> &data);
+    bool readNode(int64_t node, int &depth, std::string &cells);
+    bool findKNearestNodes(const Point &pt, size_t k, double maxDist,
+                           std::vector<VertexPoint> &results, std::vector<string> &data);
+    bool findKNearestBoxes(const Point &pt, size_t k, double maxDist,
+                           std::vector<VertexPoint> &results, std::vector<string> &data);
 public:
     KdTreeSql();
     virtual ~KdTreeSql();
@@ -59,6 +69,8 @@ public:
     bool insertBulkSql(const VertexPoint &vertexPoint,const std::string &separator,
                        const std::string &data = "");
     bool findNearestVertex(const Point &pt, NearestPointResult &result, std::string &data);
+    bool findKNearest(const Point &pt, size_t k, double maxDist,
+                      std::vector<VertexPoint> &results, std::vector<string> &data);
     bool findAllInBoundingBox(const Point &hiLeft, const Point &lowRight,
                               std::vector<VertexPoint> &results, std::vector<string> &data);
     bool getPoints(const std::vector<Vertex::VertexId> &vs,std::vector<Point> &pt, std::vector<int8_t> &found);
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <functional>
 #include <unordered_map>
 #include <UrbanLabs/Sdk/Platform/Stdafx.h>
 #include <UrbanLabs/Sdk/Utils/Timer.h>
@@ -116,6 +117,7 @@ class GeometryIndexSql {
 public:
     typedef Vertex::VertexId VertexId;
     typedef Point::CoordType CoordType;
+    typedef std::function<bool (VertexId, VertexId, const std::vector<Point> &)> GeometryVisitor;
 private:
     std::unique_ptr<DbConn> conn_;
     std::unique_ptr<PrepStmt> selectStmt_;
@@ -135,6 +137,7 @@ public:
                                 const bool fixed, std::vector<Point> &points);
     virtual bool findGeometry(const VertexId id1, const VertexId id2, const Point &target,
                               const bool fixed, std::vector<Point> &geometry);
+    bool forEachGeometry(const GeometryVisitor &visitor);
 
     void setCompression(bool compress);
 };
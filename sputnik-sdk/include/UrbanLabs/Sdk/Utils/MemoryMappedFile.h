@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include <UrbanLabs/Sdk/Platform/Stdafx.h>
+
+/**
+ * @brief The MemoryMappedFile class
+ * maps a whole file into memory, pages are shared between processes
+ * mapping the same file, writes are private to the process
+ */
+class MemoryMappedFile {
+private:
+    std::string path_;
+    char *data_;
+    size_t size_;
+private:
+    MemoryMappedFile(const MemoryMappedFile &) = delete;
+    MemoryMappedFile &operator = (const MemoryMappedFile &) = delete;
+public:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+    bool open(const std::string &path);
+    bool close();
+    bool isOpen() const;
+    char *data() const;
+    size_t size() const;
+    const std::string &getPath() const;
+};
@@ -1,5 +1,12 @@
+#include <unordered_map>
+
 #include <UrbanLabs/Sdk/Concurrent/ReadWriteLock.h>
 
+namespace {
+// number of read locks the calling thread holds on each lock
+thread_local std::unordered_map<const ReadWriteLock*, int> heldReads;
+} // namespace
+
 namespace detail {
 
 WriteScopeGuard::WriteScopeGuard(ReadWriteLock* lock)
@@ -14,7 +21,7 @@ WriteScopeGuard::WriteScopeGuard(ReadWriteLock* lock)
 WriteScopeGuard::~WriteScopeGuard()
 {
     if (engaged_) {
-        std::bind(finish_, std::move(result_));
+        finish_(std::move(result_));
     }
 }
 void WriteScopeGuard::release()
@@ -46,7 +53,11 @@ void ReadScopeGuard::release()
 void ReadWriteLock::init()
 {
     startRead_ = [this]() {
-        std::lock_guard<std::mutex> guard(requestLock_);
+        std::unique_lock<std::mutex> guard(requestLock_);
+        // a thread reading already mustn't wait for a writer which waits for it
+        if (heldReads[this]++ == 0) {
+            hasNoWriters_.wait(guard, [this]() {return numWriters_ == 0; });
+        }
         numRequests_++;
     };
 
@@ -54,6 +65,10 @@ void ReadWriteLock::init()
         {
             std::lock_guard<std::mutex> guard(requestLock_);
             numRequests_--;
+            auto held = heldReads.find(this);
+            if (--held->second == 0) {
+                heldReads.erase(held);
+            }
         }
         // notify all potential writers that read is over
         // notifying one will not work as he might not be able to aquire the lock
@@ -62,32 +77,39 @@ void ReadWriteLock::init()
 
     startWrite_ = [this]() {
         std::unique_lock<std::mutex> guard(requestLock_);
+        // new readers wait from now on
+        numWriters_++;
         hasNoRequests_.wait(guard, [this]() {return numRequests_ == 0; });
         assert(numRequests_ == 0);
         return guard;
     };
 
     finishWrite_ = [this](std::unique_lock<std::mutex>&& guard) {
+        numWriters_--;
         guard.unlock();
-        // wake up only 1 writer
+        // wake up only 1 writer, the readers go once no writer waits
         hasNoRequests_.notify_one();
+        hasNoWriters_.notify_all();
     };
 }
 
 ReadWriteLock::ReadWriteLock()
     : numRequests_(0)
+    , numWriters_(0)
 {
     init();
 }
 
 ReadWriteLock::ReadWriteLock(const ReadWriteLock& lock)
     : numRequests_(0)
+    , numWriters_(0)
 {
     init();
 }
 
 ReadWriteLock::ReadWriteLock(ReadWriteLock&& lock)
     : numRequests_(0)
+    , numWriters_(0)
 {
     init();
 }
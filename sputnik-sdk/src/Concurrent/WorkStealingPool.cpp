@@ -0,0 +1,130 @@
+// WorkStealingPool.cpp
+//
+#include <limits>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/Concurrent/WorkStealingPool.h>
+
+using namespace std;
+
+const size_t WorkStealingPool::NullWorker = numeric_limits<size_t>::max();
+
+namespace {
+    // pool and index of the pool thread running on this thread
+    thread_local const WorkStealingPool *currentPool = 0;
+    thread_local size_t currentWorker = WorkStealingPool::NullWorker;
+}
+
+/**
+ * @brief WorkStealingPool::WorkStealingPool
+ * @param numThreads 0 uses all available cores
+ */
+WorkStealingPool::WorkStealingPool(size_t numThreads) : numQueued_(0), nextQueue_(0), stop_(false) {
+    if(numThreads == 0)
+        numThreads = max<size_t>(1, thread::hardware_concurrency());
+
+    for(size_t t = 0; t < numThreads; t++)
+        queues_.push_back(unique_ptr<Queue>(new Queue()));
+    for(size_t t = 0; t < numThreads; t++)
+        threads_.push_back(thread(&WorkStealingPool::run, this, t));
+}
+/**
+ * the queued tasks are run before the threads stop
+ * @brief WorkStealingPool::~WorkStealingPool
+ */
+WorkStealingPool::~WorkStealingPool() {
+    {
+        lock_guard<mutex> lock(sleepLock_);
+        stop_ = true;
+    }
+    wakeUp_.notify_all();
+    for(size_t t = 0; t < threads_.size(); t++)
+        threads_[t].join();
+}
+/**
+ * @brief WorkStealingPool::getNumThreads
+ * @return
+ */
+size_t WorkStealingPool::getNumThreads() const {
+    return threads_.size();
+}
+/**
+ * @brief WorkStealingPool::getCurrentWorker
+ * @return the index of the calling thread, null if it is not a thread of the pool
+ */
+size_t WorkStealingPool::getCurrentWorker() const {
+    return currentPool == this ? currentWorker : NullWorker;
+}
+/**
+ * a thread of the pool queues the task in its own queue, other threads
+ * spread the tasks over the queues
+ * @brief WorkStealingPool::submit
+ * @param task
+ */
+void WorkStealingPool::submit(const Task &task) {
+    size_t worker = getCurrentWorker();
+    if(worker == NullWorker)
+        worker = nextQueue_++ % queues_.size();
+    {
+        lock_guard<mutex> lock(queues_[worker]->lock_);
+        queues_[worker]->tasks_.push_back(task);
+        numQueued_++;
+    }
+    // a thread about to sleep either sees the task or gets the notification
+    {
+        lock_guard<mutex> lock(sleepLock_);
+    }
+    wakeUp_.notify_one();
+}
+/**
+ * the newest task of the own queue, otherwise the oldest task of another
+ * @brief WorkStealingPool::popTask
+ * @param worker
+ * @param task
+ * @return false if all queues are empty
+ */
+bool WorkStealingPool::popTask(size_t worker, Task &task) {
+    {
+        Queue &own = *queues_[worker];
+        lock_guard<mutex> lock(own.lock_);
+        if(!own.tasks_.empty()) {
+            task = move(own.tasks_.back());
+            own.tasks_.pop_back();
+            numQueued_--;
+            return true;
+        }
+    }
+    for(size_t i = 1; i < queues_.size(); i++) {
+        Queue &other = *queues_[(worker+i) % queues_.size()];
+        lock_guard<mutex> lock(other.lock_);
+        if(!other.tasks_.empty()) {
+            task = move(other.tasks_.front());
+            other.tasks_.pop_front();
+            numQueued_--;
+            return true;
+        }
+    }
+    return false;
+}
+/**
+ * @brief WorkStealingPool::run
+ * @param worker
+ */
+void WorkStealingPool::run(size_t worker) {
+    currentPool = this;
+    currentWorker = worker;
+
+    Task task;
+    while(true) {
+        if(popTask(worker, task)) {
+            task(worker);
+            task = Task();
+            continue;
+        }
+
+        unique_lock<mutex> lock(sleepLock_);
+        wakeUp_.wait(lock, [this]() { return stop_ || numQueued_ > 0; });
+        if(stop_ && numQueued_ == 0)
+            return;
+    }
+}
@@ -0,0 +1,249 @@
+// CompactAdjacency.cpp
+//
+#include <limits>
+
+#include <UrbanLabs/Sdk/GraphCore/CompactAdjacency.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+
+using namespace std;
+
+const CompactAdjacency::EdgeIndex CompactAdjacency::NullEdgeIndex = numeric_limits<EdgeIndex>::max();
+const CompactAdjacency::ShortcutEdges CompactAdjacency::NullShortcutEdges = {NullEdgeIndex, NullEdgeIndex};
+
+const CompactAdjacency::Sections CompactAdjacency::FORWARD_SECTIONS = {
+    GraphFile::FORW_OFFSETS, GraphFile::FORW_EDGES, GraphFile::FORW_VIA, GraphFile::FORW_ORIG_IDS,
+    {GraphFile::FORW_DIST_INPUT, GraphFile::FORW_TIME_INPUT},
+    {GraphFile::FORW_DIST_SHORTCUT_VIA, GraphFile::FORW_TIME_SHORTCUT_VIA},
+    {GraphFile::FORW_DIST_SHORTCUT_EDGES, GraphFile::FORW_TIME_SHORTCUT_EDGES}
+};
+
+const CompactAdjacency::Sections CompactAdjacency::BACKWARD_SECTIONS = {
+    GraphFile::BACK_OFFSETS, GraphFile::BACK_EDGES, GraphFile::BACK_VIA, GraphFile::BACK_ORIG_IDS,
+    {GraphFile::BACK_DIST_INPUT, GraphFile::BACK_TIME_INPUT},
+    {GraphFile::BACK_DIST_SHORTCUT_VIA, GraphFile::BACK_TIME_SHORTCUT_VIA},
+    {GraphFile::BACK_DIST_SHORTCUT_EDGES, GraphFile::BACK_TIME_SHORTCUT_EDGES}
+};
+
+/**
+ * @brief CompactAdjacency::CompactAdjacency
+ */
+CompactAdjacency::CompactAdjacency() : offsets_(0), edges_(0), via_(0), origIds_(0),
+    numVertices_(0), numEdges_(0) {
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        input_[m] = 0;
+        shortcutVia_[m] = 0;
+        shortcutEdges_[m] = 0;
+    }
+}
+/**
+ * @brief CompactAdjacency::clear
+ */
+void CompactAdjacency::clear() {
+    vector<EdgeOffset>().swap(offsetsData_);
+    vector<CompactEdge>().swap(edgesData_);
+    vector<CompactVertexId>().swap(viaData_);
+    vector<Edge::EdgeId>().swap(origIdsData_);
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        vector<Weight>().swap(inputData_[m]);
+        vector<CompactVertexId>().swap(shortcutViaData_[m]);
+        vector<ShortcutEdges>().swap(shortcutEdgesData_[m]);
+        input_[m] = 0;
+        shortcutVia_[m] = 0;
+        shortcutEdges_[m] = 0;
+    }
+    offsets_ = 0;
+    edges_ = 0;
+    via_ = 0;
+    origIds_ = 0;
+    numVertices_ = 0;
+    numEdges_ = 0;
+}
+/**
+ * @brief CompactAdjacency::isMapped
+ * @return
+ */
+bool CompactAdjacency::isMapped() const {
+    return offsets_ != 0 && offsets_ != offsetsData_.data();
+}
+/**
+ * @brief CompactAdjacency::getNumVertices
+ * @return
+ */
+size_t CompactAdjacency::getNumVertices() const {
+    return numVertices_;
+}
+/**
+ * @brief CompactAdjacency::getNumEdges
+ * @return
+ */
+size_t CompactAdjacency::getNumEdges() const {
+    return numEdges_;
+}
+/**
+ * @brief CompactAdjacency::getMemoryUsage
+ * memory allocated on the heap, mapped arrays are not counted
+ * @return
+ */
+size_t CompactAdjacency::getMemoryUsage() const {
+    size_t memory = offsetsData_.capacity()*sizeof(EdgeOffset)+edgesData_.capacity()*sizeof(CompactEdge)+
+                    viaData_.capacity()*sizeof(CompactVertexId)+origIdsData_.capacity()*sizeof(Edge::EdgeId);
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        memory += inputData_[m].capacity()*sizeof(Weight)+shortcutViaData_[m].capacity()*sizeof(CompactVertexId)+
+                  shortcutEdgesData_[m].capacity()*sizeof(ShortcutEdges);
+    }
+    return memory;
+}
+/**
+ * @brief CompactAdjacency::useOwnedData
+ */
+void CompactAdjacency::useOwnedData() {
+    assert(offsetsData_.size() > 0);
+    offsets_ = offsetsData_.data();
+    edges_ = edgesData_.data();
+    via_ = viaData_.data();
+    origIds_ = origIdsData_.data();
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        input_[m] = inputData_[m].data();
+        shortcutVia_[m] = shortcutViaData_[m].data();
+        shortcutEdges_[m] = shortcutEdgesData_[m].data();
+    }
+    numVertices_ = offsetsData_.size()-1;
+    numEdges_ = edgesData_.size();
+}
+/**
+ * copies the array into data unless it is already stored there
+ * @brief copyArray
+ */
+template<typename T>
+static void copyArray(const T *array, size_t size, vector<T> &data) {
+    if(array != data.data())
+        data.assign(array, array+size);
+}
+/**
+ * copies the mapped arrays so that they can be modified. Arrays swapped
+ * in by swapWeights are owned already
+ * @brief CompactAdjacency::copyMappedData
+ */
+void CompactAdjacency::copyMappedData() {
+    if(!isMapped())
+        return;
+
+    copyArray(offsets_, numVertices_+1, offsetsData_);
+    copyArray(edges_, numEdges_, edgesData_);
+    copyArray(via_, numEdges_, viaData_);
+    copyArray(origIds_, numEdges_, origIdsData_);
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        copyArray(input_[m], numEdges_, inputData_[m]);
+        copyArray(shortcutVia_[m], numEdges_, shortcutViaData_[m]);
+        copyArray(shortcutEdges_[m], numEdges_, shortcutEdgesData_[m]);
+    }
+    useOwnedData();
+}
+/**
+ * @brief CompactAdjacency::map
+ * uses the arrays stored in the graph file without copying them, the
+ * file should stay open while the adjacency is in use
+ * @param file
+ * @param sections
+ * @return
+ */
+bool CompactAdjacency::map(const GraphFileReader &file, const Sections &sections) {
+    clear();
+
+    size_t numOffsets = 0, numEdges = 0, numVia = 0, numOrigIds = 0;
+    EdgeOffset *offsets = file.getSection<EdgeOffset>(sections.offsets_, numOffsets);
+    CompactEdge *edges = file.getSection<CompactEdge>(sections.edges_, numEdges);
+    CompactVertexId *via = file.getSection<CompactVertexId>(sections.via_, numVia);
+    Edge::EdgeId *origIds = file.getSection<Edge::EdgeId>(sections.origIds_, numOrigIds);
+
+    size_t numVertices = file.getNumVertices();
+    bool good = offsets != 0 && numOffsets == numVertices+1 && offsets[0] == 0 && offsets[numVertices] == numEdges &&
+                numVia == numEdges && numOrigIds == numEdges && (numEdges == 0 || (edges != 0 && via != 0 && origIds != 0));
+
+    Weight *input[Edge::NUM_METRICS];
+    CompactVertexId *shortcutVia[Edge::NUM_METRICS];
+    ShortcutEdges *shortcutEdges[Edge::NUM_METRICS];
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        size_t numInput = 0, numShortcutVia = 0, numShortcutEdges = 0;
+        input[m] = file.getSection<Weight>(sections.input_[m], numInput);
+        shortcutVia[m] = file.getSection<CompactVertexId>(sections.shortcutVia_[m], numShortcutVia);
+        shortcutEdges[m] = file.getSection<ShortcutEdges>(sections.shortcutEdges_[m], numShortcutEdges);
+        good = good && numInput == numEdges && numShortcutVia == numEdges && numShortcutEdges == numEdges &&
+               (numEdges == 0 || (input[m] != 0 && shortcutVia[m] != 0 && shortcutEdges[m] != 0));
+    }
+
+    if(!good) {
+        LOGG(Logger::ERROR) << "[GRAPH FILE] inconsistent adjacency sections" << Logger::FLUSH;
+        return false;
+    }
+
+    // a corrupted file should not lead to reads outside of the mapping
+    for(size_t i = 0; i < numVertices; i++) {
+        if(offsets[i] > offsets[i+1]) {
+            LOGG(Logger::ERROR) << "[GRAPH FILE] adjacency offsets are not sorted" << Logger::FLUSH;
+            return false;
+        }
+    }
+    for(size_t i = 0; i < numEdges; i++) {
+        if(edges[i].getNextId() >= (VertexId)numVertices) {
+            LOGG(Logger::ERROR) << "[GRAPH FILE] edge target out of range" << Logger::FLUSH;
+            return false;
+        }
+    }
+
+    offsets_ = offsets;
+    edges_ = edges;
+    via_ = via;
+    origIds_ = origIds;
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        input_[m] = input[m];
+        shortcutVia_[m] = shortcutVia[m];
+        shortcutEdges_[m] = shortcutEdges[m];
+    }
+    numVertices_ = numVertices;
+    numEdges_ = numEdges;
+    return true;
+}
+/**
+ * @brief CompactAdjacency::write
+ * @param file
+ * @param sections
+ * @return
+ */
+bool CompactAdjacency::write(GraphFileWriter &file, const Sections &sections) const {
+    if(offsets_ == 0)
+        return false;
+
+    bool good = file.writeSection(sections.offsets_, offsets_, (numVertices_+1)*sizeof(EdgeOffset)) &&
+                file.writeSection(sections.edges_, edges_, numEdges_*sizeof(CompactEdge)) &&
+                file.writeSection(sections.via_, via_, numEdges_*sizeof(CompactVertexId)) &&
+                file.writeSection(sections.origIds_, origIds_, numEdges_*sizeof(Edge::EdgeId));
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        good = good && file.writeSection(sections.input_[m], input_[m], numEdges_*sizeof(Weight)) &&
+               file.writeSection(sections.shortcutVia_[m], shortcutVia_[m], numEdges_*sizeof(CompactVertexId)) &&
+               file.writeSection(sections.shortcutEdges_[m], shortcutEdges_[m], numEdges_*sizeof(ShortcutEdges));
+    }
+    return good;
+}
+/**
+ * a corrupted file should not lead to reads outside of the mapping when
+ * shortcuts are unpacked
+ * @brief CompactAdjacency::checkShortcutEdges
+ * @param in the adjacency the edges into the middle vertices are stored in
+ * @param out the adjacency the edges out of the middle vertices are stored in
+ * @return
+ */
+bool CompactAdjacency::checkShortcutEdges(const CompactAdjacency &in, const CompactAdjacency &out) const {
+    for(size_t m = 0; m < Edge::NUM_METRICS; m++) {
+        for(size_t i = 0; i < numEdges_; i++) {
+            const ShortcutEdges &edges = shortcutEdges_[m][i];
+            if(edges.in_ == NullEdgeIndex)
+                continue;
+            if(edges.in_ >= in.getNumEdges() || edges.out_ >= out.getNumEdges()) {
+                LOGG(Logger::ERROR) << "[GRAPH FILE] shortcut edge out of range" << Logger::FLUSH;
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -8,6 +8,7 @@ using namespace std;
 const Edge::EdgeId Edge::NullEdgeId = -1;
 const Edge::EdgeDist Edge::MaxDist = numeric_limits<Edge::EdgeDist>::max();
 const Edge::EdgeTime Edge::MaxTime = numeric_limits<Edge::EdgeTime>::max();
+const CompactEdge::CompactVertexId CompactEdge::NullCompactVertexId = numeric_limits<CompactEdge::CompactVertexId>::max();
 
 /**
  * @brief getCost
@@ -18,6 +19,24 @@ typename Edge::TimeMetric::Metric Edge::getCost<Edge::TimeMetric>() const {
     return time_;
 }
 
+/**
+ * @brief getCost
+ * @return
+ */
+template<>
+typename Edge::TimeMetric::Metric CompactEdge::getCost<Edge::TimeMetric>() const {
+    return time_;
+}
+
+/**
+ * @brief setCost
+ * @param cost
+ */
+template<>
+void CompactEdge::setCost<Edge::TimeMetric>(Edge::TimeMetric::Metric cost) {
+    time_ = cost;
+}
+
 namespace std {
     // specialize hashing function for edges
 //    template<>
@@ -6,9 +6,9 @@
  * @param nextId
  * @param time
  */
-EdgeGTFS::EdgeGTFS(Trip::TripId tripId, VertexGTFS::VertexId /*nextId*/, StopTime::StopTimeDiff /*time*/)
-    : tripId_(tripId) {// Edge(nextId, time, Vertex::NullVertexId, 0),  {
-    abort();
+EdgeGTFS::EdgeGTFS(Trip::TripId tripId, VertexGTFS::VertexId nextId, StopTime::StopTimeDiff time)
+    : Edge(Vertex(nextId), time, time, Vertex::NullVertexId, 0, Edge::NullEdgeId), tripId_(tripId) {
+    ;
 }
 /**
  * @brief EdgeGTFS::getTripId
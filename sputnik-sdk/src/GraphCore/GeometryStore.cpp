@@ -0,0 +1,222 @@
+// GeometryStore.cpp
+//
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/GraphCore/GeometryStore.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+
+using namespace std;
+
+const double GeometryStore::SCALE_FACTOR = 1e7;
+
+namespace {
+    /**
+     * @brief writeVarint
+     * @param value
+     * @param out
+     */
+    inline void writeVarint(int64_t value, vector<uint8_t> &out) {
+        // zigzag, small negative values get small codes
+        uint64_t bits = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+        while(bits >= 0x80) {
+            out.push_back(uint8_t(bits) | 0x80);
+            bits >>= 7;
+        }
+        out.push_back(uint8_t(bits));
+    }
+
+    /**
+     * @brief readVarint
+     * @param data
+     * @return
+     */
+    inline int64_t readVarint(const uint8_t *&data) {
+        uint64_t bits = 0;
+        for(unsigned shift = 0; ; shift += 7) {
+            uint8_t byte = *data++;
+            bits |= uint64_t(byte & 0x7f) << shift;
+            if(byte < 0x80)
+                break;
+        }
+        return int64_t(bits >> 1) ^ -int64_t(bits & 1);
+    }
+}
+
+/**
+ * @brief GeometryStore::GeometryStore
+ */
+GeometryStore::GeometryStore() {
+    clear();
+}
+/**
+ * @brief GeometryStore::setStored
+ * points the arrays to the stored vectors
+ */
+void GeometryStore::setStored() {
+    numGeometries_ = keyStore_.size();
+    keys_ = keyStore_.data();
+    offsets_ = offsetStore_.data();
+    points_ = pointStore_.data();
+}
+/**
+ * @brief GeometryStore::clear
+ */
+void GeometryStore::clear() {
+    vector<Key>().swap(keyStore_);
+    vector<Offset>(1, 0).swap(offsetStore_);
+    vector<uint8_t>().swap(pointStore_);
+    file_.close();
+    setStored();
+}
+/**
+ * @brief GeometryStore::empty
+ * @return
+ */
+bool GeometryStore::empty() const {
+    return numGeometries_ == 0;
+}
+/**
+ * @brief GeometryStore::getNumGeometries
+ * @return
+ */
+size_t GeometryStore::getNumGeometries() const {
+    return numGeometries_;
+}
+/**
+ * appends a geometry, the geometries have to be added ordered by their keys
+ * @brief GeometryStore::add
+ * @param id1
+ * @param id2
+ * @param points
+ * @return false if the geometry is out of order, empty geometries are skipped
+ */
+bool GeometryStore::add(VertexId id1, VertexId id2, const vector<Point> &points) {
+    Key key = {id1, id2};
+    if(file_.isOpen() || (!keyStore_.empty() && key < keyStore_.back()))
+        return false;
+    if(points.empty())
+        return true;
+
+    int64_t prevLat = 0, prevLon = 0;
+    for(const Point &pt : points) {
+        int64_t lat = llround(pt.lat()*SCALE_FACTOR), lon = llround(pt.lon()*SCALE_FACTOR);
+        writeVarint(lat-prevLat, pointStore_);
+        writeVarint(lon-prevLon, pointStore_);
+        prevLat = lat;
+        prevLon = lon;
+    }
+    keyStore_.push_back(key);
+    offsetStore_.push_back(pointStore_.size());
+    setStored();
+    return true;
+}
+/**
+ * @brief GeometryStore::decode
+ * @param geometry
+ * @param points the points are appended
+ */
+void GeometryStore::decode(size_t geometry, vector<Point> &points) const {
+    const uint8_t *data = points_+offsets_[geometry], *end = points_+offsets_[geometry+1];
+    int64_t lat = 0, lon = 0;
+    while(data < end) {
+        lat += readVarint(data);
+        lon += readVarint(data);
+        points.push_back(Point(lat/SCALE_FACTOR, lon/SCALE_FACTOR));
+    }
+}
+/**
+ * finds the geometry like GeometryIndexSql::findGeometry, of several
+ * geometries with the same key the one closest to the target is taken
+ * @brief GeometryStore::findGeometry
+ * @param id1
+ * @param id2
+ * @param target
+ * @param fixed the key depends on the order of the vertices
+ * @param geometry the points are appended
+ * @return false if there is no geometry for the edge
+ */
+bool GeometryStore::findGeometry(VertexId id1, VertexId id2, const Point &target,
+                                 bool fixed, vector<Point> &geometry) const {
+    Edge::EdgeKey edge = fixed ? edgeKeyFixed(Vertex(id1), Vertex(id2)) : edgeKey(Vertex(id1), Vertex(id2));
+    Key key = {edge.first, edge.second};
+    pair<const Key *, const Key *> range = equal_range(keys_, keys_+numGeometries_, key);
+    if(range.first == range.second)
+        return false;
+
+    size_t best = range.first-keys_;
+    if(range.second-range.first > 1) {
+        vector<Point> points;
+        Point::PointDistType currDistance = numeric_limits<Point::PointDistType>::max();
+        for(size_t i = range.first-keys_; i < size_t(range.second-keys_); i++) {
+            points.clear();
+            decode(i, points);
+            Point::PointDistType distance = manhattanDistance(target, points[closestPoint(target, points)]);
+            if(currDistance-distance > 0) {
+                currDistance = distance;
+                best = i;
+            }
+        }
+    }
+
+    size_t first = geometry.size();
+    decode(best, geometry);
+    if(id1 > id2 && !fixed)
+        reverse(geometry.begin()+first, geometry.end());
+    return true;
+}
+/**
+ * @brief GeometryStore::save
+ * @param path
+ * @return
+ */
+bool GeometryStore::save(const string &path) const {
+    GraphFileWriter writer;
+    if(!writer.open(path, 0))
+        return false;
+
+    bool written = writer.writeSection(GraphFile::GEOMETRY_KEYS, keys_, numGeometries_*sizeof(Key)) &&
+                   writer.writeSection(GraphFile::GEOMETRY_OFFSETS, offsets_, (numGeometries_+1)*sizeof(Offset)) &&
+                   writer.writeSection(GraphFile::GEOMETRY_POINTS, points_, offsets_[numGeometries_]);
+    if(!writer.close() || !written) {
+        LOGG(Logger::ERROR) << "[GEOMETRY STORE] can't write " << path << Logger::FLUSH;
+        return false;
+    }
+    return true;
+}
+/**
+ * maps the geometries stored next to a graph
+ * @brief GeometryStore::load
+ * @param path
+ * @return false if there is no file or it is corrupted
+ */
+bool GeometryStore::load(const string &path) {
+    clear();
+    if(!file_.open(path))
+        return false;
+
+    size_t numKeys = 0, numOffsets = 0, numBytes = 0;
+    const Key *keys = file_.getSection<Key>(GraphFile::GEOMETRY_KEYS, numKeys);
+    const Offset *offsets = file_.getSection<Offset>(GraphFile::GEOMETRY_OFFSETS, numOffsets);
+    const uint8_t *points = file_.getSection<uint8_t>(GraphFile::GEOMETRY_POINTS, numBytes);
+    if(offsets == 0 || numOffsets != numKeys+1 || offsets[0] != 0 || offsets[numKeys] != numBytes) {
+        LOGG(Logger::ERROR) << "[GEOMETRY STORE] inconsistent geometry sections in " << path << Logger::FLUSH;
+        clear();
+        return false;
+    }
+    for(size_t i = 0; i < numKeys; i++) {
+        if(offsets[i] > offsets[i+1] || (i > 0 && keys[i] < keys[i-1])) {
+            LOGG(Logger::ERROR) << "[GEOMETRY STORE] corrupted geometries in " << path << Logger::FLUSH;
+            clear();
+            return false;
+        }
+    }
+
+    numGeometries_ = numKeys;
+    keys_ = keys;
+    offsets_ = offsets;
+    points_ = points;
+    LOGG(Logger::INFO) << "[GEOMETRY STORE] loaded " << numGeometries_ << " geometries" << Logger::FLUSH;
+    return true;
+}
@@ -0,0 +1,177 @@
+// GraphFile.cpp
+//
+#include <cstring>
+
+#include <UrbanLabs/Sdk/GraphCore/GraphFile.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+
+using namespace std;
+
+const char GraphFile::MAGIC[8] = {'S', 'P', 'T', 'K', 'G', 'R', 'P', 'H'};
+const uint32_t GraphFile::VERSION;
+const size_t GraphFile::ALIGNMENT;
+
+/**
+ * @brief GraphFile::isGraphFile
+ * checks the magic only, the file might be of a different version
+ * @param path
+ * @return
+ */
+bool GraphFile::isGraphFile(const string &path) {
+    ifstream iss(path, ifstream::in | ifstream::binary);
+    char magic[sizeof(MAGIC)];
+    if(!iss.read(magic, sizeof(magic)))
+        return false;
+    return memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+//------------------------------------------------------------------------------
+// GraphFileWriter
+//------------------------------------------------------------------------------
+/**
+ * @brief GraphFileWriter::GraphFileWriter
+ */
+GraphFileWriter::GraphFileWriter() {
+    memset(&header_, 0, sizeof(header_));
+}
+/**
+ * @brief GraphFileWriter::open
+ * @param path
+ * @param numVertices
+ * @return
+ */
+bool GraphFileWriter::open(const string &path, uint64_t numVertices) {
+    oss_.open(path, ofstream::out | ofstream::binary | ofstream::trunc);
+    if(!oss_.is_open()) {
+        LOGG(Logger::ERROR) << "[GRAPH FILE] can't open " << path << " for writing" << Logger::FLUSH;
+        return false;
+    }
+
+    memset(&header_, 0, sizeof(header_));
+    memcpy(header_.magic_, GraphFile::MAGIC, sizeof(GraphFile::MAGIC));
+    header_.version_ = GraphFile::VERSION;
+    header_.numVertices_ = numVertices;
+
+    // reserve space for the header, it is rewritten on close
+    oss_.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+    return oss_.good();
+}
+/**
+ * @brief GraphFileWriter::writeSection
+ * @param section
+ * @param data
+ * @param size
+ * @return
+ */
+bool GraphFileWriter::writeSection(GraphFile::Section section, const void *data, size_t size) {
+    if(!oss_.is_open() || section >= GraphFile::NUM_SECTIONS)
+        return false;
+
+    // align the beginning of the section
+    uint64_t pos = oss_.tellp();
+    static const char zeros[GraphFile::ALIGNMENT] = {0};
+    if(pos % GraphFile::ALIGNMENT != 0) {
+        size_t padding = GraphFile::ALIGNMENT-pos%GraphFile::ALIGNMENT;
+        oss_.write(zeros, padding);
+        pos += padding;
+    }
+
+    header_.offset_[section] = pos;
+    header_.size_[section] = size;
+    if(size > 0)
+        oss_.write(static_cast<const char *>(data), size);
+    return oss_.good();
+}
+/**
+ * @brief GraphFileWriter::close
+ * @return
+ */
+bool GraphFileWriter::close() {
+    if(!oss_.is_open())
+        return true;
+
+    oss_.seekp(0);
+    oss_.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+    bool ret = oss_.good();
+    oss_.close();
+    return ret;
+}
+//------------------------------------------------------------------------------
+// GraphFileReader
+//------------------------------------------------------------------------------
+/**
+ * @brief GraphFileReader::GraphFileReader
+ */
+GraphFileReader::GraphFileReader() : header_(0) {;}
+/**
+ * @brief GraphFileReader::open
+ * @param path
+ * @return
+ */
+bool GraphFileReader::open(const string &path) {
+    if(!close() || !file_.open(path))
+        return false;
+
+    // check that this is a graph file of the version we understand
+    if(file_.size() < sizeof(GraphFile::Header) ||
+       memcmp(file_.data(), GraphFile::MAGIC, sizeof(GraphFile::MAGIC)) != 0) {
+        file_.close();
+        return false;
+    }
+
+    header_ = reinterpret_cast<const GraphFile::Header *>(file_.data());
+    if(header_->version_ != GraphFile::VERSION) {
+        LOGG(Logger::WARNING) << "[GRAPH FILE] " << path << " has version " << header_->version_
+                              << ", expected " << GraphFile::VERSION << Logger::FLUSH;
+        close();
+        return false;
+    }
+
+    // validate sections
+    for(size_t i = 0; i < GraphFile::NUM_SECTIONS; i++) {
+        if(header_->offset_[i] % GraphFile::ALIGNMENT != 0 ||
+           header_->offset_[i]+header_->size_[i] > file_.size()) {
+            LOGG(Logger::ERROR) << "[GRAPH FILE] " << path << " is truncated" << Logger::FLUSH;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+/**
+ * @brief GraphFileReader::close
+ * @return
+ */
+bool GraphFileReader::close() {
+    header_ = 0;
+    return file_.close();
+}
+/**
+ * @brief GraphFileReader::isOpen
+ * @return
+ */
+bool GraphFileReader::isOpen() const {
+    return header_ != 0;
+}
+/**
+ * @brief GraphFileReader::getNumVertices
+ * @return
+ */
+uint64_t GraphFileReader::getNumVertices() const {
+    if(header_ == 0)
+        return 0;
+    return header_->numVertices_;
+}
+/**
+ * @brief GraphFileReader::getSection
+ * @param section
+ * @param size
+ * @return
+ */
+const char *GraphFileReader::getSection(GraphFile::Section section, size_t &size) const {
+    if(header_ == 0 || section >= GraphFile::NUM_SECTIONS || header_->offset_[section] == 0) {
+        size = 0;
+        return 0;
+    }
+    size = header_->size_[section];
+    return file_.data()+header_->offset_[section];
+}
@@ -0,0 +1,51 @@
+// Isochrone.cpp
+//
+#include <cmath>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/GraphCore/Isochrone.h>
+
+using namespace std;
+
+/**
+ * @brief Isochrone::Isochrone
+ * @param center point the distances were measured from
+ * @param numSectors
+ */
+Isochrone::Isochrone(const Point &center, size_t numSectors)
+    : center_(center), numSectors_(max<size_t>(3, numSectors)) {
+    ;
+}
+/**
+ * @brief Isochrone::findPolygon
+ * @param points reachable points
+ * @param polygon corners in counterclockwise order, the first corner is
+ * repeated at the end. Empty if there are no points besides the center
+ */
+void Isochrone::findPolygon(const vector<Point> &points, vector<Point> &polygon) const {
+    // longitude degrees are shorter away from the equator
+    double lonScale = cos(center_.lat()*DEG_TO_RAD);
+
+    // squared distance and index of the farthest point of every sector
+    vector<pair<double, size_t> > farthest(numSectors_, {0, points.size()});
+    for(size_t i = 0; i < points.size(); i++) {
+        double y = points[i].lat()-center_.lat();
+        double x = (points[i].lon()-center_.lon())*lonScale;
+        double dist = x*x+y*y;
+        if(dist == 0)
+            continue;
+
+        double angle = atan2(y, x)+M_PI;
+        size_t sector = min(numSectors_-1, (size_t)(angle/(2*M_PI)*numSectors_));
+        if(dist > farthest[sector].first)
+            farthest[sector] = {dist, i};
+    }
+
+    polygon.clear();
+    for(size_t sector = 0; sector < numSectors_; sector++) {
+        if(farthest[sector].second != points.size())
+            polygon.push_back(points[farthest[sector].second]);
+    }
+    if(!polygon.empty())
+        polygon.push_back(polygon.front());
+}
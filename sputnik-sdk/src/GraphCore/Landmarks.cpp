@@ -0,0 +1,230 @@
+// Landmarks.cpp
+//
+#include <queue>
+#include <functional>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/GraphCore/Landmarks.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+
+using namespace std;
+
+const Landmarks::Dist Landmarks::Unreachable = numeric_limits<Landmarks::Dist>::max();
+
+namespace {
+    // sections of the distances per metric
+    const GraphFile::Section FROM_SECTIONS[Edge::NUM_METRICS] = {GraphFile::LANDMARK_DIST_FROM,
+                                                                 GraphFile::LANDMARK_TIME_FROM};
+    const GraphFile::Section TO_SECTIONS[Edge::NUM_METRICS] = {GraphFile::LANDMARK_DIST_TO,
+                                                               GraphFile::LANDMARK_TIME_TO};
+}
+
+/**
+ * @brief Landmarks::Landmarks
+ */
+Landmarks::Landmarks() : numVertices_(0) {
+    clear();
+}
+/**
+ * @brief Landmarks::clear
+ */
+void Landmarks::clear() {
+    numVertices_ = 0;
+    landmarks_.clear();
+    for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+        from_[metric] = to_[metric] = 0;
+        vector<Dist>().swap(fromStore_[metric]);
+        vector<Dist>().swap(toStore_[metric]);
+    }
+    file_.close();
+}
+/**
+ * @brief Landmarks::empty
+ * @return
+ */
+bool Landmarks::empty() const {
+    return landmarks_.empty();
+}
+/**
+ * @brief Landmarks::getNumLandmarks
+ * @return
+ */
+size_t Landmarks::getNumLandmarks() const {
+    return landmarks_.size();
+}
+/**
+ * @brief Landmarks::getLandmarks
+ * @return
+ */
+const vector<Landmarks::VertexId> &Landmarks::getLandmarks() const {
+    return landmarks_;
+}
+/**
+ * @brief Landmarks::getDistanceFrom
+ * @return distance from the landmark to the vertex
+ */
+Landmarks::Dist Landmarks::getDistanceFrom(size_t landmark, VertexId v, size_t metric) const {
+    return from_[metric][v*landmarks_.size()+landmark];
+}
+/**
+ * @brief Landmarks::getDistanceTo
+ * @return distance from the vertex to the landmark
+ */
+Landmarks::Dist Landmarks::getDistanceTo(size_t landmark, VertexId v, size_t metric) const {
+    return to_[metric][v*landmarks_.size()+landmark];
+}
+/**
+ * distances from the source to all vertices by Dijkstra's algorithm
+ * @brief Landmarks::search
+ */
+void Landmarks::search(const Adjacency &graph, VertexId source, size_t metric, vector<Dist> &dist) const {
+    typedef pair<Dist, VertexId> QueueEntry;
+    priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry> > queue;
+
+    dist.assign(graph.offsets_.size()-1, Unreachable);
+    dist[source] = 0;
+    queue.push({0, source});
+    while(!queue.empty()) {
+        QueueEntry curr = queue.top();
+        queue.pop();
+        if(curr.first != dist[curr.second])
+            continue;
+
+        for(EdgeOffset i = graph.offsets_[curr.second]; i < graph.offsets_[curr.second+1]; i++) {
+            const Arc &arc = graph.arcs_[i];
+            Dist newDist = curr.first+arc.cost_[metric];
+            if(newDist < dist[arc.target_]) {
+                dist[arc.target_] = newDist;
+                queue.push({newDist, arc.target_});
+            }
+        }
+    }
+}
+/**
+ * picks the landmarks one by one, each is the vertex farthest from the ones
+ * picked before. The first one is the vertex farthest from a vertex of the
+ * largest component among a few tried. Allocates the distances, which are
+ * filled by computeDistances
+ * @brief Landmarks::selectLandmarks
+ * @param forw
+ * @param numCandidates landmarks are picked from the vertices [0, numCandidates)
+ * @param numLandmarks
+ */
+void Landmarks::selectLandmarks(const Adjacency &forw, size_t numCandidates, size_t numLandmarks) {
+    clear();
+    numVertices_ = forw.offsets_.size()-1;
+    if(numVertices_ == 0 || numCandidates == 0)
+        return;
+
+    // the start is in the component reached most often
+    vector<Dist> minDist, dist;
+    size_t mostReached = 0;
+    for(size_t i = 0; i < 4; i++) {
+        search(forw, i*numCandidates/4, Edge::DistanceMetric::Index, dist);
+        size_t reached = numVertices_-count(dist.begin(), dist.end(), Unreachable);
+        if(reached > mostReached) {
+            mostReached = reached;
+            minDist.swap(dist);
+        }
+    }
+
+    while(landmarks_.size() < numLandmarks) {
+        VertexId farthest = Vertex::NullVertexId;
+        for(VertexId v = 0; v < VertexId(numCandidates); v++) {
+            if(minDist[v] != Unreachable && (farthest == Vertex::NullVertexId || minDist[v] > minDist[farthest]))
+                farthest = v;
+        }
+        // every vertex is a landmark or all reached vertices are
+        if(farthest == Vertex::NullVertexId || (!landmarks_.empty() && minDist[farthest] == 0))
+            break;
+
+        landmarks_.push_back(farthest);
+        search(forw, farthest, Edge::DistanceMetric::Index, dist);
+        for(VertexId v = 0; v < VertexId(numVertices_); v++)
+            minDist[v] = landmarks_.size() == 1 ? dist[v] : min(minDist[v], dist[v]);
+    }
+
+    for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+        fromStore_[metric].assign(numVertices_*landmarks_.size(), Unreachable);
+        toStore_[metric].assign(numVertices_*landmarks_.size(), Unreachable);
+        from_[metric] = fromStore_[metric].data();
+        to_[metric] = toStore_[metric].data();
+    }
+    LOGG(Logger::INFO) << "[LANDMARKS] selected " << landmarks_.size() << " landmarks" << Logger::FLUSH;
+}
+/**
+ * distances of one landmark in one metric, calls for different landmarks,
+ * metrics or directions can run in parallel
+ * @brief Landmarks::computeDistances
+ * @param landmark index of the landmark
+ * @param metric
+ * @param backward the graph is the reversed graph and the distances are the distances to the landmark
+ * @param graph
+ */
+void Landmarks::computeDistances(size_t landmark, size_t metric, bool backward, const Adjacency &graph) {
+    vector<Dist> dist;
+    search(graph, landmarks_[landmark], metric, dist);
+
+    vector<Dist> &store = backward ? toStore_[metric] : fromStore_[metric];
+    for(VertexId v = 0; v < VertexId(numVertices_); v++)
+        store[v*landmarks_.size()+landmark] = dist[v];
+}
+/**
+ * @brief Landmarks::save
+ * @param path
+ * @return
+ */
+bool Landmarks::save(const string &path) const {
+    GraphFileWriter writer;
+    if(!writer.open(path, numVertices_))
+        return false;
+
+    size_t size = numVertices_*landmarks_.size()*sizeof(Dist);
+    bool written = writer.writeSection(GraphFile::LANDMARKS, landmarks_);
+    for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+        written = written && writer.writeSection(FROM_SECTIONS[metric], from_[metric], size);
+        written = written && writer.writeSection(TO_SECTIONS[metric], to_[metric], size);
+    }
+
+    if(!writer.close() || !written) {
+        LOGG(Logger::ERROR) << "[LANDMARKS] can't write " << path << Logger::FLUSH;
+        return false;
+    }
+    return true;
+}
+/**
+ * maps the landmarks stored next to a graph, the distances are used from
+ * the mapping
+ * @brief Landmarks::load
+ * @param path
+ * @param numVertices the number of vertices of the graph
+ * @return false if there is no file or it was computed for another graph
+ */
+bool Landmarks::load(const string &path, size_t numVertices) {
+    clear();
+    if(!file_.open(path))
+        return false;
+    if(file_.getNumVertices() != numVertices) {
+        LOGG(Logger::WARNING) << "[LANDMARKS] " << path << " doesn't match the graph, ignoring it" << Logger::FLUSH;
+        clear();
+        return false;
+    }
+
+    size_t count = 0;
+    const VertexId *landmarks = file_.getSection<VertexId>(GraphFile::LANDMARKS, count);
+    landmarks_.assign(landmarks, landmarks+count);
+    for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+        size_t fromCount = 0, toCount = 0;
+        from_[metric] = file_.getSection<Dist>(FROM_SECTIONS[metric], fromCount);
+        to_[metric] = file_.getSection<Dist>(TO_SECTIONS[metric], toCount);
+        if(landmarks_.empty() || fromCount != numVertices*count || toCount != numVertices*count) {
+            LOGG(Logger::ERROR) << "[LANDMARKS] inconsistent landmark sections in " << path << Logger::FLUSH;
+            clear();
+            return false;
+        }
+    }
+
+    numVertices_ = numVertices;
+    LOGG(Logger::INFO) << "[LANDMARKS] loaded " << landmarks_.size() << " landmarks" << Logger::FLUSH;
+    return true;
+}
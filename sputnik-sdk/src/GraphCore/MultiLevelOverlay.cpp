@@ -0,0 +1,416 @@
+// MultiLevelOverlay.cpp
+//
+#include <queue>
+#include <stack>
+#include <numeric>
+#include <iterator>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+
+#include <UrbanLabs/Sdk/GraphCore/MultiLevelOverlay.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/Utils/Timer.h>
+
+using namespace std;
+
+const MultiLevelOverlay::Dist MultiLevelOverlay::Unreachable = numeric_limits<MultiLevelOverlay::Dist>::max();
+
+namespace {
+    // no previous vertex in the search of a cell
+    const uint32_t NullNode = numeric_limits<uint32_t>::max();
+}
+
+/**
+ * @brief MultiLevelOverlay::MultiLevelOverlay
+ */
+MultiLevelOverlay::MultiLevelOverlay() : numLevels_(0), levelBits_(1) {
+    clear();
+}
+/**
+ * @brief MultiLevelOverlay::clear
+ */
+void MultiLevelOverlay::clear() {
+    numLevels_ = 0;
+    vector<EdgeOffset>().swap(offsets_);
+    vector<VertexId>().swap(targets_);
+    vector<CellId>().swap(cell_);
+    vector<uint8_t>().swap(boundaryLevel_);
+    vector<vector<VertexId> >().swap(vertices_);
+    vector<vector<uint32_t> >().swap(position_);
+    vector<vector<uint32_t> >().swap(boundaryStart_);
+    vector<vector<uint32_t> >().swap(nodeStart_);
+    vector<vector<EdgeOffset> >().swap(cliqueStart_);
+    for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+        vector<Dist>().swap(weights_[metric].arcs_);
+        vector<Dist>().swap(weights_[metric].cliques_);
+    }
+}
+/**
+ * @brief MultiLevelOverlay::empty
+ * @return true if there are no levels, the graph fits into one cell
+ */
+bool MultiLevelOverlay::empty() const {
+    return numLevels_ == 0;
+}
+/**
+ * @brief MultiLevelOverlay::getNumLevels
+ * @return
+ */
+size_t MultiLevelOverlay::getNumLevels() const {
+    return numLevels_;
+}
+/**
+ * @brief MultiLevelOverlay::getNumCells
+ * @param level
+ * @return
+ */
+size_t MultiLevelOverlay::getNumCells(size_t level) const {
+    return boundaryStart_[level].size()-1;
+}
+/**
+ * @brief MultiLevelOverlay::getNumBoundaryVertices
+ * @param level
+ * @return
+ */
+size_t MultiLevelOverlay::getNumBoundaryVertices(size_t level) const {
+    return vertices_[level].size();
+}
+/**
+ * splits the vertices into 2^leafBits leaf cells of the same size. Each
+ * cell is split at the median of the coordinate which cuts fewer arcs
+ * @brief MultiLevelOverlay::partition
+ * @param points
+ * @param leafBits
+ */
+void MultiLevelOverlay::partition(const vector<Point> &points, size_t leafBits) {
+    struct Range {
+        size_t begin_, end_;
+        CellId cell_;
+        size_t depth_;
+    };
+
+    size_t numVertices = points.size();
+    vector<VertexId> order(numVertices);
+    iota(order.begin(), order.end(), 0);
+    cell_.assign(numVertices, 0);
+
+    // side of the split a vertex is on, valid for the current stamp
+    vector<uint32_t> side(numVertices, 0);
+    uint32_t stamp = 0;
+
+    stack<Range> ranges;
+    ranges.push({0, numVertices, 0, 0});
+    while(!ranges.empty()) {
+        Range range = ranges.top();
+        ranges.pop();
+        if(range.depth_ == leafBits) {
+            for(size_t i = range.begin_; i < range.end_; i++)
+                cell_[order[i]] = range.cell_;
+            continue;
+        }
+
+        auto first = order.begin()+range.begin_, last = order.begin()+range.end_;
+        auto median = first+(last-first)/2;
+        auto byAxis = [&points](int axis) {
+            return [&points, axis](VertexId v1, VertexId v2) {
+                double c1 = axis == 0 ? points[v1].lat() : points[v1].lon();
+                double c2 = axis == 0 ? points[v2].lat() : points[v2].lon();
+                return make_pair(c1, v1) < make_pair(c2, v2);
+            };
+        };
+
+        size_t bestCut = numeric_limits<size_t>::max();
+        int bestAxis = 0;
+        for(int axis = 0; axis < 2; axis++) {
+            nth_element(first, median, last, byAxis(axis));
+
+            // the counter wrapped around, stale entries could become valid
+            if(stamp > numeric_limits<uint32_t>::max()-2) {
+                fill(side.begin(), side.end(), 0);
+                stamp = 0;
+            }
+            uint32_t low = ++stamp, high = ++stamp;
+            for(auto it = first; it != last; ++it)
+                side[*it] = it < median ? low : high;
+
+            size_t cut = 0;
+            for(auto it = first; it != last; ++it) {
+                uint32_t other = it < median ? high : low;
+                for(EdgeOffset i = offsets_[*it]; i < offsets_[*it+1]; i++)
+                    cut += side[targets_[i]] == other;
+            }
+            if(cut < bestCut) {
+                bestCut = cut;
+                bestAxis = axis;
+            }
+        }
+        if(bestAxis == 0)
+            nth_element(first, median, last, byAxis(0));
+
+        size_t middle = median-order.begin();
+        ranges.push({range.begin_, middle, range.cell_*2, range.depth_+1});
+        ranges.push({middle, range.end_, range.cell_*2+1, range.depth_+1});
+    }
+}
+/**
+ * partitions the graph and finds the boundary of every cell. The leaf cells
+ * have at most cellSize vertices, every level has 2^levelBits times fewer
+ * cells than the one below and the highest one has at least two
+ * @brief MultiLevelOverlay::build
+ * @param points coordinates of the vertices
+ * @param offsets
+ * @param targets arcs of the graph, the arcs of vertex v are in [offsets[v], offsets[v+1])
+ * @param cellSize
+ * @param levelBits
+ * @param maxLevels
+ */
+void MultiLevelOverlay::build(const vector<Point> &points, const vector<EdgeOffset> &offsets,
+                              const vector<VertexId> &targets, size_t cellSize, size_t levelBits, size_t maxLevels) {
+    Timer timer;
+    clear();
+    size_t numVertices = points.size();
+    levelBits_ = max<size_t>(1, levelBits);
+
+    size_t leafBits = 0;
+    while(numVertices > 0 && leafBits < 31 && ((numVertices-1) >> leafBits) >= max<size_t>(1, cellSize))
+        leafBits++;
+    if(leafBits == 0 || maxLevels == 0)
+        return;
+    numLevels_ = min(maxLevels, (leafBits-1)/levelBits_+1);
+
+    offsets_ = offsets;
+    targets_ = targets;
+    partition(points, leafBits);
+
+    // the ends of an arc are boundary vertices of the levels their cells differ on
+    boundaryLevel_.assign(numVertices, 0);
+    for(VertexId v = 0; v < VertexId(numVertices); v++) {
+        for(EdgeOffset i = offsets_[v]; i < offsets_[v+1]; i++) {
+            CellId diff = cell_[v]^cell_[targets_[i]];
+            if(diff == 0)
+                continue;
+            size_t highest = 0;
+            while(diff >>= 1)
+                highest++;
+            uint8_t level = uint8_t(min(numLevels_, highest/levelBits_+1));
+            boundaryLevel_[v] = max(boundaryLevel_[v], level);
+            boundaryLevel_[targets_[i]] = max(boundaryLevel_[targets_[i]], level);
+        }
+    }
+
+    vertices_.resize(numLevels_+1);
+    position_.resize(numLevels_+1);
+    vertices_[0].resize(numVertices);
+    iota(vertices_[0].begin(), vertices_[0].end(), 0);
+    stable_sort(vertices_[0].begin(), vertices_[0].end(), [this](VertexId v1, VertexId v2) {
+        return cell_[v1] < cell_[v2];
+    });
+    for(size_t level = 0; level <= numLevels_; level++) {
+        if(level > 0) {
+            copy_if(vertices_[0].begin(), vertices_[0].end(), back_inserter(vertices_[level]), [this, level](VertexId v) {
+                return boundaryLevel_[v] >= level;
+            });
+        }
+        position_[level].assign(numVertices, NullNode);
+        for(size_t i = 0; i < vertices_[level].size(); i++)
+            position_[level][vertices_[level][i]] = uint32_t(i);
+    }
+
+    // where the cells start in the sorted vertices and in the cliques
+    auto findStarts = [this](size_t level, const vector<VertexId> &vertices, size_t numCells, vector<uint32_t> &starts) {
+        starts.assign(numCells+1, 0);
+        for(VertexId v : vertices)
+            starts[getCell(level, v)+1]++;
+        partial_sum(starts.begin(), starts.end(), starts.begin());
+    };
+    boundaryStart_.resize(numLevels_+1);
+    nodeStart_.resize(numLevels_+1);
+    cliqueStart_.resize(numLevels_+1);
+    EdgeOffset numEntries = 0;
+    for(size_t level = 1; level <= numLevels_; level++) {
+        size_t numCells = size_t(1) << (leafBits-(level-1)*levelBits_);
+        findStarts(level, vertices_[level], numCells, boundaryStart_[level]);
+        findStarts(level, vertices_[level-1], numCells, nodeStart_[level]);
+
+        cliqueStart_[level].resize(numCells+1);
+        for(size_t cell = 0; cell < numCells; cell++) {
+            EdgeOffset size = boundaryStart_[level][cell+1]-boundaryStart_[level][cell];
+            cliqueStart_[level][cell] = numEntries;
+            numEntries += size*size;
+        }
+        cliqueStart_[level][numCells] = numEntries;
+        LOGG(Logger::INFO) << "[OVERLAY] level " << level << ": " << numCells << " cells, "
+                           << vertices_[level].size() << " boundary vertices" << Logger::FLUSH;
+    }
+
+    timer.stop();
+    LOGG(Logger::INFO) << "[OVERLAY] " << numLevels_ << " levels, " << numEntries
+                       << " clique entries, partitioned in " << timer.getElapsedTimeSec() << Logger::FLUSH;
+}
+/**
+ * sizes the cliques of the weights, the costs of the arcs are set by the caller
+ * @brief MultiLevelOverlay::initWeights
+ * @param weights
+ */
+void MultiLevelOverlay::initWeights(Weights &weights) const {
+    assert(weights.arcs_.size() == targets_.size());
+    weights.cliques_.assign(numLevels_ > 0 ? cliqueStart_[numLevels_].back() : 0, Unreachable);
+}
+/**
+ * Dijkstra inside of the cell. The first level searches the arcs between
+ * the vertices of the cell, the others the boundary vertices of the cells
+ * of the level below using their cliques and the arcs between them
+ * @brief MultiLevelOverlay::search
+ * @param level
+ * @param cell
+ * @param source
+ * @param target the search stops once it is settled, null to settle all
+ * @param weights
+ * @param dist distances of the vertices searched on, by position in the cell
+ * @param prev previous vertices by position in the cell
+ */
+void MultiLevelOverlay::search(size_t level, CellId cell, VertexId source, VertexId target, const Weights &weights,
+                               vector<Dist> &dist, vector<uint32_t> &prev) const {
+    typedef pair<Dist, uint32_t> QueueEntry;
+    priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry> > queue;
+
+    const vector<VertexId> &nodes = vertices_[level-1];
+    const vector<uint32_t> &position = position_[level-1];
+    uint32_t begin = nodeStart_[level][cell];
+    dist.assign(nodeStart_[level][cell+1]-begin, Unreachable);
+    prev.assign(dist.size(), NullNode);
+
+    dist[position[source]-begin] = 0;
+    queue.push({0, position[source]-begin});
+    while(!queue.empty()) {
+        QueueEntry curr = queue.top();
+        queue.pop();
+        if(curr.first != dist[curr.second])
+            continue;
+
+        VertexId v = nodes[begin+curr.second];
+        if(v == target)
+            break;
+
+        auto relax = [&](VertexId next, Dist cost) {
+            uint32_t node = position[next]-begin;
+            if(curr.first+cost < dist[node]) {
+                dist[node] = curr.first+cost;
+                prev[node] = curr.second;
+                queue.push({dist[node], node});
+            }
+        };
+        if(level > 1)
+            forEachCliqueArc(level-1, v, false, weights, relax);
+        for(EdgeOffset i = offsets_[v]; i < offsets_[v+1]; i++) {
+            VertexId next = targets_[i];
+            if(weights.arcs_[i] == Unreachable || getCell(level, next) != cell)
+                continue;
+            // above the first level the arcs inside the cells below are in the cliques
+            if(level == 1 || getCell(level-1, next) != getCell(level-1, v))
+                relax(next, weights.arcs_[i]);
+        }
+    }
+}
+/**
+ * computes the clique of the cell, the cliques of the level below have
+ * to be computed. The cells of a level can be computed in parallel
+ * @brief MultiLevelOverlay::customizeCell
+ * @param level
+ * @param cell
+ * @param weights
+ */
+void MultiLevelOverlay::customizeCell(size_t level, CellId cell, Weights &weights) const {
+    uint32_t begin = boundaryStart_[level][cell], size = boundaryStart_[level][cell+1]-begin;
+    uint32_t nodeBegin = nodeStart_[level][cell];
+    Dist *clique = weights.cliques_.data()+cliqueStart_[level][cell];
+
+    vector<Dist> dist;
+    vector<uint32_t> prev;
+    for(uint32_t i = 0; i < size; i++) {
+        search(level, cell, vertices_[level][begin+i], Vertex::NullVertexId, weights, dist, prev);
+        for(uint32_t j = 0; j < size; j++)
+            clique[size_t(i)*size+j] = dist[position_[level-1][vertices_[level][begin+j]]-nodeBegin];
+    }
+}
+/**
+ * @brief MultiLevelOverlay::setWeights
+ * @param metric
+ * @param weights customized weights, they are swapped with the current ones
+ */
+void MultiLevelOverlay::setWeights(size_t metric, Weights &weights) {
+    weights_[metric].arcs_.swap(weights.arcs_);
+    weights_[metric].cliques_.swap(weights.cliques_);
+}
+/**
+ * @brief MultiLevelOverlay::getCliqueCost
+ * @param level
+ * @param from
+ * @param to boundary vertices of the level
+ * @param metric
+ * @return distance inside of their cell, Unreachable if they are in different cells
+ */
+MultiLevelOverlay::Dist MultiLevelOverlay::getCliqueCost(size_t level, VertexId from, VertexId to, size_t metric) const {
+    CellId cell = getCell(level, from);
+    if(getCell(level, to) != cell)
+        return Unreachable;
+    uint32_t begin = boundaryStart_[level][cell], size = boundaryStart_[level][cell+1]-begin;
+    return weights_[metric].cliques_[cliqueStart_[level][cell]+size_t(position_[level][from]-begin)*size+position_[level][to]-begin];
+}
+/**
+ * @brief MultiLevelOverlay::initQuery
+ * @param ends the vertices the searches of the query start from
+ * @param query
+ */
+void MultiLevelOverlay::initQuery(const vector<VertexId> &ends, Query &query) const {
+    query.ends_.clear();
+    for(VertexId v : ends) {
+        if(v >= 0 && size_t(v) < cell_.size())
+            query.ends_.push_back(cell_[v]);
+    }
+}
+/**
+ * level of the clique arc between two vertices of a search tree. The arcs
+ * a search relaxes from a vertex above the first level leave its cell, so
+ * vertices of the same cell are joined by a clique arc
+ * @brief MultiLevelOverlay::getArcLevel
+ * @param from
+ * @param to
+ * @param backward the backward search relaxed the arc from to
+ * @param query
+ * @return the level, 0 if the vertices are joined by an arc of the graph
+ */
+size_t MultiLevelOverlay::getArcLevel(VertexId from, VertexId to, bool backward, const Query &query) const {
+    size_t level = getQueryLevel(backward ? to : from, query);
+    return level > 0 && getCell(level, from) == getCell(level, to) ? level : 0;
+}
+/**
+ * the path of a clique arc, by searching its cell again down to the first level
+ * @brief MultiLevelOverlay::unpackArc
+ * @param level
+ * @param from
+ * @param to
+ * @param metric
+ * @param path the vertices after from are appended
+ */
+void MultiLevelOverlay::unpackArc(size_t level, VertexId from, VertexId to, size_t metric, vector<VertexId> &path) const {
+    vector<Dist> dist;
+    vector<uint32_t> prev;
+    CellId cell = getCell(level, from);
+    search(level, cell, from, to, weights_[metric], dist, prev);
+
+    uint32_t begin = nodeStart_[level][cell];
+    vector<VertexId> nodes;
+    for(uint32_t curr = position_[level-1][to]-begin; curr != NullNode; curr = prev[curr])
+        nodes.push_back(vertices_[level-1][begin+curr]);
+    reverse(nodes.begin(), nodes.end());
+    assert(nodes.front() == from);
+
+    for(size_t i = 1; i < nodes.size(); i++) {
+        if(level > 1 && getCell(level-1, nodes[i-1]) == getCell(level-1, nodes[i]))
+            unpackArc(level-1, nodes[i-1], nodes[i], metric, path);
+        else
+            path.push_back(nodes[i]);
+    }
+}
@@ -0,0 +1,178 @@
+// NestedDissection.cpp
+//
+#include <stack>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/GraphCore/NestedDissection.h>
+
+using namespace std;
+
+/**
+ * @brief NestedDissection::NestedDissection
+ * @param points coordinates of the vertices
+ * @param offsets
+ * @param neighbors undirected adjacency of the vertices
+ */
+NestedDissection::NestedDissection(const vector<Point> &points, const vector<EdgeOffset> &offsets,
+                                   const vector<VertexId> &neighbors)
+    : points_(points), offsets_(offsets), neighbors_(neighbors), leafSize_(8), generation_(0) {
+    ;
+}
+/**
+ * @brief NestedDissection::setLeafSize
+ * @param leafSize
+ */
+void NestedDissection::setLeafSize(size_t leafSize) {
+    leafSize_ = max<size_t>(1, leafSize);
+}
+/**
+ * @brief NestedDissection::nextGeneration
+ * @return
+ */
+uint32_t NestedDissection::nextGeneration() {
+    // the counter wrapped around, stale entries could become valid
+    if(++generation_ == 0) {
+        fill(side_.begin(), side_.end(), 0);
+        generation_ = 1;
+    }
+    return generation_;
+}
+/**
+ * splits the cell at the median of the axis, the separator is the boundary
+ * of the half which has the smaller one
+ * @brief NestedDissection::splitAxis
+ * @return the size of the separator
+ */
+size_t NestedDissection::splitAxis(const vector<VertexId> &cell, int axis, vector<VertexId> &low,
+                                   vector<VertexId> &high, vector<VertexId> &separator) {
+    auto coord = [this, axis](VertexId id) {
+        return axis == 0 ? points_[id].lat() : points_[id].lon();
+    };
+
+    vector<VertexId> sorted(cell);
+    auto median = sorted.begin()+sorted.size()/2;
+    nth_element(sorted.begin(), median, sorted.end(), [&coord](VertexId v1, VertexId v2) {
+        return make_pair(coord(v1), v1) < make_pair(coord(v2), v2);
+    });
+
+    uint32_t lowSide = nextGeneration();
+    uint32_t highSide = nextGeneration();
+    for(auto it = sorted.begin(); it != sorted.end(); ++it)
+        side_[*it] = it < median ? lowSide : highSide;
+
+    // vertices with a neighbor on the other side
+    auto isBoundary = [this](VertexId id, uint32_t otherSide) {
+        for(EdgeOffset i = offsets_[id]; i < offsets_[id+1]; i++) {
+            if(side_[neighbors_[i]] == otherSide)
+                return true;
+        }
+        return false;
+    };
+    size_t lowBoundary = 0, highBoundary = 0;
+    for(auto it = sorted.begin(); it != sorted.end(); ++it) {
+        if(it < median)
+            lowBoundary += isBoundary(*it, highSide);
+        else
+            highBoundary += isBoundary(*it, lowSide);
+    }
+
+    low.clear();
+    high.clear();
+    separator.clear();
+    bool separateLow = lowBoundary <= highBoundary;
+    for(auto it = sorted.begin(); it != sorted.end(); ++it) {
+        if(it < median) {
+            if(separateLow && isBoundary(*it, highSide))
+                separator.push_back(*it);
+            else
+                low.push_back(*it);
+        } else {
+            if(!separateLow && isBoundary(*it, lowSide))
+                separator.push_back(*it);
+            else
+                high.push_back(*it);
+        }
+    }
+    return separator.size();
+}
+/**
+ * @brief NestedDissection::split
+ */
+void NestedDissection::split(const vector<VertexId> &cell, vector<VertexId> &low,
+                             vector<VertexId> &high, vector<VertexId> &separator) {
+    splitAxis(cell, 0, low, high, separator);
+
+    vector<VertexId> lowLon, highLon, separatorLon;
+    if(splitAxis(cell, 1, lowLon, highLon, separatorLon) < separator.size()) {
+        low.swap(lowLon);
+        high.swap(highLon);
+        separator.swap(separatorLon);
+    }
+}
+/**
+ * @brief NestedDissection::computeRanks
+ * @param rank the rank of every vertex, a permutation of the vertex ids
+ */
+void NestedDissection::computeRanks(vector<VertexId> &rank) {
+    vector<pair<VertexId, VertexId> > cells;
+    computeRanks(rank, 0, cells);
+}
+/**
+ * also returns the cells the splits down to the depth leave, as ranges
+ * [first, last) of their ranks. Vertices of different cells aren't
+ * neighbors, the vertices in none of them are separators ranked above the
+ * cells they separate
+ * @brief NestedDissection::computeRanks
+ * @param rank the rank of every vertex, a permutation of the vertex ids
+ * @param depth
+ * @param independent
+ */
+void NestedDissection::computeRanks(vector<VertexId> &rank, size_t depth, vector<pair<VertexId, VertexId> > &independent) {
+    size_t numVertices = points_.size();
+    rank.assign(numVertices, Vertex::NullVertexId);
+    side_.assign(numVertices, 0);
+    generation_ = 0;
+    independent.clear();
+
+    stack<Cell> cells;
+    cells.push(Cell());
+    cells.top().firstRank_ = 0;
+    cells.top().depth_ = 0;
+    for(VertexId id = 0; id < VertexId(numVertices); id++)
+        cells.top().vertices_.push_back(id);
+
+    vector<VertexId> low, high, separator;
+    while(!cells.empty()) {
+        Cell cell;
+        cell.vertices_.swap(cells.top().vertices_);
+        cell.firstRank_ = cells.top().firstRank_;
+        cell.depth_ = cells.top().depth_;
+        cells.pop();
+
+        bool isLeaf = cell.vertices_.size() <= leafSize_;
+        if(cell.depth_ == depth || (isLeaf && cell.depth_ < depth))
+            independent.push_back(make_pair(cell.firstRank_, VertexId(cell.firstRank_+cell.vertices_.size())));
+
+        if(isLeaf) {
+            for(size_t i = 0; i < cell.vertices_.size(); i++)
+                rank[cell.vertices_[i]] = cell.firstRank_+i;
+            continue;
+        }
+
+        // the separator is contracted after both halves
+        split(cell.vertices_, low, high, separator);
+        VertexId highRank = cell.firstRank_+low.size();
+        VertexId separatorRank = highRank+high.size();
+        for(size_t i = 0; i < separator.size(); i++)
+            rank[separator[i]] = separatorRank+i;
+
+        cells.push(Cell());
+        cells.top().vertices_.swap(low);
+        cells.top().firstRank_ = cell.firstRank_;
+        cells.top().depth_ = cell.depth_+1;
+        cells.push(Cell());
+        cells.top().vertices_.swap(high);
+        cells.top().firstRank_ = highRank;
+        cells.top().depth_ = cell.depth_+1;
+    }
+}
@@ -0,0 +1,170 @@
+// PackedRTree.cpp
+//
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/GraphCore/PackedRTree.h>
+
+using namespace std;
+
+const double PackedRTree::SCALE_FACTOR = 1e7;
+const size_t PackedRTree::NODE_SIZE = 16;
+
+/**
+ * @brief PackedRTree::Box::Box
+ * the empty box, extending it by a box gives that box
+ */
+PackedRTree::Box::Box() : minLat_(numeric_limits<Coord>::max()), minLon_(numeric_limits<Coord>::max()),
+                          maxLat_(numeric_limits<Coord>::min()), maxLon_(numeric_limits<Coord>::min()) {
+    ;
+}
+/**
+ * the box is rounded outwards, it always contains the point
+ * @brief PackedRTree::Box::Box
+ * @param pt
+ */
+PackedRTree::Box::Box(const Point &pt) : Box(pt, pt) {
+    ;
+}
+/**
+ * @brief PackedRTree::Box::Box
+ * @param pt1
+ * @param pt2
+ */
+PackedRTree::Box::Box(const Point &pt1, const Point &pt2)
+    : minLat_(Coord(floor(min(pt1.lat(), pt2.lat())*SCALE_FACTOR))),
+      minLon_(Coord(floor(min(pt1.lon(), pt2.lon())*SCALE_FACTOR))),
+      maxLat_(Coord(ceil(max(pt1.lat(), pt2.lat())*SCALE_FACTOR))),
+      maxLon_(Coord(ceil(max(pt1.lon(), pt2.lon())*SCALE_FACTOR))) {
+    ;
+}
+/**
+ * @brief PackedRTree::Box::extend
+ * @param box
+ */
+void PackedRTree::Box::extend(const Box &box) {
+    minLat_ = min(minLat_, box.minLat_);
+    minLon_ = min(minLon_, box.minLon_);
+    maxLat_ = max(maxLat_, box.maxLat_);
+    maxLon_ = max(maxLon_, box.maxLon_);
+}
+/**
+ * @brief PackedRTree::Box::distanceTo
+ * @param pt
+ * @return the manhattan distance to the closest point of the box
+ */
+Point::PointDistType PackedRTree::Box::distanceTo(const Point &pt) const {
+    Point::PointDistType dLat = max(0.0, max(minLat_/SCALE_FACTOR-pt.lat(), pt.lat()-maxLat_/SCALE_FACTOR));
+    Point::PointDistType dLon = max(0.0, max(minLon_/SCALE_FACTOR-pt.lon(), pt.lon()-maxLon_/SCALE_FACTOR));
+    return dLat+dLon;
+}
+/**
+ * @brief PackedRTree::PackedRTree
+ */
+PackedRTree::PackedRTree() : numItems_(0) {
+    ;
+}
+/**
+ * @brief PackedRTree::clear
+ */
+void PackedRTree::clear() {
+    numItems_ = 0;
+    vector<Box>().swap(boxes_);
+    vector<uint32_t>().swap(items_);
+    vector<size_t>().swap(levelEnds_);
+}
+/**
+ * @brief PackedRTree::empty
+ * @return
+ */
+bool PackedRTree::empty() const {
+    return numItems_ == 0;
+}
+/**
+ * @brief PackedRTree::getNumItems
+ * @return
+ */
+size_t PackedRTree::getNumItems() const {
+    return numItems_;
+}
+/**
+ * @brief PackedRTree::getMemoryInfo
+ * @return bytes used by the tree
+ */
+size_t PackedRTree::getMemoryInfo() const {
+    return boxes_.capacity()*sizeof(Box)+items_.capacity()*sizeof(uint32_t)+levelEnds_.capacity()*sizeof(size_t);
+}
+/**
+ * position on the Hilbert curve filling a square with sides of 2^16
+ * @brief PackedRTree::hilbertIndex
+ * @param x
+ * @param y
+ * @return
+ */
+uint32_t PackedRTree::hilbertIndex(uint32_t x, uint32_t y) {
+    const uint32_t side = 1 << 16;
+    uint32_t index = 0;
+    for(uint32_t s = side/2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) > 0, ry = (y & s) > 0;
+        index += s*s*((3*rx) ^ ry);
+        // rotate the quadrant
+        if(ry == 0) {
+            if(rx == 1) {
+                x = side-1-x;
+                y = side-1-y;
+            }
+            swap(x, y);
+        }
+    }
+    return index;
+}
+/**
+ * @brief PackedRTree::build
+ * @param boxes box of every item, the items are the indices of the boxes
+ */
+void PackedRTree::build(const vector<Box> &boxes) {
+    clear();
+    numItems_ = boxes.size();
+    if(numItems_ == 0)
+        return;
+
+    // the centers are scaled to the extent of all boxes
+    Box extent;
+    for(const Box &box : boxes)
+        extent.extend(box);
+    double latRange = max(1.0, double(extent.maxLat_)-extent.minLat_);
+    double lonRange = max(1.0, double(extent.maxLon_)-extent.minLon_);
+
+    vector<pair<uint32_t, uint32_t> > order(numItems_);
+    for(size_t i = 0; i < numItems_; i++) {
+        const Box &box = boxes[i];
+        double lat = (double(box.minLat_)+box.maxLat_)/2-extent.minLat_;
+        double lon = (double(box.minLon_)+box.maxLon_)/2-extent.minLon_;
+        uint32_t x = uint32_t(lon/lonRange*0xffff), y = uint32_t(lat/latRange*0xffff);
+        order[i] = {hilbertIndex(x, y), uint32_t(i)};
+    }
+    sort(order.begin(), order.end());
+
+    boxes_.reserve(numItems_+numItems_/(NODE_SIZE-1)+1);
+    items_.resize(numItems_);
+    for(size_t i = 0; i < numItems_; i++) {
+        items_[i] = order[i].second;
+        boxes_.push_back(boxes[items_[i]]);
+    }
+    levelEnds_.push_back(numItems_);
+
+    // every node covers the boxes of its children
+    size_t levelBegin = 0;
+    while(levelEnds_.back()-levelBegin > 1) {
+        size_t levelEnd = levelEnds_.back();
+        for(size_t first = levelBegin; first < levelEnd; first += NODE_SIZE) {
+            Box node;
+            for(size_t child = first; child < min(first+NODE_SIZE, levelEnd); child++)
+                node.extend(boxes_[child]);
+            boxes_.push_back(node);
+        }
+        levelBegin = levelEnd;
+        levelEnds_.push_back(boxes_.size());
+    }
+}
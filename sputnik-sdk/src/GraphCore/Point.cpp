@@ -153,6 +153,63 @@ size_t closestPoint(const Point &ref, const vector <Point> &points) {
     return closest;
 }
 
+/**
+ * distance in degrees of latitude on the plane touching the earth at the
+ * reference point, the longitudes are scaled by the cosine of its latitude
+ */
+Point::PointDistType planarDistance(const Point &ref, const Point &pt) {
+    double scale = cos(ref.lat()*DEG_TO_RAD);
+    double dLat = pt.lat()-ref.lat(), dLon = (pt.lon()-ref.lon())*scale;
+    return sqrt(dLat*dLat+dLon*dLon);
+}
+/**
+ * the point of the segment closest to the reference point by planarDistance,
+ * fraction is its position between 0 at from and 1 at to
+ */
+Point projectOnSegment(const Point &ref, const Point &from, const Point &to, double &fraction) {
+    double scale = cos(ref.lat()*DEG_TO_RAD);
+    double fromLat = from.lat()-ref.lat(), fromLon = (from.lon()-ref.lon())*scale;
+    double dLat = to.lat()-from.lat(), dLon = (to.lon()-from.lon())*scale;
+    double length = dLat*dLat+dLon*dLon;
+
+    fraction = 0;
+    if(length > 0)
+        fraction = max(0.0, min(1.0, -(fromLat*dLat+fromLon*dLon)/length));
+    if(fraction == 0)
+        return from;
+    if(fraction == 1)
+        return to;
+    return Point(from.lat()+fraction*(to.lat()-from.lat()), from.lon()+fraction*(to.lon()-from.lon()));
+}
+/**
+ * the segment of the line closest to the reference point, of segments at
+ * the same distance the first one
+ * @return index of the first point of the segment
+ */
+size_t closestSegment(const Point &ref, const vector<Point> &line, Point &projection, double &fraction) {
+    size_t closest = 0;
+    fraction = 0;
+    if(line.size() < 2) {
+        if(!line.empty())
+            projection = line[0];
+        return closest;
+    }
+
+    Point::PointDistType dist = numeric_limits<Point::PointDistType>::max();
+    for(size_t i = 0; i+1 < line.size(); i++) {
+        double currFraction = 0;
+        Point curr = projectOnSegment(ref, line[i], line[i+1], currFraction);
+        Point::PointDistType currDist = planarDistance(ref, curr);
+        if(currDist < dist) {
+            dist = currDist;
+            closest = i;
+            projection = curr;
+            fraction = currFraction;
+        }
+    }
+    return closest;
+}
+
 vector<Point> computeBoundingBox(const Point &p1, const Point &p2) {
     Point::CoordType maxLat, maxLon, minLat, minLon;
 
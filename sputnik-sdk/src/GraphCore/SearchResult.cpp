@@ -82,50 +82,3 @@ SearchResultBasic::DistType SearchResultBasic::getLength() const {
 void SearchResultBasic::setLength(DistType len) {
     length_ = len;
 }
-//------------------------------------------------------------------------------
-// Local search search result
-//------------------------------------------------------------------------------
-/**
- * @brief SearchResultLocal::SearchResultLocal
- */
-SearchResultLocal::SearchResultLocal() : SearchResultBasic(), searchSpace_(0), distToTargets_() {
-    ;
-}
-/**
- * @brief SearchResultLocal::SearchResultLocal
- * @param src
- * @param dest
- */
-SearchResultLocal::SearchResultLocal(const NearestPointResult &src, const NearestPointResult &dest)
-    : SearchResultBasic(src, dest), searchSpace_(0), distToTargets_() {
-    ;
-}
-/**
- * @brief SearchResultLocal::setSearchSpace
- * @param searchSpace
- */
-void SearchResultLocal::setSearchSpace(size_t searchSpace) {
-    searchSpace_ = searchSpace;
-}
-/**
- * @brief SearchResultLocal::getSearchSpace
- * @return
- */
-size_t SearchResultLocal::getSearchSpace() const {
-    return searchSpace_;
-}
-/**
- * @brief SearchResultLocal::getTargetDistFor
- * @param id
- * @return
- */
-SearchResultLocal::DistType SearchResultLocal::getTargetDistFor(const VertexId id) const{
-    return distToTargets_.find(id)->second;
-}
-/**
- * @brief SearchResultLocal::setDistToTargets
- * @param dists
- */
-void SearchResultLocal::setDistToTargets(const unordered_map<VertexId, DistType> &dists) {
-    distToTargets_ = dists;
-}
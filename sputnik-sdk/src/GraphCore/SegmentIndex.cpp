@@ -0,0 +1,132 @@
+// SegmentIndex.cpp
+//
+#include <cmath>
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/GraphCore/SegmentIndex.h>
+
+using namespace std;
+
+/**
+ * @brief SegmentIndex::SegmentIndex
+ */
+SegmentIndex::SegmentIndex() {
+    ;
+}
+/**
+ * @brief SegmentIndex::clear
+ */
+void SegmentIndex::clear() {
+    tree_.clear();
+    vector<Line>().swap(lines_);
+    vector<Segment>().swap(segments_);
+    vector<PackedRTree::Coord>().swap(lats_);
+    vector<PackedRTree::Coord>().swap(lons_);
+    vector<float>().swap(offsets_);
+}
+/**
+ * @brief SegmentIndex::empty
+ * @return
+ */
+bool SegmentIndex::empty() const {
+    return tree_.empty();
+}
+/**
+ * @brief SegmentIndex::getNumSegments
+ * @return
+ */
+size_t SegmentIndex::getNumSegments() const {
+    return segments_.size();
+}
+/**
+ * @brief SegmentIndex::getMemoryInfo
+ * @return
+ */
+size_t SegmentIndex::getMemoryInfo() const {
+    return tree_.getMemoryInfo()+lines_.capacity()*sizeof(Line)+segments_.capacity()*sizeof(Segment)+
+           (lats_.capacity()+lons_.capacity())*sizeof(PackedRTree::Coord)+offsets_.capacity()*sizeof(float);
+}
+/**
+ * @brief SegmentIndex::getPoint
+ * @param point
+ * @return
+ */
+Point SegmentIndex::getPoint(size_t point) const {
+    return Point(lats_[point]/PackedRTree::SCALE_FACTOR, lons_[point]/PackedRTree::SCALE_FACTOR);
+}
+/**
+ * adds the geometry of an edge, build has to be called afterwards
+ * @brief SegmentIndex::add
+ * @param start
+ * @param end
+ * @param geometry the points from start to end
+ */
+void SegmentIndex::add(VertexId start, VertexId end, const vector<Point> &geometry) {
+    if(geometry.size() < 2)
+        return;
+
+    size_t first = lats_.size();
+    lines_.push_back({start, end});
+    for(const Point &pt : geometry) {
+        lats_.push_back(PackedRTree::Coord(llround(pt.lat()*PackedRTree::SCALE_FACTOR)));
+        lons_.push_back(PackedRTree::Coord(llround(pt.lon()*PackedRTree::SCALE_FACTOR)));
+    }
+
+    // offsets by the lengths of the segments, all are 0 if the points are the same
+    vector<double> lengths(1, 0);
+    for(size_t i = first+1; i < lats_.size(); i++)
+        lengths.push_back(lengths.back()+pointDistance(getPoint(i-1), getPoint(i)));
+    for(double length : lengths)
+        offsets_.push_back(lengths.back() > 0 ? length/lengths.back() : 0);
+
+    for(size_t i = first; i+1 < lats_.size(); i++)
+        segments_.push_back({uint32_t(i), uint32_t(lines_.size()-1)});
+}
+/**
+ * @brief SegmentIndex::build
+ */
+void SegmentIndex::build() {
+    vector<PackedRTree::Box> boxes(segments_.size());
+    for(size_t i = 0; i < segments_.size(); i++)
+        boxes[i] = PackedRTree::Box(getPoint(segments_[i].first_), getPoint(segments_[i].first_+1));
+    tree_.build(boxes);
+}
+/**
+ * @brief SegmentIndex::findNearest
+ * @param location
+ * @param snap the projection on the closest segment
+ * @return false if the index is empty
+ */
+bool SegmentIndex::findNearest(const Point &location, Snap &snap) const {
+    // the location is rounded like the segments, so a location at a point
+    // of a line is projected exactly on it
+    Point pt(llround(location.lat()*PackedRTree::SCALE_FACTOR)/PackedRTree::SCALE_FACTOR,
+             llround(location.lon()*PackedRTree::SCALE_FACTOR)/PackedRTree::SCALE_FACTOR);
+
+    // the boxes are measured on the same plane as the segments
+    double scale = cos(pt.lat()*DEG_TO_RAD);
+    auto boxDistance = [&pt, scale](const PackedRTree::Box &box) {
+        double dLat = max(0.0, max(box.minLat_/PackedRTree::SCALE_FACTOR-pt.lat(), pt.lat()-box.maxLat_/PackedRTree::SCALE_FACTOR));
+        double dLon = max(0.0, max(box.minLon_/PackedRTree::SCALE_FACTOR-pt.lon(), pt.lon()-box.maxLon_/PackedRTree::SCALE_FACTOR));
+        return sqrt(dLat*dLat+dLon*dLon*scale*scale);
+    };
+    auto distance = [this, &pt](size_t i) {
+        double fraction = 0;
+        size_t first = segments_[i].first_;
+        return planarDistance(pt, projectOnSegment(pt, getPoint(first), getPoint(first+1), fraction));
+    };
+
+    size_t item = 0;
+    if(!tree_.findNearest(boxDistance, distance, item))
+        return false;
+
+    const Segment &segment = segments_[item];
+    const Line &line = lines_[segment.line_];
+    double fraction = 0;
+    snap.start_ = line.start_;
+    snap.end_ = line.end_;
+    snap.point_ = projectOnSegment(pt, getPoint(segment.first_), getPoint(segment.first_+1), fraction);
+    double first = offsets_[segment.first_], last = offsets_[segment.first_+1];
+    snap.offset_ = first+fraction*(last-first);
+    return true;
+}
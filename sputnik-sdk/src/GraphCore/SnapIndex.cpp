@@ -0,0 +1,115 @@
+// SnapIndex.cpp
+//
+#include <cmath>
+
+#include <UrbanLabs/Sdk/GraphCore/SnapIndex.h>
+#include <UrbanLabs/Sdk/Utils/StringUtils.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/Utils/Timer.h>
+
+using namespace std;
+
+/**
+ * the coordinates the same as the kd trees return
+ * @brief SnapIndex::Target::getPoint
+ * @return
+ */
+Point SnapIndex::Target::getPoint() const {
+    return Point(lat_/PackedRTree::SCALE_FACTOR, lon_/PackedRTree::SCALE_FACTOR);
+}
+/**
+ * @brief SnapIndex::SnapIndex
+ */
+SnapIndex::SnapIndex() {
+    ;
+}
+/**
+ * @brief SnapIndex::clear
+ */
+void SnapIndex::clear() {
+    tree_.clear();
+    vector<Target>().swap(targets_);
+}
+/**
+ * @brief SnapIndex::empty
+ * @return
+ */
+bool SnapIndex::empty() const {
+    return tree_.empty();
+}
+/**
+ * @brief SnapIndex::getMemoryInfo
+ * @return
+ */
+size_t SnapIndex::getMemoryInfo() const {
+    return tree_.getMemoryInfo()+targets_.capacity()*sizeof(Target);
+}
+/**
+ * reads all points of a kd tree, the data of a non endpoint are the ids of
+ * the ends of its edge separated by a space
+ * @brief SnapIndex::addPoints
+ * @param kdTree
+ * @param endPoints
+ * @return
+ */
+bool SnapIndex::addPoints(KdTreeSql &kdTree, bool endPoints) {
+    vector<string> data;
+    vector<VertexPoint> points;
+    if(!kdTree.findAllInBoundingBox(Point(90, -180), Point(-90, 180), points, data))
+        return false;
+
+    for(size_t i = 0; i < points.size(); i++) {
+        Target target;
+        target.id_ = target.start_ = target.end_ = points[i].getId();
+        target.lat_ = PackedRTree::Coord(llround(points[i].getPoint().lat()*PackedRTree::SCALE_FACTOR));
+        target.lon_ = PackedRTree::Coord(llround(points[i].getPoint().lon()*PackedRTree::SCALE_FACTOR));
+        if(!endPoints && i < data.size() && data[i] != "") {
+            SimpleTokenator st(data[i], ' ', '\"', true);
+            target.start_ = lexical_cast<VertexId>(st.nextToken());
+            target.end_ = lexical_cast<VertexId>(st.nextToken());
+        }
+        targets_.push_back(target);
+    }
+    return true;
+}
+/**
+ * @brief SnapIndex::build
+ * @param endPoints
+ * @param nonEndPoints
+ * @return false if the kd trees can't be read
+ */
+bool SnapIndex::build(KdTreeSql &endPoints, KdTreeSql &nonEndPoints) {
+    Timer timer;
+    clear();
+    if(!addPoints(endPoints, true) || !addPoints(nonEndPoints, false)) {
+        LOGG(Logger::ERROR) << "[SNAP INDEX] can't read the kd trees" << Logger::FLUSH;
+        clear();
+        return false;
+    }
+
+    vector<PackedRTree::Box> boxes(targets_.size());
+    for(size_t i = 0; i < targets_.size(); i++)
+        boxes[i] = PackedRTree::Box(targets_[i].getPoint());
+    tree_.build(boxes);
+
+    timer.stop();
+    LOGG(Logger::INFO) << "[SNAP INDEX] " << targets_.size() << " points in " << timer.getElapsedTimeSec()
+                       << " sec, " << getMemoryInfo()/1048576.0 << " MB" << Logger::FLUSH;
+    return true;
+}
+/**
+ * @brief SnapIndex::findNearest
+ * @param pt
+ * @param target the point closest to pt by manhattan distance
+ * @return false if the index is empty
+ */
+bool SnapIndex::findNearest(const Point &pt, Target &target) const {
+    size_t item = 0;
+    auto distance = [this, &pt](size_t i) {
+        return manhattanDistance(pt, targets_[i].getPoint());
+    };
+    if(!tree_.findNearest(pt, distance, item))
+        return false;
+    target = targets_[item];
+    return true;
+}
@@ -0,0 +1,233 @@
+// TourOptimizer.cpp
+//
+#include <algorithm>
+
+#include <UrbanLabs/Sdk/GraphCore/TourOptimizer.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+
+using namespace std;
+
+const TourOptimizer::TourCost TourOptimizer::UNREACHABLE = TourCost(1) << 40;
+const size_t TourOptimizer::MAX_FAILED_KICKS = 200;
+
+/**
+ * @brief TourOptimizer::TourOptimizer
+ * @param costs square matrix of the lengths between the stops
+ */
+TourOptimizer::TourOptimizer(const Matrix &costs) : costs_(costs), roundTrip_(false), timeLimit_(0.5), random_(1) {
+    ;
+}
+/**
+ * @brief TourOptimizer::setRoundTrip
+ * @param roundTrip the tour returns to the first stop
+ */
+void TourOptimizer::setRoundTrip(bool roundTrip) {
+    roundTrip_ = roundTrip;
+}
+/**
+ * @brief TourOptimizer::setTimeLimit
+ * @param seconds time the local search may take
+ */
+void TourOptimizer::setTimeLimit(double seconds) {
+    timeLimit_ = max(0.0, seconds);
+}
+/**
+ * the tour has an extra stop at its end which stands for the end of the
+ * route, reaching it costs nothing or the way back to the first stop
+ * @brief TourOptimizer::cost
+ * @param from
+ * @param to
+ * @return
+ */
+TourOptimizer::TourCost TourOptimizer::cost(size_t from, size_t to) const {
+    if(to == costs_.size()) {
+        if(!roundTrip_)
+            return 0;
+        to = 0;
+    }
+    Cost length = costs_[from][to];
+    return length < 0 ? UNREACHABLE : length;
+}
+/**
+ * @brief TourOptimizer::tourCost
+ * @param tour
+ * @return
+ */
+TourOptimizer::TourCost TourOptimizer::tourCost(const vector<size_t> &tour) const {
+    TourCost total = 0;
+    for(size_t i = 0; i+1 < tour.size(); i++)
+        total += cost(tour[i], tour[i+1]);
+    return total;
+}
+/**
+ * @brief TourOptimizer::timeIsUp
+ * @return
+ */
+bool TourOptimizer::timeIsUp() const {
+    return Clock::now() >= deadline_;
+}
+/**
+ * always goes on to the closest stop not visited yet
+ * @brief TourOptimizer::nearestNeighbor
+ * @param tour
+ */
+void TourOptimizer::nearestNeighbor(vector<size_t> &tour) const {
+    size_t numStops = costs_.size();
+    vector<bool> visited(numStops, false);
+    tour.assign(1, 0);
+    visited[0] = true;
+    for(size_t step = 1; step < numStops; step++) {
+        size_t curr = tour.back(), next = numStops;
+        for(size_t stop = 0; stop < numStops; stop++) {
+            if(!visited[stop] && (next == numStops || cost(curr, stop) < cost(curr, next)))
+                next = stop;
+        }
+        visited[next] = true;
+        tour.push_back(next);
+    }
+    tour.push_back(numStops);
+}
+/**
+ * @brief TourOptimizer::updatePrefix
+ * @param tour
+ */
+void TourOptimizer::updatePrefix(const vector<size_t> &tour) {
+    forward_.assign(tour.size(), 0);
+    backward_.assign(tour.size(), 0);
+    for(size_t i = 0; i+1 < tour.size(); i++) {
+        forward_[i+1] = forward_[i]+cost(tour[i], tour[i+1]);
+        // the end of the route is never reversed
+        backward_[i+1] = backward_[i]+(tour[i+1] == costs_.size() ? 0 : cost(tour[i+1], tour[i]));
+    }
+}
+/**
+ * reverses the stops at the positions [i+1, j] if it makes the tour
+ * shorter, the lengths of the reversed parts come from the prefix sums
+ * @brief TourOptimizer::twoOpt
+ * @param tour
+ * @return true if a move was made
+ */
+bool TourOptimizer::twoOpt(vector<size_t> &tour) {
+    size_t last = tour.size()-1;
+    for(size_t i = 0; i+2 < last; i++) {
+        if(timeIsUp())
+            return false;
+        for(size_t j = i+2; j < last; j++) {
+            TourCost before = cost(tour[i], tour[i+1])+(forward_[j]-forward_[i+1])+cost(tour[j], tour[j+1]);
+            TourCost after = cost(tour[i], tour[j])+(backward_[j]-backward_[i+1])+cost(tour[i+1], tour[j+1]);
+            if(after < before) {
+                reverse(tour.begin()+i+1, tour.begin()+j+1);
+                updatePrefix(tour);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+/**
+ * moves one to three consecutive stops between two other stops if it
+ * makes the tour shorter
+ * @brief TourOptimizer::orOpt
+ * @param tour
+ * @return true if a move was made
+ */
+bool TourOptimizer::orOpt(vector<size_t> &tour) {
+    size_t last = tour.size()-1;
+    for(size_t length = 1; length <= 3; length++) {
+        for(size_t s = 1; s+length <= last; s++) {
+            if(timeIsUp())
+                return false;
+
+            size_t prev = tour[s-1], first = tour[s], end = tour[s+length-1], next = tour[s+length];
+            TourCost removed = cost(prev, first)+cost(end, next)-cost(prev, next);
+            // the segment may also be inserted reversed
+            TourCost reversal = (backward_[s+length-1]-backward_[s])-(forward_[s+length-1]-forward_[s]);
+            for(size_t p = 0; p < last; p++) {
+                if(p+1 >= s && p < s+length)
+                    continue;
+                TourCost between = cost(tour[p], tour[p+1]);
+                TourCost added = cost(tour[p], first)+cost(end, tour[p+1])-between;
+                TourCost addedReversed = cost(tour[p], end)+cost(first, tour[p+1])-between+reversal;
+                if(added < removed || addedReversed < removed) {
+                    vector<size_t> segment(tour.begin()+s, tour.begin()+s+length);
+                    if(added >= removed)
+                        reverse(segment.begin(), segment.end());
+                    tour.erase(tour.begin()+s, tour.begin()+s+length);
+                    size_t insert = p < s ? p+1 : p+1-length;
+                    tour.insert(tour.begin()+insert, segment.begin(), segment.end());
+                    updatePrefix(tour);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+/**
+ * @brief TourOptimizer::localSearch
+ * @param tour
+ * @return number of moves made
+ */
+size_t TourOptimizer::localSearch(vector<size_t> &tour) {
+    updatePrefix(tour);
+    size_t moves = 0;
+    while(twoOpt(tour) || orOpt(tour))
+        moves++;
+    return moves;
+}
+/**
+ * swaps two neighbouring parts of the tour, unlike a reversal the lengths
+ * inside the parts stay the same. Needs at least two stops which can move
+ * @brief TourOptimizer::kick
+ * @param tour
+ */
+void TourOptimizer::kick(vector<size_t> &tour) {
+    // the first stop and the end of the route stay in place
+    size_t numCuts = tour.size()-1;
+    vector<size_t> cuts(3);
+    do {
+        for(size_t &cut : cuts)
+            cut = 1+random_() % numCuts;
+        sort(cuts.begin(), cuts.end());
+    } while(cuts[0] == cuts[1] || cuts[1] == cuts[2]);
+    rotate(tour.begin()+cuts[0], tour.begin()+cuts[1], tour.begin()+cuts[2]);
+}
+/**
+ * @brief TourOptimizer::optimize
+ * @param order indices of the stops in the order they are visited, the
+ * first stop comes first
+ * @return false if the tour needs a path which doesn't exist
+ */
+bool TourOptimizer::optimize(vector<size_t> &order) {
+    order.clear();
+    if(costs_.empty())
+        return true;
+
+    deadline_ = Clock::now()+chrono::duration_cast<Clock::duration>(chrono::duration<double>(timeLimit_));
+
+    vector<size_t> tour;
+    nearestNeighbor(tour);
+    TourCost initial = tourCost(tour);
+    size_t moves = localSearch(tour);
+    TourCost total = tourCost(tour);
+
+    size_t kicks = 0;
+    for(size_t failed = 0; tour.size() > 3 && failed < MAX_FAILED_KICKS && !timeIsUp(); kicks++) {
+        vector<size_t> candidate(tour);
+        kick(candidate);
+        moves += localSearch(candidate);
+        TourCost candidateCost = tourCost(candidate);
+        if(candidateCost < total) {
+            tour.swap(candidate);
+            total = candidateCost;
+            failed = 0;
+        } else {
+            failed++;
+        }
+    }
+
+    order.assign(tour.begin(), tour.end()-1);
+    LOGG(Logger::INFO) << "[TOUR] " << costs_.size() << " stops, " << initial << " to " << total << " after "
+                       << moves << " moves and " << kicks << " kicks" << (timeIsUp() ? ", out of time" : "") << Logger::FLUSH;
+    return total < UNREACHABLE;
+}
@@ -54,3 +54,21 @@ Edge::EdgeId TurnRestriction::getFrom() const {
 Edge::EdgeId TurnRestriction::getTo() const {
     return to_;
 }
+
+/**
+ * the turn from the from way to the to way is not allowed, no_* types
+ * @brief isProhibitive
+ * @return
+ */
+bool TurnRestriction::isProhibitive() const {
+    return type_.compare(0, 3, "no_") == 0;
+}
+
+/**
+ * the to way is the only way allowed after the from way, only_* types
+ * @brief isMandatory
+ * @return
+ */
+bool TurnRestriction::isMandatory() const {
+    return type_.compare(0, 5, "only_") == 0;
+}
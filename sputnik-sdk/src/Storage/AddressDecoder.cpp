@@ -109,15 +109,16 @@ bool AddressDecoder::resolve(const Point &pt, TagList &tags) {
     for(auto &tree : addrTree_) {
         string tag = tree.first;
 
-        string data;
-        OsmGraphCore::NearestPointResult res;
+        // only areas close enough are searched
+        vector<string> data;
+        vector<VertexPoint> res;
         if(tree.second) {
-            if(!tree.second->findNearestVertex(pt, res, data)) {
+            if(!tree.second->findKNearest(pt, 1, dist_[tag], res, data) || res.empty()) {
                 LOGG(Logger::WARNING) << "Couldn't find "+tag << " for " << pt << Logger::FLUSH; 
             } else {
-                if(goodNeighbor(pt, res.getTarget().getPoint(), tree.first)) {
+                if(goodNeighbor(pt, res[0].getPoint(), tree.first)) {
                     ConditionContainer cont;
-                    cont.addIdsIn({res.getTarget().getId()});
+                    cont.addIdsIn({res[0].getId()});
 
                     vector<TagList> areaTags;
                     if(tags_.simpleSearch(tagTable_, cont, 0, 1, areaTags)) {
@@ -1,5 +1,10 @@
 // KdTreeSpatial.cpp
 //
+#include <queue>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
 #include <UrbanLabs/Sdk/GraphCore/Vertices.h>
 #include <UrbanLabs/Sdk/Utils/StringUtils.h>
 #include <UrbanLabs/Sdk/Storage/KdTreeSql.h>
@@ -9,6 +14,38 @@ using namespace std;
 
 const int KdTreeSql::PRECISION = 7;
 
+namespace {
+    // a node of the sqlite r-tree is the depth of the tree, the number of
+    // cells and the cells, an id and the bounds as big endian 32 bit floats
+    const size_t NODE_HEADER_SIZE = 4;
+    const size_t CELL_SIZE = 8+4*sizeof(float);
+
+    /**
+     * @brief readBigEndian
+     * @param data
+     * @param size
+     * @return
+     */
+    inline uint64_t readBigEndian(const char *data, size_t size) {
+        uint64_t value = 0;
+        for(size_t i = 0; i < size; i++)
+            value = (value << 8) | uint8_t(data[i]);
+        return value;
+    }
+
+    /**
+     * @brief readCoord
+     * @param data
+     * @return
+     */
+    inline double readCoord(const char *data) {
+        uint32_t bits = uint32_t(readBigEndian(data, 4));
+        float value;
+        memcpy(&value, &bits, sizeof(float));
+        return value;
+    }
+}
+
 //------------------------------------------------------------------------------
 // KdTreeSqlite
 //------------------------------------------------------------------------------
@@ -65,10 +102,11 @@ bool KdTreeSql::open(const URL &url, const Properties &props, bool fetchData) {
     }
     SqlQuery nearestPt = SqlQuery::q().select({table_+"."+idCol_,"minlat","minlon"})
                 .from(table_).where("minlat>=? AND maxlat<=? AND minlon>=? AND maxlon<=?");
+    dataField_ = props.get("dataField");
+    if (dataField_ == "")
+        dataField_ = "data";
     if (fetchData) {
-        string dataField = props.get("dataField");
-        if (dataField == "")
-            dataField = "data";
+        string dataField = dataField_;
 
         SqlQuery inner = SqlQuery::q().select({table_+"."+idCol_})
                 .from(table_).where("minlat>=? AND maxlat<=? AND minlon>=? AND maxlon<=?");
@@ -84,6 +122,19 @@ bool KdTreeSql::open(const URL &url, const Properties &props, bool fetchData) {
         return false;
     }
     LOGG(Logger::INFO) << "[KDTREE SQLITE] :" << nearestPt.toString() << Logger::FLUSH;
+
+    // the nodes of the tree are only stored in a table by sqlite
+    nodeStmt_.reset(0);
+    dataStmt_.reset(0);
+    if(conn_->existsTable(table_+"_node")) {
+        SqlQuery node = SqlQuery::q().select({"data"}).from(table_+"_node").where("nodeno=?");
+        SqlQuery data = SqlQuery::q().select({dataField_}).from(table_+dataTablePostfix_).where(idCol_+"=?");
+        if(!conn_->prepare(node.toString(), nodeStmt_) || (fetchData && !conn_->prepare(data.toString(), dataStmt_))) {
+            LOGG(Logger::WARNING) << "[KDTREE SQLITE] Searching boxes for nearest points" << Logger::FLUSH;
+            nodeStmt_.reset(0);
+            dataStmt_.reset(0);
+        }
+    }
     return true;
 }
 /**
@@ -170,32 +221,187 @@ bool KdTreeSql::insertBulk(const VertexPoint &vertexPoint,const std::string &sep
  * @return
  */
 bool KdTreeSql::findNearestVertex(const Point &pt, NearestPointResult &result, string& data) {
+    vector<string> pointData;
+    vector<VertexPoint> nearVertPoints;
+    if(!findKNearest(pt, 1, numeric_limits<double>::max(), nearVertPoints, pointData) || nearVertPoints.size() == 0) {
+        LOGG(Logger::ERROR) << "[KDTREE SQLITE] Failed to find nearest neighbour" << Logger::FLUSH;
+        return false;
+    }
+    result.setTarget(nearVertPoints[0]);
+    if (fetchData_) {
+        data = pointData[0];
+    }
+    return true;
+}
+/**
+ * the k points closest to the given one, closer ones first. Distances are
+ * measured on the plane touching the earth at the point, see planarDistance
+ * @brief KdTreeSql::findKNearest
+ * @param pt
+ * @param k
+ * @param maxDist points farther away in meters are not returned
+ * @param results
+ * @param data
+ * @return false if the tree couldn't be read
+ */
+bool KdTreeSql::findKNearest(const Point &pt, size_t k, double maxDist,
+                             vector<VertexPoint> &results, vector<string> &data) {
+    // the planar distance is in degrees of latitude
+    double degrees = maxDist/(EARTH_RADIUS_IN_METERS/2*DEG_TO_RAD);
+    if(nodeStmt_)
+        return findKNearestNodes(pt, k, degrees, results, data);
+    return findKNearestBoxes(pt, k, degrees, results, data);
+}
+/**
+ * @brief KdTreeSql::readNode
+ * @param node
+ * @param depth of the node if it is the root
+ * @param cells
+ * @return
+ */
+bool KdTreeSql::readNode(int64_t node, int &depth, string &cells) {
+    nodeStmt_->reset();
+    if(!nodeStmt_->bind(node) || !nodeStmt_->step())
+        return false;
+    string blob = nodeStmt_->column_blob(0);
+    if(blob.size() < NODE_HEADER_SIZE)
+        return false;
+    size_t count = readBigEndian(blob.data()+2, 2);
+    if(blob.size() < NODE_HEADER_SIZE+count*CELL_SIZE)
+        return false;
+    depth = int(readBigEndian(blob.data(), 2));
+    cells = blob.substr(NODE_HEADER_SIZE, count*CELL_SIZE);
+    return true;
+}
+/**
+ * visits the nodes of the r-tree closest to the point first, until the
+ * next one is farther than the k points found
+ * @brief KdTreeSql::findKNearestNodes
+ * @param pt
+ * @param k
+ * @param maxDist planar distance
+ * @param results
+ * @param data
+ * @return
+ */
+bool KdTreeSql::findKNearestNodes(const Point &pt, size_t k, double maxDist,
+                                  vector<VertexPoint> &results, vector<string> &data) {
+    double fact = PRECISION == -1 ? 1 : pow(10, PRECISION);
+    double scale = cos(pt.lat()*DEG_TO_RAD);
+    auto boxDistance = [&pt, scale](double minLat, double maxLat, double minLon, double maxLon) {
+        double dLat = max(0.0, max(minLat-pt.lat(), pt.lat()-maxLat));
+        double dLon = max(0.0, max(minLon-pt.lon(), pt.lon()-maxLon));
+        return sqrt(dLat*dLat+dLon*dLon*scale*scale);
+    };
+
+    // the root is node 1, the depth of the other nodes is one less than of their parent
+    struct Entry {
+        Point::PointDistType dist_;
+        int depth_;
+        int64_t id_;
+        Point point_;
+        bool operator > (const Entry &e) const {
+            return dist_ > e.dist_ || (dist_ == e.dist_ && (depth_ < e.depth_ || (depth_ == e.depth_ && id_ > e.id_)));
+        }
+    };
+    std::priority_queue<Entry, vector<Entry>, std::greater<Entry> > queue;
+    queue.push({0, 0, 1, Point()});
+
+    bool root = true;
+    size_t found = 0;
+    while(!queue.empty() && found < k) {
+        Entry top = queue.top();
+        queue.pop();
+        if(top.dist_ > maxDist)
+            break;
+        // points are at depth -1, below the leaves
+        if(top.depth_ < 0) {
+            results.push_back(VertexPoint(top.id_, top.point_));
+            if(fetchData_) {
+                dataStmt_->reset();
+                if(!dataStmt_->bind(top.id_) || !dataStmt_->step())
+                    return false;
+                data.push_back(dataStmt_->column_text(0));
+            }
+            found++;
+            continue;
+        }
+
+        int depth = 0;
+        string cells;
+        if(!readNode(top.id_, depth, cells)) {
+            LOGG(Logger::ERROR) << "[KDTREE SQLITE] Failed to read node " << top.id_ << Logger::FLUSH;
+            return false;
+        }
+        if(root)
+            top.depth_ = depth, root = false;
+
+        for(size_t i = 0; i < cells.size(); i += CELL_SIZE) {
+            const char *cell = cells.data()+i;
+            int64_t id = int64_t(readBigEndian(cell, 8));
+            double minLat = readCoord(cell+8)/fact, maxLat = readCoord(cell+12)/fact;
+            double minLon = readCoord(cell+16)/fact, maxLon = readCoord(cell+20)/fact;
+            // the bounds of a point are rounded outwards, it is at the lower ones
+            Point::PointDistType dist = top.depth_ == 0 ? planarDistance(pt, Point(minLat, minLon)) :
+                                                          boxDistance(minLat, maxLat, minLon, maxLon);
+            if(dist <= maxDist)
+                queue.push({dist, top.depth_-1, id, Point(minLat, minLon)});
+        }
+    }
+    return true;
+}
+/**
+ * searches growing boxes around the point, for databases which don't store
+ * the nodes of the tree
+ * @brief KdTreeSql::findKNearestBoxes
+ * @param pt
+ * @param k
+ * @param maxDist planar distance
+ * @param results
+ * @param data
+ * @return
+ */
+bool KdTreeSql::findKNearestBoxes(const Point &pt, size_t k, double maxDist,
+                                  vector<VertexPoint> &results, vector<string> &data) {
     // initial bbox
     int attempts = 100;
     double bboxFactor = 0.0001;
     double half = bboxFactor / 2.0;
+    double scale = max(cos(pt.lat()*DEG_TO_RAD), 1e-9);
 
-    // results
+    // a box holds all points as close as half its height, so when there are
+    // enough points the box as large as the distance to the k-th is searched
     vector<string> pointData;
     vector<VertexPoint> nearVertPoints;
-    while(nearVertPoints.size() == 0 && attempts > 0) {
-        Point hiLeft(pt.lat()+half, pt.lon()-half);
-        Point lowRight(pt.lat()-half, pt.lon()+half);
-        findAllInBoundingBox(hiLeft, lowRight, nearVertPoints, pointData);
-        half *= 2.0;
+    vector<pair<Point::PointDistType, size_t> > order;
+    double limit = min(maxDist, 180.0);
+    bool covered = false;
+    while(!covered && attempts > 0) {
+        half = min(half, limit);
+        Point hiLeft(pt.lat()+half, pt.lon()-half/scale);
+        Point lowRight(pt.lat()-half, pt.lon()+half/scale);
+        nearVertPoints.clear();
+        pointData.clear();
+        if(!findAllInBoundingBox(hiLeft, lowRight, nearVertPoints, pointData))
+            return false;
+
+        order.clear();
+        for(size_t i = 0; i < nearVertPoints.size(); i++)
+            order.push_back({planarDistance(pt, nearVertPoints[i].getPoint()), i});
+        sort(order.begin(), order.end());
+
+        covered = half >= limit || (order.size() >= k && order[k-1].first <= half);
+        if(order.size() >= k && order[k-1].first > half)
+            half = order[k-1].first;
+        else
+            half *= 2.0;
         attempts--;
     }
-    if(nearVertPoints.size() == 0) {
-        LOGG(Logger::ERROR) << "[KDTREE SQLITE] Failed to find nearest neighbour" << Logger::FLUSH;
-        return false;
-    }
-    vector<Point> nearestPts(nearVertPoints.size());
-    for(int i = 0; i < (int)nearestPts.size(); ++i)
-        nearestPts[i] = nearVertPoints[i].getPoint();
-    size_t cId = closestPoint(pt, nearestPts);
-    result.setTarget(VertexPoint(nearVertPoints[cId].getId(),nearVertPoints[cId].getPoint()));
-    if (fetchData_) {
-        data = pointData[cId];
+
+    for(size_t i = 0; i < order.size() && i < k && order[i].first <= maxDist; i++) {
+        results.push_back(nearVertPoints[order[i].second]);
+        if(fetchData_)
+            data.push_back(pointData[order[i].second]);
     }
     return true;
 }
@@ -374,6 +580,8 @@ void KdTreeSql::cleanUp() {
  * @brief KdTreeSqlite::unload
  */
 void KdTreeSql::close() {
+    nodeStmt_.reset(0);
+    dataStmt_.reset(0);
     stmt_.reset(0);
     conn_.reset(0);
 }
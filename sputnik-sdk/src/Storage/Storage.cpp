@@ -466,6 +466,32 @@ bool GeometryIndexSql::findGeometry(const VertexId id1, const VertexId id2,
     geometry.insert(geometry.end(), closestGeom.begin(), closestGeom.end());
     return true;
 }
+/**
+ * visits the stored geometries ordered by their keys, the points are as
+ * they were inserted
+ * @brief GeometryIndexSql::forEachGeometry
+ * @param visitor returns false to stop
+ * @return false if the geometries couldn't be read
+ */
+bool GeometryIndexSql::forEachGeometry(const GeometryVisitor &visitor) {
+    if(!conn_)
+        return false;
+
+    unique_ptr<PrepStmt> stmt;
+    SqlQuery select = SqlQuery::q().select({"ver1", "ver2", "geom"}).from(SqlConsts::GEOMETRY_TABLE).
+            orderAsc("ver1").orderAsc("ver2");
+    if(!conn_->prepare(select.toString(), stmt))
+        return false;
+
+    while(stmt->step()) {
+        string compressed = stmt->column_blob(2);
+        if(compressed == "")
+            continue;
+        if(!visitor(stmt->column_int64(0), stmt->column_int64(1), deserialize(compressed)))
+            break;
+    }
+    return true;
+}
 //--------------------------------------------------------------------------------------------------
 // TagStorage
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,110 @@
+// MemoryMappedFile.cpp
+//
+#include <cerrno>
+#include <cstring>
+
+#include <UrbanLabs/Sdk/Utils/MemoryMappedFile.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+
+// do not change the order here, ANDROID should come before __linux
+#ifdef _WIN64
+    #error "not defined"
+#elif _WIN32
+    #error "not defined"
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief MemoryMappedFile::MemoryMappedFile
+ */
+MemoryMappedFile::MemoryMappedFile() : path_(""), data_(0), size_(0) {;}
+/**
+ * @brief MemoryMappedFile::~MemoryMappedFile
+ */
+MemoryMappedFile::~MemoryMappedFile() {
+    close();
+}
+/**
+ * @brief MemoryMappedFile::open
+ * @param path
+ * @return
+ */
+bool MemoryMappedFile::open(const string &path) {
+    if(!close())
+        return false;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        LOGG(Logger::ERROR) << "[MMAP] can't stat " << path << Logger::FLUSH;
+        ::close(fd);
+        return false;
+    }
+
+    // private mapping, in place updates of the data such as metric
+    // import do not touch the file and do not affect other processes
+    void *addr = mmap(0, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(addr == MAP_FAILED) {
+        LOGG(Logger::ERROR) << "[MMAP] can't map " << path << ": " << strerror(errno) << Logger::FLUSH;
+        return false;
+    }
+
+    path_ = path;
+    data_ = static_cast<char *>(addr);
+    size_ = st.st_size;
+    return true;
+}
+/**
+ * @brief MemoryMappedFile::close
+ * @return
+ */
+bool MemoryMappedFile::close() {
+    bool ret = true;
+    if(data_ != 0 && munmap(data_, size_) != 0) {
+        LOGG(Logger::ERROR) << "[MMAP] can't unmap " << path_ << Logger::FLUSH;
+        ret = false;
+    }
+    path_ = "";
+    data_ = 0;
+    size_ = 0;
+    return ret;
+}
+/**
+ * @brief MemoryMappedFile::isOpen
+ * @return
+ */
+bool MemoryMappedFile::isOpen() const {
+    return data_ != 0;
+}
+/**
+ * @brief MemoryMappedFile::data
+ * @return
+ */
+char *MemoryMappedFile::data() const {
+    return data_;
+}
+/**
+ * @brief MemoryMappedFile::size
+ * @return
+ */
+size_t MemoryMappedFile::size() const {
+    return size_;
+}
+/**
+ * @brief MemoryMappedFile::getPath
+ * @return
+ */
+const string &MemoryMappedFile::getPath() const {
+    return path_;
+}
@@ -9,7 +9,23 @@ SOURCES += main.cpp \
            test_time.cpp \
            test_string_utils.cpp \
            test_polyline_encoder.cpp \
-           test_filesystem.cpp
+           test_filesystem.cpp \
+           test_graph_file.cpp \
+           test_compact_adjacency.cpp \
+           test_nested_dissection.cpp \
+           test_isochrone.cpp \
+           test_landmarks.cpp \
+           test_search_space.cpp \
+           test_heap.cpp \
+           test_geometry_store.cpp \
+           test_work_stealing_pool.cpp \
+           test_tour_optimizer.cpp \
+           test_packed_rtree.cpp \
+           test_segment_index.cpp \
+           test_kdtree_sql.cpp \
+           test_multi_level_overlay.cpp \
+           test_contraction_hierarchy.cpp \
+           test_traffic_update.cpp
 
 HEADERS += AutoTest.h \
            test_storage.h \
@@ -17,7 +33,24 @@ HEADERS += AutoTest.h \
            test_time.h \
            test_string_utils.h \
            test_polyline_encoder.h \
-           test_filesystem.h
+           test_filesystem.h \
+           test_graph_file.h \
+           test_compact_adjacency.h \
+           test_nested_dissection.h \
+           test_isochrone.h \
+           test_landmarks.h \
+           test_search_space.h \
+           test_heap.h \
+           test_geometry_store.h \
+           test_work_stealing_pool.h \
+           test_tour_optimizer.h \
+           test_packed_rtree.h \
+           test_segment_index.h \
+           test_kdtree_sql.h \
+           test_multi_level_overlay.h \
+           test_grid_map.h \
+           test_contraction_hierarchy.h \
+           test_traffic_update.h
 
 CONFIG-=app_bundle
           
@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <vector>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/CompactAdjacency.h>
+#include "test_compact_adjacency.h"
+
+using namespace std;
+
+void TestCompactAdjacency::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    QVERIFY(sizeof(CompactEdge) == 16);
+
+    // 0 -> 1, 0 -> 2 (shortcut via 1), 2 -> 0
+    vector<vector<EdgeForw> > lists(3);
+    lists[0].push_back(EdgeForw(1, 10, 5, Vertex::NullVertexId, Edge::ONE_WAY, 100));
+    lists[0].push_back(EdgeForw(2, 30, 15, 1, Edge::CREATED_ON_PREPROCESSING));
+    lists[2].push_back(EdgeForw(0, 7, 3, Vertex::NullVertexId, 0, 101));
+
+    CompactAdjacency adj;
+    adj.build(lists, 3);
+    QVERIFY(lists.empty());
+    QVERIFY(adj.getNumVertices() == 3 && adj.getNumEdges() == 3);
+    QVERIFY(adj.degree(0) == 2 && adj.degree(1) == 0 && adj.degree(2) == 1);
+
+    CompactEdge *edge = adj.begin(0);
+    QVERIFY(edge->getNextId() == 1 && edge->getCost<Edge::DistanceMetric>() == 10);
+    QVERIFY(edge->getCost<Edge::TimeMetric>() == 5 && edge->getType() == Edge::ONE_WAY);
+    QVERIFY(adj.getVia(edge) == Vertex::NullVertexId && adj.getOrigId(edge) == 100);
+    edge++;
+    QVERIFY(adj.getVia(edge) == 1 && adj.getOrigId(edge) == Edge::NullEdgeId);
+
+    // customized weights, the input weights are kept
+    QVERIFY(adj.getShortcutVia<Edge::DistanceMetric>(edge) == Vertex::NullVertexId);
+    QVERIFY(adj.getShortcutEdges<Edge::DistanceMetric>(edge).in_ == CompactAdjacency::NullEdgeIndex);
+    adj.setShortcut<Edge::DistanceMetric>(edge, 25, 1, 2, 0);
+    QVERIFY(edge->getCost<Edge::DistanceMetric>() == 25 && edge->getCost<Edge::TimeMetric>() == 15);
+    QVERIFY(adj.getInputCost<Edge::DistanceMetric>(edge) == 30);
+    QVERIFY(adj.getShortcutVia<Edge::DistanceMetric>(edge) == 1);
+    QVERIFY(adj.getShortcutVia<Edge::TimeMetric>(edge) == Vertex::NullVertexId);
+    QVERIFY(adj.getShortcutEdges<Edge::DistanceMetric>(edge).in_ == 2 && adj.getShortcutEdges<Edge::DistanceMetric>(edge).out_ == 0);
+    QVERIFY(adj.getShortcutEdges<Edge::TimeMetric>(edge).in_ == CompactAdjacency::NullEdgeIndex);
+    QVERIFY(adj.index(edge) == 1 && adj.getEdge(1) == edge);
+
+    // write and use the arrays from the mapping
+    string path = "test_compact_adjacency.bin";
+    GraphFileWriter writer;
+    QVERIFY(writer.open(path, 3));
+    QVERIFY(adj.write(writer, CompactAdjacency::FORWARD_SECTIONS));
+    QVERIFY(writer.close());
+
+    GraphFileReader reader;
+    QVERIFY(reader.open(path));
+    CompactAdjacency mapped;
+    QVERIFY(mapped.map(reader, CompactAdjacency::FORWARD_SECTIONS));
+    QVERIFY(mapped.isMapped() && mapped.getMemoryUsage() == 0);
+    QVERIFY(mapped.degree(0) == 2 && mapped.begin(2)->getNextId() == 0);
+    QVERIFY(mapped.getOrigId(mapped.begin(2)) == 101);
+    QVERIFY(mapped.getShortcutVia<Edge::DistanceMetric>(mapped.begin(0)+1) == 1);
+    QVERIFY(mapped.getShortcutEdges<Edge::DistanceMetric>(mapped.begin(0)+1).in_ == 2);
+    QVERIFY(mapped.checkShortcutEdges(mapped, mapped));
+
+    // a missing section is an error
+    CompactAdjacency missing;
+    QVERIFY(!missing.map(reader, CompactAdjacency::BACKWARD_SECTIONS));
+
+    // pruning copies the mapped arrays and drops the customization
+    mapped.prune([](Vertex::VertexId, const CompactEdge &e) { return e.getNextId() != 1; });
+    QVERIFY(!mapped.isMapped());
+    QVERIFY(mapped.getNumEdges() == 2 && mapped.degree(0) == 1 && mapped.degree(2) == 1);
+    QVERIFY(mapped.getVia(mapped.begin(0)) == 1);
+    QVERIFY(mapped.getShortcutEdges<Edge::DistanceMetric>(mapped.begin(0)).in_ == CompactAdjacency::NullEdgeIndex);
+
+    // customization starts over from the input weights
+    mapped.resetCosts<Edge::DistanceMetric>();
+    QVERIFY(mapped.begin(0)->getCost<Edge::DistanceMetric>() == 30);
+    QVERIFY(mapped.getShortcutVia<Edge::DistanceMetric>(mapped.begin(0)) == Vertex::NullVertexId);
+    QVERIFY(reader.close());
+    remove(path.c_str());
+
+    // back to lists
+    vector<vector<EdgeForw> > expanded;
+    mapped.expand(expanded);
+    QVERIFY(expanded.size() == 3 && expanded[0].size() == 1 && expanded[2].size() == 1);
+    QVERIFY(expanded[0][0].getVia() == 1 && expanded[0][0].getCost<Edge::TimeMetric>() == 15);
+    QVERIFY(expanded[2][0].getOrigId() == 101);
+    QVERIFY(mapped.getNumEdges() == 0);
+}
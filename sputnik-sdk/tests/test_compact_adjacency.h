@@ -0,0 +1,13 @@
+#pragma once
+
+#include "AutoTest.h"
+
+class TestCompactAdjacency : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test();
+};
+
+DECLARE_TEST(TestCompactAdjacency)
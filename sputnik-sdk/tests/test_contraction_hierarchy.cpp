@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/Model.h>
+#include "test_grid_map.h"
+#include "test_contraction_hierarchy.h"
+
+using namespace std;
+
+typedef Graph<AdjacencyList> RoutingGraph;
+
+void TestContractionHierarchy::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    string path = "test_contraction_hierarchy.db";
+    remove(path.c_str());
+    remove((path+".preprocessed").c_str());
+    QVERIFY(writeGridMap(path, 12, 7));
+
+    // queries between points on and next to the streets
+    mt19937 rng(5);
+    uniform_real_distribution<double> lat(50, 50.011), lon(10, 10.011);
+    vector<pair<Point, Point> > queries;
+    for(size_t i = 0; i < 200; i++)
+        queries.push_back(make_pair(Point(lat(rng), lon(rng)), Point(lat(rng), lon(rng))));
+
+    // lengths by bidirectional Dijkstra on the input graph
+    vector<RoutingGraph::DistType> dist, time;
+    {
+        RoutingGraph graph;
+        QVERIFY(graph.parseGraph(path));
+        QVERIFY(!graph.getModel()->hasHierarchy());
+        for(const pair<Point, Point> &query : queries) {
+            RoutingGraph::SearchResult result;
+            dist.push_back(graph.shortestPathBidirectionalDijkstra<Edge::DistanceMetric>(query.first, query.second, result));
+            time.push_back(graph.shortestPathBidirectionalDijkstra<Edge::TimeMetric>(query.first, query.second, result));
+        }
+        graph.getModel()->setNumThreads(2);
+        graph.getModel()->preprocess();
+
+        // preprocessing renumbers the vertices, snapping follows them
+        QVERIFY(graph.getModel()->hasHierarchy());
+        for(size_t i = 0; i < queries.size(); i++) {
+            RoutingGraph::SearchResult result;
+            QVERIFY(graph.shortestPathCH<Edge::DistanceMetric>(queries[i].first, queries[i].second, result) == dist[i]);
+            QVERIFY(graph.shortestPathCH<Edge::TimeMetric>(queries[i].first, queries[i].second, result) == time[i]);
+        }
+        graph.unloadGraph();
+    }
+    QVERIFY(size_t(count(dist.begin(), dist.end(), -1)) < queries.size()/2);
+
+    // the customized hierarchy gives the same lengths in both metrics, also
+    // when the searches of both directions run on their own threads
+    RoutingGraph graph;
+    QVERIFY(graph.parseGraph(path));
+    QVERIFY(graph.getModel()->hasHierarchy());
+    for(size_t i = 0; i < queries.size(); i++) {
+        RoutingGraph::SearchResult result;
+        QVERIFY(graph.shortestPathCH<Edge::DistanceMetric>(queries[i].first, queries[i].second, result) == dist[i]);
+        QVERIFY(graph.shortestPathCH<Edge::TimeMetric>(queries[i].first, queries[i].second, result) == time[i]);
+        QVERIFY(graph.shortestPathCH<Edge::DistanceMetric>(queries[i].first, queries[i].second, result, true) == dist[i]);
+        QVERIFY(graph.shortestPathCH<Edge::TimeMetric>(queries[i].first, queries[i].second, result, true) == time[i]);
+        QVERIFY(result.getLength() == time[i] || time[i] == -1);
+    }
+    graph.unloadGraph();
+
+    remove(path.c_str());
+    remove((path+".preprocessed").c_str());
+}
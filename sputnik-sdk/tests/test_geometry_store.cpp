@@ -0,0 +1,58 @@
+#include <cstdio>
+#include <vector>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/GeometryStore.h>
+#include "test_geometry_store.h"
+
+using namespace std;
+
+void TestGeometryStore::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    // coordinates with the precision of the store, negative ones included
+    vector<Point> line = {Point(52.5200066, 13.4049540), Point(52.5201, 13.405), Point(52.5203, 13.4049)};
+    vector<Point> other = {Point(52.5200066, 13.4049540), Point(52.519, 13.406), Point(52.5203, 13.4049)};
+    vector<Point> west = {Point(-33.8688197, -151.2092955), Point(-33.87, -151.21)};
+
+    GeometryStore store;
+    QVERIFY(store.empty());
+    QVERIFY(store.add(1, 2, line));
+    QVERIFY(store.add(1, 2, other));
+    QVERIFY(store.add(3, 4, west));
+    QVERIFY(store.add(7, 5, west));
+    // the geometries are added in the order of their keys
+    QVERIFY(!store.add(0, 1, line));
+    QVERIFY(store.getNumGeometries() == 4);
+
+    // the points survive a round trip through the file
+    string path = "test_geometry_store.bin";
+    QVERIFY(store.save(path));
+    GeometryStore loaded;
+    QVERIFY(loaded.load(path));
+    QVERIFY(loaded.getNumGeometries() == 4);
+
+    vector<Point> geometry;
+    QVERIFY(loaded.findGeometry(3, 4, Point(0, 0), false, geometry));
+    QVERIFY(geometry == west);
+
+    // the vertices in the opposite order reverse the geometry
+    geometry.clear();
+    QVERIFY(loaded.findGeometry(4, 3, Point(0, 0), false, geometry));
+    QVERIFY(geometry == vector<Point>(west.rbegin(), west.rend()));
+
+    // of two geometries of an edge the one closer to the target is taken
+    geometry.clear();
+    QVERIFY(loaded.findGeometry(1, 2, Point(52.5201, 13.405), false, geometry));
+    QVERIFY(geometry == line);
+    geometry.clear();
+    QVERIFY(loaded.findGeometry(2, 1, Point(52.519, 13.406), false, geometry));
+    QVERIFY(geometry == vector<Point>(other.rbegin(), other.rend()));
+
+    // fixed keys depend on the order of the vertices
+    geometry = {Point(1, 1)};
+    QVERIFY(loaded.findGeometry(7, 5, Point(0, 0), true, geometry));
+    QVERIFY(geometry.size() == west.size()+1 && geometry[1] == west[0]);
+    QVERIFY(!loaded.findGeometry(5, 7, Point(0, 0), true, geometry));
+    QVERIFY(!loaded.findGeometry(1, 3, Point(0, 0), false, geometry));
+    remove(path.c_str());
+}
@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <vector>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/GraphFile.h>
+#include "test_graph_file.h"
+
+using namespace std;
+
+void TestGraphFile::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    string path = "test_graph_file.bin";
+    vector<uint64_t> offsets = {0, 2, 2, 3};
+    vector<int32_t> values = {7, -1, 42};
+    vector<char> odd = {'a', 'b', 'c'};
+
+    // write sections of different sizes
+    GraphFileWriter writer;
+    QVERIFY(writer.open(path, 3));
+    QVERIFY(writer.writeSection(GraphFile::FORW_OFFSETS, offsets));
+    QVERIFY(writer.writeSection(GraphFile::RANKS, odd));
+    QVERIFY(writer.writeSection(GraphFile::FORW_EDGES, values));
+    QVERIFY(writer.close());
+
+    // read them back from the mapping
+    GraphFileReader reader;
+    QVERIFY(reader.open(path));
+    QVERIFY(reader.getNumVertices() == 3);
+
+    size_t count = 0;
+    const uint64_t *offs = reader.getSection<uint64_t>(GraphFile::FORW_OFFSETS, count);
+    QVERIFY(offs != 0 && count == offsets.size());
+    QVERIFY(vector<uint64_t>(offs, offs+count) == offsets);
+
+    const int32_t *vals = reader.getSection<int32_t>(GraphFile::FORW_EDGES, count);
+    QVERIFY(vals != 0 && count == values.size());
+    QVERIFY(reinterpret_cast<uintptr_t>(vals) % GraphFile::ALIGNMENT == 0);
+    QVERIFY(vector<int32_t>(vals, vals+count) == values);
+
+    const char *chars = reader.getSection<char>(GraphFile::RANKS, count);
+    QVERIFY(chars != 0 && count == odd.size());
+
+    // missing section
+    QVERIFY(reader.getSection<uint64_t>(GraphFile::BACK_OFFSETS, count) == 0);
+    QVERIFY(count == 0);
+    QVERIFY(reader.close());
+
+    // not a graph file
+    FILE *file = fopen(path.c_str(), "w");
+    fputs("0 1\n1 2\n", file);
+    fclose(file);
+    QVERIFY(!reader.open(path));
+    remove(path.c_str());
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <random>
+#include <UrbanLabs/Sdk/Utils/URL.h>
+#include <UrbanLabs/Sdk/Utils/Properties.h>
+#include <UrbanLabs/Sdk/Storage/SqlConsts.h>
+#include <UrbanLabs/Sdk/Storage/KdTreeSql.h>
+#include <UrbanLabs/Sdk/Storage/ConnectionsManager.h>
+
+/**
+ * writes a map of size x size crossings in the layout of the routing
+ * database. Every street is its own way, some of them are one way, and
+ * a few ways can't turn at their end
+ * @brief writeGridMap
+ * @param path
+ * @param size
+ * @param seed
+ * @return
+ */
+inline bool writeGridMap(const std::string &path, int size, unsigned seed) {
+    std::mt19937 rng(seed);
+    auto random = [&rng](int count) {
+        return int(rng()%count);
+    };
+
+    URL url(path);
+    Properties props = {{"create","1"},{"type","sqlite"},{"memory", "0"},{"table",SqlConsts::VERTICES_TABLE}};
+    auto conn = ConnectionsManager::getConnection(url, props);
+    if(!conn || !conn->open(url, props))
+        return false;
+    if(!conn->exec({SqlConsts::CREATE_VERTICES, SqlConsts::CREATE_EDGES, SqlConsts::CREATE_TURN_RESTRICTIONS,
+                    SqlConsts::CREATE_KDTREE_ENDPT, SqlConsts::CREATE_KDTREE_NONENDPT,
+                    SqlConsts::CREATE_KDTREE_NONENDPT_DATA, SqlConsts::CREATE_GEOMETRY}))
+        return false;
+    if(!conn->beginTransaction())
+        return false;
+
+    bool ok = true;
+    double fact = pow(10, KdTreeSql::PRECISION);
+    for(int id = 0; id < size*size; id++) {
+        double lat = 50+(id/size)*0.001+random(41)*0.000005, lon = 10+(id%size)*0.001+random(41)*0.000005;
+        std::string latPt = std::to_string(int64_t(lat*fact)), lonPt = std::to_string(int64_t(lon*fact));
+        ok = ok && conn->exec("INSERT INTO "+SqlConsts::VERTICES_TABLE+" VALUES("+std::to_string(id)+","+
+                              std::to_string(lat)+","+std::to_string(lon)+")");
+        ok = ok && conn->exec("INSERT INTO "+SqlConsts::KDTREE_ENDPT_TABLE+" VALUES("+std::to_string(id)+","+
+                              latPt+","+latPt+","+lonPt+","+lonPt+")");
+    }
+
+    // ways entering and leaving every crossing
+    std::vector<std::vector<int> > into(size*size), outOf(size*size);
+    int way = 0;
+    auto addEdge = [&](int from, int to, int dist, int time, int type) {
+        ok = ok && conn->exec("INSERT INTO "+SqlConsts::EDGES_TABLE+" VALUES("+std::to_string(from)+","+std::to_string(to)+
+                              ",-1,"+std::to_string(dist)+","+std::to_string(time)+","+std::to_string(type)+","+
+                              std::to_string(way)+")");
+        into[to].push_back(way);
+        outOf[from].push_back(way);
+    };
+    for(int id = 0; id < size*size; id++) {
+        for(int next : {id+1, id+size}) {
+            if((next == id+1 && id%size+1 == size) || next >= size*size || random(20) == 0)
+                continue;
+            int dist = 60+random(80), time = dist/(4+random(12))+1;
+            way++;
+            if(random(6) == 0) {
+                if(random(2) == 0)
+                    addEdge(id, next, dist, time, 2);
+                else
+                    addEdge(next, id, dist, time, 2);
+            } else {
+                addEdge(id, next, dist, time, 0);
+                addEdge(next, id, dist, time, 0);
+            }
+        }
+    }
+
+    for(int id = 0; id < size*size; id++) {
+        if(into[id].empty() || outOf[id].empty() || random(4) != 0)
+            continue;
+        int from = into[id][random(into[id].size())], to = outOf[id][random(outOf[id].size())];
+        std::string type = random(3) == 0 ? "only_straight_on" : (from == to ? "no_u_turn" : "no_left_turn");
+        ok = ok && conn->exec("INSERT INTO "+SqlConsts::TURN_RESTRICTIONS+" VALUES("+std::to_string(from)+","+
+                              std::to_string(to)+","+std::to_string(id)+",'"+type+"')");
+    }
+    return conn->commitTransaction() && conn->close() && ok;
+}
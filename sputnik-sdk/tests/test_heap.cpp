@@ -0,0 +1,252 @@
+#include <set>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <UrbanLabs/Sdk/Utils/Timer.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/Model.h>
+#include <UrbanLabs/Sdk/GraphCore/SearchSpace.h>
+#include "test_heap.h"
+
+using namespace std;
+
+namespace {
+    typedef uint32_t Key;
+    typedef int Val;
+
+    /**
+     * pushes, decreases and pops like a search does and compares the heap
+     * with a set, the values never go below the last popped one
+     */
+    template<typename HeapPolicy>
+    bool checkHeap(unsigned seed) {
+        typedef SearchSpace<Key, Val, HeapPolicy> Space;
+        Space space;
+        space.reset(2000);
+        typename Space::HeapType &heap = space.getHeap();
+
+        mt19937 rng(seed);
+        set<pair<Val, Key> > ref;
+        vector<Val> val(2000, -1);
+        Val last = 0;
+        for(int step = 0; step < 20000; step++) {
+            Key key = rng()%2000;
+            if(rng()%3 != 0 && val[key] == -1) {
+                val[key] = last+rng()%1000;
+                heap.pushHeap(key, val[key]);
+                ref.insert({val[key], key});
+            } else if(rng()%2 == 0 && val[key] > last) {
+                ref.erase({val[key], key});
+                val[key] = last+rng()%(val[key]-last);
+                heap.decreaseKey(key, val[key]);
+                ref.insert({val[key], key});
+            } else if(!ref.empty()) {
+                pair<Key, Val> top = heap.topHeap();
+                if(top.second != ref.begin()->first || val[top.first] != top.second)
+                    return false;
+                heap.popHeap();
+                ref.erase({top.second, top.first});
+                last = top.second;
+            }
+            if(heap.size() != ref.size())
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief The Grid struct
+     * grid graph in adjacency arrays
+     */
+    struct Grid {
+        vector<uint32_t> offsets_;
+        vector<pair<Key, Val> > arcs_;
+    };
+
+    void makeGrid(size_t n, Grid &grid) {
+        mt19937 rng(3);
+        grid.offsets_.assign(1, 0);
+        for(size_t i = 0; i < n; i++) {
+            for(size_t j = 0; j < n; j++) {
+                if(i > 0) grid.arcs_.push_back({(i-1)*n+j, 50+rng()%100});
+                if(i+1 < n) grid.arcs_.push_back({(i+1)*n+j, 50+rng()%100});
+                if(j > 0) grid.arcs_.push_back({i*n+j-1, 50+rng()%100});
+                if(j+1 < n) grid.arcs_.push_back({i*n+j+1, 50+rng()%100});
+                grid.offsets_.push_back(grid.arcs_.size());
+            }
+        }
+    }
+
+    /**
+     * one to all searches on the grid like the ones of preprocessing
+     * @return the sum of the distances
+     */
+    template<typename HeapPolicy>
+    uint64_t searchGrid(const Grid &grid, size_t searches, double &time) {
+        typedef SearchSpace<Key, Val, HeapPolicy> Space;
+        Space *space = Space::acquire();
+        typename Space::HeapType &heap = space->getHeap();
+        size_t numVertices = grid.offsets_.size()-1;
+
+        Timer timer;
+        uint64_t sum = 0;
+        for(size_t i = 0; i < searches; i++) {
+            Key source = (i*7919)%numVertices;
+            space->reset(numVertices);
+            space->visit(source, 0, source);
+            heap.pushHeap(source, 0);
+            while(!heap.empty()) {
+                pair<Key, Val> curr = heap.topHeap();
+                heap.popHeap();
+                sum += curr.second;
+                for(uint32_t e = grid.offsets_[curr.first]; e < grid.offsets_[curr.first+1]; e++) {
+                    Key next = grid.arcs_[e].first;
+                    Val dist = curr.second+grid.arcs_[e].second;
+                    if(!space->wasSeen(next)) {
+                        space->visit(next, dist, curr.first);
+                        heap.pushHeap(next, dist);
+                    } else if(dist < space->getDist(next)) {
+                        space->visit(next, dist, curr.first);
+                        heap.decreaseKey(next, dist);
+                    }
+                }
+            }
+        }
+        timer.stop();
+        time = timer.getElapsedTimeSec();
+
+        Space::release(space);
+        return sum;
+    }
+
+    /**
+     * one to all searches on a map, these settle the vertices in the order
+     * the queries do
+     * @return the sum of the distances
+     */
+    template<typename HeapPolicy>
+    int64_t searchMap(AdjacencyList *model, size_t searches, double &time) {
+        typedef SearchSpace<AdjacencyList::VertexId, AdjacencyList::DistType, HeapPolicy> Space;
+        Space *space = Space::acquire();
+        typename Space::HeapType &heap = space->getHeap();
+        size_t numVertices = model->getNumVertices();
+
+        Timer timer;
+        int64_t sum = 0;
+        for(size_t i = 0; i < searches; i++) {
+            AdjacencyList::VertexId source = (i*7919)%numVertices;
+            space->reset(numVertices);
+            space->visit(source, 0, source);
+            heap.pushHeap(source, 0);
+            while(!heap.empty()) {
+                pair<AdjacencyList::VertexId, AdjacencyList::DistType> curr = heap.topHeap();
+                heap.popHeap();
+                sum += curr.second;
+
+                auto edge = model->getOutgoingIterBegin(curr.first), end = model->getOutgoingIterEnd(curr.first);
+                for(; edge != end; ++edge) {
+                    AdjacencyList::VertexId next = edge->getNext().getId();
+                    AdjacencyList::DistType dist = curr.second+edge->template getCost<Edge::DistanceMetric>();
+                    if(!space->wasSeen(next)) {
+                        space->visit(next, dist, curr.first);
+                        heap.pushHeap(next, dist);
+                    } else if(dist < space->getDist(next)) {
+                        space->visit(next, dist, curr.first);
+                        heap.decreaseKey(next, dist);
+                    }
+                }
+            }
+        }
+        timer.stop();
+        time = timer.getElapsedTimeSec();
+
+        Space::release(space);
+        return sum;
+    }
+
+    /**
+     * routes between random vertices of a map with the heap
+     * @return the sum of the lengths
+     */
+    template<typename HeapPolicy>
+    int64_t routeMap(AdjacencyList *model, size_t queries, double &time) {
+        Graph<AdjacencyList, HeapPolicy> graph;
+        graph.setModel(model);
+
+        mt19937 rng(5);
+        vector<pair<Point, Point> > ends;
+        for(size_t i = 0; i < queries; i++) {
+            Point src = model->getPoint(rng()%model->getNumVertices());
+            ends.push_back({src, model->getPoint(rng()%model->getNumVertices())});
+        }
+
+        Timer timer;
+        int64_t sum = 0;
+        for(const pair<Point, Point> &end : ends) {
+            typename Graph<AdjacencyList, HeapPolicy>::SearchResult result;
+            sum += graph.shortestPathBidirectionalDijkstra(end.first, end.second, result);
+        }
+        timer.stop();
+        time = timer.getElapsedTimeSec();
+        return sum;
+    }
+}
+
+void TestHeap::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    for(unsigned seed = 0; seed < 5; seed++) {
+        QVERIFY(checkHeap<BinaryHeapPolicy>(seed));
+        QVERIFY(checkHeap<QuaternaryHeapPolicy>(seed));
+        QVERIFY(checkHeap<RadixHeapPolicy>(seed));
+    }
+
+    // a radix heap pops values below the last popped one first
+    RadixHeap<Key, Val> radix;
+    radix.keyPosMap_.resize(10);
+    radix.pushHeap(1, 10);
+    radix.pushHeap(2, 20);
+    radix.popHeap();
+    radix.pushHeap(3, 5);
+    radix.pushHeap(4, 7);
+    QVERIFY(radix.topHeap().first == 3);
+    radix.popHeap();
+    QVERIFY(radix.topHeap().first == 4);
+    radix.popHeap();
+    QVERIFY(radix.topHeap().first == 2 && radix.size() == 1);
+
+    // benchmark of the heaps in one to all searches
+    Grid grid;
+    makeGrid(300, grid);
+    double binaryTime, quaternaryTime, radixTime;
+    uint64_t binary = searchGrid<BinaryHeapPolicy>(grid, 20, binaryTime);
+    uint64_t quaternary = searchGrid<QuaternaryHeapPolicy>(grid, 20, quaternaryTime);
+    uint64_t radix2 = searchGrid<RadixHeapPolicy>(grid, 20, radixTime);
+    QVERIFY(binary == quaternary && binary == radix2);
+    LOGG(Logger::INFO) << "[HEAP] one to all binary " << binaryTime << "s 4-ary "
+                       << quaternaryTime << "s radix " << radixTime << "s" << Logger::FLUSH;
+
+    // and in the queries of a map if one is given
+    const char *map = getenv("SPUTNIK_BENCH_MAP");
+    if(map == 0)
+        return;
+
+    Graph<AdjacencyList> graph;
+    QVERIFY(graph.parseGraph(map));
+    int64_t binaryLength = searchMap<BinaryHeapPolicy>(graph.getModel(), 20, binaryTime);
+    int64_t quaternaryLength = searchMap<QuaternaryHeapPolicy>(graph.getModel(), 20, quaternaryTime);
+    int64_t radixLength = searchMap<RadixHeapPolicy>(graph.getModel(), 20, radixTime);
+    QVERIFY(binaryLength == quaternaryLength && binaryLength == radixLength);
+    LOGG(Logger::INFO) << "[HEAP] " << map << " one to all binary " << binaryTime << "s 4-ary "
+                       << quaternaryTime << "s radix " << radixTime << "s" << Logger::FLUSH;
+
+    // the queries include finding the nearest points
+    binaryLength = routeMap<BinaryHeapPolicy>(graph.getModel(), 200, binaryTime);
+    quaternaryLength = routeMap<QuaternaryHeapPolicy>(graph.getModel(), 200, quaternaryTime);
+    radixLength = routeMap<RadixHeapPolicy>(graph.getModel(), 200, radixTime);
+    QVERIFY(binaryLength == quaternaryLength && binaryLength == radixLength);
+    LOGG(Logger::INFO) << "[HEAP] " << map << " queries binary " << binaryTime << "s 4-ary "
+                       << quaternaryTime << "s radix " << radixTime << "s" << Logger::FLUSH;
+    graph.unloadGraph();
+}
@@ -0,0 +1,40 @@
+#include <vector>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/Isochrone.h>
+#include "test_isochrone.h"
+
+using namespace std;
+
+void TestIsochrone::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    // L shaped area, the inner corner is not covered by the convex hull
+    Point center(0, 0);
+    vector<Point> points;
+    for(int i = 0; i <= 10; i++) {
+        points.push_back(Point(i*0.001, 0));
+        points.push_back(Point(0, i*0.001));
+        points.push_back(Point(i*0.001, 0.001));
+        points.push_back(Point(0.001, i*0.001));
+    }
+    points.push_back(center);
+
+    vector<Point> polygon;
+    Isochrone(center, 8).findPolygon(points, polygon);
+
+    // the polygon is closed and has a corner at both ends of the L
+    QVERIFY(polygon.size() >= 4);
+    QVERIFY(polygon.front() == polygon.back());
+    bool north = false, east = false;
+    for(const Point &pt : polygon) {
+        north = north || pt.lat() == 0.01;
+        east = east || pt.lon() == 0.01;
+        // the dent between the arms stays outside
+        QVERIFY(pt.lat() <= 0.001 || pt.lon() <= 0.001);
+    }
+    QVERIFY(north && east);
+
+    // nothing but the center is reachable
+    Isochrone(center).findPolygon({center}, polygon);
+    QVERIFY(polygon.empty());
+}
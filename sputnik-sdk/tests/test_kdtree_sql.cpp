@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <UrbanLabs/Sdk/Utils/URL.h>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/Utils/Properties.h>
+#include <UrbanLabs/Sdk/Storage/SqlConsts.h>
+#include <UrbanLabs/Sdk/Storage/KdTreeSql.h>
+#include <UrbanLabs/Sdk/Storage/ConnectionsManager.h>
+#include "test_kdtree_sql.h"
+
+using namespace std;
+
+void TestKdTreeSql::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    unsigned seed = 11;
+    auto random = [&seed]() {
+        seed = seed*1103515245+12345;
+        return double((seed >> 16) & 0x7fff)/0x8000;
+    };
+
+    // points stored like the bulk load does, with their ids as data
+    string path = "test_kdtree_sql.db";
+    remove(path.c_str());
+    URL url(path);
+    Properties props = {{"create","1"},{"type","sqlite"},{"memory", "0"},{"table",SqlConsts::KDTREE_NON_ENDPOINT_TABLE}};
+    {
+        auto conn = ConnectionsManager::getConnection(url, props);
+        QVERIFY(conn && conn->open(url, props));
+        QVERIFY(conn->exec({SqlConsts::CREATE_KDTREE_NONENDPT, SqlConsts::CREATE_KDTREE_NONENDPT_DATA}));
+        QVERIFY(conn->beginTransaction());
+        double fact = pow(10, KdTreeSql::PRECISION);
+        for(size_t i = 0; i < 5000; i++) {
+            int64_t lat = int64_t((49+random()*0.5)*fact), lon = int64_t((7+random()*0.5)*fact);
+            string id = to_string(i+1), pt = to_string(lat)+","+to_string(lat)+","+to_string(lon)+","+to_string(lon);
+            QVERIFY(conn->exec("INSERT INTO "+SqlConsts::KDTREE_NON_ENDPOINT_TABLE+" VALUES("+id+","+pt+")"));
+            QVERIFY(conn->exec("INSERT INTO "+SqlConsts::KDTREE_NON_ENDPOINT_TABLE+"_data VALUES("+id+",'"+id+"')"));
+        }
+        QVERIFY(conn->commitTransaction());
+        QVERIFY(conn->close());
+    }
+
+    props.set("create", "0");
+    KdTreeSql tree;
+    QVERIFY(tree.open(url, props, true));
+
+    vector<string> data;
+    vector<VertexPoint> points;
+    QVERIFY(tree.findAllInBoundingBox(Point(90, -180), Point(-90, 180), points, data));
+    QVERIFY(points.size() == 5000);
+
+    // the distances of the k closest points, inside and outside the area
+    double metersPerDegree = EARTH_RADIUS_IN_METERS/2*DEG_TO_RAD;
+    for(size_t i = 0; i < 200; i++) {
+        Point pt(48.9+random()*0.7, 6.9+random()*0.7);
+        size_t k = 1+i%5;
+        double maxDist = i%2 ? 300 : numeric_limits<double>::max();
+
+        vector<double> closest;
+        for(const VertexPoint &vpt : points) {
+            double dist = planarDistance(pt, vpt.getPoint());
+            if(dist*metersPerDegree <= maxDist)
+                closest.push_back(dist);
+        }
+        sort(closest.begin(), closest.end());
+        closest.resize(min(closest.size(), k));
+
+        vector<string> resultData;
+        vector<VertexPoint> results;
+        QVERIFY(tree.findKNearest(pt, k, maxDist, results, resultData));
+        QVERIFY(results.size() == closest.size() && resultData.size() == closest.size());
+        for(size_t j = 0; j < results.size(); j++) {
+            QVERIFY(planarDistance(pt, results[j].getPoint()) == closest[j]);
+            QVERIFY(resultData[j] == to_string(results[j].getId()));
+        }
+    }
+
+    // the nearest vertex is the first of the nearest points
+    string pointData;
+    vector<string> resultData;
+    vector<VertexPoint> results;
+    OsmGraphCore::NearestPointResult result;
+    QVERIFY(tree.findNearestVertex(Point(49.2, 7.2), result, pointData));
+    QVERIFY(tree.findKNearest(Point(49.2, 7.2), 1, numeric_limits<double>::max(), results, resultData));
+    QVERIFY(result.getTarget().getId() == results[0].getId() && pointData == resultData[0]);
+    tree.close();
+    remove(path.c_str());
+}
@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/Landmarks.h>
+#include "test_landmarks.h"
+
+using namespace std;
+
+typedef Landmarks::Dist Dist;
+typedef Landmarks::VertexId VertexId;
+
+/**
+ * distances from the source to all vertices by Bellman-Ford
+ */
+static vector<Dist> findDistances(const Landmarks::Adjacency &graph, VertexId source, size_t metric) {
+    size_t numVertices = graph.offsets_.size()-1;
+    vector<Dist> dist(numVertices, Landmarks::Unreachable);
+    dist[source] = 0;
+    for(size_t round = 0; round < numVertices; round++) {
+        for(size_t v = 0; v < numVertices; v++) {
+            if(dist[v] == Landmarks::Unreachable)
+                continue;
+            for(size_t i = graph.offsets_[v]; i < graph.offsets_[v+1]; i++) {
+                const Landmarks::Arc &arc = graph.arcs_[i];
+                dist[arc.target_] = min(dist[arc.target_], dist[v]+arc.cost_[metric]);
+            }
+        }
+    }
+    return dist;
+}
+
+void TestLandmarks::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    // grid with random one way streets and a vertex which can't be left
+    const VertexId size = 12, numVertices = size*size+1;
+    mt19937 rng(3);
+    vector<vector<Landmarks::Arc> > forwArcs(numVertices), backArcs(numVertices);
+    auto addArc = [&](VertexId from, VertexId to) {
+        Dist dist = 10+rng()%90, time = 1+rng()%20;
+        forwArcs[from].push_back({to, {dist, time}});
+        backArcs[to].push_back({from, {dist, time}});
+    };
+    for(VertexId id = 0; id < size*size; id++) {
+        VertexId row = id/size, col = id%size;
+        if(col+1 < size) {
+            if(rng()%4 != 0)
+                addArc(id, id+1);
+            addArc(id+1, id);
+        }
+        if(row+1 < size) {
+            addArc(id, id+size);
+            if(rng()%4 != 0)
+                addArc(id+size, id);
+        }
+    }
+    addArc(size+1, size*size);
+
+    Landmarks::Adjacency forw, back;
+    for(VertexId id = 0; id < numVertices; id++) {
+        forw.offsets_.push_back(forw.arcs_.size());
+        forw.arcs_.insert(forw.arcs_.end(), forwArcs[id].begin(), forwArcs[id].end());
+        back.offsets_.push_back(back.arcs_.size());
+        back.arcs_.insert(back.arcs_.end(), backArcs[id].begin(), backArcs[id].end());
+    }
+    forw.offsets_.push_back(forw.arcs_.size());
+    back.offsets_.push_back(back.arcs_.size());
+
+    Landmarks landmarks;
+    landmarks.selectLandmarks(forw, numVertices, 4);
+    QVERIFY(landmarks.getNumLandmarks() == 4);
+    for(size_t l = 0; l < 4; l++) {
+        for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+            landmarks.computeDistances(l, metric, false, forw);
+            landmarks.computeDistances(l, metric, true, back);
+        }
+    }
+
+    // the stored distances survive a round trip through the file
+    string path = "test_landmarks.bin";
+    QVERIFY(landmarks.save(path));
+    Landmarks loaded;
+    QVERIFY(!loaded.load(path, numVertices+1));
+    QVERIFY(loaded.load(path, numVertices));
+    QVERIFY(loaded.getLandmarks() == landmarks.getLandmarks());
+
+    for(size_t l = 0; l < loaded.getNumLandmarks(); l++) {
+        VertexId landmark = loaded.getLandmarks()[l];
+        for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+            vector<Dist> from = findDistances(forw, landmark, metric);
+            vector<Dist> to = findDistances(back, landmark, metric);
+            for(VertexId v = 0; v < numVertices; v++) {
+                QVERIFY(loaded.getDistanceFrom(l, v, metric) == from[v]);
+                QVERIFY(loaded.getDistanceTo(l, v, metric) == to[v]);
+            }
+        }
+    }
+
+    // the bounds are at most the distances, towards and from the target
+    for(VertexId t = 0; t < numVertices; t += 7) {
+        Landmarks::Target forwTarget, backTarget;
+        loaded.initTarget<Edge::TimeMetric>({t}, false, forwTarget);
+        loaded.initTarget<Edge::TimeMetric>({t}, true, backTarget);
+        vector<Dist> from = findDistances(forw, t, Edge::TimeMetric::Index);
+        vector<Dist> to = findDistances(back, t, Edge::TimeMetric::Index);
+        for(VertexId v = 0; v < numVertices; v++) {
+            QVERIFY(loaded.lowerBound(v, forwTarget) <= to[v]);
+            QVERIFY(loaded.lowerBound(v, backTarget) <= from[v]);
+        }
+    }
+
+    // the vertex which can't be left doesn't reach anything
+    Landmarks::Target target;
+    loaded.initTarget<Edge::DistanceMetric>({0}, false, target);
+    QVERIFY(loaded.lowerBound(size*size, target) == Landmarks::Unreachable);
+    QVERIFY(loaded.lowerBound(0, target) == 0);
+
+    QVERIFY(loaded.load("missing_landmarks.bin", numVertices) == false);
+    remove(path.c_str());
+}
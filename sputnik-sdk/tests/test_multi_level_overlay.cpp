@@ -0,0 +1,164 @@
+#include <vector>
+#include <random>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/MultiLevelOverlay.h>
+#include "test_multi_level_overlay.h"
+
+using namespace std;
+
+typedef MultiLevelOverlay::Dist Dist;
+typedef MultiLevelOverlay::VertexId VertexId;
+typedef MultiLevelOverlay::EdgeOffset EdgeOffset;
+
+/**
+ * distances from the source to the vertices of its cell by Bellman-Ford
+ */
+static vector<Dist> findDistances(const MultiLevelOverlay &overlay, const vector<EdgeOffset> &offsets,
+                                  const vector<VertexId> &targets, const vector<Dist> &costs,
+                                  size_t level, VertexId source) {
+    size_t numVertices = offsets.size()-1;
+    vector<Dist> dist(numVertices, MultiLevelOverlay::Unreachable);
+    dist[source] = 0;
+    for(size_t round = 0; round < numVertices; round++) {
+        for(size_t v = 0; v < numVertices; v++) {
+            if(dist[v] == MultiLevelOverlay::Unreachable)
+                continue;
+            for(EdgeOffset i = offsets[v]; i < offsets[v+1]; i++) {
+                if(overlay.getCell(level, targets[i]) == overlay.getCell(level, source))
+                    dist[targets[i]] = min(dist[targets[i]], dist[v]+costs[i]);
+            }
+        }
+    }
+    return dist;
+}
+
+void TestMultiLevelOverlay::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    // grid with random one way streets
+    const VertexId size = 12, numVertices = size*size;
+    mt19937 rng(5);
+    vector<Point> points;
+    vector<vector<VertexId> > arcs(numVertices);
+    for(VertexId id = 0; id < numVertices; id++) {
+        VertexId row = id/size, col = id%size;
+        points.push_back(Point(52.5+row*0.001, 13.4+col*0.0015));
+        if(col+1 < size) {
+            if(rng()%4 != 0)
+                arcs[id].push_back(id+1);
+            arcs[id+1].push_back(id);
+        }
+        if(row+1 < size) {
+            arcs[id].push_back(id+size);
+            if(rng()%4 != 0)
+                arcs[id+size].push_back(id);
+        }
+    }
+    vector<EdgeOffset> offsets(1, 0);
+    vector<VertexId> targets;
+    vector<Dist> costs[Edge::NUM_METRICS];
+    for(VertexId id = 0; id < numVertices; id++) {
+        for(VertexId next : arcs[id]) {
+            targets.push_back(next);
+            costs[Edge::DistanceMetric::Index].push_back(10+rng()%90);
+            costs[Edge::TimeMetric::Index].push_back(1+rng()%20);
+        }
+        offsets.push_back(targets.size());
+    }
+
+    // a graph which fits into one cell has no overlay
+    MultiLevelOverlay overlay;
+    overlay.build(points, offsets, targets, numVertices, 1, 3);
+    QVERIFY(overlay.empty());
+
+    // cells of at most 8 vertices, each level halves the number of cells
+    overlay.build(points, offsets, targets, 8, 1, 3);
+    QVERIFY(overlay.getNumLevels() == 3);
+    QVERIFY(overlay.getNumCells(1) == 32 && overlay.getNumCells(3) == 8);
+    for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+        MultiLevelOverlay::Weights weights;
+        weights.arcs_ = costs[metric];
+        overlay.initWeights(weights);
+        for(size_t level = 1; level <= overlay.getNumLevels(); level++) {
+            for(size_t cell = 0; cell < overlay.getNumCells(level); cell++)
+                overlay.customizeCell(level, MultiLevelOverlay::CellId(cell), weights);
+        }
+        overlay.setWeights(metric, weights);
+    }
+
+    for(size_t level = 1; level <= overlay.getNumLevels(); level++) {
+        // vertices with an arc leaving or entering their cell
+        vector<VertexId> boundary;
+        vector<bool> isBoundary(numVertices, false);
+        for(VertexId v = 0; v < numVertices; v++) {
+            for(EdgeOffset i = offsets[v]; i < offsets[v+1]; i++) {
+                if(overlay.getCell(level, v) != overlay.getCell(level, targets[i]))
+                    isBoundary[v] = isBoundary[targets[i]] = true;
+            }
+        }
+        for(VertexId v = 0; v < numVertices; v++) {
+            if(isBoundary[v])
+                boundary.push_back(v);
+        }
+        QVERIFY(overlay.getNumBoundaryVertices(level) == boundary.size());
+
+        // the cliques hold the distances inside of the cells and their
+        // arcs unpack to paths of the same length
+        for(size_t metric = 0; metric < Edge::NUM_METRICS; metric++) {
+            for(VertexId from : boundary) {
+                vector<Dist> dist = findDistances(overlay, offsets, targets, costs[metric], level, from);
+                for(VertexId to : boundary) {
+                    Dist cost = overlay.getCliqueCost(level, from, to, metric);
+                    if(overlay.getCell(level, from) != overlay.getCell(level, to)) {
+                        QVERIFY(cost == MultiLevelOverlay::Unreachable);
+                        continue;
+                    }
+                    QVERIFY(cost == dist[to]);
+                    if(from == to || cost == MultiLevelOverlay::Unreachable)
+                        continue;
+
+                    vector<VertexId> path(1, from);
+                    overlay.unpackArc(level, from, to, metric, path);
+                    QVERIFY(path.back() == to);
+                    Dist length = 0;
+                    for(size_t i = 0; i+1 < path.size(); i++) {
+                        QVERIFY(overlay.getCell(level, path[i+1]) == overlay.getCell(level, from));
+                        Dist arc = MultiLevelOverlay::Unreachable;
+                        for(EdgeOffset j = offsets[path[i]]; j < offsets[path[i]+1]; j++) {
+                            if(targets[j] == path[i+1])
+                                arc = min(arc, costs[metric][j]);
+                        }
+                        QVERIFY(arc != MultiLevelOverlay::Unreachable);
+                        length += arc;
+                    }
+                    QVERIFY(length == cost);
+                }
+            }
+        }
+    }
+
+    // the cells of the ends are searched on the graph, the others on the
+    // highest level whose cell has none of the ends
+    MultiLevelOverlay::Query query;
+    overlay.initQuery({0, numVertices-1}, query);
+    QVERIFY(overlay.getQueryLevel(0, query) == 0);
+    QVERIFY(overlay.getQueryLevel(numVertices-1, query) == 0);
+    for(VertexId v = 0; v < numVertices; v++) {
+        size_t level = overlay.getQueryLevel(v, query);
+        if(level > 0) {
+            QVERIFY(overlay.getCell(level, v) != overlay.getCell(level, 0));
+            QVERIFY(overlay.getCell(level, v) != overlay.getCell(level, numVertices-1));
+        }
+        if(level < overlay.getNumLevels() && overlay.getCell(level+1, v) != overlay.getCell(level+1, 0) &&
+           overlay.getCell(level+1, v) != overlay.getCell(level+1, numVertices-1)) {
+            // the vertex isn't on the boundary of the higher cell
+            bool leaves = false;
+            for(EdgeOffset i = offsets[v]; i < offsets[v+1]; i++)
+                leaves = leaves || overlay.getCell(level+1, targets[i]) != overlay.getCell(level+1, v);
+            QVERIFY(!leaves);
+        }
+    }
+
+    overlay.clear();
+    QVERIFY(overlay.empty());
+}
@@ -0,0 +1,111 @@
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/NestedDissection.h>
+#include "test_nested_dissection.h"
+
+using namespace std;
+
+typedef Vertex::VertexId VertexId;
+
+/**
+ * number of edges added when the vertices are contracted in the order of the ranks
+ */
+static size_t countFill(const vector<set<VertexId> > &graph, const vector<VertexId> &rank) {
+    vector<set<VertexId> > adjacency(graph);
+    vector<VertexId> order(rank.size());
+    for(size_t id = 0; id < rank.size(); id++)
+        order[rank[id]] = id;
+
+    size_t fill = 0;
+    for(VertexId v : order) {
+        vector<VertexId> higher;
+        for(VertexId u : adjacency[v]) {
+            if(rank[u] > rank[v])
+                higher.push_back(u);
+        }
+        for(size_t i = 0; i < higher.size(); i++) {
+            for(size_t j = i+1; j < higher.size(); j++) {
+                if(adjacency[higher[i]].insert(higher[j]).second) {
+                    adjacency[higher[j]].insert(higher[i]);
+                    fill++;
+                }
+            }
+        }
+    }
+    return fill;
+}
+
+void TestNestedDissection::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    // grid with unit spacing
+    const VertexId size = 30;
+    vector<Point> points;
+    vector<set<VertexId> > graph(size*size);
+    for(VertexId row = 0; row < size; row++) {
+        for(VertexId col = 0; col < size; col++) {
+            VertexId id = row*size+col;
+            points.push_back(Point(row, col));
+            if(col+1 < size) {
+                graph[id].insert(id+1);
+                graph[id+1].insert(id);
+            }
+            if(row+1 < size) {
+                graph[id].insert(id+size);
+                graph[id+size].insert(id);
+            }
+        }
+    }
+
+    vector<NestedDissection::EdgeOffset> offsets(1, 0);
+    vector<VertexId> neighbors;
+    for(size_t id = 0; id < graph.size(); id++) {
+        neighbors.insert(neighbors.end(), graph[id].begin(), graph[id].end());
+        offsets.push_back(neighbors.size());
+    }
+
+    vector<VertexId> rank;
+    NestedDissection dissection(points, offsets, neighbors);
+    dissection.computeRanks(rank);
+
+    // the ranks are a permutation
+    QVERIFY(rank.size() == graph.size());
+    vector<VertexId> sorted(rank);
+    sort(sorted.begin(), sorted.end());
+    for(size_t id = 0; id < sorted.size(); id++)
+        QVERIFY(sorted[id] == VertexId(id));
+
+    // the last vertices separate the grid
+    QVERIFY(rank[(size/2-1)*size] >= VertexId(graph.size())-size);
+
+    // contracting row by row adds much more edges
+    vector<VertexId> rowOrder(graph.size());
+    for(size_t id = 0; id < graph.size(); id++)
+        rowOrder[id] = id;
+    QVERIFY(2*countFill(graph, rank) < countFill(graph, rowOrder));
+
+    // the cells three splits deep, vertices of different cells aren't
+    // neighbors and the separators are ranked above them
+    vector<pair<VertexId, VertexId> > cells;
+    dissection.computeRanks(rank, 3, cells);
+    QVERIFY(cells.size() == 8);
+    vector<VertexId> cellOf(graph.size(), Vertex::NullVertexId);
+    for(size_t id = 0; id < graph.size(); id++) {
+        for(size_t cell = 0; cell < cells.size(); cell++) {
+            if(cells[cell].first <= rank[id] && rank[id] < cells[cell].second) {
+                QVERIFY(cellOf[id] == Vertex::NullVertexId);
+                cellOf[id] = cell;
+            }
+        }
+    }
+    for(size_t id = 0; id < graph.size(); id++) {
+        for(VertexId next : graph[id]) {
+            if(cellOf[id] != Vertex::NullVertexId && cellOf[next] != Vertex::NullVertexId)
+                QVERIFY(cellOf[id] == cellOf[next]);
+            else if(cellOf[id] != Vertex::NullVertexId)
+                QVERIFY(rank[next] > rank[id]);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#include <vector>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/PackedRTree.h>
+#include "test_packed_rtree.h"
+
+using namespace std;
+
+void TestPackedRTree::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    unsigned seed = 7;
+    auto random = [&seed]() {
+        seed = seed*1103515245+12345;
+        return double((seed >> 16) & 0x7fff)/0x8000;
+    };
+
+    // points on a small grid, so some of them are at the same distance
+    vector<Point> points;
+    vector<PackedRTree::Box> boxes;
+    for(size_t i = 0; i < 2000; i++) {
+        points.push_back(Point(52+int(random()*200)*0.0005, 13+int(random()*200)*0.0005));
+        boxes.push_back(PackedRTree::Box(points.back()));
+    }
+
+    PackedRTree tree;
+    size_t item = 0;
+    auto pointDistance = [&points](const Point &pt) {
+        return [&points, pt](size_t i) { return manhattanDistance(pt, points[i]); };
+    };
+    QVERIFY(tree.empty());
+    QVERIFY(!tree.findNearest(Point(52, 13), pointDistance(Point(52, 13)), item));
+
+    // the same point as the first of the closest points, inside and outside the area
+    tree.build(boxes);
+    QVERIFY(tree.getNumItems() == points.size());
+    for(size_t i = 0; i < 500; i++) {
+        Point pt(51.9+random()*0.3, 12.9+random()*0.3);
+        QVERIFY(tree.findNearest(pt, pointDistance(pt), item));
+        QVERIFY(item == closestPoint(pt, points));
+    }
+    for(size_t i = 0; i < 20; i++) {
+        QVERIFY(tree.findNearest(points[i], pointDistance(points[i]), item));
+        QVERIFY(manhattanDistance(points[i], points[item]) == 0 && item <= i);
+    }
+
+    // segments between consecutive points, the distance is to the closer end
+    vector<PackedRTree::Box> segments;
+    for(size_t i = 0; i+1 < points.size(); i += 2)
+        segments.push_back(PackedRTree::Box(points[i], points[i+1]));
+    tree.build(segments);
+    for(size_t i = 0; i < 200; i++) {
+        Point pt(52+random()*0.1, 13+random()*0.1);
+        auto endDistance = [&points, &pt](size_t s) {
+            return min(manhattanDistance(pt, points[2*s]), manhattanDistance(pt, points[2*s+1]));
+        };
+        QVERIFY(tree.findNearest(pt, endDistance, item));
+        for(size_t s = 0; s < segments.size(); s++)
+            QVERIFY(endDistance(item) <= endDistance(s));
+    }
+
+    // a single item is the root
+    tree.build({PackedRTree::Box(Point(1, 2))});
+    QVERIFY(tree.findNearest(Point(50, 50), [](size_t) { return 0.0; }, item) && item == 0);
+}
@@ -0,0 +1,46 @@
+#include <cstdint>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/SearchSpace.h>
+#include "test_search_space.h"
+
+using namespace std;
+
+void TestSearchSpace::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    typedef SearchSpace<uint32_t, uint32_t> Space;
+    Space *space = Space::acquire();
+    space->reset(10, true);
+    QVERIFY(!space->wasSeen(3) && !space->wasSettled(3) && !space->hasBound(3));
+
+    space->visit(3, 42, 7);
+    space->settle(3);
+    space->setBound(3, 5);
+    QVERIFY(space->wasSeen(3) && space->getDist(3) == 42 && space->getPrev(3) == 7);
+    QVERIFY(space->wasSettled(3) && space->hasBound(3) && space->getBound(3) == 5);
+    QVERIFY(!space->wasSeen(4));
+
+    // the heap keeps the positions in the space
+    Space::HeapType &heap = space->getHeap();
+    heap.pushHeap(5, 30);
+    heap.pushHeap(6, 20);
+    heap.pushHeap(9, 25);
+    heap.decreaseKey(5, 10);
+    QVERIFY(heap.topHeap().first == 5 && heap.topHeap().second == 10);
+    heap.popHeap();
+    QVERIFY(heap.topHeap().first == 6 && heap.size() == 2);
+
+    // a new search forgets the old one and grows with the graph
+    space->reset(20);
+    QVERIFY(!space->wasSeen(3) && !space->wasSettled(3) && heap.empty());
+    space->visit(15, 1, 3);
+    QVERIFY(space->wasSeen(15) && !space->wasSeen(3));
+
+    // released spaces are reused by the thread
+    Space::release(space);
+    Space *again = Space::acquire();
+    Space *other = Space::acquire();
+    QVERIFY(again == space && other != space);
+    Space::release(other);
+    Space::release(again);
+}
@@ -0,0 +1,62 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/SegmentIndex.h>
+#include "test_segment_index.h"
+
+using namespace std;
+
+void TestSegmentIndex::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    SegmentIndex index;
+    SegmentIndex::Snap snap;
+    QVERIFY(index.empty());
+    QVERIFY(!index.findNearest(Point(0, 0), snap));
+
+    // a line along the equator, the offsets are proportional to the longitudes
+    index.add(1, 2, {Point(0, 0), Point(0, 1), Point(0, 3)});
+    index.build();
+    QVERIFY(index.getNumSegments() == 2);
+    QVERIFY(index.findNearest(Point(0.5, 2), snap));
+    QVERIFY(snap.start_ == 1 && snap.end_ == 2);
+    QVERIFY(snap.point_ == Point(0, 2));
+    QVERIFY(fabs(snap.offset_-2.0/3) < 1e-6);
+    QVERIFY(index.findNearest(Point(0, 0), snap) && snap.offset_ == 0);
+    QVERIFY(index.findNearest(Point(-1, 4), snap) && snap.offset_ == 1 && snap.point_ == Point(0, 3));
+
+    unsigned seed = 7;
+    auto random = [&seed]() {
+        seed = seed*1103515245+12345;
+        return double((seed >> 16) & 0x7fff)/0x8000;
+    };
+
+    // lines of up to four points on a small grid
+    vector<vector<Point> > lines;
+    index.clear();
+    for(size_t i = 0; i < 500; i++) {
+        vector<Point> line;
+        for(size_t j = 0, size = 2+size_t(random()*3); j < size; j++)
+            line.push_back(Point(52+int(random()*200)*0.0005, 13+int(random()*200)*0.0005));
+        lines.push_back(line);
+        index.add(i, i+1, line);
+    }
+    index.build();
+
+    // the same distance as the closest segment of all lines
+    for(size_t i = 0; i < 500; i++) {
+        Point pt(52+llround(random()*1e6)/1e7, 13+llround(random()*1e6)/1e7);
+        QVERIFY(index.findNearest(pt, snap));
+
+        double best = numeric_limits<double>::max();
+        for(const vector<Point> &line : lines) {
+            Point projection;
+            double fraction = 0;
+            closestSegment(pt, line, projection, fraction);
+            best = min(best, planarDistance(pt, projection));
+        }
+        QVERIFY(fabs(planarDistance(pt, snap.point_)-best) < 1e-9);
+        QVERIFY(snap.offset_ >= 0 && snap.offset_ <= 1 && snap.end_ == snap.start_+1);
+    }
+}
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/TourOptimizer.h>
+#include "test_tour_optimizer.h"
+
+using namespace std;
+
+typedef TourOptimizer::Cost Cost;
+typedef TourOptimizer::Matrix Matrix;
+
+/**
+ * length of the tour, with the way back to the first stop for round trips
+ */
+static Cost tourLength(const Matrix &costs, const vector<size_t> &order, bool roundTrip) {
+    Cost length = 0;
+    for(size_t i = 0; i+1 < order.size(); i++)
+        length += costs[order[i]][order[i+1]];
+    if(roundTrip && !order.empty())
+        length += costs[order.back()][order.front()];
+    return length;
+}
+
+/**
+ * the order starts at the first stop and visits every stop once
+ */
+static bool isTour(const vector<size_t> &order, size_t numStops) {
+    vector<size_t> sorted(order);
+    sort(sorted.begin(), sorted.end());
+    for(size_t i = 0; i < sorted.size(); i++) {
+        if(sorted[i] != i)
+            return false;
+    }
+    return sorted.size() == numStops && (order.empty() || order[0] == 0);
+}
+
+void TestTourOptimizer::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    // stops on a circle in shuffled order, the best round trip follows the circle
+    const size_t numStops = 40;
+    vector<size_t> angle(numStops);
+    for(size_t i = 0; i < numStops; i++)
+        angle[i] = (i*17) % numStops;
+    Matrix costs(numStops, vector<Cost>(numStops, 0));
+    for(size_t i = 0; i < numStops; i++) {
+        for(size_t j = 0; j < numStops; j++) {
+            double a = 2*M_PI*angle[i]/numStops, b = 2*M_PI*angle[j]/numStops;
+            costs[i][j] = Cost(lround(1000*hypot(cos(a)-cos(b), sin(a)-sin(b))));
+        }
+    }
+    Cost step = Cost(lround(1000*2*sin(M_PI/numStops)));
+
+    vector<size_t> order;
+    TourOptimizer optimizer(costs);
+    optimizer.setRoundTrip(true);
+    optimizer.setTimeLimit(10);
+    QVERIFY(optimizer.optimize(order));
+    QVERIFY(isTour(order, numStops));
+    QVERIFY(tourLength(costs, order, true) == Cost(numStops)*step);
+
+    // without the way back the open side is the longest step of the circle
+    optimizer.setRoundTrip(false);
+    QVERIFY(optimizer.optimize(order));
+    QVERIFY(isTour(order, numStops));
+    QVERIFY(tourLength(costs, order, false) == Cost(numStops-1)*step);
+
+    // one way streets, going back along the line costs ten times more
+    const size_t numLine = 12;
+    Matrix line(numLine, vector<Cost>(numLine, 0));
+    for(size_t i = 0; i < numLine; i++) {
+        for(size_t j = 0; j < numLine; j++) {
+            size_t pi = (i*5) % numLine, pj = (j*5) % numLine;
+            line[i][j] = pj >= pi ? Cost(pj-pi) : Cost(10*(pi-pj));
+        }
+    }
+    QVERIFY(TourOptimizer(line).optimize(order));
+    QVERIFY(isTour(order, numLine));
+    QVERIFY(tourLength(line, order, false) == Cost(numLine-1));
+
+    // random stops, the order found is as short as the best of all orders
+    unsigned seed = 1;
+    auto random = [&seed]() {
+        seed = seed*1103515245+12345;
+        return double((seed >> 16) & 0x7fff)/0x8000;
+    };
+    for(size_t round = 0; round < 20; round++) {
+        const size_t numRandom = 8;
+        vector<double> lat(numRandom), lon(numRandom);
+        for(size_t i = 0; i < numRandom; i++) {
+            lat[i] = random();
+            lon[i] = random();
+        }
+        Matrix distances(numRandom, vector<Cost>(numRandom));
+        for(size_t i = 0; i < numRandom; i++) {
+            for(size_t j = 0; j < numRandom; j++)
+                distances[i][j] = Cost(lround(1000*hypot(lat[i]-lat[j], lon[i]-lon[j])));
+        }
+
+        bool roundTrip = round % 2 == 0;
+        vector<size_t> all(numRandom);
+        for(size_t i = 0; i < numRandom; i++)
+            all[i] = i;
+        Cost best = tourLength(distances, all, roundTrip);
+        while(next_permutation(all.begin()+1, all.end()))
+            best = min(best, tourLength(distances, all, roundTrip));
+
+        TourOptimizer tour(distances);
+        tour.setRoundTrip(roundTrip);
+        QVERIFY(tour.optimize(order));
+        QVERIFY(isTour(order, numRandom));
+        QVERIFY(tourLength(distances, order, roundTrip) == best);
+    }
+
+    // a stop without paths can't be visited
+    costs[3].assign(numStops, -1);
+    for(size_t i = 0; i < numStops; i++)
+        costs[i][3] = -1;
+    QVERIFY(!TourOptimizer(costs).optimize(order));
+    QVERIFY(isTour(order, numStops));
+
+    // nothing to order
+    QVERIFY(TourOptimizer(Matrix(1, vector<Cost>(1, 0))).optimize(order));
+    QVERIFY(order == vector<size_t>({0}));
+    QVERIFY(TourOptimizer(Matrix()).optimize(order));
+    QVERIFY(order.empty());
+}
@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <vector>
+#include <random>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/GraphCore/Model.h>
+#include "test_grid_map.h"
+#include "test_traffic_update.h"
+
+using namespace std;
+
+typedef Graph<AdjacencyList> RoutingGraph;
+
+void TestTrafficUpdate::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    string path = "test_traffic_update.db";
+    remove(path.c_str());
+    remove((path+".preprocessed").c_str());
+    QVERIFY(writeGridMap(path, 12, 11));
+    {
+        RoutingGraph graph;
+        QVERIFY(graph.parseGraph(path));
+        graph.getModel()->preprocess();
+        graph.unloadGraph();
+    }
+
+    mt19937 rng(3);
+    uniform_real_distribution<double> lat(50, 50.011), lon(10, 10.011);
+    vector<pair<Point, Point> > queries;
+    for(size_t i = 0; i < 150; i++)
+        queries.push_back(make_pair(Point(lat(rng), lon(rng)), Point(lat(rng), lon(rng))));
+
+    // the ways of the grid map are numbered from 1, a third of them is slow
+    vector<pair<Edge::EdgeId, double> > speeds, restore;
+    for(Edge::EdgeId way = 1; way < 250; way++) {
+        if(rng()%3 == 0) {
+            speeds.push_back(make_pair(way, double(2+rng()%10)));
+            restore.push_back(make_pair(way, 0.0));
+        }
+    }
+
+    // the hierarchy and the overlay find the lengths bidirectional Dijkstra
+    // finds with the new times, the distances don't change
+    for(string engine : {"ch", "overlay"}) {
+        RoutingGraph graph;
+        QVERIFY(graph.parseGraph(path, engine));
+        AdjacencyList *model = graph.getModel();
+        // the map fits into one cell of the default size
+        if(engine == "overlay")
+            QVERIFY(model->buildOverlay(16, 1, 3));
+        QVERIFY(engine == "ch" ? model->hasHierarchy() : model->hasOverlay());
+
+        vector<RoutingGraph::DistType> dist, time;
+        for(const pair<Point, Point> &query : queries) {
+            RoutingGraph::SearchResult result;
+            dist.push_back(graph.shortestPathCH<Edge::DistanceMetric>(query.first, query.second, result));
+            time.push_back(graph.shortestPathCH<Edge::TimeMetric>(query.first, query.second, result));
+        }
+
+        QVERIFY(model->updateTraffic(speeds) > 0);
+        size_t slower = 0;
+        for(size_t i = 0; i < queries.size(); i++) {
+            RoutingGraph::SearchResult result;
+            RoutingGraph::DistType expected =
+                graph.shortestPathBidirectionalDijkstra<Edge::TimeMetric>(queries[i].first, queries[i].second, result);
+            QVERIFY(graph.shortestPathCH<Edge::TimeMetric>(queries[i].first, queries[i].second, result) == expected);
+            QVERIFY(graph.shortestPathCH<Edge::DistanceMetric>(queries[i].first, queries[i].second, result) == dist[i]);
+            QVERIFY(expected >= time[i]);
+            slower += expected > time[i];
+        }
+        QVERIFY(slower > queries.size()/4);
+
+        // the loaded times come back
+        model->updateTraffic(restore);
+        for(size_t i = 0; i < queries.size(); i++) {
+            RoutingGraph::SearchResult result;
+            QVERIFY(graph.shortestPathCH<Edge::TimeMetric>(queries[i].first, queries[i].second, result) == time[i]);
+        }
+        graph.unloadGraph();
+    }
+
+    remove(path.c_str());
+    remove((path+".preprocessed").c_str());
+}
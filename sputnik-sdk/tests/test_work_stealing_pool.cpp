@@ -0,0 +1,44 @@
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <UrbanLabs/Sdk/Utils/Logger.h>
+#include <UrbanLabs/Sdk/Concurrent/WorkStealingPool.h>
+#include "test_work_stealing_pool.h"
+
+using namespace std;
+
+void TestWorkStealingPool::test() {
+    INIT_LOGGING(Logger::INFO);
+
+    WorkStealingPool pool(4);
+    QVERIFY(pool.getNumThreads() == 4);
+
+    // every index once, on the threads of the pool
+    vector<int> calls(1000, 0);
+    vector<size_t> workers(calls.size(), WorkStealingPool::NullWorker);
+    pool.parallelFor(calls.size(), [&](size_t i, size_t worker) {
+        calls[i]++;
+        workers[i] = worker;
+    });
+    for(size_t i = 0; i < calls.size(); i++)
+        QVERIFY(calls[i] == 1 && workers[i] < pool.getNumThreads());
+
+    // loops started by the tasks don't block the threads
+    atomic<size_t> inner(0);
+    pool.parallelFor(16, [&](size_t, size_t) {
+        pool.parallelFor(16, [&](size_t, size_t) { inner++; });
+    });
+    QVERIFY(inner == 256);
+
+    pool.parallelFor(0, [&](size_t, size_t) { inner++; });
+    QVERIFY(inner == 256);
+
+    // the queued tasks are done before the pool stops
+    atomic<size_t> submitted(0);
+    {
+        WorkStealingPool single(1);
+        for(size_t i = 0; i < 100; i++)
+            single.submit([&](size_t) { submitted++; });
+    }
+    QVERIFY(submitted == 100);
+}
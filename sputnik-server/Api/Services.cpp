@@ -8,7 +8,7 @@ using namespace std;
 /**
  * @brief Service::Service
  */
-Service::Service() : lock_(), config_(), tileServer_(), workDir_()  {
+Service::Service() : lock_(), config_(), tileServer_(), workDir_(), trafficPool_(1)  {
     ;
 }
 /**
@@ -68,9 +68,10 @@ bool Service::existsGraph(const string &name, const string &type) {
  * @brief Service::addGraph
  * @param name
  * @param type
+ * @param engine how osm graphs are searched, "ch" or "overlay", empty for the default
  * @return
  */
-bool Service::addGraph(const string &name, const string &type) {
+bool Service::addGraph(const string &name, const string &type, const string &engine) {
     Timer timer;
     string realPath;
     if (!findFile(name, realPath)) {
@@ -78,7 +79,7 @@ bool Service::addGraph(const string &name, const string &type) {
     }
     bool ret = false;
     if(type == "osm") {
-        Graph<AdjacencyList>::Initializer init(realPath);
+        Graph<AdjacencyList>::Initializer init(realPath, engine);
         ret = osm_.addObj(name, init);
     }
     else if(type == "gtfs") {
@@ -96,8 +97,11 @@ bool Service::addGraph(const string &name, const string &type) {
  * @return
  */
 bool Service::removeGraph(string &name, const string &type) {
-    if(type == "osm")
+    if(type == "osm") {
+        // waits for the traffic update running on the graph
+        lock_guard<mutex> traffic(trafficLock_);
         return osm_.removeObj(name);
+    }
     else if(type == "gtfs")
         return gtfs_.removeObj(name);
     return false;
@@ -118,6 +122,13 @@ Graph <AdjacencyList> &Service::getOsmGraph(const string &name) {
 Graph <AdjacencyListGTFS> &Service::getGtfsGraph(const string &name) {
     return gtfs_.getObj(name);
 }
+/**
+ * @brief Service::getRoutingPool
+ * @return
+ */
+WorkStealingPool &Service::getRoutingPool() {
+    return routingPool_;
+}
 /**
  * @brief getLoadedOsm
  * @return
@@ -129,6 +140,88 @@ vector<string> Service::getLoadedGraphs(const string &type) {
         return gtfs_.getLoadedObj();
     return {};
 }
+/**
+ * the graph is only read, so the pairs don't take the graph lock. Every
+ * distinct point is snapped once, then every pair is one search on a
+ * thread of the pool
+ * @brief Service::routeBatch
+ * @param mapName
+ * @param metric
+ * @param sources
+ * @param targets
+ * @param visitor
+ * @return
+ */
+bool Service::routeBatch(const string &mapName, size_t metric, const vector<Point> &sources,
+                         const vector<Point> &targets, const RouteVisitor &visitor) {
+    if(sources.empty() || (sources.size() != 1 && sources.size() != targets.size()) || !osm_.existsObj(mapName))
+        return false;
+
+    Timer timer;
+    Osm &graph = osm_.getObj(mapName);
+    AdjacencyList *model = graph.getModel();
+
+    // indices of the pairs into the distinct points
+    vector<Point> points;
+    vector<size_t> src(sources.size()), dst(targets.size());
+    map<pair<Point::CoordType, Point::CoordType>, size_t> pointIndex;
+    auto addPoint = [&](const Point &pt) {
+        auto it = pointIndex.insert({{pt.lat(), pt.lon()}, points.size()});
+        if(it.second)
+            points.push_back(pt);
+        return it.first->second;
+    };
+    for(size_t i = 0; i < sources.size(); i++)
+        src[i] = addPoint(sources[i]);
+    for(size_t i = 0; i < targets.size(); i++)
+        dst[i] = addPoint(targets[i]);
+
+    vector<NearestPointResult> nearest(points.size());
+    vector<int8_t> snapped(points.size(), 0);
+    routingPool_.parallelFor(points.size(), [&](size_t i, size_t) {
+        snapped[i] = model->findNearestPointKdTree(points[i], nearest[i]);
+    });
+
+    routingPool_.parallelFor(targets.size(), [&](size_t i, size_t) {
+        Osm::SearchResult result;
+        size_t s = src[sources.size() == 1 ? 0 : i], d = dst[i];
+        if(snapped[s] && snapped[d]) {
+            AdjacencyList::AlgorithmInit initConfig;
+            model->setInitConfig(nearest[s], nearest[d], initConfig);
+            if(metric == Edge::TimeMetric::Index)
+                graph.shortestPathCH<Edge::TimeMetric>(initConfig, result);
+            else
+                graph.shortestPathCH(initConfig, result);
+        }
+        visitor(i, result);
+    });
+
+    timer.stop();
+    LOGG(Logger::INFO) << "[ROUTE BATCH] " << targets.size() << " pairs, " << points.size()
+                       << " points in " << timer.getElapsedTimeSec() << " sec" << Logger::FLUSH;
+    return true;
+}
+/**
+ * @brief Service::updateTraffic
+ * @param mapName
+ * @param speeds
+ * @return
+ */
+bool Service::updateTraffic(const string &mapName, const vector<pair<Edge::EdgeId, double> > &speeds) {
+    if(!osm_.existsObj(mapName))
+        return false;
+
+    // searches running meanwhile keep the old times. The graph may have
+    // been removed or loaded again before the update runs, then the ids of
+    // the ways don't belong to it anymore
+    AdjacencyList *model = osm_.getObj(mapName).getModel();
+    trafficPool_.enqueue([this, mapName, speeds, model]() {
+        lock_guard<mutex> traffic(trafficLock_);
+        if(osm_.existsObj(mapName) && osm_.getObj(mapName).getModel() == model)
+            model->updateTraffic(speeds);
+    });
+    return true;
+}
 /**
  * @brief Service::findNearestPoint
  * @param mapName
@@ -12,6 +12,7 @@
 #include <UrbanLabs/Sdk/Utils/ObjectPool.h>
 #include <UrbanLabs/Sdk/Config/ConfigManager.h>
 #include <UrbanLabs/Sdk/Concurrent/LongTask.h>
+#include <UrbanLabs/Sdk/Concurrent/WorkStealingPool.h>
 #include <TileServer/TileServer.h>
 
 class Service {
@@ -21,6 +22,9 @@ private:
     typedef TagStorage Objects;
     typedef VertexToPointIndexSql VtoPt;
     typedef OsmGraphCore::NearestPointResult NearestPointResult;
+public:
+    // called with the index of a pair and its path as soon as it is found
+    typedef std::function<void (size_t, const Osm::SearchResult &)> RouteVisitor;
 private:
     std::mutex lock_;
     std::mutex osmLock_;
@@ -28,11 +32,15 @@ private:
     std::mutex objectsLock_;
     std::mutex kdTreeSqlLock_;
     std::mutex addrDecodeLock_;
+    // held while a traffic update runs, a graph isn't removed meanwhile
+    std::mutex trafficLock_;
 private:
     ConfigManager config_;
     FilePathCache fsCache_;
     TileServer tileServer_;
     LongTaskService longTaskService_;
+    // threads answering the routing requests of a batch
+    WorkStealingPool routingPool_;
 
     // object pools
     ObjectPool<Objects, typename Objects::Initializer, typename Objects::Destructor> objects_;
@@ -43,6 +51,9 @@ private:
     ObjectPool<KdTreeSql, typename KdTreeSql::Initializer, typename KdTreeSql::Destructor> kdTreeSql_;
     ObjectPool<AddressDecoder, typename AddressDecoder::Initializer, typename AddressDecoder::Destructor> addrDecode_;
     std::string workDir_;
+    // thread customizing the graphs for the traffic updates, declared after
+    // the graphs so it is stopped before they are destroyed
+    ThreadPool trafficPool_;
 public:
     const static int DEFAULT_SEARCH_RESULT_LIMIT = 10;
     const static int DEFAULT_SEARCH_RESULT_OFFSET = 0;
@@ -62,9 +73,10 @@ public:
      * @brief addGraph
      * @param name
      * @param type
+     * @param engine how osm graphs are searched, "ch" or "overlay", empty for the default
      * @return
      */
-    bool addGraph(const std::string &name, const std::string &type);
+    bool addGraph(const std::string &name, const std::string &type, const std::string &engine = "");
     /**
      * @brief removeGraph
      * @param name
@@ -84,6 +96,12 @@ public:
      * @return
      */
     Graph <AdjacencyListGTFS> &getGtfsGraph(const std::string &name);
+    /**
+     * @brief getRoutingPool
+     * the threads shared by the requests which solve several paths at once
+     * @return
+     */
+    WorkStealingPool &getRoutingPool();
     /**
      * @brief getLoadeGraphs
      * @param type
@@ -145,6 +163,32 @@ public:
      * @return
      */
     bool writeData(const std::string &mapName, const std::string &table, const TagList &tagList);
+    /**
+     * @brief routeBatch
+     * shortest paths from every source to the target with the same index,
+     * a single source is shared by all targets. The pairs are solved in
+     * parallel and passed to the visitor in the order they finish, pairs
+     * without a path get an invalid result
+     * @param mapName
+     * @param metric index of the metric, see Edge::DistanceMetric
+     * @param sources
+     * @param targets
+     * @param visitor called on the threads of the pool, several calls may run at once
+     * @return false if the graph is missing or the number of points is wrong
+     */
+    bool routeBatch(const std::string &mapName, size_t metric, const std::vector<Point> &sources,
+                    const std::vector<Point> &targets, const RouteVisitor &visitor);
+    /**
+     * @brief updateTraffic
+     * sets the speeds of the ways of the graph, the graph is customized
+     * for them in the background and the routes use the new times once it
+     * is done. The updates are applied in the order they come
+     * @param mapName
+     * @param speeds osm way ids with their speeds in km/h, 0 restores the
+     * speed the way was loaded with
+     * @return false if the graph is missing
+     */
+    bool updateTraffic(const std::string &mapName, const std::vector<std::pair<Edge::EdgeId, double> > &speeds);
     /**
      * @brief findNearestPoint
      * @param mapName
@@ -25,6 +25,24 @@ void JsonRouteFormatter::addRoot(const Point &startPoint, const Point &endPoint)
  * @param length
  */
 void JsonRouteFormatter::addRoute(const Point &startPoint, const Point &endPoint, JsonRouteFormatter::Nodes &legs, const Edge::EdgeDist length) {
+    addRoutes(Nodes {getRoute(startPoint, endPoint, legs, length)});
+}
+/**
+ * @brief JsonRouteFormatter::addRoutes
+ * @param routes the routes, the first one is the main route
+ */
+void JsonRouteFormatter::addRoutes(const JsonRouteFormatter::Nodes &routes) {
+    root_.add(Nodes {Node("routes", routes)});
+}
+/**
+ * @brief JsonRouteFormatter::getRoute
+ * @param startPoint
+ * @param endPoint
+ * @param legs
+ * @param length
+ * @return
+ */
+JsonRouteFormatter::Node JsonRouteFormatter::getRoute(const Point &startPoint, const Point &endPoint, JsonRouteFormatter::Nodes &legs, const Edge::EdgeDist length) {
 
     Node startEl("start_location", startPoint);
     Node endEl("end_location", endPoint);
@@ -37,7 +55,7 @@ void JsonRouteFormatter::addRoute(const Point &startPoint, const Point &endPoint
     Node legsEl("legs", legs);
     Node routeEl("");
     routeEl.add(Nodes {distance, duration, startEl, endEl, legsEl});
-    root_.add(Nodes {Node("routes", Nodes{routeEl})});
+    return routeEl;
 }
 /**
  * @brief JsonRouteFormatter::getLeg
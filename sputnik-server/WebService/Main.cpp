@@ -2,6 +2,8 @@
 #include <WebService/Main.h>
 #include <UrbanLabs/Sdk/SqlModels/Tag.h>
 #include <UrbanLabs/Sdk/Output/JsonRouteFormatter.h>
+#include <UrbanLabs/Sdk/GraphCore/Isochrone.h>
+#include <UrbanLabs/Sdk/GraphCore/TourOptimizer.h>
 #include <UrbanLabs/Sdk/Network/HttpClient.h>
 #include <UrbanLabs/Sdk/OSM/TagFilter.h>
 #include <UrbanLabs/Sdk/Utils/MathUtils.h>
@@ -22,6 +24,10 @@ std::map<std::string, std::string> GeoRouting::ERRORS = {
     // invalid parameters
     {"NO_WAY_PTS","Parameter 'waypoints' was not specified"},
     {"NOT_ENOUGH_WPTS", "Not enough waypoints were specified (<2)"},
+    {"NO_MATRIX_PTS", "Parameters 'sources' and 'targets' were not specified"},
+    {"BATCH_PAIRS", "Parameter 'sources' needs a single point or as many points as 'targets'"},
+    {"NO_LIMITS", "Parameter 'limits' was not specified"},
+    {"NO_SPEEDS", "Parameter 'speeds' needs pairs of a way id and a speed"},
     {"MISS_LONLAT","Missing latitude/longitude"},
     {"TOO_MUCH_LONLAT", "Too many latitude/longitude parameters"},
     {"INVALID_COORD", "Invalid coordinate value: "},
@@ -46,6 +52,9 @@ std::map<std::string, std::string> GeoRouting::ERRORS = {
     {"FAILED_LOAD_GRAPH", "Cannot load graph"},
     {"FAILED_UNLOAD_GRAPH", "Cannot unload graph"},
     {"FAILED_NEAREST_NEIGHBOR", "Cannot find nearest neighbor for all points"},
+    {"FAILED_MATRIX", "Cannot snap all points to the graph"},
+    {"FAILED_OPTIMIZE", "Cannot find a route through all points"},
+    {"FAILED_ISOCHRONE", "Cannot snap the point to the graph"},
     {"FAILED_GET_TAGS", "Cannot get tags for objects"},
     {"FAILED_MATCH_TAG", "Cannot match a tag"},
     {"FAILED_FIND_MAP", "Cannot find map file"},
@@ -85,6 +94,8 @@ GeoRouting::GeoRouting(int port, const string &workDir) : server_(port,"0.0.0.0"
     TRAVEL_MODE = "travelmode";
     METRIC = "metric";
     ALTERNATIVE = "altern";
+    SOURCES = "sources";
+    TARGETS = "targets";
 
     CTYPE_JSON = "application/json; charset=UTF-8";
 
@@ -111,7 +122,12 @@ void GeoRouting::Init() {
     dispatcher_.AddMapping("/graph/load", HttpGet,HTTP_HANDLER(this,&GeoRouting::loadGraph),true);
     dispatcher_.AddMapping("/graph/unload", HttpGet,HTTP_HANDLER(this,&GeoRouting::unloadGraph),true);
     dispatcher_.AddMapping("/graph/list", HttpGet,HTTP_HANDLER(this,&GeoRouting::getLoadedGraphs),true);
+    dispatcher_.AddMapping("/graph/route/batch", HttpGet, HTTP_HANDLER(this,&GeoRouting::routeBatch),true);
     dispatcher_.AddMapping("/graph/route", HttpGet, HTTP_HANDLER(this,&GeoRouting::route),true);
+    dispatcher_.AddMapping("/graph/matrix", HttpGet, HTTP_HANDLER(this,&GeoRouting::matrix),true);
+    dispatcher_.AddMapping("/graph/optimize", HttpGet, HTTP_HANDLER(this,&GeoRouting::optimize),true);
+    dispatcher_.AddMapping("/graph/isochrone", HttpGet, HTTP_HANDLER(this,&GeoRouting::isochrone),true);
+    dispatcher_.AddMapping("/graph/traffic", HttpGet, HTTP_HANDLER(this,&GeoRouting::traffic),true);
     dispatcher_.AddMapping("/graph/nearest", HttpGet, HTTP_HANDLER(this,&GeoRouting::nearestNeighbor),true);
     // Search
     dispatcher_.AddMapping("/search/query", HttpGet,HTTP_HANDLER(this,&GeoRouting::search),true);
@@ -220,6 +236,27 @@ bool GeoRouting::validate(const HttpServerContext *context, vector<Point> &wayPo
         return false;
     }
 
+    if(!parsePoints(request[WAYPOINTS], wayPoints, error))
+        return false;
+
+    if(wayPoints.size() > 150) {
+        error = "TOO_MANY_PTS";
+        return false;
+    }
+
+    metric = getMetric(request);
+    mode = getTravelMode(request);
+    return true;
+}
+/**
+ * @brief GeoRouting::parsePoints
+ * @param value points separated by '|', each given as lat,lon
+ * @param points
+ * @param error
+ * @return
+ */
+bool GeoRouting::parsePoints(const string &value, vector<Point> &points, string &error) const {
+    SimpleTokenator tokenator(value, '|', '\"', true);
     vector<string> tokens = tokenator.getTokens();
     for(int i = 0; i < tokens.size(); i++) {
         string lonLatString = tokens[i];
@@ -235,19 +272,14 @@ bool GeoRouting::validate(const HttpServerContext *context, vector<Point> &wayPo
 
         VertexPoint::CoordType lat = lexical_cast<VertexPoint::CoordType>(lonLatTokenizer.nextToken()),
                                lon = lexical_cast<VertexPoint::CoordType>(lonLatTokenizer.nextToken());
-        wayPoints.push_back(Point(lat, lon));
-    }
-
-    if(wayPoints.size() > 150) {
-        error = "TOO_MANY_PTS";
-        return false;
+        points.push_back(Point(lat, lon));
     }
-
-    metric = getMetric(request);
-    mode = getTravelMode(request);
     return true;
 }
 /**
+ * every waypoint is snapped once, then the legs are solved in parallel on
+ * the routing pool, a leg with an endpoint which can't be snapped keeps an
+ * invalid result
  * @brief GeoRouting::runShortestPath
  * @param modeIndex
  * @param wayPoints
@@ -261,22 +293,86 @@ void GeoRouting::runShortestPath(G &g, const GeoRouting::Metric &metric, vector<
     Timer timer;
     timer.start();
 
-    size_t wayPointsSize = wayPoints.size();
-    for(size_t i = 0, j = 1; j < wayPointsSize; i++, j++) {
+    // maps with a hierarchy or an overlay use their query, the others the
+    // landmarks if they have them
+    bool useLandmarks = !g.getModel()->hasHierarchy() && !g.getModel()->hasOverlay() &&
+                        !g.getModel()->getLandmarks().empty();
+    WorkStealingPool &pool = service_.getRoutingPool();
+
+    // interior waypoints end one leg and start the next
+    vector<typename G::NearestPointResult> nearest(wayPoints.size());
+    vector<int8_t> snapped(wayPoints.size(), 0);
+    pool.parallelFor(wayPoints.size(), [&](size_t i, size_t) {
+        snapped[i] = g.getModel()->findNearestPointKdTree(wayPoints[i], nearest[i]);
+    });
+
+    if (metric == Metric::DISTANCE)
+        LOGG(Logger::INFO) << "[DISTANCE METRIC]" << Logger::FLUSH;
+    else
+        LOGG(Logger::INFO) << "[TIME METRIC]" << Logger::FLUSH;
+
+    size_t numLegs = wayPoints.size() > 1 ? wayPoints.size()-1 : 0;
+    pool.parallelFor(numLegs, [&](size_t i, size_t) {
+        if(!snapped[i] || !snapped[i+1])
+            return;
+
+        typename G::DijkstraInit initConfig;
+        g.getModel()->setInitConfig(nearest[i], nearest[i+1], initConfig);
         if (metric == Metric::DISTANCE) {
-            LOGG(Logger::INFO) << "[DISTANCE METRIC]" << Logger::FLUSH;
-            g.shortestPathBidirectionalDijkstra(wayPoints[i], wayPoints[j], searchResults[i]);
+            if(useLandmarks)
+                g.shortestPathBidirectionalAStar(initConfig, searchResults[i]);
+            else
+                g.shortestPathCH(initConfig, searchResults[i]);
         } else {
-            LOGG(Logger::INFO) << "[TIME METRIC]" << Logger::FLUSH;
-            g.template shortestPathBidirectionalDijkstra<typename Edge::TimeMetric>(wayPoints[i], wayPoints[j], searchResults[i]);
+            if(useLandmarks)
+                g.template shortestPathBidirectionalAStar<typename Edge::TimeMetric>(initConfig, searchResults[i]);
+            else
+                g.template shortestPathCH<typename Edge::TimeMetric>(initConfig, searchResults[i]);
         }
-    }
+    });
 
     // get elapsed time
     timer.stop();
     LOGG(Logger::INFO) << "[SPT TIME]: " << timer.getElapsedTimeSec() << " sec" << Logger::FLUSH;
 }
 
+/**
+ * the shortest path between two waypoints followed by the alternatives to it,
+ * every path is a route with a single leg
+ * @brief GeoRouting::runAlternatives
+ * @param metric
+ * @param wayPoints
+ * @param maxAlternatives
+ * @param routes
+ */
+template<typename G>
+void GeoRouting::runAlternatives(G &g, const GeoRouting::Metric &metric, vector<Point> &wayPoints,
+                                 size_t maxAlternatives, vector<vector<typename G::SearchResult> > &routes) {
+    // start the timer
+    Timer timer;
+    timer.start();
+
+    vector<typename G::SearchResult> paths;
+    if (metric == Metric::DISTANCE) {
+        LOGG(Logger::INFO) << "[DISTANCE METRIC]" << Logger::FLUSH;
+        g.shortestPathAlternatives(wayPoints[0], wayPoints[1], maxAlternatives, paths);
+    } else {
+        LOGG(Logger::INFO) << "[TIME METRIC]" << Logger::FLUSH;
+        g.template shortestPathAlternatives<typename Edge::TimeMetric>(wayPoints[0], wayPoints[1], maxAlternatives, paths);
+    }
+
+    // an invalid result is reported as a missing path
+    if(paths.empty())
+        paths.push_back(typename G::SearchResult());
+
+    routes.clear();
+    for(const typename G::SearchResult &path : paths)
+        routes.push_back({path});
+
+    // get elapsed time
+    timer.stop();
+    LOGG(Logger::INFO) << "[SPT TIME]: " << timer.getElapsedTimeSec() << " sec" << Logger::FLUSH;
+}
 /**
  * @brief GeoRouting::runShortestPathPublic
  * @param modeIndex
@@ -294,7 +390,11 @@ void GeoRouting::runShortestPathPublic(G &g, const GeoRouting::Metric &metric, v
     for(size_t i = 0, j = 1; j < wayPointsSize; i++, j++) {
         if (metric == Metric::DISTANCE) {
             LOGG(Logger::INFO) << "[DISTANCE METRIC]" << Logger::FLUSH;
-            g.shortestPathDijkstra(wayPoints[i], wayPoints[j], searchResults[i]);
+            // A* is only faster than dijkstra when it has landmarks
+            if(g.getModel()->getLandmarks().empty())
+                g.shortestPathDijkstra(wayPoints[i], wayPoints[j], searchResults[i]);
+            else
+                g.template shortestPathAStar<EdgeGTFS::DistanceMetric>(wayPoints[i], wayPoints[j], searchResults[i]);
         }
     }
 
@@ -313,6 +413,19 @@ template<typename G>
 void GeoRouting::outputResults(G &graph, const vector<Point> &wayPoints,
                                const vector<typename G::SearchResult> &searchResults,
                                HttpServerContext *context) {
+    outputResults(graph, wayPoints, vector<vector<typename G::SearchResult> >(1, searchResults), context);
+}
+/**
+ * @brief GeoRouting::outputResults
+ * @param wayPoints
+ * @param routes the legs of every route, the first route is the main one
+ * @param context
+ * @param attributes added to the response next to the routes
+ */
+template<typename G>
+void GeoRouting::outputResults(G &graph, const vector<Point> &wayPoints,
+                               const vector<vector<typename G::SearchResult> > &routes,
+                               HttpServerContext *context, const JSONFormatterNode::Nodes &attributes) {
 
     // start the timer
     Timer timer;
@@ -322,27 +435,47 @@ void GeoRouting::outputResults(G &graph, const vector<Point> &wayPoints,
     if(wayPoints.size() > 0) {
         fmt.addRoot(wayPoints[0], wayPoints[wayPoints.size()-1]);
 
-        // accumulate legs for a route
-        JsonRouteFormatter::Nodes legs;
+        // every leg of every route, the geometries are found in parallel
+        vector<const typename G::SearchResult *> paths;
+        for(const vector<typename G::SearchResult> &searchResults : routes) {
+            for(const typename G::SearchResult &currPath : searchResults) {
+                if (!currPath.isValid()) {
+                    VertexPoint src = currPath.getSrc().getTarget(), dst = currPath.getDst().getTarget();
+                    stringstream msg;
+                    msg << src.getPoint() << "|" << dst.getPoint() << endl;
+                    respondError(context, ERRORS["PATH_NOT_FND"]+msg.str());
+                    return;
+                }
+                paths.push_back(&currPath);
+            }
+        }
 
-        // compute path geometries
-        for(const typename G::SearchResult &currPath : searchResults) {
-            VertexPoint src = currPath.getSrc().getTarget(), dst = currPath.getDst().getTarget();
-            if (!currPath.isValid()) {
-                stringstream msg;
-                msg << src.getPoint() << "|" << dst.getPoint() << endl;
-                respondError(context, ERRORS["PATH_NOT_FND"]+msg.str());
-                return;
+        vector<vector<vector<Point> > > pathLines(paths.size());
+        service_.getRoutingPool().parallelFor(paths.size(), [&](size_t i, size_t) {
+            graph.findMultiLinesFromPath(paths[i]->getSrc(), paths[i]->getDst(), paths[i]->getPath(), pathLines[i]);
+        });
+
+        JsonRouteFormatter::Nodes routeNodes;
+        size_t pathIndex = 0;
+        for(const vector<typename G::SearchResult> &searchResults : routes) {
+            // accumulate legs for a route
+            JsonRouteFormatter::Nodes legs;
+            Edge::EdgeDist length = 0;
+
+            for(const typename G::SearchResult &currPath : searchResults) {
+                VertexPoint src = currPath.getSrc().getTarget(), dst = currPath.getDst().getTarget();
+                const vector<vector<Point> > &multiLines = pathLines[pathIndex++];
+
+                legs.push_back(fmt.getLeg(multiLines, currPath.getOrigWayIds(), src.getPoint(), dst.getPoint(),
+                                          currPath.getLength(), currPath.getLength()));
+                length += currPath.getLength();
             }
-            vector<vector<Point> > multiLines;
-            graph.findMultiLinesFromPath(currPath.getSrc(), currPath.getDst(),
-                                         currPath.getPath(), multiLines);
 
-            legs.push_back(fmt.getLeg(multiLines, currPath.getOrigWayIds(), src.getPoint(), dst.getPoint(),
-                                      currPath.getLength(), currPath.getLength()));
+            routeNodes.push_back(fmt.getRoute(wayPoints[0], wayPoints[wayPoints.size()-1], legs, length));
         }
-
-        fmt.addRoute(wayPoints[0], wayPoints[wayPoints.size()-1], legs, 0);
+        fmt.addRoutes(routeNodes);
+        if(!attributes.empty())
+            fmt.root_.add(attributes);
 
         // time elapsed
         timer.stop();
@@ -996,8 +1129,10 @@ void GeoRouting::loadGraph(HttpServerContext *context) {
     if(findKeys(context, {"mapname", "maptype"})) {
         string mapType = getAttribute<string>(context, "maptype");
         string mapName = getAttribute<string>(context, "mapname");
+        // the engine is optional, osm maps use the hierarchy by default
+        string engine = findKeys(context, {"engine"}) ? getAttribute<string>(context, "engine") : "";
 
-        if(service_.addGraph(mapName, mapType)) {
+        if(service_.addGraph(mapName, mapType, engine)) {
             respondSuccess(context);
         } else {
             respondError(context, ERRORS["FAILED_LOAD_GRAPH"]);
@@ -1226,9 +1361,22 @@ void GeoRouting::route(HttpServerContext* context) {
     string mapType = getAttribute<string>(context, "maptype");
     string mapName = getAttribute<string>(context, "mapname");
 
+    // number of alternatives, only computed between two waypoints
+    size_t alternatives = 0;
+    string altern = getAttribute<string>(context, ALTERNATIVE);
+    if(altern == "true") {
+        alternatives = 2;
+    } else if(!altern.empty() && all_of(altern.begin(), altern.end(), ::isdigit)) {
+        alternatives = min<size_t>(3, lexical_cast<size_t>(altern));
+    }
+
     // run algorithms
     if(mapType == "osm") {
-        if(service_.existsGraph(mapName, mapType)) {
+        if(service_.existsGraph(mapName, mapType) && alternatives > 0 && wayPoints.size() == 2) {
+            vector<vector<OsmSearchResult> > routes;
+            runAlternatives(service_.getOsmGraph(mapName), metric, wayPoints, alternatives, routes);
+            outputResults(service_.getOsmGraph(mapName), wayPoints, routes, context);
+        } else if(service_.existsGraph(mapName, mapType)) {
             vector<OsmSearchResult> searchResults(wayPoints.size()-1, OsmSearchResult());
             runShortestPath(service_.getOsmGraph(mapName), metric, wayPoints, searchResults);
             outputResults(service_.getOsmGraph(mapName), wayPoints, searchResults, context);
@@ -1247,6 +1395,354 @@ void GeoRouting::route(HttpServerContext* context) {
         respondError(context, ERRORS["NO_MAP_TYPE"]);
     }
 }
+/**
+ * shortest paths from every source to the target with the same index, a
+ * single source is shared by all targets. Each route is formatted as soon
+ * as it is found, with the index of its pair and a length of -1 if there is
+ * no path, the response is sent once all of them are done. The geometry of
+ * the routes is added if it is requested
+ * @brief GeoRouting::routeBatch
+ * @param context
+ */
+void GeoRouting::routeBatch(HttpServerContext* context) {
+    if(!findKeys(context, {SOURCES, TARGETS})) {
+        respondError(context, ERRORS["NO_MATRIX_PTS"]);
+        return;
+    }
+
+    string error;
+    vector<Point> sources, targets;
+    map<string,string> request = getAllAttributes(context);
+    if(!parsePoints(request[SOURCES], sources, error) || !parsePoints(request[TARGETS], targets, error)) {
+        respondError(context, ERRORS[error]);
+        return;
+    }
+    if(sources.size() == 0 || targets.size() == 0) {
+        respondError(context, ERRORS["NO_MATRIX_PTS"]);
+        return;
+    }
+    if(sources.size() != 1 && sources.size() != targets.size()) {
+        respondError(context, ERRORS["BATCH_PAIRS"]);
+        return;
+    }
+    if(targets.size() > 10000) {
+        respondError(context, ERRORS["TOO_MANY_PTS"]);
+        return;
+    }
+
+    string mapType = getAttribute<string>(context, "maptype");
+    string mapName = getAttribute<string>(context, "mapname");
+    if(mapType != "osm") {
+        respondError(context, ERRORS["NO_MAP_TYPE"]);
+        return;
+    }
+    if(!service_.existsGraph(mapName, mapType)) {
+        respondError(context, ERRORS["GRAPH_MISSING"]);
+        return;
+    }
+
+    // without a hierarchy every pair is searched on its own
+    Graph<AdjacencyList> &graph = service_.getOsmGraph(mapName);
+    if(!graph.getModel()->hasHierarchy() && targets.size() > 2500) {
+        respondError(context, ERRORS["TOO_MANY_PTS"]);
+        return;
+    }
+
+    // the routes are formatted on the threads finding them
+    mutex outputLock;
+    bool first = true;
+    stringstream routes;
+    bool geometry = getAttribute<string>(context, "geometry") == "true";
+    size_t metric = getMetric(request) == Metric::TIME ? size_t(Edge::TimeMetric::Index) : size_t(Edge::DistanceMetric::Index);
+    bool found = service_.routeBatch(mapName, metric, sources, targets, [&](size_t i, const Graph<AdjacencyList>::SearchResult &result) {
+        JSONFormatterNode node("");
+        Edge::EdgeDist length = result.isValid() ? result.getLength() : -1;
+        JSONFormatterNode::Nodes attrs = {JSONFormatterNode::Node("index", i), JSONFormatterNode::Node("length", length)};
+        if(geometry && result.isValid()) {
+            vector<Point> points;
+            vector<vector<Point> > multiLines;
+            graph.findMultiLinesFromPath(result.getSrc(), result.getDst(), result.getPath(), multiLines);
+            for(const vector<Point> &line : multiLines)
+                points.insert(points.end(), line.begin(), line.end());
+            attrs.push_back(JSONFormatterNode::Node("geometry", points));
+        }
+        node.add(attrs);
+
+        lock_guard<mutex> lock(outputLock);
+        if(!first)
+            routes << ",";
+        routes << node;
+        first = false;
+    });
+    // the graph may have been removed meanwhile
+    if(!found) {
+        respondError(context, ERRORS["GRAPH_MISSING"]);
+        return;
+    }
+
+    context->responseHeader.contentType = CTYPE_JSON;
+    context->responseBody << "{" << successAttr() << "," << ver() << ",\"response\":{\"routes\":["
+                          << routes.str() << "]}}";
+}
+/**
+ * lengths of the shortest paths between all sources and all targets,
+ * -1 if there is no path
+ * @brief GeoRouting::matrix
+ * @param context
+ */
+void GeoRouting::matrix(HttpServerContext* context) {
+    if(!findKeys(context, {SOURCES, TARGETS})) {
+        respondError(context, ERRORS["NO_MATRIX_PTS"]);
+        return;
+    }
+
+    string error;
+    vector<Point> sources, targets;
+    map<string,string> request = getAllAttributes(context);
+    if(!parsePoints(request[SOURCES], sources, error) || !parsePoints(request[TARGETS], targets, error)) {
+        respondError(context, ERRORS[error]);
+        return;
+    }
+    if(sources.size() == 0 || targets.size() == 0) {
+        respondError(context, ERRORS["NO_MATRIX_PTS"]);
+        return;
+    }
+    if(sources.size() > 1000 || targets.size() > 1000) {
+        respondError(context, ERRORS["TOO_MANY_PTS"]);
+        return;
+    }
+
+    string mapType = getAttribute<string>(context, "maptype");
+    string mapName = getAttribute<string>(context, "mapname");
+    if(mapType != "osm") {
+        respondError(context, ERRORS["NO_MAP_TYPE"]);
+        return;
+    }
+    if(!service_.existsGraph(mapName, mapType)) {
+        respondError(context, ERRORS["GRAPH_MISSING"]);
+        return;
+    }
+
+    // without a hierarchy every pair is searched on its own
+    Graph<AdjacencyList> &graph = service_.getOsmGraph(mapName);
+    if(!graph.getModel()->hasHierarchy() && sources.size()*targets.size() > 2500) {
+        respondError(context, ERRORS["TOO_MANY_PTS"]);
+        return;
+    }
+
+    bool found = false;
+    vector<vector<Edge::EdgeDist> > lengths;
+    if(getMetric(request) == Metric::DISTANCE) {
+        found = graph.distanceMatrix(sources, targets, lengths);
+    } else {
+        found = graph.distanceMatrix<Edge::TimeMetric>(sources, targets, lengths);
+    }
+    if(!found) {
+        respondError(context, ERRORS["FAILED_MATRIX"]);
+        return;
+    }
+
+    JSONFormatterNode node("response");
+    node.add({JSONFormatterNode::Node("sources", sources),
+              JSONFormatterNode::Node("targets", targets),
+              JSONFormatterNode::Node("lengths", lengths)});
+    JSONFormatterNode root("");
+    root.add(JSONFormatterNode::Nodes({successAttr(), ver(), node}));
+
+    respondContent(context, {}, CTYPE_JSON, root);
+}
+/**
+ * orders the waypoints so the route through them is short, the first
+ * waypoint stays the start. The route returns to it if a round trip is
+ * requested. The order is found on the matrix of the lengths between the
+ * waypoints, the route through the ordered waypoints is returned like any
+ * other route together with the order
+ * @brief GeoRouting::optimize
+ * @param context
+ */
+void GeoRouting::optimize(HttpServerContext* context) {
+    typedef Graph<AdjacencyList>::SearchResult OsmSearchResult;
+
+    string error;
+    vector<Point> wayPoints;
+    GeoRouting::TravelMode mode;
+    GeoRouting::Metric metric;
+    if(!validate(context, wayPoints, mode, metric, error)) {
+        respondError(context, ERRORS[error]);
+        return;
+    }
+    if(wayPoints.size() > 100) {
+        respondError(context, ERRORS["TOO_MANY_PTS"]);
+        return;
+    }
+
+    string mapType = getAttribute<string>(context, "maptype");
+    string mapName = getAttribute<string>(context, "mapname");
+    if(mapType != "osm") {
+        respondError(context, ERRORS["NO_MAP_TYPE"]);
+        return;
+    }
+    if(!service_.existsGraph(mapName, mapType)) {
+        respondError(context, ERRORS["GRAPH_MISSING"]);
+        return;
+    }
+
+    // without a hierarchy every pair is searched on its own
+    Graph<AdjacencyList> &graph = service_.getOsmGraph(mapName);
+    if(!graph.getModel()->hasHierarchy() && wayPoints.size()*wayPoints.size() > 2500) {
+        respondError(context, ERRORS["TOO_MANY_PTS"]);
+        return;
+    }
+
+    bool found = false;
+    vector<vector<Edge::EdgeDist> > lengths;
+    if(metric == Metric::DISTANCE) {
+        found = graph.distanceMatrix(wayPoints, wayPoints, lengths);
+    } else {
+        found = graph.distanceMatrix<Edge::TimeMetric>(wayPoints, wayPoints, lengths);
+    }
+    if(!found) {
+        respondError(context, ERRORS["FAILED_MATRIX"]);
+        return;
+    }
+
+    vector<size_t> order;
+    bool roundTrip = getAttribute<string>(context, "roundtrip") == "true";
+    TourOptimizer optimizer(lengths);
+    optimizer.setRoundTrip(roundTrip);
+    if(!optimizer.optimize(order)) {
+        respondError(context, ERRORS["FAILED_OPTIMIZE"]);
+        return;
+    }
+
+    vector<Point> ordered;
+    for(size_t i : order)
+        ordered.push_back(wayPoints[i]);
+    if(roundTrip)
+        ordered.push_back(wayPoints[0]);
+
+    vector<OsmSearchResult> searchResults(ordered.size()-1, OsmSearchResult());
+    runShortestPath(graph, metric, ordered, searchResults);
+    outputResults(graph, ordered, vector<vector<OsmSearchResult> >(1, searchResults), context,
+                  {JSONFormatterNode::Node("order", order)});
+}
+/**
+ * areas reachable from a point within each of the limits, given as
+ * polygons or as the reachable vertices. The limits are in seconds unless
+ * the distance metric is requested
+ * @brief GeoRouting::isochrone
+ * @param context
+ */
+void GeoRouting::isochrone(HttpServerContext* context) {
+    if(!findKeys(context, {"lat", "lon", "mapname", "maptype"})) {
+        respondError(context, ERRORS["NOT_ENOUGH_ARGS"]);
+        return;
+    }
+
+    vector<Edge::EdgeDist> limits = getAttributes<Edge::EdgeDist>(context, "limits");
+    if(limits.size() == 0) {
+        respondError(context, ERRORS["NO_LIMITS"]);
+        return;
+    }
+
+    string mapType = getAttribute<string>(context, "maptype");
+    string mapName = getAttribute<string>(context, "mapname");
+    if(mapType != "osm") {
+        respondError(context, ERRORS["NO_MAP_TYPE"]);
+        return;
+    }
+    if(!service_.existsGraph(mapName, mapType)) {
+        respondError(context, ERRORS["GRAPH_MISSING"]);
+        return;
+    }
+
+    Point center(getAttribute<VertexPoint::CoordType>(context, "lat"),
+                 getAttribute<VertexPoint::CoordType>(context, "lon"));
+
+    bool found = false;
+    vector<Edge::EdgeDist> dist;
+    Graph<AdjacencyList> &graph = service_.getOsmGraph(mapName);
+    if(findKey(context, METRIC) && getMetric(getAllAttributes(context)) == Metric::DISTANCE) {
+        found = graph.shortestPathsOneToAll(center, dist);
+    } else {
+        found = graph.shortestPathsOneToAll<Edge::TimeMetric>(center, dist);
+    }
+    if(!found) {
+        respondError(context, ERRORS["FAILED_ISOCHRONE"]);
+        return;
+    }
+
+    bool vertices = getAttribute<string>(context, "output") == "vertices";
+    JSONFormatterNode::Nodes isochrones;
+    for(Edge::EdgeDist limit : limits) {
+        vector<Point> points;
+        vector<Vertex::VertexId> ids;
+        for(size_t id = 0; id < dist.size(); id++) {
+            if(dist[id] != -1 && dist[id] <= limit) {
+                ids.push_back(graph.getModel()->getInputId(id));
+                points.push_back(graph.getModel()->getPoint(Vertex(id)));
+            }
+        }
+
+        JSONFormatterNode node("");
+        if(vertices) {
+            node.add({JSONFormatterNode::Node("limit", limit), JSONFormatterNode::Node("vertices", ids)});
+        } else {
+            vector<Point> polygon;
+            Isochrone(center).findPolygon(points, polygon);
+            node.add({JSONFormatterNode::Node("limit", limit), JSONFormatterNode::Node("polygon", polygon)});
+        }
+        isochrones.push_back(node);
+    }
+
+    JSONFormatterNode node("response", isochrones);
+    JSONFormatterNode root("");
+    root.add(JSONFormatterNode::Nodes({successAttr(), ver(), node}));
+
+    respondContent(context, {}, CTYPE_JSON, root);
+}
+/**
+ * sets the speeds of ways from live traffic, the speeds are pairs of an osm
+ * way id and its speed in km/h. The graph is customized for the speeds in
+ * the background, routes get the new times once it is done. A speed of 0
+ * restores the speed the way was loaded with
+ * @brief GeoRouting::traffic
+ * @param context
+ */
+void GeoRouting::traffic(HttpServerContext* context) {
+    if(!findKeys(context, {"speeds", "mapname", "maptype"})) {
+        respondError(context, ERRORS["NOT_ENOUGH_ARGS"]);
+        return;
+    }
+
+    vector<string> tokens = getAttributes<string>(context, "speeds");
+    if(tokens.size() == 0 || tokens.size() % 2 != 0) {
+        respondError(context, ERRORS["NO_SPEEDS"]);
+        return;
+    }
+
+    string mapType = getAttribute<string>(context, "maptype");
+    string mapName = getAttribute<string>(context, "mapname");
+    if(mapType != "osm") {
+        respondError(context, ERRORS["NO_MAP_TYPE"]);
+        return;
+    }
+
+    vector<pair<Edge::EdgeId, double> > speeds;
+    for(size_t i = 0; i+1 < tokens.size(); i += 2)
+        speeds.push_back({lexical_cast<Edge::EdgeId>(tokens[i]), lexical_cast<double>(tokens[i+1])});
+    if(!service_.updateTraffic(mapName, speeds)) {
+        respondError(context, ERRORS["GRAPH_MISSING"]);
+        return;
+    }
+
+    JSONFormatterNode node("response");
+    node.add({JSONFormatterNode::Node("updates", (int)speeds.size())});
+    JSONFormatterNode root("");
+    root.add(JSONFormatterNode::Nodes({successAttr(), ver(), node}));
+
+    respondContent(context, {}, CTYPE_JSON, root);
+}
 /**
  * @brief GeoRouting::serveFile
  * @param context
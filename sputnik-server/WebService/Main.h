@@ -33,6 +33,8 @@ private:
     std::string TRAVEL_MODE;
     std::string METRIC;
     std::string ALTERNATIVE;
+    std::string SOURCES;
+    std::string TARGETS;
 private:
     std::string CTYPE_JSON;
 private:
@@ -55,15 +57,24 @@ private:
     Graph<AdjacencyListGTFS> graphGTFS_;
     bool validate(const WebToolkit::HttpServerContext* context, vector<Point> &wayPoints,
                   GeoRouting::TravelMode &mode, GeoRouting::Metric &metric, std::string& error) const;
+    bool parsePoints(const std::string &value, std::vector<Point> &points, std::string &error) const;
 
     template<typename G>
     void outputResults(G &graph, const vector<Point> &wayPoints,
                        const vector<typename G::SearchResult> &searchResults,
                        WebToolkit::HttpServerContext *context);
     template<typename G>
+    void outputResults(G &graph, const vector<Point> &wayPoints,
+                       const vector<vector<typename G::SearchResult> > &routes,
+                       WebToolkit::HttpServerContext *context,
+                       const JSONFormatterNode::Nodes &attributes = JSONFormatterNode::Nodes());
+    template<typename G>
     void runShortestPath(G &graph, const GeoRouting::Metric &metric, vector<Point> &wayPoints,
                          vector<typename G::SearchResult> &searchResults);
     template<typename G>
+    void runAlternatives(G &graph, const GeoRouting::Metric &metric, vector<Point> &wayPoints,
+                         size_t maxAlternatives, vector<vector<typename G::SearchResult> > &routes);
+    template<typename G>
     void runShortestPathPublic(G &graph, const GeoRouting::Metric &metric, vector<Point> &wayPoints,
                                vector<typename G::SearchResult> &searchResults);
 private:
@@ -83,6 +94,11 @@ public:
     void heartBeat(WebToolkit::HttpServerContext* context);
     // routing
     void route(WebToolkit::HttpServerContext* context);
+    void routeBatch(WebToolkit::HttpServerContext* context);
+    void matrix(WebToolkit::HttpServerContext* context);
+    void optimize(WebToolkit::HttpServerContext* context);
+    void isochrone(WebToolkit::HttpServerContext* context);
+    void traffic(WebToolkit::HttpServerContext* context);
     void unloadGraph(WebToolkit::HttpServerContext *context);
     void loadGraph(WebToolkit::HttpServerContext *context);
     void getLoadedGraphs(WebToolkit::HttpServerContext *context);